@@ -60,7 +60,7 @@ extern void GetSRB_State (double met, double &thrust_level, double &prop_level);
 // Constructor
 // --------------------------------------------------------------
 Atlantis::Atlantis (OBJHANDLE hObj, int fmodel)
-: VESSEL4 (hObj, fmodel)
+: VESSEL4 (hObj, fmodel), ssmetrim (3, 1)
 {
 #ifdef _DEBUG
         // D. Beachy: for BoundsChecker debugging
@@ -72,6 +72,9 @@ Atlantis::Atlantis (OBJHANDLE hObj, int fmodel)
 	ascap           = new AscentAP (this);
 	ascapMfdId      = RegisterAscentApMfd ();
 	status          = 3;
+	gimbal_trim_valid = false;
+	ssmetrim.SetRange (0, tan(-21.0*RAD), 0.0, -tan(4.0*RAD), tan(4.0*RAD)); // pitch, yaw limits as in AutoGimbal
+	ssmetrim.SetAxisWeight (_V(1,1,0)); // roll is not trimmed by the common setting
 	gear_status     = AnimState::CLOSED;
 	gear_proc       = 0.0;
 	ldoor_drag      = rdoor_drag = 0.0;
@@ -111,7 +114,7 @@ Atlantis::Atlantis (OBJHANDLE hObj, int fmodel)
 	pET = NULL; // ET reference
 
 	center_arm      = false;
-	arm_moved       = arm_scheduled = false;
+	arm_scheduled   = false;
 	bManualSeparate = false;
 	ofs_sts_sat     = _V(0,0,0);      
 	do_eva          = false;
@@ -133,6 +136,10 @@ Atlantis::Atlantis (OBJHANDLE hObj, int fmodel)
 
 	sat_attach = CreateAttachment (false, ofs_sts_sat, _V(0,1,0), _V(0,0,1), "X");
 	rms_attach = CreateAttachment (false, arm_tip[0], arm_tip[1]-arm_tip[0], arm_tip[2]-arm_tip[0], "G", true);
+	rms_tree.AddPoints (rms_tipcomp, arm_tip, rms_tip, 3);
+	rms_ik.SetTip (arm_tip[0], arm_tip[1]-arm_tip[0], arm_tip[2]-arm_tip[0]);
+	arm_tipvel = _V(0,0,0);
+	arm_tiprot = _V(0,0,0);
 
 	// Entry particle stream
 	PARTICLESTREAMSPEC rps = {
@@ -480,6 +487,7 @@ void Atlantis::EnableRCS (bool enable)
 
 	bool enable_as = (GetAttitudeMode() == RCS_NONE || enable == false);
 	SetADCtrlMode (enable_as ? 7 : 0);
+	rcsalloc.Invalidate();
 }
 
 // --------------------------------------------------------------
@@ -613,35 +621,53 @@ void Atlantis::DefineAnimations (void)
 		_V(-2.26, 1.70, 9.65), _V(0, 1, 0), (float)(-360*RAD)); // -180 .. +180
 	anim_arm_sy = CreateAnimation (0.5);
 	parent = AddAnimationComponent (anim_arm_sy, 0, 1, rms_anim[0]);
+	rms_tree.AddAnimation (anim_arm_sy, 0.5);
+	rms_ik.AddJoint ((MGROUP_ROTATE*)rms_anim[0], 0.5);
+	rms_tipcomp = rms_tree.AddComponent (anim_arm_sy, 0, 1, rms_anim[0]);
 
 	static UINT RMSShoulderPitchGrp[1] = {GRP_Humerus};
 	rms_anim[1] = new MGROUP_ROTATE (midx, RMSShoulderPitchGrp, 1,
 		_V(-2.26, 1.70, 9.65), _V(1, 0, 0), (float)(147*RAD)); // -2 .. +145
 	anim_arm_sp = CreateAnimation (0.0136);
 	parent = AddAnimationComponent (anim_arm_sp, 0, 1, rms_anim[1], parent);
+	rms_tree.AddAnimation (anim_arm_sp, 0.0136);
+	rms_ik.AddJoint ((MGROUP_ROTATE*)rms_anim[1], 0.0136);
+	rms_tipcomp = rms_tree.AddComponent (anim_arm_sp, 0, 1, rms_anim[1], rms_tipcomp);
 
 	static UINT RMSElbowPitchGrp[3] = {GRP_radii,GRP_RMScamera,GRP_RMScamera_pivot};
 	rms_anim[2] = new MGROUP_ROTATE (midx, RMSElbowPitchGrp, 3,
 		_V(-2.26,1.55,3.10), _V(1,0,0), (float)(-162*RAD)); // -160 .. +2
 	anim_arm_ep = CreateAnimation (0.0123);
 	parent = AddAnimationComponent (anim_arm_ep, 0, 1, rms_anim[2], parent);
+	rms_tree.AddAnimation (anim_arm_ep, 0.0123);
+	rms_ik.AddJoint ((MGROUP_ROTATE*)rms_anim[2], 0.0123);
+	rms_tipcomp = rms_tree.AddComponent (anim_arm_ep, 0, 1, rms_anim[2], rms_tipcomp);
 
 	static UINT RMSWristPitchGrp[1] = {GRP_wrist};
 	rms_anim[3] = new MGROUP_ROTATE (midx, RMSWristPitchGrp, 1,
 		_V(-2.26,1.7,-3.55), _V(1,0,0), (float)(240*RAD)); // -120 .. +120
 	anim_arm_wp = CreateAnimation (0.5);
 	parent = AddAnimationComponent (anim_arm_wp, 0, 1, rms_anim[3], parent);
+	rms_tree.AddAnimation (anim_arm_wp, 0.5);
+	rms_ik.AddJoint ((MGROUP_ROTATE*)rms_anim[3], 0.5);
+	rms_tipcomp = rms_tree.AddComponent (anim_arm_wp, 0, 1, rms_anim[3], rms_tipcomp);
 
 	static UINT RMSWristYawGrp[1] = {GRP_endeffecter};
 	rms_anim[4] = new MGROUP_ROTATE (midx, RMSWristYawGrp, 1,
 		_V(-2.26,1.7,-4.9), _V(0,1,0), (float)(-240*RAD)); // -120 .. +120
 	anim_arm_wy = CreateAnimation (0.5);
 	parent = AddAnimationComponent (anim_arm_wy, 0, 1, rms_anim[4], parent);
+	rms_tree.AddAnimation (anim_arm_wy, 0.5);
+	rms_ik.AddJoint ((MGROUP_ROTATE*)rms_anim[4], 0.5);
+	rms_tipcomp = rms_tree.AddComponent (anim_arm_wy, 0, 1, rms_anim[4], rms_tipcomp);
 
 	rms_anim[5] = new MGROUP_ROTATE (LOCALVERTEXLIST, MAKEGROUPARRAY(arm_tip), 3,
 		_V(-2.26,1.7,-6.5), _V(0,0,1), (float)(894*RAD)); // -447 .. +447
 	anim_arm_wr = CreateAnimation (0.5);
 	hAC_arm = AddAnimationComponent (anim_arm_wr, 0, 1, rms_anim[5], parent);
+	rms_tree.AddAnimation (anim_arm_wr, 0.5);
+	rms_ik.AddJoint ((MGROUP_ROTATE*)rms_anim[5], 0.5);
+	rms_tipcomp = rms_tree.AddComponent (anim_arm_wr, 0, 1, rms_anim[5], rms_tipcomp);
 
 	// ***** 9. SSME pitch gimbal animations
 	double init_gimbal = -10*RAD;
@@ -743,6 +769,7 @@ void Atlantis::ToggleGrapple (void)
 {
 	HWND hDlg;
 	OBJHANDLE hV = GetAttachmentStatus (rms_attach);
+	rcsalloc.Invalidate(); // payload change
 
 	if (hV) {  // release satellite
 
@@ -781,7 +808,8 @@ void Atlantis::ToggleGrapple (void)
 	} else {             // grapple satellite
 
 		VECTOR3 gpos, grms, pos, dir, rot;
-		Local2Global (arm_tip[0], grms);  // global position of RMS tip
+		rms_tree.Update ();
+		Local2Global (rms_tip[0], grms);  // global position of RMS tip
 		
 		// Search the complete vessel list for a grappling candidate.
 		// Not very scalable ...
@@ -846,6 +874,7 @@ void Atlantis::ToggleArrest (void)
 	HWND hDlg;
 	if (SatStowed()) { // purge satellite
 		DetachChild (sat_attach, 0.1);
+		rcsalloc.Invalidate();
 		if (hDlg = oapiFindDialog (g_Param.hDLL, IDD_RMS)) {
 			SetWindowText (GetDlgItem (hDlg, IDC_PAYLOAD), "Arrest");
 			EnableWindow (GetDlgItem (hDlg, IDC_PAYLOAD), CanArrest() ? TRUE:FALSE);
@@ -896,6 +925,7 @@ void Atlantis::SeparateMMU (void)
 	GetStatus (vs);
 	hMMU = oapiCreateVessel (name, "Nasa_MMU", vs);
 	Dock (hMMU, 0, 0, 1);
+	rcsalloc.Invalidate();
 	oapiSetFocusObject (hMMU);
 }
 
@@ -925,6 +955,27 @@ void Atlantis::SetSSMEGimbal (const VECTOR3 &angle)
 	SetSSMEPosition (gimbal_pos.x/pitch_gimbal_max);
 }
 
+bool Atlantis::GetSSMETrim (VECTOR3 &angle)
+{
+	int i;
+	double ptan, ytan;
+	VECTOR3 ref, cg;
+
+	for (i = 0; i < 3; i++) {
+		GetThrusterRef (th_main[i], ref);
+		ssmetrim.SetEngine (i, ref);
+		ssmetrim.SetThrust (i, GetThrusterLevel (th_main[i]) * GetThrusterMax (th_main[i]));
+	}
+	GetSuperstructureCG (cg);
+	if (!ssmetrim.Solve (cg, _V(0,0,0), &ptan, &ytan))
+		return false;
+
+	angle.x = atan(ptan);
+	angle.y = -atan(ytan); // yaw gimbal is applied as -sin(angle.y), see SetSSMEGimbal
+	angle.z = 0.0;
+	return true;
+}
+
 // --------------------------------------------------------------
 // Autopilot function: set target pitch angle [rad]
 // during launch phase (until ET separation)
@@ -979,6 +1030,20 @@ void Atlantis::AutoGimbal (const VECTOR3 &tgt_rate)
 	double a_roll = (srb_gimbal ? a_roll_srb : a_roll_ssme);
 	double b_roll = (srb_gimbal ? b_roll_srb : b_roll_ssme);
 
+	// Feed-forward: once the SSMEs are the only engines, move the gimbals
+	// along with the trim setting as the CG drifts, so that the damped
+	// oscillators below only need to correct the residual
+	VECTOR3 trim;
+	if (!srb_gimbal && GetSSMETrim (trim)) {
+		if (gimbal_trim_valid) {
+			gimbal_pos.x += trim.x-gimbal_trim.x;
+			gimbal_pos.y += trim.y-gimbal_trim.y;
+		}
+		gimbal_trim = trim;
+		gimbal_trim_valid = true;
+	} else
+		gimbal_trim_valid = false;
+
 	// Pitch gimbal settings
 	maxdg = dt*0.3; // max gimbal speed [rad/s]
 	dgimbal = a_pitch*(avel.x-tgt_rate.x) + b_pitch*aacc.x;
@@ -1017,41 +1082,26 @@ void Atlantis::AutoRCS (const VECTOR3 &tgt_rate)
 	const double a_roll = 2e-1;
 	const double b_roll = 6e-2;
 
-	VECTOR3 avel, aacc;
+	VECTOR3 avel, aacc, rcs, lin;
 	GetAngularVel(avel);
 	GetAngularAcc(aacc);
-	double dt = oapiGetSimStep();
-	double drcs;
 
-	// Pitch RCS settings
-	drcs = a_pitch*(tgt_rate.x-avel.x) - b_pitch*aacc.x;
-	if (drcs > 0.0) {
-		SetThrusterGroupLevel(THGROUP_ATT_PITCHUP, min(drcs, 1.0));
-		SetThrusterGroupLevel(THGROUP_ATT_PITCHDOWN, 0);
-	} else {
-		SetThrusterGroupLevel(THGROUP_ATT_PITCHUP, 0);
-		SetThrusterGroupLevel(THGROUP_ATT_PITCHDOWN, min(-drcs, 1.0));
-	}
+	rcs.x = a_pitch*(tgt_rate.x-avel.x) - b_pitch*aacc.x; // pitch
+	rcs.y = a_yaw  *(tgt_rate.y-avel.y) - b_yaw  *aacc.y; // yaw
+	rcs.z = a_roll *(tgt_rate.z-avel.z) - b_roll *aacc.z; // roll
+	rcs.x = max (-1.0, min (1.0, rcs.x));
+	rcs.y = max (-1.0, min (1.0, rcs.y));
+	rcs.z = max (-1.0, min (1.0, rcs.z));
 
-	// Yaw RCS settings
-	drcs = a_yaw*(tgt_rate.y-avel.y) - b_yaw*aacc.y;
-	if (drcs > 0.0) {
-		SetThrusterGroupLevel(THGROUP_ATT_YAWLEFT, min(drcs, 1.0));
-		SetThrusterGroupLevel(THGROUP_ATT_YAWRIGHT, 0);
-	} else {
-		SetThrusterGroupLevel(THGROUP_ATT_YAWLEFT, 0);
-		SetThrusterGroupLevel(THGROUP_ATT_YAWRIGHT, min(-drcs, 1.0));
-	}
+	// pass through any manual translation command, since the allocator
+	// sets the levels of all RCS thrusters
+	lin.x = GetManualControlLevel (THGROUP_ATT_RIGHT,   MANCTRL_LINMODE) - GetManualControlLevel (THGROUP_ATT_LEFT, MANCTRL_LINMODE);
+	lin.y = GetManualControlLevel (THGROUP_ATT_UP,      MANCTRL_LINMODE) - GetManualControlLevel (THGROUP_ATT_DOWN, MANCTRL_LINMODE);
+	lin.z = GetManualControlLevel (THGROUP_ATT_FORWARD, MANCTRL_LINMODE) - GetManualControlLevel (THGROUP_ATT_BACK, MANCTRL_LINMODE);
 
-	// Roll RCS settings
-	drcs = a_roll*(tgt_rate.z-avel.z) - b_roll*aacc.z;
-	if (drcs > 0.0) {
-		SetThrusterGroupLevel(THGROUP_ATT_BANKRIGHT, min(drcs, 1.0));
-		SetThrusterGroupLevel(THGROUP_ATT_BANKLEFT, 0);
-	} else {
-		SetThrusterGroupLevel(THGROUP_ATT_BANKRIGHT, 0);
-		SetThrusterGroupLevel(THGROUP_ATT_BANKLEFT, min(-drcs, 1.0));
-	}
+	// distribute the combined command over the individual RCS thrusters
+	if (!rcsalloc.Valid (this)) rcsalloc.Setup (this);
+	rcsalloc.SetLevels (this, lin, rcs);
 }
 
 
@@ -1229,6 +1279,7 @@ void Atlantis::RevertSpeedbrake (void)
 void Atlantis::SetAnimationArm (UINT anim, double state)
 {
 	SetAnimation (anim, state);
+	rms_tree.SetState (anim, state);
 	arm_scheduled = true;
 
 	HWND hDlg;
@@ -1238,6 +1289,22 @@ void Atlantis::SetAnimationArm (UINT anim, double state)
 	}
 }
 
+bool Atlantis::MoveArmTip (const VECTOR3 &dpos, const VECTOR3 &drot, double dpmax)
+{
+	double *state[6] = {&arm_sy, &arm_sp, &arm_ep, &arm_wp, &arm_wy, &arm_wr};
+	UINT anim[6] = {anim_arm_sy, anim_arm_sp, anim_arm_ep, anim_arm_wp, anim_arm_wy, anim_arm_wr};
+	double s[6];
+	int i;
+
+	for (i = 0; i < 6; i++) s[i] = *state[i];
+	bool ok = rms_ik.Move (s, dpos, drot, dpmax);
+	for (i = 0; i < 6; i++) {
+		if (s[i] != *state[i])
+			SetAnimationArm (anim[i], *state[i] = s[i]);
+	}
+	return ok;
+}
+
 void Atlantis::RedrawPanel_MFDButton (SURFHANDLE surf, int mfd)
 {
 	HDC hDC = oapiGetDC (surf);
@@ -1562,6 +1629,7 @@ void Atlantis::clbkPreStep (double simt, double simdt, double mjd)
 
 		if (bManualSeparate && GetAttachmentStatus (sat_attach)) {
 			DetachChild (sat_attach, 0.1);
+			rcsalloc.Invalidate();
 			bManualSeparate = false;
 		}
 
@@ -1667,13 +1735,17 @@ void Atlantis::clbkPreStep (double simt, double simdt, double mjd)
 		}
 	}
 
-	if (arm_moved) {
-		SetAttachmentParams (rms_attach, arm_tip[0], arm_tip[1]-arm_tip[0], arm_tip[2]-arm_tip[0]);
-		arm_moved = false;
-	}
+	// ***** RMS end effector control *****
+
+	if (!center_arm && (length (arm_tipvel) || length (arm_tiprot)))
+		MoveArmTip (arm_tipvel*simdt, arm_tiprot*simdt, ARM_OPERATING_SPEED*simdt);
+
+	// the tip points are evaluated locally, so the attachment follows
+	// the arm in the same frame rather than after the visual is updated
 	if (arm_scheduled) {
 		arm_scheduled = false;
-		arm_moved = true;
+		rms_tree.Update ();
+		SetAttachmentParams (rms_attach, rms_tip[0], rms_tip[1]-rms_tip[0], rms_tip[2]-rms_tip[0]);
 	}
 }
 
@@ -1728,8 +1800,9 @@ void Atlantis::clbkVisualCreated (VISHANDLE _vis, int refcount)
 	if (refcount > 1) return; // we don't support more than one visual per object
 	vis = _vis;
 
-	// make sure the RMS attachment point is in sync with the animation state of the visual
-	SetAttachmentParams (rms_attach, arm_tip[0], arm_tip[1]-arm_tip[0], arm_tip[2]-arm_tip[0]);
+	// make sure the RMS attachment point is in sync with the animation state
+	rms_tree.Update ();
+	SetAttachmentParams (rms_attach, rms_tip[0], rms_tip[1]-rms_tip[0], rms_tip[2]-rms_tip[0]);
 }
 
 // --------------------------------------------------------------
@@ -2300,11 +2373,41 @@ BOOL CALLBACK RMS_DlgProc (HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 		return FALSE;
 	case WM_DESTROY:
 		KillTimer (hWnd, 1);
+		sts->arm_tipvel = sts->arm_tiprot = _V(0,0,0);
 		return 0;
 	case WM_TIMER:
 		if (wParam == 1) {
 			t1 = oapiGetSimTime();
-			if (SendDlgItemMessage (hWnd, IDC_SHOULDER_YAWLEFT, BM_GETSTATE, 0, 0) & BST_PUSHED) {
+			sts->arm_tipvel = sts->arm_tiprot = _V(0,0,0);
+			if (SendDlgItemMessage (hWnd, IDC_ARMIK, BM_GETCHECK, 0, 0) == BST_CHECKED) {
+				// end effector mode: the shoulder and elbow buttons translate the tip
+				// (elbow up/down = forward/aft), the wrist buttons rotate it, in the
+				// orbiter frame. The joint states are updated in clbkPreStep
+				if (SendDlgItemMessage (hWnd, IDC_SHOULDER_YAWLEFT, BM_GETSTATE, 0, 0) & BST_PUSHED)
+					sts->arm_tipvel.x = -ARM_TIP_SPEED;
+				else if (SendDlgItemMessage (hWnd, IDC_SHOULDER_YAWRIGHT, BM_GETSTATE, 0, 0) & BST_PUSHED)
+					sts->arm_tipvel.x = ARM_TIP_SPEED;
+				else if (SendDlgItemMessage (hWnd, IDC_SHOULDER_PITCHUP, BM_GETSTATE, 0, 0) & BST_PUSHED)
+					sts->arm_tipvel.y = ARM_TIP_SPEED;
+				else if (SendDlgItemMessage (hWnd, IDC_SHOULDER_PITCHDOWN, BM_GETSTATE, 0, 0) & BST_PUSHED)
+					sts->arm_tipvel.y = -ARM_TIP_SPEED;
+				else if (SendDlgItemMessage (hWnd, IDC_ELBOW_PITCHUP, BM_GETSTATE, 0, 0) & BST_PUSHED)
+					sts->arm_tipvel.z = ARM_TIP_SPEED;
+				else if (SendDlgItemMessage (hWnd, IDC_ELBOW_PITCHDOWN, BM_GETSTATE, 0, 0) & BST_PUSHED)
+					sts->arm_tipvel.z = -ARM_TIP_SPEED;
+				else if (SendDlgItemMessage (hWnd, IDC_WRIST_PITCHUP, BM_GETSTATE, 0, 0) & BST_PUSHED)
+					sts->arm_tiprot.x = ARM_TIP_RATE;
+				else if (SendDlgItemMessage (hWnd, IDC_WRIST_PITCHDOWN, BM_GETSTATE, 0, 0) & BST_PUSHED)
+					sts->arm_tiprot.x = -ARM_TIP_RATE;
+				else if (SendDlgItemMessage (hWnd, IDC_WRIST_YAWLEFT, BM_GETSTATE, 0, 0) & BST_PUSHED)
+					sts->arm_tiprot.y = ARM_TIP_RATE;
+				else if (SendDlgItemMessage (hWnd, IDC_WRIST_YAWRIGHT, BM_GETSTATE, 0, 0) & BST_PUSHED)
+					sts->arm_tiprot.y = -ARM_TIP_RATE;
+				else if (SendDlgItemMessage (hWnd, IDC_WRIST_ROLLLEFT, BM_GETSTATE, 0, 0) & BST_PUSHED)
+					sts->arm_tiprot.z = -ARM_TIP_RATE;
+				else if (SendDlgItemMessage (hWnd, IDC_WRIST_ROLLRIGHT, BM_GETSTATE, 0, 0) & BST_PUSHED)
+					sts->arm_tiprot.z = ARM_TIP_RATE;
+			} else if (SendDlgItemMessage (hWnd, IDC_SHOULDER_YAWLEFT, BM_GETSTATE, 0, 0) & BST_PUSHED) {
 				sts->arm_sy = min (1.0, sts->arm_sy + (t1-t0)*ARM_OPERATING_SPEED);
 				sts->SetAnimationArm (sts->anim_arm_sy, sts->arm_sy);
 			} else if (SendDlgItemMessage (hWnd, IDC_SHOULDER_YAWRIGHT, BM_GETSTATE, 0, 0) & BST_PUSHED) {
@@ -13,6 +13,10 @@
 #define __ATLANTIS_H
 
 #include "orbitersdk.h"
+#include "..\..\Common\Vessel\RcsAlloc.h"
+#include "..\..\Common\Vessel\GimbalTrim.h"
+#include "..\..\Common\Vessel\AnimTree.h"
+#include "..\..\Common\Vessel\ArmIK.h"
 #include <math.h>
 
 #ifdef ATLANTIS_TANK_MODULE
@@ -89,6 +93,12 @@ const double SPEEDBRAKE_OPERATING_SPEED = 0.20284;
 const double ARM_OPERATING_SPEED = 0.005;
 // RMS arm joint rotation speed (rad/sec)
 
+const double ARM_TIP_SPEED = 0.3;
+// RMS end effector translation speed in end effector mode (m/sec)
+
+const double ARM_TIP_RATE = 3.0*RAD;
+// RMS end effector rotation rate in end effector mode (rad/sec)
+
 const VECTOR3 ORBITER_CS = {234.8,389.1,68.2};
 // Orbiter cross sections (projections into principal axes) [m^2]
 
@@ -266,6 +276,9 @@ public:
 	void OperateSpeedbrake (AnimState::Action action);
 	void RevertSpeedbrake ();
 	void SetAnimationArm (UINT anim, double state);
+	bool MoveArmTip (const VECTOR3 &dpos, const VECTOR3 &drot, double dpmax);  // dpmax: max. joint state change
+	// translate and rotate the RMS end effector in the orbiter frame, by solving
+	// for the joint states. Returns false if the target could not be reached exactly
 
 	double GetSRBThrustLevel (int which);
 	// returns the thrust level from left (which=0) or right (which=1)
@@ -290,7 +303,7 @@ public:
 	double spdb_proc; // Speedbrake deployment state (0=retracted, 1=deployed)
 	double ldoor_drag, rdoor_drag; // drag components from open cargo doors
 	bool center_arm;
-	bool arm_moved, arm_scheduled;
+	bool arm_scheduled;
 	double center_arm_t;
 	bool do_eva;
 	bool do_plat;
@@ -302,6 +315,9 @@ public:
 	char cargo_static_mesh_name[256];
 	ATTACHMENTHANDLE sat_attach, rms_attach;
 	VECTOR3 arm_tip[3];
+	VECTOR3 rms_tip[3];  // current RMS tip reference points, evaluated by rms_tree
+	VECTOR3 arm_tipvel;  // commanded RMS end effector velocity [m/s]
+	VECTOR3 arm_tiprot;  // commanded RMS end effector angular velocity [rad/s]
 
 	// Overloaded callback functions
 	void clbkSetClassCaps (FILEHANDLE cfg);
@@ -353,6 +369,10 @@ private:
 	void SetSSMEGimbal (const VECTOR3 &angle);
 	// Set the gimbal positions for the shuttle main engines
 
+	bool GetSSMETrim (VECTOR3 &angle);
+	// Returns the common SSME pitch,yaw gimbal setting that balances the
+	// SSME thrust moment about the current stack CG
+
 	double GetAscentPitchRate (double tgt_pitch);
 	// Autopilot function: returns the pitch rate for the specified
 	// target pitch during launch phase (until ET separation)
@@ -374,11 +394,15 @@ private:
 	ATTACHMENTHANDLE CanArrest() const;
 
 	AscentAP *ascap;                           // ascent autopilot
+	RcsAllocator rcsalloc;                     // RCS thruster allocation for autopilot commands
 	int ascapMfdId;                            // ID for ascent autopilot MFD mode
 	Atlantis_Tank *pET;                        // pointer to ET object (if attached)
 	DOCKHANDLE hDockET;                        // docking connector to ET
 
 	VECTOR3 gimbal_pos;                        // gimbal settings for pitch,yaw,roll
+	GimbalTrim ssmetrim;                       // SSME moment balance solver
+	VECTOR3 gimbal_trim;                       // SSME trim setting applied in the last step
+	bool gimbal_trim_valid;                    // gimbal_trim is up to date
 
 	UINT anim_door;                            // handle for cargo door animation
 	UINT anim_rad;                             // handle for radiator animation
@@ -403,6 +427,9 @@ private:
 	// RMS arm animation status
 	ANIMATIONCOMPONENT_HANDLE hAC_arm, hAC_sat, hAC_satref;
 	MGROUP_TRANSFORM *rms_anim[6];
+	AnimTree rms_tree;                         // vessel-side copy of the RMS joint hierarchy
+	int rms_tipcomp;                           // rms_tree component carrying the tip points
+	ArmIK rms_ik;                              // RMS inverse kinematics, parametrised by joint states
 	MGROUP_TRANSFORM *ssme_anim[3];
 	UINT anim_arm_sy, anim_arm_sp, anim_arm_ep, anim_arm_wp, anim_arm_wy, anim_arm_wr;
 	double arm_sy, arm_sp, arm_ep, arm_wp, arm_wy, arm_wr;
@@ -82,6 +82,7 @@
 #define IDC_SSMETHRUST                  1060
 #define IDC_SRB_R                       1061
 #define IDC_ALTITUDE                    1061
+#define IDC_ARMIK                       1062
 
 // Next default values for new objects
 // 
@@ -89,7 +90,7 @@
 #ifndef APSTUDIO_READONLY_SYMBOLS
 #define _APS_NEXT_RESOURCE_VALUE        116
 #define _APS_NEXT_COMMAND_VALUE         40001
-#define _APS_NEXT_CONTROL_VALUE         1062
+#define _APS_NEXT_CONTROL_VALUE         1063
 #define _APS_NEXT_SYMED_VALUE           101
 #endif
 #endif
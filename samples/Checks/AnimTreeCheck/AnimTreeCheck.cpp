@@ -0,0 +1,234 @@
+// ==============================================================
+//                 ORBITER MODULE: AnimTreeCheck
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// AnimTreeCheck.cpp
+// Headless consistency and timing check for AnimTree, using the
+// animation hierarchy of the Atlantis RMS.
+//
+// (a) The RMS tip points evaluated by the tree must agree with the
+//     end effector frame of ArmIK::Forward, which Atlantis uses to
+//     move the arm, for random joint states.
+// (b) Incremental updates: an RMS tree with extra branches (a camera
+//     on the elbow, a telescopic boom and a scaled part) receives
+//     random state changes of random subsets of its animations. After
+//     each Update, all transforms must match a tree evaluated from
+//     scratch with the same states, and Update must report whether
+//     anything changed.
+// (c) CPU time per Update of the RMS chain, with all joints moving,
+//     with the wrist roll moving only, and without changes.
+// Returns nonzero if a check fails.
+// ==============================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include "..\..\Common\Vessel\AnimTree.h"
+#include "..\..\Common\Vessel\ArmIK.h"
+
+const int NJOINT = 6;
+static const double defstate[NJOINT] = {0.5, 0.0136, 0.0123, 0.5, 0.5, 0.5};
+
+static double Rnd ()
+{
+	return (double)rand()/(double)RAND_MAX;
+}
+
+// ==============================================================
+// RMS hierarchy (see Atlantis::DefineAnimations)
+
+struct RMS {
+	MGROUP_ROTATE *rot[NJOINT];
+	MGROUP_ROTATE *cam;
+	MGROUP_TRANSLATE *boom;
+	MGROUP_SCALE *scl;
+	VECTOR3 tip[3], tipout[3];
+	int tipcomp, ncomp;
+	UINT nanim;
+};
+
+static void MakeRMS (RMS &rms)
+{
+	rms.rot[0] = new MGROUP_ROTATE (0, 0, 0, _V(-2.26,1.70, 9.65), _V(0,1,0), (float)(-360*RAD));
+	rms.rot[1] = new MGROUP_ROTATE (0, 0, 0, _V(-2.26,1.70, 9.65), _V(1,0,0), (float)( 147*RAD));
+	rms.rot[2] = new MGROUP_ROTATE (0, 0, 0, _V(-2.26,1.55, 3.10), _V(1,0,0), (float)(-162*RAD));
+	rms.rot[3] = new MGROUP_ROTATE (0, 0, 0, _V(-2.26,1.70,-3.55), _V(1,0,0), (float)( 240*RAD));
+	rms.rot[4] = new MGROUP_ROTATE (0, 0, 0, _V(-2.26,1.70,-4.90), _V(0,1,0), (float)(-240*RAD));
+	rms.rot[5] = new MGROUP_ROTATE (0, 0, 0, _V(-2.26,1.70,-6.50), _V(0,0,1), (float)( 894*RAD));
+	rms.cam  = new MGROUP_ROTATE (0, 0, 0, _V(-2.0,1.6,2.0), _V(0,1,0), (float)(340*RAD));
+	rms.boom = new MGROUP_TRANSLATE (0, 0, 0, _V(0,0.5,-2.0));
+	rms.scl  = new MGROUP_SCALE (0, 0, 0, _V(-2.26,1.70,9.65), _V(1.2,0.8,1.5));
+	rms.tip[0] = _V(-2.26,1.71,-6.5);
+	rms.tip[1] = _V(-2.26,1.71,-7.5);
+	rms.tip[2] = _V(-2.26,2.71,-6.5);
+}
+
+static void FreeRMS (RMS &rms)
+{
+	for (int i = 0; i < NJOINT; i++) delete rms.rot[i];
+	delete rms.cam;
+	delete rms.boom;
+	delete rms.scl;
+}
+
+// The RMS chain; with branches, also a camera pan on the elbow
+// (animation 6), a boom extension on the shoulder pitch (animation 7)
+// and a scaled part at the root (animation 8)
+static void BuildTree (AnimTree &tree, RMS &rms, bool branches)
+{
+	int i, comp = -1, elbow = -1, shoulder = -1;
+	for (i = 0; i < NJOINT; i++) {
+		tree.AddAnimation (i, defstate[i]);
+		comp = tree.AddComponent (i, 0, 1, rms.rot[i], comp);
+		if (i == 1) shoulder = comp;
+		if (i == 2) elbow = comp;
+	}
+	rms.tipcomp = comp;
+	tree.AddPoints (comp, rms.tip, rms.tipout, 3);
+	rms.nanim = NJOINT;
+	if (branches) {
+		tree.AddAnimation (6, 0.5);
+		tree.AddComponent (6, 0, 1, rms.cam, elbow);
+		tree.AddAnimation (7, 0.0);
+		tree.AddComponent (7, 0.2, 0.8, rms.boom, shoulder);  // moves only between states 0.2 and 0.8
+		tree.AddAnimation (8, 0.0);
+		tree.AddComponent (8, 0, 1, rms.scl);
+		rms.nanim = 9;
+	}
+	rms.ncomp = tree.ComponentCount();
+}
+
+static double Diff (const AnimTree &a, const AnimTree &b)
+{
+	double d = 0.0;
+	for (int c = 0; c < a.ComponentCount(); c++) {
+		const MATRIX3 &Ra = a.Rotation (c), &Rb = b.Rotation (c);
+		for (int k = 0; k < 9; k++)
+			d = max (d, fabs (Ra.data[k]-Rb.data[k]));
+		d = max (d, length (a.Offset (c)-b.Offset (c)));
+	}
+	return d;
+}
+
+// ==============================================================
+// (a) Agreement with ArmIK::Forward
+
+static bool CheckForward (int ntest)
+{
+	RMS rms;
+	MakeRMS (rms);
+	AnimTree tree;
+	BuildTree (tree, rms, false);
+	ArmIK ik;
+	int i, k;
+	for (i = 0; i < NJOINT; i++)
+		ik.AddJoint (rms.rot[i], defstate[i]);
+	ik.SetTip (rms.tip[0], rms.tip[1]-rms.tip[0], rms.tip[2]-rms.tip[0]);
+
+	double perr = 0.0, derr = 0.0;
+	srand (1);
+	for (k = 0; k < ntest; k++) {
+		double p[NJOINT];
+		VECTOR3 pos, dir, rot;
+		for (i = 0; i < NJOINT; i++)
+			tree.SetState (i, p[i] = Rnd());
+		tree.Update ();
+		ik.Forward (p, pos, dir, rot);
+		perr = max (perr, length (rms.tipout[0]-pos));
+		derr = max (derr, length (unit (rms.tipout[1]-rms.tipout[0])-dir));
+		derr = max (derr, length (unit (rms.tipout[2]-rms.tipout[0])-rot));
+	}
+	printf ("forward: %d states, max. tip deviation from ArmIK %.1e m, direction %.1e\n", ntest, perr, derr);
+	FreeRMS (rms);
+	return perr < 1e-9 && derr < 1e-9;
+}
+
+// ==============================================================
+// (b) Incremental updates against evaluation from scratch
+
+static bool CheckIncremental (int nstep)
+{
+	RMS rms;
+	MakeRMS (rms);
+	AnimTree tree;
+	BuildTree (tree, rms, true);
+	double state[9], err = 0.0;
+	int i, k, nwrong = 0, nchange = 0;
+	for (i = 0; i < (int)rms.nanim; i++)
+		state[i] = (i < NJOINT ? defstate[i] : i == 6 ? 0.5 : 0.0);
+
+	srand (2);
+	for (k = 0; k < nstep; k++) {
+		// change a random subset, sometimes none, sometimes to the same value
+		bool changed = false;
+		int nset = rand() % 4;
+		for (i = 0; i < nset; i++) {
+			int a = rand() % rms.nanim;
+			double s = (rand() % 5 ? Rnd() : state[a]);
+			if (s != state[a]) changed = true;
+			tree.SetState (a, state[a] = s);
+		}
+		if (tree.Update () != changed) nwrong++;
+		if (changed) nchange++;
+
+		if (k % 10 == 0 || k == nstep-1) {
+			AnimTree ref;
+			BuildTree (ref, rms, true);
+			for (i = 0; i < (int)rms.nanim; i++)
+				ref.SetState (i, state[i]);
+			ref.Update ();
+			err = max (err, Diff (tree, ref));
+		}
+	}
+	printf ("incremental: %d updates (%d with changes), max. deviation from full evaluation %.1e, wrong return values %d\n",
+		nstep, nchange, err, nwrong);
+	FreeRMS (rms);
+	return err < 1e-12 && nwrong == 0;
+}
+
+// ==============================================================
+// (c) Timing
+
+static void Time (int nupdate, int nmove, const char *label)
+{
+	RMS rms;
+	MakeRMS (rms);
+	AnimTree tree;
+	BuildTree (tree, rms, false);
+	double s = 0.0, sum = 0.0;
+	int i, k;
+	clock_t t0 = clock();
+	for (k = 0; k < nupdate; k++) {
+		s += 1e-6;
+		for (i = NJOINT-nmove; i < NJOINT; i++)
+			tree.SetState (i, defstate[i] + s);
+		tree.Update ();
+		sum += rms.tipout[0].x;
+	}
+	clock_t t1 = clock();
+	printf ("RMS update, %-18s %6.0f ns (checksum %.3f)\n", label,
+		1e9*(double)(t1-t0)/CLOCKS_PER_SEC/nupdate, sum/nupdate);
+	FreeRMS (rms);
+}
+
+// ==============================================================
+
+int main (int argc, char *argv[])
+{
+	const int nupdate = argc > 1 ? atoi (argv[1]) : 2000000;
+	bool ok = true;
+
+	ok = CheckForward (10000) && ok;
+	ok = CheckIncremental (20000) && ok;
+	printf ("\n");
+
+	Time (nupdate, NJOINT, "all joints moving:");
+	Time (nupdate, 1, "wrist roll moving:");
+	Time (nupdate, 0, "no change:");
+
+	printf ("\n%s\n", ok ? "all checks passed" : "CHECK FAILED");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,179 @@
+// ==============================================================
+//                 ORBITER MODULE: ArmIKCheck
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// ArmIKCheck.cpp
+// Headless accuracy, convergence and rate limit check for ArmIK,
+// using the joint geometry of the Atlantis RMS.
+//
+// (a) Solve: targets generated by Forward from random joint states
+//     within the limits are solved from a start within +-0.05 of the
+//     target states. Reports the convergence rate, separately for
+//     targets close to the singular poses, the iteration count and
+//     the worst position and orientation error of the converged
+//     solutions. At least 99% of the regular targets must converge.
+// (b) Move: the end effector is jogged along each axis, and rotated
+//     about each axis, at the RMS dialog rates (ARM_TIP_SPEED,
+//     ARM_TIP_RATE) with the joint rate limit of Atlantis::MoveArmTip
+//     (ARM_OPERATING_SPEED), for a range of time steps. Reports the
+//     achieved fraction of the commanded move. No joint may move
+//     faster than the limit, and the tip must stay on the commanded
+//     line.
+// Returns nonzero if a check fails.
+// ==============================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "..\..\Common\Vessel\ArmIK.h"
+
+// Atlantis RMS parameters (see Atlantis.h, Atlantis::DefineAnimations)
+const double ARM_OPERATING_SPEED = 0.005;    // joint state rate [1/s]
+const double ARM_TIP_SPEED = 0.3;            // end effector speed [m/s]
+const double ARM_TIP_RATE = 3.0*RAD;         // end effector rotation rate [rad/s]
+
+static const double defstate[6] = {0.5, 0.0136, 0.0123, 0.5, 0.5, 0.5};
+
+static void MakeRMS (ArmIK &ik)
+{
+	ik.AddJoint (_V(-2.26,1.70, 9.65), _V(0,1,0), 0, 1, -360*RAD, defstate[0]); // shoulder yaw
+	ik.AddJoint (_V(-2.26,1.70, 9.65), _V(1,0,0), 0, 1,  147*RAD, defstate[1]); // shoulder pitch
+	ik.AddJoint (_V(-2.26,1.55, 3.10), _V(1,0,0), 0, 1, -162*RAD, defstate[2]); // elbow pitch
+	ik.AddJoint (_V(-2.26,1.70,-3.55), _V(1,0,0), 0, 1,  240*RAD, defstate[3]); // wrist pitch
+	ik.AddJoint (_V(-2.26,1.70,-4.90), _V(0,1,0), 0, 1, -240*RAD, defstate[4]); // wrist yaw
+	ik.AddJoint (_V(-2.26,1.70,-6.50), _V(0,0,1), 0, 1,  894*RAD, defstate[5]); // wrist roll
+	VECTOR3 tip0 = _V(-2.26,1.71,-6.5), tip1 = _V(-2.26,1.71,-7.5), tip2 = _V(-2.26,2.71,-6.5);
+	ik.SetTip (tip0, tip1-tip0, tip2-tip0);
+}
+
+static double Rnd ()
+{
+	return (double)rand()/(double)RAND_MAX;
+}
+
+// Angle between two end effector frames [rad]
+static double FrameAngle (const VECTOR3 &d1, const VECTOR3 &r1, const VECTOR3 &d2, const VECTOR3 &r2)
+{
+	double a1 = acos (min (1.0, max (-1.0, dotp (d1, d2))));
+	double a2 = acos (min (1.0, max (-1.0, dotp (r1, r2))));
+	return max (a1, a2);
+}
+
+// ==============================================================
+// (a) Accuracy and convergence of Solve
+
+// Joint states close to the singular poses of the RMS: stretched elbow,
+// and wrist yaw at +-90 deg (wrist pitch and roll axes aligned)
+static bool NearSingular (const double *p)
+{
+	return p[2] < 0.12 || fabs (p[4]-0.125) < 0.06 || fabs (p[4]-0.875) < 0.06;
+}
+
+static bool CheckSolve (int ntarget, double dev, double tol)
+{
+	ArmIK ik;
+	MakeRMS (ik);
+	int i, k, g, n[2] = {0,0}, nconv[2] = {0,0}, itsum = 0, itmax = 0;
+	double perr = 0.0, rerr = 0.0;
+
+	srand (1);
+	for (k = 0; k < ntarget; k++) {
+		double pt[6], p[6];
+		VECTOR3 pos, dir, rot, cpos, cdir, crot;
+		for (i = 0; i < 6; i++) {
+			pt[i] = 0.05 + 0.9*Rnd();
+			p[i] = min (1.0, max (0.0, pt[i] + dev*(2.0*Rnd()-1.0)));
+		}
+		g = (NearSingular (pt) ? 1 : 0);
+		n[g]++;
+		ik.Forward (pt, pos, dir, rot);
+		if (!ik.Solve (p, pos, dir, rot, 20, tol)) continue;
+		nconv[g]++;
+		itsum += ik.Iterations();
+		itmax = max (itmax, ik.Iterations());
+		ik.Forward (p, cpos, cdir, crot);
+		perr = max (perr, length (cpos-pos));
+		rerr = max (rerr, FrameAngle (cdir, crot, dir, rot));
+	}
+	int nc = nconv[0]+nconv[1];
+	double rate0 = (double)nconv[0]/max (n[0], 1);
+	double rate1 = (double)nconv[1]/max (n[1], 1);
+	printf ("solve, start +-%4.2f: converged %5.1f%% of %4d regular, %5.1f%% of %4d near-singular targets\n",
+		dev, 100.0*rate0, n[0], 100.0*rate1, n[1]);
+	printf ("                   iterations %4.1f avg %2d max, error %.1e m %.1e rad\n",
+		nc ? (double)itsum/nc : 0.0, itmax, perr, rerr);
+	return nc > 0 && perr < 10.0*tol && rerr < 10.0*tol && rate0 > 0.99;
+}
+
+// ==============================================================
+// (b) End effector moves with the joint rate limit
+
+static bool CheckMove (const VECTOR3 &vel, const VECTOR3 &rate, double dt, double T, const char *label)
+{
+	ArmIK ik;
+	MakeRMS (ik);
+	double p[6] = {0.45, 0.35, 0.45, 0.45, 0.5, 0.5};  // unstowed, away from singularities
+	double q[6], dpmax = ARM_OPERATING_SPEED*dt, excess = 0.0;
+	VECTOR3 pos0, dir0, rot0, pos, dir, rot;
+	int i, n, nstep = (int)(T/dt + 0.5);
+
+	ik.Forward (p, pos0, dir0, rot0);
+	for (n = 0; n < nstep; n++) {
+		for (i = 0; i < 6; i++) q[i] = p[i];
+		ik.Move (p, vel*dt, rate*dt, dpmax);
+		for (i = 0; i < 6; i++) excess = max (excess, fabs (p[i]-q[i]) - dpmax);
+	}
+	ik.Forward (p, pos, dir, rot);
+
+	// achieved fraction of the commanded move, and deviation from the
+	// commanded line relative to the distance moved
+	VECTOR3 dp = pos-pos0;
+	double frac, dev = 0.0, ang = FrameAngle (dir, rot, dir0, rot0);
+	if (length (vel) > 0.0) {
+		VECTOR3 u = unit (vel);
+		double s = dotp (dp, u);
+		frac = s / (length (vel)*T);
+		dev = length (dp - u*s) / max (fabs (s), 1e-6);
+	} else {
+		frac = ang / (length (rate)*T);
+		dev = length (dp);
+	}
+	printf ("%-6s dt %4.2f: %5.1f%% of command, off-axis %.1e, joint rate excess %.1e\n",
+		label, dt, 100.0*frac, dev, excess);
+	return excess <= 1e-12 && frac > 0.0 && frac <= 1.0+1e-6 && dev < 0.02;
+}
+
+// ==============================================================
+
+int main (int argc, char *argv[])
+{
+	static const double dt[3] = {0.02, 0.2, 1.0};
+	static const char *axname[3] = {"x", "y", "z"};
+	const int ntarget = argc > 1 ? atoi (argv[1]) : 2000;
+	bool ok = true;
+	int i, k;
+	char label[16];
+
+	ok = CheckSolve (ntarget, 0.05, 1e-6) && ok;
+	ok = CheckSolve (ntarget, 0.05, 1e-4) && ok;  // as used by Atlantis::MoveArmTip
+	printf ("\n");
+
+	for (k = 0; k < 3; k++) {
+		for (i = 0; i < 3; i++) {
+			VECTOR3 v = _V(0,0,0), r = _V(0,0,0);
+			v.data[i] = ARM_TIP_SPEED;
+			sprintf (label, "move %s", axname[i]);
+			ok = CheckMove (v, r, dt[k], 10.0, label) && ok;
+		}
+		for (i = 0; i < 3; i++) {
+			VECTOR3 v = _V(0,0,0), r = _V(0,0,0);
+			r.data[i] = ARM_TIP_RATE;
+			sprintf (label, "rot %s", axname[i]);
+			ok = CheckMove (v, r, dt[k], 10.0, label) && ok;
+		}
+	}
+	printf ("\n%s\n", ok ? "all checks passed" : "CHECK FAILED");
+	return ok ? 0 : 1;
+}
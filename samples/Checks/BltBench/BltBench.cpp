@@ -0,0 +1,252 @@
+// ==============================================================
+//                 ORBITER MODULE: BltBench
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// BltBench.cpp
+// Headless benchmark and consistency check for BltBatch and
+// SurfaceAtlas.
+//
+// A synthetic panel frame of about 360 blits (area backgrounds,
+// switch and indicator bitmaps, colour-keyed overlays, glyph
+// readouts into a shared texture, label blits within a texture and
+// save/restore round trips through scratch surfaces) is submitted
+//   (a) directly with oapiBlt, in issue order,
+//   (b) through a BltBatch flushed after each panel area, and
+//   (c) as (b), with the small bitmaps packed into a SurfaceAtlas.
+// The target surfaces of (b) and (c) must match (a) pixel by pixel.
+// The program reports the backend calls and the CPU time per frame,
+// and returns nonzero if the results differ.
+// ==============================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+#include "..\..\Common\Vessel\BltBatch.h"
+#include "HeadlessBlt.h"
+
+// ==============================================================
+// Surfaces of the synthetic panel
+
+const int NAREA = 24;   // panel areas with their own surface
+const int NBMP  = 6;    // small bitmaps (switches, indicators)
+const int NSCR  = 2;    // scratch surfaces
+
+struct Scene {
+	SURFHANDLE area[NAREA];
+	SURFHANDLE tex;             // shared instrument texture (512x512)
+	SURFHANDLE bg;              // area background bitmap (256x128)
+	SURFHANDLE font;            // readout glyphs (136x11)
+	SURFHANDLE bmp[NBMP];       // small bitmaps (64x32)
+	SURFHANDLE scr[NSCR];       // scratch surfaces (64x64)
+	SurfaceAtlas *atlas;
+	int sprite[NBMP];
+	int aw[NAREA], ah[NAREA];
+};
+
+static void MakeScene (Scene &sc, bool useatlas)
+{
+	int i, w, h;
+	for (i = 0; i < NAREA; i++) {
+		sc.aw[i] = 64 + (i*37)%136;
+		sc.ah[i] = 32 + (i*23)%68;
+		sc.area[i] = (SURFHANDLE)HeadlessCreate (sc.aw[i], sc.ah[i], 100+i);
+	}
+	sc.tex  = (SURFHANDLE)HeadlessCreate (512, 512, 1);
+	sc.bg   = (SURFHANDLE)HeadlessCreate (256, 128, 2);
+	sc.font = (SURFHANDLE)HeadlessCreate (136, 11, 3);
+	for (i = 0; i < NBMP; i++) {
+		sc.bmp[i] = (SURFHANDLE)HeadlessCreate (64, 32, 10+i);
+		unsigned int *px = HeadlessPixels (sc.bmp[i], w, h);
+		for (int j = 0; j < w*h; j += 3) px[j] = 0; // colour key pixels
+	}
+	for (i = 0; i < NSCR; i++)
+		sc.scr[i] = (SURFHANDLE)HeadlessCreate (64, 64, 20+i);
+
+	sc.atlas = 0;
+	if (useatlas) {
+		sc.atlas = new SurfaceAtlas (256, 128);
+		for (i = 0; i < NBMP; i++)
+			sc.sprite[i] = sc.atlas->Add (sc.bmp[i], 64, 32);
+	}
+}
+
+static void FreeScene (Scene &sc)
+{
+	int i;
+	for (i = 0; i < NAREA; i++) oapiDestroySurface (sc.area[i]);
+	oapiDestroySurface (sc.tex);
+	oapiDestroySurface (sc.bg);
+	oapiDestroySurface (sc.font);
+	for (i = 0; i < NBMP; i++) oapiDestroySurface (sc.bmp[i]);
+	for (i = 0; i < NSCR; i++) oapiDestroySurface (sc.scr[i]);
+	if (sc.atlas) delete sc.atlas;
+}
+
+// ==============================================================
+// Blit submission: direct, or through the batcher
+
+struct Submit {
+	Submit (Scene &s, BltBatch *b): sc(s), batch(b) {}
+	void Blt (SURFHANDLE tgt, SURFHANDLE src, int tx, int ty, int sx, int sy, int w, int h, DWORD ck = SURF_NO_CK) {
+		if (batch) batch->Blt (tgt, src, tx, ty, sx, sy, w, h, ck);
+		else       oapiBlt (tgt, src, tx, ty, sx, sy, w, h, ck);
+	}
+	void BltBmp (SURFHANDLE tgt, int b, int tx, int ty, int sx, int sy, int w, int h, DWORD ck = SURF_NO_CK) {
+		if (sc.atlas) batch->Blt (tgt, sc.atlas, sc.sprite[b], tx, ty, sx, sy, w, h, ck);
+		else          Blt (tgt, sc.bmp[b], tx, ty, sx, sy, w, h, ck);
+	}
+	void EndArea () {  // end of a redraw callback
+		if (batch) batch->Flush();
+	}
+	Scene &sc;
+	BltBatch *batch;
+};
+
+static unsigned int rnd;
+static int Rnd (int n)
+{
+	rnd = rnd*1103515245u + 12345u;
+	return (int)((rnd >> 16) % (unsigned int)n);
+}
+
+static void Frame (Submit &s, int frame)
+{
+	Scene &sc = s.sc;
+	int i, j, k;
+	rnd = 12345u + frame;
+
+	// panel areas: background, elements, overlays
+	for (i = 0; i < NAREA; i++) {
+		SURFHANDLE a = sc.area[i];
+		int w = sc.aw[i], h = sc.ah[i];
+		int nel = 3 + Rnd (8);
+		s.Blt (a, sc.bg, 0, 0, Rnd (256-w+1), Rnd (128-h+1), w, h);
+		for (j = 0; j < nel; j++) {
+			int ew = 8 + Rnd (32), eh = 8 + Rnd (24);
+			int b = Rnd (NBMP);
+			s.BltBmp (a, b, Rnd (w-ew+1), Rnd (h-eh+1), Rnd (64-ew+1), Rnd (32-eh+1), ew, eh, Rnd (3) ? SURF_NO_CK : 0);
+		}
+		if (Rnd (6) == 0) { // save part of the area to a scratch surface, draw over it, restore
+			SURFHANDLE t = sc.scr[Rnd (NSCR)];
+			int rw = 16 + Rnd (32), rh = 8 + Rnd (16);
+			int rx = Rnd (w-rw+1), ry = Rnd (h-rh+1);
+			s.Blt (t, a, 0, 0, rx, ry, rw, rh);
+			s.BltBmp (a, Rnd (NBMP), rx, ry, 0, 0, rw, rh < 32 ? rh : 32, 0);
+			s.Blt (a, t, rx, ry, 0, 0, rw, rh, Rnd (2) ? SURF_NO_CK : 0);
+		}
+		s.EndArea ();
+	}
+
+	// readouts in the shared texture: glyphs from the font bitmap
+	for (k = 0; k < 12; k++) {
+		for (j = 0; j < 6; j++)
+			s.Blt (sc.tex, sc.font, 8 + j*8, 300 + k*16, Rnd (17)*8, 0, 8, 11);
+		s.EndArea ();
+	}
+
+	// button labels: blank, then characters, copied within the texture
+	for (k = 0; k < 4; k++) {
+		int y = 14 + k*41;
+		for (j = 0; j < 6; j++)
+			s.Blt (sc.tex, sc.tex, 132 + j*40, y, 0, 128, 32, 12);
+		for (j = 0; j < 6; j++) {
+			int x = 136 + j*40;
+			for (i = 0; i < 3; i++, x += 8)
+				s.Blt (sc.tex, sc.tex, x, y, 300 + Rnd (20)*9, 480, 8, 12);
+		}
+		s.EndArea ();
+	}
+}
+
+// ==============================================================
+
+static bool Compare (Scene &a, Scene &b)
+{
+	int i, w1, h1, w2, h2;
+	std::vector<SURFHANDLE> sa, sb;
+	for (i = 0; i < NAREA; i++) sa.push_back (a.area[i]), sb.push_back (b.area[i]);
+	for (i = 0; i < NSCR; i++) sa.push_back (a.scr[i]), sb.push_back (b.scr[i]);
+	sa.push_back (a.tex), sb.push_back (b.tex);
+	for (i = 0; i < (int)sa.size(); i++) {
+		unsigned int *p1 = HeadlessPixels (sa[i], w1, h1);
+		unsigned int *p2 = HeadlessPixels (sb[i], w2, h2);
+		if (w1 != w2 || h1 != h2 || memcmp (p1, p2, w1*h1*sizeof(unsigned int))) {
+			printf ("surface %d differs\n", i);
+			return false;
+		}
+	}
+	return true;
+}
+
+struct Result {
+	HeadlessCount cnt;
+	double us;
+	BltBatch::Stats stats;
+};
+
+static Result Run (int mode, int nframe, bool copy, Scene *keep = 0)
+{
+	Result r;
+	Scene sc;
+	BltBatch batch;
+	MakeScene (sc, mode == 2);
+	Submit s (sc, mode ? &batch : 0);
+
+	HeadlessSetCopy (copy);
+	HeadlessResetCount ();
+	clock_t t0 = clock();
+	for (int f = 0; f < nframe; f++)
+		Frame (s, f);
+	clock_t t1 = clock();
+	HeadlessSetCopy (true);
+
+	r.cnt = HeadlessGetCount ();
+	r.us = 1e6*(double)(t1-t0)/CLOCKS_PER_SEC/nframe;
+	r.stats = batch.GetStats();
+	if (keep) *keep = sc;
+	else FreeScene (sc);
+	return r;
+}
+
+int main (int argc, char *argv[])
+{
+	static const char *name[3] = {"direct", "batched", "batched+atlas"};
+	const int ncheck = 20;
+	const int ntime = argc > 1 ? atoi (argv[1]) : 2000;
+	int mode;
+	bool ok = true;
+
+	// consistency: identical frames, compare all written surfaces
+	Scene ref, sc;
+	Run (0, ncheck, true, &ref);
+	for (mode = 1; mode < 3; mode++) {
+		Run (mode, ncheck, true, &sc);
+		bool same = Compare (ref, sc);
+		printf ("%-14s %d frames: %s\n", name[mode], ncheck, same ? "identical to direct" : "MISMATCH");
+		ok = ok && same;
+		FreeScene (sc);
+	}
+	FreeScene (ref);
+
+	// backend calls and CPU time per frame, without pixel copies
+	printf ("\n%-14s %8s %8s %8s %8s %10s\n", "mode", "blt", "groups", "srcchg", "forced", "us/frame");
+	for (mode = 0; mode < 3; mode++) {
+		Result r = Run (mode, ntime, false);
+		printf ("%-14s %8.1f %8.1f %8.1f %8.1f %10.2f\n", name[mode],
+			(double)r.cnt.nblt/ntime, (double)r.cnt.ngroup/ntime, (double)r.cnt.nsrc/ntime,
+			(double)r.stats.nflush/ntime, r.us);
+	}
+
+	// the same with a simulated per-call client cost
+	HeadlessSetCost (50, 400, 200);
+	printf ("\nsimulated client cost (blt 50, group 400, source change 200)\n");
+	for (mode = 0; mode < 3; mode++) {
+		Result r = Run (mode, ntime/4, false);
+		printf ("%-14s %10.2f us/frame\n", name[mode], r.us);
+	}
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,141 @@
+// ==============================================================
+//                 ORBITER MODULE: BltBench
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// HeadlessBlt.cpp
+// Stand-in for the blitting functions of the Orbiter core.
+// Surfaces are plain 32-bit pixel buffers.
+//
+// This file deliberately does not include OrbiterAPI.h: the SDK
+// declares these functions as imports from the Orbiter core, and
+// the linker resolves the imports to the local definitions below.
+// ==============================================================
+
+#include <windows.h>
+#include <vector>
+#include <string.h>
+#include "HeadlessBlt.h"
+
+typedef void *SURFHANDLE;
+
+static const DWORD SURF_NO_CK = 0xFFFFFFFF;
+
+struct Surf {
+	int w, h;
+	std::vector<unsigned int> px;
+};
+
+static HeadlessCount count;
+static SURFHANDLE lastsrc = 0, lasttgt = 0;
+static int cost_blt = 0, cost_group = 0, cost_src = 0;
+static bool copypx = true;
+static SURFHANDLE grouptgt = 0;
+static volatile unsigned int sink = 0;
+
+static void Spend (int n)
+{
+	for (int i = 0; i < n; i++) sink += i;
+}
+
+// ==============================================================
+
+void *HeadlessCreate (int w, int h, unsigned int seed)
+{
+	Surf *s = new Surf;
+	s->w = w, s->h = h;
+	s->px.resize (w*h);
+	for (int i = 0; i < w*h; i++) {
+		seed = seed*1664525u + 1013904223u;
+		s->px[i] = seed >> 8;
+	}
+	return s;
+}
+
+unsigned int *HeadlessPixels (void *surf, int &w, int &h)
+{
+	Surf *s = (Surf*)surf;
+	w = s->w, h = s->h;
+	return &s->px[0];
+}
+
+void HeadlessResetCount ()
+{
+	memset (&count, 0, sizeof(count));
+	lastsrc = lasttgt = 0;
+}
+
+const HeadlessCount &HeadlessGetCount ()
+{
+	return count;
+}
+
+void HeadlessSetCost (int blt, int group, int src)
+{
+	cost_blt = blt, cost_group = group, cost_src = src;
+}
+
+void HeadlessSetCopy (bool copy)
+{
+	copypx = copy;
+}
+
+// ==============================================================
+// API stand-ins
+
+SURFHANDLE oapiCreateSurface (int width, int height)
+{
+	return HeadlessCreate (width, height, 0);
+}
+
+SURFHANDLE oapiCreateSurface (HBITMAP hBmp, bool release_bmp)
+{
+	return 0;
+}
+
+void oapiDestroySurface (SURFHANDLE surf)
+{
+	delete (Surf*)surf;
+}
+
+void oapiBlt (SURFHANDLE tgt, SURFHANDLE src, int tgtx, int tgty, int srcx, int srcy, int w, int h, DWORD ck)
+{
+	Surf *t = (Surf*)tgt, *s = (Surf*)src;
+	count.nblt++;
+	if (src != lastsrc) count.nsrc++, lastsrc = src, Spend (cost_src);
+	if (tgt != lasttgt) count.ntgt++, lasttgt = tgt;
+	Spend (cost_blt);
+	if (tgt != grouptgt) Spend (cost_group); // target set up for a single blit
+	if (!copypx) return;
+
+	// copy through a buffer, so that blits within a surface read the
+	// source pixels as they were before the call
+	std::vector<unsigned int> buf (w*h);
+	int i, j;
+	for (j = 0; j < h; j++)
+		for (i = 0; i < w; i++)
+			if (srcx+i >= 0 && srcx+i < s->w && srcy+j >= 0 && srcy+j < s->h)
+				buf[j*w+i] = s->px[(srcy+j)*s->w + srcx+i];
+	for (j = 0; j < h; j++)
+		for (i = 0; i < w; i++)
+			if (tgtx+i >= 0 && tgtx+i < t->w && tgty+j >= 0 && tgty+j < t->h) {
+				unsigned int c = buf[j*w+i];
+				if (ck != SURF_NO_CK && c == ck) continue;
+				t->px[(tgty+j)*t->w + tgtx+i] = c;
+			}
+}
+
+int oapiBeginBltGroup (SURFHANDLE tgt)
+{
+	count.ngroup++;
+	Spend (cost_group);
+	grouptgt = tgt;
+	return 0;
+}
+
+int oapiEndBltGroup ()
+{
+	grouptgt = 0;
+	return 0;
+}
@@ -0,0 +1,42 @@
+// ==============================================================
+//                 ORBITER MODULE: BltBench
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// HeadlessBlt.h
+// Stand-in for the blitting functions of the Orbiter core, for
+// running panel blitting code without a graphics client.
+// ==============================================================
+
+#ifndef __HEADLESSBLT_H
+#define __HEADLESSBLT_H
+
+// Backend call counters
+struct HeadlessCount {
+	long nblt;     // oapiBlt calls
+	long ngroup;   // oapiBeginBltGroup calls
+	long nsrc;     // source surface changes between consecutive blits
+	long ntgt;     // target surface changes between consecutive blits
+};
+
+// Create a surface filled with a pattern derived from seed.
+// Returns a SURFHANDLE (void*).
+void *HeadlessCreate (int w, int h, unsigned int seed);
+
+// Pixel buffer of a surface created by HeadlessCreate or oapiCreateSurface
+unsigned int *HeadlessPixels (void *surf, int &w, int &h);
+
+// Reset/read the call counters
+void HeadlessResetCount ();
+const HeadlessCount &HeadlessGetCount ();
+
+// Simulated cost of the graphics client [loop iterations] per blit,
+// per target set-up (each group, or each blit outside a group) and
+// per source change
+void HeadlessSetCost (int blt, int group, int src);
+
+// Enable/disable pixel copying (disable for timing runs)
+void HeadlessSetCopy (bool copy);
+
+#endif // !__HEADLESSBLT_H
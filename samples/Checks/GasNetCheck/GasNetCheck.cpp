@@ -0,0 +1,249 @@
+// ==============================================================
+//                 ORBITER MODULE: GasNetCheck
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// GasNetCheck.cpp
+// Headless stability, conservation and timing check for GasNetwork.
+//
+// (a) Two compartments with a link: the pressure difference must
+//     follow the backward Euler recursion
+//     dp' = dp/(1 + G dt (1/V1 + 1/V2)) for any time step.
+// (b) A station of 25 docked modules (separate networks connected by
+//     docking tunnels) with 8 compartments each, 200 in total, with
+//     random hatches and closed valves, at time steps from 0.02 s to
+//     1e6 s: the gas content (sum of p*V) must be conserved, no
+//     pressure may leave the range of the initial pressures, and at
+//     the largest step the connected compartments must equalise.
+// (c) A regulator feeding a leaking compartment from a supply tank:
+//     the pressure may not exceed the set point at any step length.
+// (d) A snapshot round trip restores the pressures.
+// (e) CPU time per step of the 200-compartment station.
+// Returns nonzero if a check fails.
+// ==============================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include "..\..\Common\Vessel\GasNet.h"
+
+const int NMOD  = 25;  // station modules
+const int NCOMP = 8;   // compartments per module
+
+static double Rnd ()
+{
+	return (double)rand()/(double)RAND_MAX;
+}
+
+// ==============================================================
+// (a) Two compartments against the backward Euler recursion
+
+static bool CheckPair ()
+{
+	static const double dt[4] = {0.02, 1.0, 100.0, 1e6};
+	const double V1 = 4.0, V2 = 24.0, G = 0.5;
+	double err = 0.0, t = 0.0;
+	for (int k = 0; k < 4; k++) {
+		GasNetwork gn;
+		int n1 = gn.AddCompartment (V1, 1e5), n2 = gn.AddCompartment (V2, 2e4);
+		gn.AddLink (n1, n2, G);
+		double d = 8e4, f = 1.0/(1.0 + G*dt[k]*(1.0/V1 + 1.0/V2));
+		for (int i = 0; i < 50; i++) {
+			gn.Step (t += 1.0, dt[k]);
+			d *= f;
+			err = max (err, fabs ((gn.Pressure (n1)-gn.Pressure (n2)) - d));
+		}
+	}
+	printf ("pair: max. deviation from backward Euler %.1e Pa\n", err);
+	return err < 1e-4;
+}
+
+// ==============================================================
+// (b) Docked station
+
+struct Station {
+	GasNetwork mod[NMOD];
+	int node[NMOD][NCOMP];
+	double V[NMOD][NCOMP];
+	int group[NMOD][NCOMP];  // connected group of each compartment
+};
+
+static int Find (int *parent, int i)
+{
+	while (parent[i] != i) i = parent[i] = parent[parent[i]];
+	return i;
+}
+
+// Modules in a tree (each docked to a random earlier module), with
+// compartment chains inside. Every 4th hatch or valve is closed.
+static void MakeStation (Station &st)
+{
+	int parent[NMOD*NCOMP];
+	int m, j;
+	srand (7);
+	for (m = 0; m < NMOD*NCOMP; m++) parent[m] = m;
+	for (m = 0; m < NMOD; m++) {
+		for (j = 0; j < NCOMP; j++) {
+			st.V[m][j] = 2.0 + 60.0*Rnd();
+			st.node[m][j] = st.mod[m].AddCompartment (st.V[m][j], 1e5*Rnd());
+		}
+		for (j = 1; j < NCOMP; j++) {
+			int k = (j > 2 && Rnd() < 0.3) ? rand() % (j-1) : j-1;
+			double G = (rand() % 4 ? 0.01 + 2.0*Rnd() : 0.0);
+			st.mod[m].AddLink (st.node[m][k], st.node[m][j], G);
+			if (G > 0.0) parent[Find (parent, m*NCOMP+j)] = Find (parent, m*NCOMP+k);
+		}
+		if (m) {
+			int o = rand() % m;
+			st.mod[m].Connect (st.node[m][0], &st.mod[o], st.node[o][NCOMP-1], 1.0);
+			parent[Find (parent, m*NCOMP)] = Find (parent, o*NCOMP+NCOMP-1);
+		}
+	}
+	for (m = 0; m < NMOD; m++)
+		for (j = 0; j < NCOMP; j++)
+			st.group[m][j] = Find (parent, m*NCOMP+j);
+}
+
+static bool CheckStation ()
+{
+	static const double dt[5] = {0.02, 1.0, 100.0, 1e4, 1e6};
+	bool ok = true;
+	for (int k = 0; k < 5; k++) {
+		Station *st = new Station;
+		MakeStation (*st);
+		int m, j, i;
+		double m0 = 0.0, pmin = 1e10, pmax = 0.0, t = 0.0;
+		for (m = 0; m < NMOD; m++)
+			for (j = 0; j < NCOMP; j++) {
+				double p = st->mod[m].Pressure (st->node[m][j]);
+				m0 += p*st->V[m][j];
+				pmin = min (pmin, p);
+				pmax = max (pmax, p);
+			}
+		double excess = 0.0;
+		for (i = 0; i < 20; i++) {
+			st->mod[i % NMOD].Step (t += 1.0, dt[k]);  // any module advances the station
+			for (m = 0; m < NMOD; m++)
+				for (j = 0; j < NCOMP; j++) {
+					double p = st->mod[m].Pressure (st->node[m][j]);
+					excess = max (excess, max (p-pmax, pmin-p));
+				}
+		}
+		// gas content, and spread within connected groups
+		double m1 = 0.0, spread = 0.0;
+		for (m = 0; m < NMOD; m++)
+			for (j = 0; j < NCOMP; j++) {
+				double p = st->mod[m].Pressure (st->node[m][j]);
+				m1 += p*st->V[m][j];
+				int g = st->group[m][j];
+				double pg = st->mod[g/NCOMP].Pressure (st->node[g/NCOMP][g%NCOMP]);
+				spread = max (spread, fabs (p-pg));
+			}
+		double err = fabs (m1-m0)/m0;
+		printf ("station dt %6.0e s: gas content error %.1e, range excess %.1e Pa, spread in groups %.1e Pa\n",
+			dt[k], err, excess, spread);
+		ok = ok && err < 1e-9 && excess < 1e-6 && (dt[k] < 1e6 || spread < 1.0);
+		delete st;
+	}
+	return ok;
+}
+
+// ==============================================================
+// (c) Regulator set point
+
+static bool CheckRegulator ()
+{
+	static const double dt[4] = {0.02, 1.0, 100.0, 1e6};
+	const double pset = 1e5;
+	double over = 0.0, pend = 0.0, t = 0.0;
+	for (int k = 0; k < 4; k++) {
+		GasNetwork gn;
+		int c = gn.AddCompartment (24.0, 5e4);
+		int s = gn.AddCompartment (2.0, 2e7);    // supply tank
+		int x = gn.AddBoundary (0.0);            // vacuum
+		gn.AddRegulator (c, s, 5.0, pset);
+		gn.AddLink (c, x, 1e-4);                 // leak
+		for (int i = 0; i < 50; i++) {
+			gn.Step (t += 1.0, dt[k]);
+			over = max (over, gn.Pressure (c)-pset);
+		}
+		if (k == 1) pend = gn.Pressure (c);
+	}
+	printf ("regulator: max. excess over set point %.1e Pa, pressure after 50 s %.0f Pa\n", over, pend);
+	return over <= 1e-6 && pend > 0.99*pset;
+}
+
+// ==============================================================
+// (d) Snapshot round trip
+
+static bool CheckSnapshot ()
+{
+	Station *st = new Station;
+	MakeStation (*st);
+	int m, j;
+	double t = 0.0, err = 0.0;
+	st->mod[0].Step (t += 1.0, 10.0);
+	SnapshotWriter w;
+	for (m = 0; m < NMOD; m++) {
+		w.BeginSection (1);
+		st->mod[m].SaveSnapshot (w);
+		w.EndSection ();
+	}
+	double p[NMOD][NCOMP];
+	for (m = 0; m < NMOD; m++)
+		for (j = 0; j < NCOMP; j++)
+			p[m][j] = st->mod[m].Pressure (st->node[m][j]);
+	st->mod[0].Step (t += 1.0, 1e4);
+
+	SnapshotReader r;
+	bool ok = r.Set (w.Data(), w.Size());
+	for (m = 0; m < NMOD && ok; m++) {
+		WORD v;
+		ok = r.BeginSection (1, v) && st->mod[m].LoadSnapshot (r);
+		r.EndSection ();
+		for (j = 0; j < NCOMP; j++)
+			err = max (err, fabs (st->mod[m].Pressure (st->node[m][j]) - p[m][j]));
+	}
+	printf ("snapshot: %s, max. pressure difference %.1e Pa\n", ok ? "restored" : "FAILED", err);
+	delete st;
+	return ok && err == 0.0;
+}
+
+// ==============================================================
+// (e) Timing
+
+static void Time (int nstep, double dt)
+{
+	Station *st = new Station;
+	MakeStation (*st);
+	double t = 0.0;
+	clock_t t0 = clock();
+	for (int i = 0; i < nstep; i++)
+		st->mod[0].Step (t += 1.0, dt);
+	clock_t t1 = clock();
+	printf ("%d compartments in %d modules, dt %6.2f s: %6.1f us/step\n", NMOD*NCOMP, NMOD, dt,
+		1e6*(double)(t1-t0)/CLOCKS_PER_SEC/nstep);
+	delete st;
+}
+
+// ==============================================================
+
+int main (int argc, char *argv[])
+{
+	const int nstep = argc > 1 ? atoi (argv[1]) : 20000;
+	bool ok = true;
+
+	ok = CheckPair () && ok;
+	ok = CheckStation () && ok;
+	ok = CheckRegulator () && ok;
+	ok = CheckSnapshot () && ok;
+	printf ("\n");
+
+	Time (nstep, 0.02);
+	Time (nstep, 1e4);
+
+	printf ("\n%s\n", ok ? "all checks passed" : "CHECK FAILED");
+	return ok ? 0 : 1;
+}
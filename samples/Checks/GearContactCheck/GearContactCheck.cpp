@@ -0,0 +1,283 @@
+// ==============================================================
+//                 ORBITER MODULE: GearContactCheck
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// GearContactCheck.cpp
+// Headless check and benchmark for GearContact and ElevationCache,
+// using the DG strut layout (see GearControl::GearControl) on a
+// synthetic heightfield.
+//
+// (a) Cache: elevations and slopes of random points are compared
+//     with the analytic heightfield. The error may not exceed the
+//     bound of bilinear interpolation.
+// (b) Rigid body runs: the DG, as a rigid body with the DG mass and
+//     inertia, driven by GearContact::Evaluate with gravity:
+//     - settling on level ground: the strut loads must balance the
+//       weight, split between nose and main gear by the lever arms;
+//     - braking from 20 m/s with full wheel brakes: the vessel must
+//       stop without yawing, and no faster than the brake force
+//       allows;
+//     - rolling with side slip at time steps up to 0.1 s: the lateral
+//       velocity must decay without oscillation building up;
+//     - rolling over hills: the vessel must stay upright.
+//     Reports the elevation source queries per step, which must stay
+//     well below the number of wheels.
+// (c) CPU time per Evaluate call.
+// Returns nonzero if a check fails.
+// ==============================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include "..\..\Common\Vessel\GearContact.h"
+
+// DG parameters (see DeltaGlider.h, DeltaGlider::SetClassCaps)
+const double MASS = 15000.0;                  // empty mass plus part of the fuel [kg]
+static const VECTOR3 PMI = {15.5, 22.1, 7.7}; // principal moments of inertia per mass [m^2]
+const double RAD0 = 6.371e6;                  // body radius [m]
+
+// ==============================================================
+// Synthetic heightfield: flat, or hills of amplitude A and wavelength L
+
+struct Terrain {
+	double A, L;
+	int nquery;
+};
+
+static double Height (const Terrain &t, double x, double z)
+{
+	if (!t.A) return 0.0;
+	double k = 2.0*PI/t.L;
+	return t.A*sin (k*x)*sin (k*z);
+}
+
+static double ElevSource (void *context, double lng, double lat)
+{
+	Terrain *t = (Terrain*)context;
+	t->nquery++;
+	return Height (*t, lng*RAD0, lat*RAD0);
+}
+
+static void MakeDG (GearContact &gc, Terrain &t)
+{
+	gc.AddStrut (_V( 0  ,-2.57,10), 0.35, 2e5, 2.4e4, 1.6, 1.6, 0.1);
+	gc.AddStrut (_V(-3.5,-2.57,-1), 0.35, 5e5, 6.1e4, 3.0, 3.0, 0.2, 1e5, 1);
+	gc.AddStrut (_V( 3.5,-2.57,-1), 0.35, 5e5, 6.1e4, 3.0, 3.0, 0.2, 1e5, 2);
+	gc.Elevation().SetSource (ElevSource, &t, RAD0);
+	gc.SetHandover (-2.0, -1.0);  // no touchdown points here: strut forces also at rest
+}
+
+// ==============================================================
+// (a) Elevation cache accuracy
+
+static bool CheckCache ()
+{
+	Terrain t = {0.5, 40.0, 0};
+	ElevationCache ec (5.0);
+	ec.SetSource (ElevSource, &t, RAD0);
+	const int n = 10000;
+	double k = 2.0*PI/t.L, h = 5.0;
+	double emax = 0.0, smax = 0.0;
+	for (int i = 0; i < n; i++) {
+		double x = 1000.0*rand()/RAND_MAX, z = 1000.0*rand()/RAND_MAX;
+		double lng = x/RAD0, lat = z/RAD0, e;
+		VECTOR3 s;
+		ec.Query (1, &lng, &lat, &e, &s);
+		emax = max (emax, fabs (e - Height (t, x, z)));
+		double sx = t.A*k*cos (k*x)*sin (k*z), sz = t.A*k*sin (k*x)*cos (k*z);
+		smax = max (smax, max (fabs (s.x-sx), fabs (s.z-sz)));
+	}
+	// interpolation error bounds: A k^2 h^2/4 for the elevation, A k^2 h for the slope
+	double ebound = t.A*k*k*h*h/4.0, sbound = t.A*k*k*h;
+	printf ("cache: max. elevation error %.3f m (bound %.3f), max. slope error %.3f (bound %.3f)\n",
+		emax, ebound, smax, sbound);
+	return emax <= ebound && smax <= sbound;
+}
+
+// ==============================================================
+// (b) Rigid body driven by the contact model
+
+struct Body {
+	VECTOR3 pos;   // position of the vessel origin (x east, y up, z north) [m]
+	VECTOR3 vel;   // velocity in the horizon frame [m/s]
+	VECTOR3 avel;  // angular velocity in the vessel frame [rad/s]
+	MATRIX3 R;     // rotation vessel -> horizon frame
+};
+
+// Rotation about a unit axis (vessel frame, Orbiter convention: the
+// velocity of a point r is crossp (r, avel))
+static MATRIX3 Rot (const VECTOR3 &w, double dt)
+{
+	double a = length (w)*dt;
+	if (!a) return identity();
+	VECTOR3 n = -w/length (w);
+	double c = cos (a), s = sin (a), t = 1.0-c;
+	return _M(t*n.x*n.x + c,     t*n.x*n.y - s*n.z, t*n.x*n.z + s*n.y,
+	          t*n.x*n.y + s*n.z, t*n.y*n.y + c,     t*n.y*n.z - s*n.x,
+	          t*n.x*n.z - s*n.y, t*n.y*n.z + s*n.x, t*n.z*n.z + c);
+}
+
+struct RunStats {
+	int nstep, ncontact;
+	double nquery;        // source queries per step
+	double load[3];       // final strut loads [N]
+	double maxdecel;      // max. horizontal deceleration [m/s^2]
+	double minup;         // min. y component of the vessel up axis
+};
+
+static RunStats Run (GearContact &gc, Terrain &t, Body &b, double dt, double T, const double *brake)
+{
+	RunStats st = {0, 0, 0.0, {0,0,0}, 0.0, 1.0};
+	VECTOR3 F[3], r[3];
+	int i, n = (int)(T/dt + 0.5);
+	t.nquery = 0;
+	for (int k = 0; k < n; k++) {
+		double lng = b.pos.x/RAD0, lat = b.pos.z/RAD0;
+		st.ncontact += gc.Evaluate (b.pos.y, lng, lat, b.R, b.vel, b.avel, MASS, PMI, dt, brake, F, r);
+		VECTOR3 Ftot = _V(0, -MASS*G, 0), tau = _V(0,0,0);
+		for (i = 0; i < gc.Count(); i++) {
+			Ftot += F[i];
+			tau += crossp (tmul (b.R, F[i]), r[i]);
+		}
+		VECTOR3 v0 = b.vel;
+		b.vel += Ftot*(dt/MASS);
+		b.pos += b.vel*dt;
+		b.avel.x += tau.x/(MASS*PMI.x)*dt;
+		b.avel.y += tau.y/(MASS*PMI.y)*dt;
+		b.avel.z += tau.z/(MASS*PMI.z)*dt;
+		b.R = mul (b.R, Rot (b.avel, dt));
+		VECTOR3 dv = (b.vel-v0)/dt;
+		st.maxdecel = max (st.maxdecel, sqrt (dv.x*dv.x + dv.z*dv.z));
+		st.minup = min (st.minup, b.R.m22);
+	}
+	st.nstep = n;
+	st.nquery = (double)t.nquery/n;
+	for (i = 0; i < gc.Count() && i < 3; i++) st.load[i] = gc.Load (i);
+	return st;
+}
+
+static Body Start (double vz, double vx)
+{
+	Body b;
+	b.pos = _V(0, 2.57+0.1, 0);
+	b.vel = _V(vx, 0, vz);
+	b.avel = _V(0,0,0);
+	b.R = identity();
+	return b;
+}
+
+static bool CheckSettle ()
+{
+	Terrain t = {0.0, 0.0, 0};
+	GearContact gc;
+	MakeDG (gc, t);
+	double brake[2] = {0,0};
+	Body b = Start (0, 0);
+	RunStats st = Run (gc, t, b, 0.01, 10.0, brake);
+	double W = MASS*G, sum = st.load[0]+st.load[1]+st.load[2];
+	double nose = W*1.0/11.0;   // lever arms: nose gear 10 m, main gear 1 m from the CG
+	bool ok = fabs (sum-W) < 0.01*W && fabs (st.load[0]-nose) < 0.02*W && fabs (b.vel.y) < 1e-3;
+	printf ("settle: loads %.0f/%.0f/%.0f N (weight %.0f, nose share %.0f), %.2f queries/step\n",
+		st.load[0], st.load[1], st.load[2], W, nose, st.nquery);
+
+	// parked: no further queries while the vessel does not move
+	st = Run (gc, t, b, 0.01, 10.0, brake);
+	printf ("parked: %.2f queries/step\n", st.nquery);
+	return ok && st.nquery == 0.0;
+}
+
+static bool CheckBrake ()
+{
+	Terrain t = {0.0, 0.0, 0};
+	GearContact gc;
+	MakeDG (gc, t);
+	double nobrake[2] = {0,0}, brake[2] = {1,1};
+	Body b = Start (20.0, 0);
+	Run (gc, t, b, 0.02, 1.0, nobrake);   // touchdown
+	double z0 = b.pos.z;
+	RunStats st = Run (gc, t, b, 0.02, 30.0, brake);
+	double amax = (2.0*1e5 + 0.2*MASS*G)/MASS;  // brake force plus rolling resistance
+	double hdg = atan2 (b.R.m13, b.R.m33);
+	printf ("brake: stopped after %.1f m, max. deceleration %.2f m/s^2 (limit %.2f), heading change %.2f deg, %.2f queries/step\n",
+		b.pos.z-z0, st.maxdecel, amax, hdg*DEG, st.nquery);
+	return length (b.vel) < 1.0 && st.maxdecel <= amax && fabs (hdg) < 1.0*RAD;
+}
+
+static bool CheckSideSlip ()
+{
+	Terrain t = {0.0, 0.0, 0};
+	GearContact gc;
+	MakeDG (gc, t);
+	double brake[2] = {0,0};
+	bool ok = true;
+	static const double dt[3] = {0.01, 0.05, 0.1};
+	for (int k = 0; k < 3; k++) {
+		Body b = Start (30.0, 2.0);
+		Run (gc, t, b, dt[k], 0.5, brake);    // touchdown
+		double v0 = fabs (b.vel.x);
+		Run (gc, t, b, dt[k], 5.0, brake);
+		double v1 = fabs (b.vel.x), w = fabs (b.avel.y);
+		printf ("side slip dt %.2f: lateral velocity %.3f -> %.3f m/s, yaw rate %.3f deg/s\n",
+			dt[k], v0, v1, w*DEG);
+		ok = ok && v1 <= v0 && v1 < 0.5 && w < 5.0*RAD;
+	}
+	return ok;
+}
+
+static bool CheckHills ()
+{
+	Terrain t = {0.3, 60.0, 0};
+	GearContact gc;
+	MakeDG (gc, t);
+	double brake[2] = {0,0};
+	Body b = Start (20.0, 0);
+	b.pos.x = 7.0;
+	RunStats st = Run (gc, t, b, 0.02, 20.0, brake);
+	printf ("hills: %.0f m rolled, min. up axis %.3f, %.2f queries/step (%d wheels)\n",
+		b.pos.z, st.minup, st.nquery, gc.Count());
+	return st.minup > 0.95 && st.nquery < gc.Count();
+}
+
+// ==============================================================
+// (c) Timing
+
+static void Time (int ncall)
+{
+	Terrain t = {0.3, 60.0, 0};
+	GearContact gc;
+	MakeDG (gc, t);
+	double brake[2] = {0.5,0.5}, sum = 0.0;
+	VECTOR3 F[3], r[3];
+	Body b = Start (10.0, 0.5);
+	b.pos.y = 2.4;
+	clock_t t0 = clock();
+	for (int k = 0; k < ncall; k++) {
+		b.pos.z = k*0.002;   // 10 m/s at 5 ms steps
+		gc.Evaluate (b.pos.y, b.pos.x/RAD0, b.pos.z/RAD0, b.R, b.vel, b.avel, MASS, PMI, 0.005, brake, F, r);
+		sum += F[0].y;
+	}
+	clock_t t1 = clock();
+	printf ("Evaluate: %.0f ns/call, %.2f queries/call (checksum %.1f)\n",
+		1e9*(double)(t1-t0)/CLOCKS_PER_SEC/ncall, (double)t.nquery/ncall, sum/ncall);
+}
+
+int main (int argc, char *argv[])
+{
+	const int ncall = argc > 1 ? atoi (argv[1]) : 2000000;
+	bool ok = true;
+
+	srand (1);
+	ok = CheckCache () && ok;
+	ok = CheckSettle () && ok;
+	ok = CheckBrake () && ok;
+	ok = CheckSideSlip () && ok;
+	ok = CheckHills () && ok;
+	printf ("\n");
+	Time (ncall);
+
+	printf ("\n%s\n", ok ? "all checks passed" : "CHECK FAILED");
+	return ok ? 0 : 1;
+}
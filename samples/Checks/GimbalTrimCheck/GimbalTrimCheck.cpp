@@ -0,0 +1,231 @@
+// ==============================================================
+//                 ORBITER MODULE: GimbalTrimCheck
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// GimbalTrimCheck.cpp
+// Headless accuracy check and benchmark for GimbalTrim.
+//
+// (a) DG: the main engine pair, set up as in
+//     GimbalControl::AutoMainGimbal, with random throttle settings
+//     and CG offsets.
+// (b) Cluster: five engines in a cross (the centre one fixed, the
+//     outer ones in two gimbal groups), with random thrust levels.
+// Half of the commanded torques are produced by a random setting
+// within the gimbal ranges. Their residual must vanish. The others
+// are random and mostly out of range. Their residual is compared with
+// a reference found by local descent from the solution, and may not
+// exceed it by more than 1%. The program reports the residuals and
+// the CPU time per solve, and returns nonzero if a check fails.
+// ==============================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include <time.h>
+#include "..\..\Common\Vessel\GimbalTrim.h"
+
+const int GT_MAXVAR = GT_MAXGROUP*2;
+
+// DG main engines (see DeltaGlider::SetClassCaps, DeltaGlider.h)
+const double MAIN_PGIMBAL_RANGE = tan (5.0*RAD);
+const double MAIN_YGIMBAL_RANGE = 1.0/7.7;
+static const VECTOR3 dg_pos[2] = {{-1,0,-7.7}, {1,0,-7.7}};
+
+static double Rnd ()
+{
+	return (double)rand()/(double)RAND_MAX;
+}
+
+// ==============================================================
+// Test layouts
+
+struct Layout {
+	int neng, ngrp;
+	VECTOR3 pos[GT_MAXENGINE];
+	int grp[GT_MAXENGINE];
+	double range[GT_MAXGROUP][4];   // pmin, pmax, ymin, ymax
+	double F[GT_MAXENGINE];
+	VECTOR3 cg;
+};
+
+static void Apply (const Layout &L, GimbalTrim &trim)
+{
+	int i;
+	for (i = 0; i < L.ngrp; i++)
+		trim.SetRange (i, L.range[i][0], L.range[i][1], L.range[i][2], L.range[i][3]);
+	for (i = 0; i < L.neng; i++) {
+		trim.SetEngine (i, L.pos[i], L.grp[i]);
+		trim.SetThrust (i, L.F[i]);
+	}
+}
+
+// DG main engines with random throttle levels and CG offset
+static void MakeDG (Layout &L)
+{
+	L.neng = L.ngrp = 2;
+	for (int i = 0; i < 2; i++) {
+		L.pos[i] = dg_pos[i];
+		L.grp[i] = i;
+		L.range[i][0] = -MAIN_PGIMBAL_RANGE, L.range[i][1] = MAIN_PGIMBAL_RANGE;
+		L.range[i][2] = -MAIN_YGIMBAL_RANGE, L.range[i][3] = MAIN_YGIMBAL_RANGE;
+		L.F[i] = (Rnd() < 0.1 ? 0.0 : Rnd());
+	}
+	if (L.F[0] == 0.0 && L.F[1] == 0.0) L.F[0] = 1.0;
+	L.cg = _V((2.0*Rnd()-1.0)*0.2, (2.0*Rnd()-1.0)*0.2, (2.0*Rnd()-1.0)*0.5);
+}
+
+// Cross of five engines: centre fixed (empty range), outer pair in
+// x and pair in y gimballed as two groups
+static void MakeCluster (Layout &L)
+{
+	static const VECTOR3 p[5] = {{0,0,-20}, {4,0,-20}, {-4,0,-20}, {0,4,-20}, {0,-4,-20}};
+	static const int g[5] = {2, 0, 0, 1, 1};
+	L.neng = 5;
+	L.ngrp = 3;
+	for (int i = 0; i < 5; i++) {
+		L.pos[i] = p[i];
+		L.grp[i] = g[i];
+		L.F[i] = 6.7e6*(0.5 + 0.5*Rnd());
+	}
+	for (int k = 0; k < 2; k++) {
+		L.range[k][0] = -0.1, L.range[k][1] = 0.1;
+		L.range[k][2] = -0.1, L.range[k][3] = 0.1;
+	}
+	L.range[2][0] = L.range[2][1] = L.range[2][2] = L.range[2][3] = 0.0;
+	L.cg = _V((2.0*Rnd()-1.0)*0.5, (2.0*Rnd()-1.0)*0.5, 0.0);
+}
+
+// ==============================================================
+// Optimality of a solution
+
+static double Residual (const GimbalTrim &trim, const Layout &L, const VECTOR3 &tcmd, const double *p, const double *y)
+{
+	VECTOR3 dT = trim.Torque (L.cg, p, y) - tcmd;
+	return dotp (dT, dT);
+}
+
+// Reference: local descent from a solution along the coordinate
+// directions and the diagonals of each pair of settings, with the step
+// size halved until it falls below 1e-9 of the range. Returns the
+// squared residual of the polished settings.
+static double Polish (const GimbalTrim &trim, const Layout &L, const VECTOR3 &tcmd, const double *p, const double *y)
+{
+	int nvar = L.ngrp*2, i, j, si, sj;
+	double x[2][GT_MAXGROUP], xt[2][GT_MAXGROUP], lo[GT_MAXVAR], hi[GT_MAXVAR];
+	for (i = 0; i < L.ngrp; i++) {
+		x[0][i] = p[i], x[1][i] = y[i];
+		lo[i*2] = L.range[i][0], hi[i*2] = L.range[i][1];
+		lo[i*2+1] = L.range[i][2], hi[i*2+1] = L.range[i][3];
+	}
+	double f = Residual (trim, L, tcmd, x[0], x[1]);
+	for (double h = 0.1; h > 1e-9; ) {
+		bool improved = false;
+		for (i = 0; i < nvar; i++) {
+			if (hi[i] <= lo[i]) continue;
+			for (j = i; j < nvar; j++) {
+				if (hi[j] <= lo[j]) continue;
+				for (si = -1; si <= 1; si += 2) {
+					for (sj = -1; sj <= (j > i ? 1 : -1); sj += 2) {
+						memcpy (xt, x, sizeof(x));
+						double *a = &xt[i%2][i/2], *b = &xt[j%2][j/2];
+						*a = min (hi[i], max (lo[i], *a + si*h*(hi[i]-lo[i])));
+						if (j > i) *b = min (hi[j], max (lo[j], *b + sj*h*(hi[j]-lo[j])));
+						double ft = Residual (trim, L, tcmd, xt[0], xt[1]);
+						if (ft < f) f = ft, memcpy (x, xt, sizeof(x)), improved = true;
+					}
+				}
+			}
+		}
+		if (!improved) h *= 0.5;
+	}
+	return f;
+}
+
+static bool Check (void (*make)(Layout&), double tscale, int nsample, const char *label)
+{
+	Layout L;
+	int n, ninrange = 0, nworse = 0;
+	double p[GT_MAXGROUP], y[GT_MAXGROUP], emax = 0.0, esum = 0.0, rmax = 0.0;
+	for (n = 0; n < nsample; n++) {
+		make (L);
+		GimbalTrim trim (L.neng, L.ngrp);
+		Apply (L, trim);
+		double fs = 0.0;  // torque scale
+		for (int i = 0; i < L.neng; i++) fs += L.F[i]*length (L.pos[i]-L.cg);
+		VECTOR3 tcmd;
+
+		if (Rnd() < 0.5) {
+			// command within range: produced by a random setting, so the
+			// balance must be achieved
+			double pt[GT_MAXGROUP], yt[GT_MAXGROUP];
+			for (int g = 0; g < L.ngrp; g++) {
+				pt[g] = L.range[g][0] + Rnd()*(L.range[g][1]-L.range[g][0]);
+				yt[g] = L.range[g][2] + Rnd()*(L.range[g][3]-L.range[g][2]);
+			}
+			tcmd = trim.Torque (L.cg, pt, yt);
+			trim.Solve (L.cg, tcmd, p, y);
+			rmax = max (rmax, sqrt (Residual (trim, L, tcmd, p, y))/fs);
+			ninrange++;
+		} else {
+			// random command, mostly out of range: the residual must be
+			// a local minimum
+			tcmd = _V(2.0*Rnd()-1.0, 2.0*Rnd()-1.0, 2.0*Rnd()-1.0)*tscale;
+			trim.Solve (L.cg, tcmd, p, y);
+			double f = Residual (trim, L, tcmd, p, y);
+			double fref = Polish (trim, L, tcmd, p, y);
+			double e = (sqrt (f) - sqrt (fref))/max (sqrt (fref), 1e-7*fs);
+			if (e > 0.01) nworse++;
+			emax = max (emax, e);
+			esum += e;
+		}
+	}
+	printf ("%-8s %d in range: max. rel. residual %.1e\n", label, ninrange, rmax);
+	printf ("%-8s %d out of range: residual above local minimum by %.1e avg, %.1e max; >1%% in %d\n",
+		"", nsample-ninrange, esum/max (nsample-ninrange, 1), emax, nworse);
+	return rmax < 1e-7 && nworse == 0;
+}
+
+static void Time (void (*make)(Layout&), double tscale, int nsolve, const char *label)
+{
+	const int nset = 64;
+	static Layout L[nset];
+	static VECTOR3 tcmd[nset];
+	GimbalTrim *trim[nset];
+	double p[GT_MAXGROUP], y[GT_MAXGROUP], sum = 0.0;
+	int n;
+	for (n = 0; n < nset; n++) {
+		make (L[n]);
+		trim[n] = new GimbalTrim (L[n].neng, L[n].ngrp);
+		Apply (L[n], *trim[n]);
+		tcmd[n] = _V(2.0*Rnd()-1.0, 2.0*Rnd()-1.0, 2.0*Rnd()-1.0)*tscale;
+	}
+	clock_t t0 = clock();
+	for (n = 0; n < nsolve; n++) {
+		trim[n%nset]->Solve (L[n%nset].cg, tcmd[n%nset], p, y);
+		sum += p[0];
+	}
+	clock_t t1 = clock();
+	for (n = 0; n < nset; n++) delete trim[n];
+	printf ("%-8s %.0f ns/solve (checksum %.3f)\n", label,
+		1e9*(double)(t1-t0)/CLOCKS_PER_SEC/nsolve, sum/nsolve);
+}
+
+int main (int argc, char *argv[])
+{
+	const int nsample = 2000;
+	const int nsolve = argc > 1 ? atoi (argv[1]) : 500000;
+	bool ok = true;
+
+	srand (1);
+	ok = Check (MakeDG, 0.3, nsample, "DG") && ok;
+	ok = Check (MakeCluster, 5e6, nsample, "cluster") && ok;
+	printf ("\n");
+	Time (MakeDG, 0.0, nsolve, "DG trim");
+	Time (MakeCluster, 5e6, nsolve, "cluster");
+
+	printf ("\n%s\n", ok ? "all checks passed" : "CHECK FAILED");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,415 @@
+// ==============================================================
+//                 ORBITER MODULE: SnapshotBench
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// SnapshotBench.cpp
+// Headless benchmark and consistency check for SnapshotWriter and
+// SnapshotReader.
+//
+// A synthetic session of 500 vessels with 30 subsystems each is
+// written with the section layout of SnapshotSaveVessel and
+// Subsystem::SaveSnapshotList (VESL/STAT/CUST, SS/DATA), and read
+// back section by section. All values must match. The same blob with
+// a single flipped bit, and a truncated copy, must be rejected.
+// For comparison, the same states are written to and parsed from
+// scenario-style text in memory.
+// The program reports the blob size and the time per save and
+// restore, and returns nonzero if any check fails.
+//
+// The vessel functions of Snapshot.cpp are never called here. They
+// are linked against orbiter.lib with Orbiter.exe delay-loaded, so
+// the program runs without the Orbiter core.
+// ==============================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <string>
+#include <vector>
+#include "..\..\Common\Vessel\Snapshot.h"
+
+const int NVESSEL = 500;
+const int NSUBSYS = 30;   // subsystems per vessel, 6 of them with 4 children each
+const int NPROP   = 3;
+const int NTHRUST = 24;
+
+// ==============================================================
+// Synthetic vessel states
+
+struct SubsysState {
+	double anim[2][2];    // two AnimState2 (state, speed)
+	int mode;
+	bool fail;
+};
+
+struct VesselState {
+	char name[32];
+	char rbody[32];
+	DWORD flag;
+	int status;
+	VECTOR3 rpos, rvel, vrot, arot;
+	double lng, lat, hdg;
+	double prop[NPROP];
+	double thrust[NTHRUST];
+	SubsysState ss[NSUBSYS];
+};
+
+static unsigned int rnd;
+static double Rnd ()
+{
+	rnd = rnd*1103515245u + 12345u;
+	return (double)(rnd >> 8) / (double)(1 << 24);
+}
+
+static void MakeStates (std::vector<VesselState> &vs)
+{
+	rnd = 12345u;
+	vs.resize (NVESSEL);
+	for (int i = 0; i < NVESSEL; i++) {
+		VesselState &v = vs[i];
+		sprintf (v.name, "GL-%03d", i);
+		strcpy (v.rbody, i%3 ? "Earth" : "Moon");
+		v.flag = 0;
+		v.status = i%4 ? 0 : 1;
+		v.rpos = _V(7e6*Rnd(), 7e6*Rnd(), 7e6*Rnd());
+		v.rvel = _V(8e3*Rnd(), 8e3*Rnd(), 8e3*Rnd());
+		v.vrot = _V(Rnd(), Rnd(), Rnd());
+		v.arot = _V(6.28*Rnd(), 6.28*Rnd(), 6.28*Rnd());
+		v.lng = 6.28*Rnd(), v.lat = 3.14*Rnd(), v.hdg = 6.28*Rnd();
+		int j, k;
+		for (j = 0; j < NPROP; j++) v.prop[j] = 1e4*Rnd();
+		for (j = 0; j < NTHRUST; j++) v.thrust[j] = Rnd();
+		for (j = 0; j < NSUBSYS; j++) {
+			SubsysState &s = v.ss[j];
+			for (k = 0; k < 2; k++) s.anim[k][0] = Rnd(), s.anim[k][1] = Rnd() - 0.5;
+			s.mode = (int)(Rnd()*4.0);
+			s.fail = Rnd() < 0.1;
+		}
+	}
+}
+
+// ==============================================================
+// Binary snapshot, with the section layout of Snapshot.cpp and
+// Subsystem::SaveSnapshotList
+
+const DWORD SNP_VESSEL = SNAPSHOT_TAG('V','E','S','L');
+const DWORD SNP_STATUS = SNAPSHOT_TAG('S','T','A','T');
+const DWORD SNP_CUSTOM = SNAPSHOT_TAG('C','U','S','T');
+const DWORD SNP_DATA   = SNAPSHOT_TAG('D','A','T','A');
+
+static inline DWORD SubsysTag (int i)
+{
+	return SNAPSHOT_TAG('S','S',i & 0xFF,i >> 8);
+}
+
+static void SaveSubsys (const SubsysState &s, SnapshotWriter &snp)
+{
+	snp.BeginSection (SNP_DATA);
+	for (int k = 0; k < 2; k++) {
+		snp.Put (s.anim[k][0]);
+		snp.Put (s.anim[k][1]);
+	}
+	snp.Put (s.mode);
+	snp.Put (s.fail);
+	snp.EndSection ();
+}
+
+static void SaveVessel (const VesselState &v, SnapshotWriter &snp)
+{
+	int i, j;
+	snp.BeginSection (SNP_VESSEL);
+	snp.PutString (v.name);
+
+	snp.BeginSection (SNP_STATUS);
+	snp.Put (v.flag);
+	snp.PutString (v.rbody);
+	snp.PutString ("");
+	snp.Put ((DWORD)0);
+	snp.Put (v.status);
+	snp.Put (v.rpos);
+	snp.Put (v.rvel);
+	snp.Put (v.vrot);
+	snp.Put (v.arot);
+	snp.Put (v.lng);
+	snp.Put (v.lat);
+	snp.Put (v.hdg);
+	snp.Put ((DWORD)NPROP);
+	for (i = 0; i < NPROP; i++) snp.Put (v.prop[i]);
+	snp.Put ((DWORD)NTHRUST);
+	for (i = 0; i < NTHRUST; i++) snp.Put (v.thrust[i]);
+	snp.EndSection ();
+
+	// top-level subsystems 0-5 have four children each (6 + 6*4 = 30)
+	snp.BeginSection (SNP_CUSTOM);
+	for (i = 0; i < 6; i++) {
+		snp.BeginSection (SubsysTag (i));
+		SaveSubsys (v.ss[i], snp);
+		for (j = 0; j < 4; j++) {
+			snp.BeginSection (SubsysTag (j));
+			SaveSubsys (v.ss[6+i*4+j], snp);
+			snp.EndSection ();
+		}
+		snp.EndSection ();
+	}
+	snp.EndSection ();
+
+	snp.EndSection ();
+}
+
+static bool LoadSubsys (SubsysState &s, SnapshotReader &snp)
+{
+	WORD version;
+	if (!snp.BeginSection (SNP_DATA, version)) return false;
+	for (int k = 0; k < 2; k++) {
+		snp.Get (s.anim[k][0]);
+		snp.Get (s.anim[k][1]);
+	}
+	snp.Get (s.mode);
+	snp.Get (s.fail);
+	snp.EndSection ();
+	return snp.Ok();
+}
+
+static bool LoadVessel (VesselState &v, SnapshotReader &snp)
+{
+	WORD version;
+	char cbuf[256];
+	DWORD n, port;
+	int i, j;
+	bool res = true;
+
+	if (!snp.BeginSection (SNP_VESSEL, version)) return false;
+	snp.GetString (v.name, 32);
+
+	if (snp.BeginSection (SNP_STATUS, version)) {
+		snp.Get (v.flag);
+		snp.GetString (v.rbody, 32);
+		snp.GetString (cbuf, 256);
+		snp.Get (port);
+		snp.Get (v.status);
+		snp.Get (v.rpos);
+		snp.Get (v.rvel);
+		snp.Get (v.vrot);
+		snp.Get (v.arot);
+		snp.Get (v.lng);
+		snp.Get (v.lat);
+		snp.Get (v.hdg);
+		if (snp.Get (n) && n == NPROP) {
+			for (i = 0; i < NPROP; i++) snp.Get (v.prop[i]);
+		} else res = false;
+		if (snp.Get (n) && n == NTHRUST) {
+			for (i = 0; i < NTHRUST; i++) snp.Get (v.thrust[i]);
+		} else res = false;
+		snp.EndSection ();
+	} else res = false;
+
+	if (snp.BeginSection (SNP_CUSTOM, version)) {
+		for (i = 0; i < 6; i++) {
+			if (!snp.BeginSection (SubsysTag (i), version)) { res = false; continue; }
+			if (!LoadSubsys (v.ss[i], snp)) res = false;
+			for (j = 0; j < 4; j++) {
+				if (!snp.BeginSection (SubsysTag (j), version)) { res = false; continue; }
+				if (!LoadSubsys (v.ss[6+i*4+j], snp)) res = false;
+				snp.EndSection ();
+			}
+			snp.EndSection ();
+		}
+		snp.EndSection ();
+	} else res = false;
+
+	snp.EndSection ();
+	return res && snp.Ok();
+}
+
+static int LoadAll (std::vector<VesselState> &vs, SnapshotReader &snp)
+{
+	int n;
+	for (n = 0; n < (int)vs.size(); n++)
+		if (!LoadVessel (vs[n], snp)) break;
+	return n;
+}
+
+// ==============================================================
+// Scenario-style text, for comparison
+
+static void SaveText (const std::vector<VesselState> &vs, std::string &txt)
+{
+	char cbuf[512];
+	txt.clear();
+	for (size_t i = 0; i < vs.size(); i++) {
+		const VesselState &v = vs[i];
+		int j;
+		sprintf (cbuf, "%s:DeltaGlider\n  STATUS %s %s\n", v.name, v.status ? "Landed" : "Orbiting", v.rbody); txt += cbuf;
+		sprintf (cbuf, "  RPOS %0.17g %0.17g %0.17g\n", v.rpos.x, v.rpos.y, v.rpos.z); txt += cbuf;
+		sprintf (cbuf, "  RVEL %0.17g %0.17g %0.17g\n", v.rvel.x, v.rvel.y, v.rvel.z); txt += cbuf;
+		sprintf (cbuf, "  AROT %0.17g %0.17g %0.17g\n", v.arot.x, v.arot.y, v.arot.z); txt += cbuf;
+		sprintf (cbuf, "  VROT %0.17g %0.17g %0.17g\n", v.vrot.x, v.vrot.y, v.vrot.z); txt += cbuf;
+		sprintf (cbuf, "  POS %0.17g %0.17g\n  HEADING %0.17g\n", v.lng, v.lat, v.hdg); txt += cbuf;
+		txt += "  PRPLEVEL";
+		for (j = 0; j < NPROP; j++) { sprintf (cbuf, " %d:%0.17g", j, v.prop[j]); txt += cbuf; }
+		txt += "\n  THLEVEL";
+		for (j = 0; j < NTHRUST; j++) { sprintf (cbuf, " %d:%0.17g", j, v.thrust[j]); txt += cbuf; }
+		txt += "\n";
+		for (j = 0; j < NSUBSYS; j++) {
+			const SubsysState &s = v.ss[j];
+			sprintf (cbuf, "  SS%02d %0.17g %0.17g %0.17g %0.17g %d %d\n", j,
+				s.anim[0][0], s.anim[0][1], s.anim[1][0], s.anim[1][1], s.mode, s.fail ? 1 : 0);
+			txt += cbuf;
+		}
+		txt += "END\n";
+	}
+}
+
+static int LoadText (std::vector<VesselState> &vs, const std::string &txt)
+{
+	const char *p = txt.c_str();
+	char line[1024], *q;
+	int n = 0, j, k, fail;
+	VesselState *v = 0;
+	while (*p) {
+		const char *e = strchr (p, '\n');
+		size_t len = (e ? e-p : strlen (p));
+		memcpy (line, p, len); line[len] = '\0';
+		p += len + (e ? 1 : 0);
+		if (!v) {
+			if (n >= (int)vs.size()) break;
+			v = &vs[n];
+			if ((q = strchr (line, ':'))) *q = '\0';
+			strcpy (v->name, line);
+		} else if (!strncmp (line, "END", 3)) {
+			v = 0, n++;
+		} else if (!strncmp (line, "  STATUS", 8)) {
+			char cstat[32];
+			sscanf (line+8, "%31s%31s", cstat, v->rbody);
+			v->status = (strcmp (cstat, "Landed") ? 0 : 1);
+		} else if (!strncmp (line, "  RPOS", 6)) {
+			sscanf (line+6, "%lf%lf%lf", &v->rpos.x, &v->rpos.y, &v->rpos.z);
+		} else if (!strncmp (line, "  RVEL", 6)) {
+			sscanf (line+6, "%lf%lf%lf", &v->rvel.x, &v->rvel.y, &v->rvel.z);
+		} else if (!strncmp (line, "  AROT", 6)) {
+			sscanf (line+6, "%lf%lf%lf", &v->arot.x, &v->arot.y, &v->arot.z);
+		} else if (!strncmp (line, "  VROT", 6)) {
+			sscanf (line+6, "%lf%lf%lf", &v->vrot.x, &v->vrot.y, &v->vrot.z);
+		} else if (!strncmp (line, "  POS", 5)) {
+			sscanf (line+5, "%lf%lf", &v->lng, &v->lat);
+		} else if (!strncmp (line, "  HEADING", 9)) {
+			sscanf (line+9, "%lf", &v->hdg);
+		} else if (!strncmp (line, "  PRPLEVEL", 10)) {
+			for (q = line+10, j = 0; j < NPROP && (q = strchr (q, ':')); j++)
+				v->prop[j] = strtod (++q, &q);
+		} else if (!strncmp (line, "  THLEVEL", 9)) {
+			for (q = line+9, j = 0; j < NTHRUST && (q = strchr (q, ':')); j++)
+				v->thrust[j] = strtod (++q, &q);
+		} else if (!strncmp (line, "  SS", 4)) {
+			SubsysState s;
+			if (sscanf (line+4, "%d%lf%lf%lf%lf%d%d", &k, &s.anim[0][0], &s.anim[0][1],
+				&s.anim[1][0], &s.anim[1][1], &s.mode, &fail) == 7 && k >= 0 && k < NSUBSYS) {
+				s.fail = (fail != 0);
+				v->ss[k] = s;
+			}
+		}
+	}
+	return n;
+}
+
+// ==============================================================
+
+static bool Same (const VesselState &a, const VesselState &b)
+{
+	if (strcmp (a.name, b.name) || strcmp (a.rbody, b.rbody) || a.status != b.status) return false;
+	if (memcmp (&a.rpos, &b.rpos, sizeof(VECTOR3)) || memcmp (&a.rvel, &b.rvel, sizeof(VECTOR3)) ||
+		memcmp (&a.vrot, &b.vrot, sizeof(VECTOR3)) || memcmp (&a.arot, &b.arot, sizeof(VECTOR3)))
+		return false;
+	if (a.lng != b.lng || a.lat != b.lat || a.hdg != b.hdg) return false;
+	if (memcmp (a.prop, b.prop, sizeof(a.prop)) || memcmp (a.thrust, b.thrust, sizeof(a.thrust))) return false;
+	for (int j = 0; j < NSUBSYS; j++) {
+		const SubsysState &s = a.ss[j], &t = b.ss[j];
+		if (memcmp (s.anim, t.anim, sizeof(s.anim)) || s.mode != t.mode || s.fail != t.fail) return false;
+	}
+	return true;
+}
+
+static int Mismatches (const std::vector<VesselState> &a, const std::vector<VesselState> &b)
+{
+	int n = 0;
+	for (size_t i = 0; i < a.size(); i++)
+		if (!Same (a[i], b[i])) n++;
+	return n;
+}
+
+static void Clear (std::vector<VesselState> &vs)
+{
+	memset (&vs[0], 0, vs.size()*sizeof(VesselState));
+}
+
+static double Ms (clock_t t0, clock_t t1, int nrep)
+{
+	return 1e3*(double)(t1-t0)/CLOCKS_PER_SEC/nrep;
+}
+
+int main (int argc, char *argv[])
+{
+	const int nrep = argc > 1 ? atoi (argv[1]) : 50;
+	std::vector<VesselState> ref, vs (NVESSEL);
+	std::vector<char> blob;
+	bool ok = true;
+	clock_t t0, t1;
+	int r, n = 0;
+
+	MakeStates (ref);
+
+	// binary snapshot
+	t0 = clock();
+	for (r = 0; r < nrep; r++) {
+		SnapshotWriter snp;
+		for (int i = 0; i < NVESSEL; i++) SaveVessel (ref[i], snp);
+		const char *data = snp.Data();
+		blob.assign (data, data + snp.Size());
+	}
+	t1 = clock();
+	double tsave = Ms (t0, t1, nrep);
+
+	t0 = clock();
+	for (r = 0; r < nrep; r++) {
+		SnapshotReader snp;
+		n = (snp.Set (&blob[0], blob.size()) ? LoadAll (vs, snp) : -1);
+	}
+	t1 = clock();
+	double tload = Ms (t0, t1, nrep);
+	int nbad = Mismatches (ref, vs);
+	printf ("binary  %5d KB  save %7.2f ms  restore %7.2f ms  %d/%d vessels, %d mismatches\n",
+		(int)(blob.size() >> 10), tsave, tload, n, NVESSEL, nbad);
+	if (n != NVESSEL || nbad) ok = false;
+
+	// corrupted blobs must be rejected
+	{
+		SnapshotReader snp;
+		std::vector<char> bad (blob);
+		bad[bad.size()/2] ^= 0x10;
+		bool acc1 = snp.Set (&bad[0], bad.size());
+		bool acc2 = snp.Set (&blob[0], blob.size()-1);
+		printf ("flipped bit: %s, truncated: %s\n", acc1 ? "ACCEPTED" : "rejected", acc2 ? "ACCEPTED" : "rejected");
+		if (acc1 || acc2) ok = false;
+	}
+
+	// scenario-style text
+	std::string txt;
+	t0 = clock();
+	for (r = 0; r < nrep; r++) SaveText (ref, txt);
+	t1 = clock();
+	tsave = Ms (t0, t1, nrep);
+
+	Clear (vs);
+	t0 = clock();
+	for (r = 0; r < nrep; r++) n = LoadText (vs, txt);
+	t1 = clock();
+	tload = Ms (t0, t1, nrep);
+	nbad = Mismatches (ref, vs);
+	printf ("text    %5d KB  save %7.2f ms  restore %7.2f ms  %d/%d vessels, %d mismatches\n",
+		(int)(txt.size() >> 10), tsave, tload, n, NVESSEL, nbad);
+
+	return ok ? 0 : 1;
+}
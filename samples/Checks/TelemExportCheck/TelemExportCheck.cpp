@@ -0,0 +1,213 @@
+// ==============================================================
+//                 ORBITER MODULE: TelemExportCheck
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// TelemExportCheck.cpp
+// Headless consistency and timing check for the telemetry export
+// region (see TelemFrame.h) and TelemetryReader.
+//
+// The program creates the telemetry region itself, so Orbiter must
+// not be running. A writer thread stands in for the TelemExport
+// module: it republishes all vessel slots with the sequence lock of
+// TelemFrame.h, filling each record with values derived from the
+// frame count, while the main thread reads them back through
+// TelemetryReader. A record is torn if its values stem from
+// different frames.
+//
+// (a) Writer republishing as fast as possible, 20 and 256 vessels:
+//     no torn records may be returned. Reports the read rate and the
+//     fraction of reads that gave up after the retry limit.
+// (b) Writer paced by a sleep between steps, as at simulation frame
+//     rates: no read may fail.
+// (c) For comparison, plain copies without the sequence lock: reports
+//     how many of them are torn, to show that (a) exercises overlap.
+// (d) CPU time per published step of the writer, without readers.
+// Returns nonzero if a check fails.
+// ==============================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include "..\..\TelemExport\TelemReader.h"
+
+// doubles of the record, from simt to the last vessel-defined value
+const int NDBL = (offsetof(TELEM_VESSEL, ntank) - offsetof(TELEM_VESSEL, simt)) / sizeof(double);
+
+static TELEM_HEADER *g_hdr = NULL;
+
+// ==============================================================
+// Stand-in writer
+
+struct Writer {
+	int nvessel;         // vessels to publish
+	DWORD pause;         // sleep between steps [ms], or 0
+	volatile LONG stop;  // set by the main thread to end the writer
+	HANDLE hThread;
+};
+
+static void Fill (TELEM_VESSEL &rec, int slot, LONG frame)
+{
+	double *d = &rec.simt;
+	double stamp = (double)frame*TELEM_MAXVESSEL + slot;
+	sprintf (rec.name, "V%03d", slot);
+	strcpy (rec.ref, "Earth");
+	for (int k = 0; k < NDBL; k++)
+		d[k] = stamp + k;
+	rec.ntank = rec.nuser = TELEM_MAXTANK;
+	rec.navmode = (DWORD)frame;
+	rec.flags = (DWORD)slot;
+}
+
+static bool Consistent (const TELEM_VESSEL &rec)
+{
+	const double *d = &rec.simt;
+	for (int k = 1; k < NDBL; k++)
+		if (d[k] != d[0] + k) return false;
+	return rec.navmode == (DWORD)(d[0]/TELEM_MAXVESSEL);
+}
+
+static void Publish (int nvessel)
+{
+	LONG frame = g_hdr->frame + 1;
+	for (int i = 0; i < nvessel; i++) {
+		TELEM_SLOT *s = TelemSlot (g_hdr, i);
+		TelemBeginUpdate (s);
+		Fill (s->rec, i, frame);
+		TelemEndUpdate (s);
+	}
+	g_hdr->nvessel = nvessel;
+	InterlockedIncrement (&g_hdr->frame);
+}
+
+static DWORD WINAPI WriterThread (LPVOID context)
+{
+	Writer *w = (Writer*)context;
+	while (!w->stop) {
+		Publish (w->nvessel);
+		if (w->pause) Sleep (w->pause);
+	}
+	return 0;
+}
+
+static void StartWriter (Writer &w, int nvessel, DWORD pause)
+{
+	w.nvessel = nvessel;
+	w.pause = pause;
+	w.stop = 0;
+	LONG frame0 = g_hdr->frame;
+	w.hThread = CreateThread (NULL, 0, WriterThread, &w, 0, NULL);
+	while (g_hdr->frame == frame0) Sleep (0);  // first step published
+}
+
+static void StopWriter (Writer &w)
+{
+	w.stop = 1;
+	WaitForSingleObject (w.hThread, INFINITE);
+	CloseHandle (w.hThread);
+}
+
+// ==============================================================
+
+static double Elapsed (const LARGE_INTEGER &t0)
+{
+	LARGE_INTEGER t1, fq;
+	QueryPerformanceCounter (&t1);
+	QueryPerformanceFrequency (&fq);
+	return (double)(t1.QuadPart - t0.QuadPart) / (double)fq.QuadPart;
+}
+
+// (a), (b) reads through TelemetryReader while the writer runs
+static bool CheckRead (TelemetryReader &reader, int nvessel, DWORD pause, int nread)
+{
+	Writer w;
+	TELEM_VESSEL rec;
+	int i, ntorn = 0, nfail = 0;
+	StartWriter (w, nvessel, pause);
+	DWORD frame0 = reader.Frame();
+	LARGE_INTEGER t0;
+	QueryPerformanceCounter (&t0);
+	for (i = 0; i < nread; i++) {
+		if (!reader.Read (i % reader.VesselCount(), rec)) nfail++;
+		else if (!Consistent (rec)) ntorn++;
+	}
+	double t = Elapsed (t0);
+	DWORD nframe = reader.Frame() - frame0;
+	StopWriter (w);
+
+	printf ("%3d vessels, writer %s: %8.0f frames/s, %5.2f M reads/s, %d torn, %.2e failed\n",
+		nvessel, pause ? "paced" : "free ", nframe/t, 1e-6*nread/t, ntorn, (double)nfail/nread);
+	return ntorn == 0 && (!pause || nfail == 0);
+}
+
+// (c) plain copies without the sequence lock
+static void RawRead (int nvessel, int nread)
+{
+	Writer w;
+	TELEM_VESSEL rec;
+	int i, ntorn = 0;
+	StartWriter (w, nvessel, 0);
+	for (i = 0; i < nread; i++) {
+		memcpy (&rec, (const void*)&TelemSlot (g_hdr, i % nvessel)->rec, sizeof(TELEM_VESSEL));
+		if (!Consistent (rec)) ntorn++;
+	}
+	StopWriter (w);
+	printf ("%3d vessels, without sequence lock: %.2e of copies torn\n", nvessel, (double)ntorn/nread);
+}
+
+// (d) writer cost per step
+static void TimeWriter (int nvessel, int nstep)
+{
+	LARGE_INTEGER t0;
+	QueryPerformanceCounter (&t0);
+	for (int i = 0; i < nstep; i++)
+		Publish (nvessel);
+	printf ("%3d vessels: %6.2f us per published step\n", nvessel, 1e6*Elapsed (t0)/nstep);
+}
+
+// ==============================================================
+
+int main (int argc, char *argv[])
+{
+	const int nread = argc > 1 ? atoi (argv[1]) : 2000000;
+	bool ok = true;
+
+	// create the region as TelemExport::clbkSimulationStart does
+	DWORD size = sizeof(TELEM_HEADER) + TELEM_MAXVESSEL*sizeof(TELEM_SLOT);
+	HANDLE hMap = CreateFileMapping (INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, size, TELEM_SHM_NAME);
+	if (!hMap || GetLastError() == ERROR_ALREADY_EXISTS) {
+		printf ("telemetry region exists or can't be created (is Orbiter running?)\n");
+		return 1;
+	}
+	g_hdr = (TELEM_HEADER*)MapViewOfFile (hMap, FILE_MAP_ALL_ACCESS, 0, 0, size);
+	g_hdr->version = TELEM_VERSION;
+	g_hdr->maxvessel = TELEM_MAXVESSEL;
+	g_hdr->slotsize = sizeof(TELEM_SLOT);
+	g_hdr->nvessel = 0;
+	g_hdr->magic = TELEM_MAGIC;
+
+	TelemetryReader reader;
+	if (!reader.Open() || !reader.Active()) {
+		printf ("reader can't open the region\n");
+		ok = false;
+	} else {
+		ok = CheckRead (reader,  20, 0, nread) && ok;
+		ok = CheckRead (reader, 256, 0, nread) && ok;
+		ok = CheckRead (reader,  20, 1, nread/10) && ok;
+		ok = CheckRead (reader, 256, 1, nread/10) && ok;
+		printf ("\n");
+		RawRead ( 20, nread);
+		RawRead (256, nread);
+		printf ("\n");
+		TimeWriter ( 20, nread/20);
+		TimeWriter (256, nread/200);
+		reader.Close();
+	}
+
+	UnmapViewOfFile (g_hdr);
+	CloseHandle (hMap);
+	printf ("\n%s\n", ok ? "all checks passed" : "CHECK FAILED");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,217 @@
+// ==============================================================
+//                 ORBITER MODULE: ThermalNetCheck
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// ThermalNetCheck.cpp
+// Headless accuracy, conservation and timing check for
+// ThermalNetwork.
+//
+// (a) Two nodes with a conductive link: the temperature difference
+//     must follow the backward Euler recursion
+//     dT' = dT/(1 + G dt (1/C1 + 1/C2)) for any time step.
+// (b) One node with a heat load and an emitter: the temperature must
+//     reach the radiative equilibrium Q = sigma epsA (T^4 - Ts^4),
+//     with and without SetLinearise.
+// (c) A closed network of conductive and radiative links with heat
+//     loads, at time steps up to 1e5 s: the stored heat must match the
+//     heat input, and without loads no temperature may leave the range
+//     of the initial temperatures.
+// (d) A 1000-node lattice (10x10x10 conductive links, radiative links
+//     and emitters on the surface, as a large vessel model): reports
+//     the solver iterations and CPU time per step, for the DG time
+//     step and under time acceleration.
+// Returns nonzero if a check fails.
+// ==============================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <vector>
+#include "..\..\Common\Vessel\ThermalNet.h"
+
+static const double SIGMA = 5.670373e-8; // Stefan-Boltzmann constant [W/(m^2 K^4)]
+
+static double Rnd ()
+{
+	return (double)rand()/(double)RAND_MAX;
+}
+
+// ==============================================================
+// (a) Conduction against the backward Euler recursion
+
+static bool CheckConduction ()
+{
+	static const double dt[4] = {0.02, 1.0, 100.0, 1e5};
+	const double C1 = 2e3, C2 = 5e4, G = 8.0;
+	double err = 0.0;
+	for (int k = 0; k < 4; k++) {
+		ThermalNetwork tn;
+		int n1 = tn.AddNode (C1, 350.0), n2 = tn.AddNode (C2, 250.0);
+		tn.AddConduction (n1, n2, G);
+		tn.Setup ();
+		double d = 100.0, f = 1.0/(1.0 + G*dt[k]*(1.0/C1 + 1.0/C2));
+		for (int i = 0; i < 50; i++) {
+			tn.Step (dt[k]);
+			d *= f;
+			err = max (err, fabs ((tn.Temp (n1)-tn.Temp (n2)) - d));
+		}
+	}
+	printf ("conduction: max. deviation from backward Euler %.1e K\n", err);
+	return err < 1e-6;
+}
+
+// ==============================================================
+// (b) Radiative equilibrium
+
+static bool CheckRadiation (bool lin)
+{
+	const double Q = 500.0, epsA = 2.0, Ts = 3.0;
+	double Teq = pow (Q/(SIGMA*epsA) + pow (Ts, 4.0), 0.25);
+	ThermalNetwork tn;
+	int n = tn.AddNode (1e5, 200.0);
+	tn.SetHeatLoad (n, Q);
+	tn.SetEmitter (n, epsA);
+	tn.SetSpaceTemp (Ts);
+	tn.SetLinearise (lin);
+	tn.Setup ();
+	for (int i = 0; i < 100; i++)
+		tn.Step (1e4);
+	double err = fabs (tn.Temp (n) - Teq);
+	printf ("radiation%s: equilibrium %.3f K, reached %.3f K\n", lin ? " (linearised)" : "", Teq, tn.Temp (n));
+	return err < 1e-3;
+}
+
+// ==============================================================
+// (c) Conservation and maximum principle in a closed network
+
+// Random tree of links, with loads on every 7th node if load is set.
+// Returns the node capacities in C and the total load.
+static double MakeClosed (ThermalNetwork &tn, int n, bool load, std::vector<double> &C)
+{
+	int i;
+	double Qtot = 0.0;
+	srand (3);
+	C.resize (n);
+	for (i = 0; i < n; i++) {
+		C[i] = 100.0 + 1e4*Rnd();
+		tn.AddNode (C[i], 150.0 + 300.0*Rnd());
+	}
+	for (i = 1; i < n; i++) {
+		int j = rand() % i;
+		if (i % 3) tn.AddConduction (i, j, 0.1 + 50.0*Rnd());
+		else       tn.AddRadiation (i, j, 0.01 + 2.0*Rnd());
+	}
+	if (load)
+		for (i = 0; i < n; i += 7) {
+			double q = 100.0*Rnd();
+			tn.SetHeatLoad (i, q);
+			Qtot += q;
+		}
+	tn.Setup ();
+	return Qtot;
+}
+
+static bool CheckClosed ()
+{
+	static const double dt[3] = {1.0, 1e3, 1e5};
+	const int n = 200;
+	bool ok = true;
+	for (int k = 0; k < 3; k++) {
+		// heat balance with loads, and range without loads
+		ThermalNetwork tn, tc;
+		std::vector<double> C, T0(n);
+		double Qtot = MakeClosed (tn, n, true, C);
+		MakeClosed (tc, n, false, C);
+		double E = 0.0, Tmin = 1e10, Tmax = 0.0;
+		int i, s;
+		for (i = 0; i < n; i++) {
+			T0[i] = tn.Temp (i);
+			Tmin = min (Tmin, T0[i]);
+			Tmax = max (Tmax, T0[i]);
+		}
+
+		double excess = 0.0;
+		for (s = 0; s < 20; s++) {
+			tn.Step (dt[k]);
+			tc.Step (dt[k]);
+			for (i = 0; i < n; i++)
+				excess = max (excess, max (tc.Temp (i)-Tmax, Tmin-tc.Temp (i)));
+		}
+		for (i = 0; i < n; i++)
+			E += C[i]*(tn.Temp (i)-T0[i]);
+		double Qin = Qtot*dt[k]*20;
+		double err = fabs (E-Qin)/Qin;
+		printf ("closed network dt %6.0e s: heat balance error %.1e, range excess %.1e K\n", dt[k], err, excess);
+		ok = ok && err < 1e-6 && excess < 1e-6;
+	}
+	return ok;
+}
+
+// ==============================================================
+// (d) Timing of a 1000-node network
+
+static void MakeLattice (ThermalNetwork &tn, int m)
+{
+	int i, j, k;
+	srand (5);
+	for (i = 0; i < m*m*m; i++)
+		tn.AddNode (100.0 + 1e4*Rnd(), 280.0 + 20.0*Rnd());
+	for (i = 0; i < m; i++)
+		for (j = 0; j < m; j++)
+			for (k = 0; k < m; k++) {
+				int a = (i*m + j)*m + k;
+				if (i+1 < m) tn.AddConduction (a, a + m*m, 1.0 + 50.0*Rnd());
+				if (j+1 < m) tn.AddConduction (a, a + m, 1.0 + 50.0*Rnd());
+				if (k+1 < m) tn.AddConduction (a, a + 1, 1.0 + 50.0*Rnd());
+				bool surf = (i == 0 || i == m-1 || j == 0 || j == m-1 || k == 0 || k == m-1);
+				if (surf) {
+					tn.SetEmitter (a, 0.5*Rnd());
+					tn.SetAbsorber (a, 0.3*Rnd());
+				} else if (Rnd() < 0.1)
+					tn.SetHeatLoad (a, 200.0*Rnd());
+			}
+	for (i = 0; i < m*m; i++)  // radiative links across the interior
+		tn.AddRadiation (rand() % (m*m*m), rand() % (m*m*m), 0.05*Rnd());
+	tn.SetIncidentFlux (1360.0);
+	tn.Setup ();
+}
+
+static void Time (int nstep, double dt, bool lin)
+{
+	ThermalNetwork tn;
+	MakeLattice (tn, 10);
+	tn.SetLinearise (lin);
+	for (int i = 0; i < 10; i++) tn.Step (dt);   // past the initial transient
+	long iter = 0;
+	clock_t t0 = clock();
+	for (int s = 0; s < nstep; s++)
+		iter += tn.Step (dt);
+	clock_t t1 = clock();
+	printf ("%d nodes dt %6.2f s%s: %6.1f CG iterations/step, %7.1f us/step\n", tn.NodeCount(), dt,
+		lin ? " (linearised)" : "             ", (double)iter/nstep, 1e6*(double)(t1-t0)/CLOCKS_PER_SEC/nstep);
+}
+
+// ==============================================================
+
+int main (int argc, char *argv[])
+{
+	const int nstep = argc > 1 ? atoi (argv[1]) : 2000;
+	bool ok = true;
+
+	ok = CheckConduction () && ok;
+	ok = CheckRadiation (false) && ok;
+	ok = CheckRadiation (true) && ok;
+	ok = CheckClosed () && ok;
+	printf ("\n");
+
+	Time (nstep, 0.02, false);
+	Time (nstep, 0.02, true);
+	Time (nstep/10, 100.0, false);
+	Time (nstep/10, 100.0, true);
+
+	printf ("\n%s\n", ok ? "all checks passed" : "CHECK FAILED");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,277 @@
+// ==============================================================
+//                 ORBITER MODULE: ThrustAllocCheck
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// ThrustAllocCheck.cpp
+// Headless optimality check and benchmark for ThrustAllocator.
+//
+// Random demands are solved for
+//   (a) the DG hover engine layout, set up as in
+//       HoverAttitudeComponent::SetupAllocator (3 thrusters, lift,
+//       pitch and roll moment), and
+//   (b) a random over-actuated layout (6 thrusters, 3 axes).
+// Each result is compared with the exact minimiser found by
+// enumerating all 3^n combinations of free thrusters and thrusters
+// fixed at either bound. The cost of the allocator solution may not
+// exceed the reference cost by more than a rounding margin, and the
+// levels must be within [0,1]. The program reports the iteration
+// count and the CPU time per solve, and returns nonzero if a check
+// fails.
+// ==============================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include "..\..\Common\Vessel\ThrustAlloc.h"
+
+// DG hover engines (see DeltaGlider::SetClassCaps)
+const double MAX_HOVER_THRUST = 1.4e5;
+static const VECTOR3 hover_pos[3] = {{0,0,3}, {-3,0,-4.55}, {3,0,-4.55}};
+static const double hover_max[3] = {MAX_HOVER_THRUST, 3.0/4.55*0.5*MAX_HOVER_THRUST, 3.0/4.55*0.5*MAX_HOVER_THRUST};
+
+static double Rnd ()
+{
+	return (double)rand()/(double)RAND_MAX;
+}
+
+// ==============================================================
+// Test layouts
+
+struct Layout {
+	int nthr, nax;
+	double B[TA_MAXAXIS][TA_MAXTHRUSTER];
+	double W[TA_MAXAXIS];
+	double lambda;
+	double span[TA_MAXAXIS];
+};
+
+static void Apply (const Layout &L, ThrustAllocator &alloc)
+{
+	double eff[TA_MAXAXIS];
+	for (int i = 0; i < L.nthr; i++) {
+		for (int k = 0; k < L.nax; k++) eff[k] = L.B[k][i];
+		alloc.SetEffectiveness (i, eff);
+	}
+	for (int k = 0; k < L.nax; k++)
+		alloc.SetAxisWeight (k, L.W[k]);
+	alloc.SetRegularisation (L.lambda);
+	alloc.Setup ();
+}
+
+// As HoverAttitudeComponent::SetupAllocator
+static void MakeHover (Layout &L)
+{
+	int i, k;
+	L.nthr = L.nax = 3;
+	L.lambda = 1e-4;
+	for (i = 0; i < 3; i++) {
+		double f = hover_max[i]/hover_max[0];
+		L.B[0][i] = f;
+		L.B[1][i] = f*hover_pos[i].z;
+		L.B[2][i] = f*hover_pos[i].x;
+	}
+	for (k = 0; k < 3; k++) {
+		for (L.span[k] = 0.0, i = 0; i < 3; i++)
+			L.span[k] += fabs (L.B[k][i]);
+		L.W[k] = 1.0/L.span[k];
+	}
+}
+
+static void MakeRandom (Layout &L)
+{
+	int i, k;
+	L.nthr = 6;
+	L.nax = 3;
+	L.lambda = 1e-4;
+	for (k = 0; k < L.nax; k++) {
+		for (L.span[k] = 0.0, i = 0; i < L.nthr; i++) {
+			L.B[k][i] = 2.0*Rnd()-1.0;
+			L.span[k] += fabs (L.B[k][i]);
+		}
+		L.W[k] = 1.0/L.span[k];
+	}
+}
+
+// Demand of the form used by HoverAttitudeComponent::TrackHoverAtt:
+// lift of the current levels, pitch and roll moment within the span
+// (the moment demands may be unattainable)
+static void MakeDemand (const Layout &L, const double *pref, double *demand)
+{
+	int i, k;
+	for (k = 0; k < L.nax; k++) {
+		demand[k] = 0.0;
+		if (k == 0)
+			for (i = 0; i < L.nthr; i++) demand[k] += pref[i]*L.B[k][i];
+		else
+			demand[k] = (2.0*Rnd()-1.0)*L.span[k];
+	}
+}
+
+// ==============================================================
+// Reference solution
+
+static double Cost (const Layout &L, const double *demand, const double *pref, const double *u)
+{
+	double c = 0.0;
+	int i, k;
+	for (k = 0; k < L.nax; k++) {
+		double r = -demand[k];
+		for (i = 0; i < L.nthr; i++) r += L.B[k][i]*u[i];
+		c += L.W[k]*L.W[k]*r*r;
+	}
+	for (i = 0; i < L.nthr; i++)
+		c += L.lambda*(u[i]-pref[i])*(u[i]-pref[i]);
+	return c;
+}
+
+// Minimise over the free thrusters (fix[i] == 0) with the others fixed
+// at their bounds. Returns false if the result is outside [0,1].
+static bool FreeSolve (const Layout &L, const double *demand, const double *pref, const int *fix, double *u)
+{
+	int i, j, k, r, c, n = 0, idx[TA_MAXTHRUSTER];
+	double a[TA_MAXTHRUSTER][TA_MAXTHRUSTER+1];
+	for (i = 0; i < L.nthr; i++) {
+		if (fix[i]) u[i] = (fix[i] < 0 ? 0.0 : 1.0);
+		else idx[n++] = i;
+	}
+	// normal equations (B^T W^2 B + lambda I) x = B^T W^2 (demand - B_fixed u_fixed) + lambda pref
+	for (r = 0; r < n; r++) {
+		i = idx[r];
+		for (c = 0; c < n; c++) {
+			j = idx[c];
+			double h = (i == j ? L.lambda : 0.0);
+			for (k = 0; k < L.nax; k++) h += L.B[k][i]*L.W[k]*L.W[k]*L.B[k][j];
+			a[r][c] = h;
+		}
+		double g = L.lambda*pref[i];
+		for (k = 0; k < L.nax; k++) {
+			double d = demand[k];
+			for (j = 0; j < L.nthr; j++)
+				if (fix[j]) d -= L.B[k][j]*u[j];
+			g += L.B[k][i]*L.W[k]*L.W[k]*d;
+		}
+		a[r][n] = g;
+	}
+	for (c = 0; c < n; c++) {
+		int p = c;
+		for (r = c+1; r < n; r++)
+			if (fabs (a[r][c]) > fabs (a[p][c])) p = r;
+		for (k = 0; k <= n; k++) { double t = a[c][k]; a[c][k] = a[p][k]; a[p][k] = t; }
+		for (r = 0; r < n; r++) {
+			if (r == c) continue;
+			double f = a[r][c]/a[c][c];
+			for (k = c; k <= n; k++) a[r][k] -= f*a[c][k];
+		}
+	}
+	for (r = 0; r < n; r++) {
+		double x = a[r][n]/a[r][r];
+		if (x < -1e-12 || x > 1.0+1e-12) return false;
+		u[idx[r]] = x;
+	}
+	return true;
+}
+
+// Exact minimiser of the convex problem: the best of all feasible
+// free-set solutions
+static double Reference (const Layout &L, const double *demand, const double *pref, double *ubest)
+{
+	int i, m, npat = 1, fix[TA_MAXTHRUSTER];
+	double u[TA_MAXTHRUSTER], cbest = -1.0;
+	for (i = 0; i < L.nthr; i++) npat *= 3;
+	for (m = 0; m < npat; m++) {
+		for (i = 0; i < L.nthr; i++) {
+			int d = m;
+			for (int j = 0; j < i; j++) d /= 3;
+			fix[i] = d%3 - 1;
+		}
+		if (!FreeSolve (L, demand, pref, fix, u)) continue;
+		double c = Cost (L, demand, pref, u);
+		if (cbest < 0.0 || c < cbest) {
+			cbest = c;
+			for (i = 0; i < L.nthr; i++) ubest[i] = u[i];
+		}
+	}
+	return cbest;
+}
+
+// ==============================================================
+
+static bool Check (const Layout &L, int nsample, const char *label)
+{
+	ThrustAllocator alloc (L.nthr, L.nax);
+	Apply (L, alloc);
+
+	int i, n, itsum = 0, itmax = 0, nworse = 0;
+	double pref[TA_MAXTHRUSTER], demand[TA_MAXAXIS], u[TA_MAXTHRUSTER], uref[TA_MAXTHRUSTER];
+	double excess = 0.0, dlvl = 0.0, range = 0.0;
+
+	for (n = 0; n < nsample; n++) {
+		for (i = 0; i < L.nthr; i++) pref[i] = Rnd();
+		MakeDemand (L, pref, demand);
+		int it = alloc.Solve (demand, pref, u);
+		itsum += it;
+		itmax = max (itmax, it);
+		double c = Cost (L, demand, pref, u);
+		double cref = Reference (L, demand, pref, uref);
+		double e = (c-cref)/max (cref, 1e-12);
+		if (e > 1e-9) nworse++;
+		excess = max (excess, e);
+		for (i = 0; i < L.nthr; i++) {
+			dlvl = max (dlvl, fabs (u[i]-uref[i]));
+			range = max (range, max (-u[i], u[i]-1.0));
+		}
+	}
+	printf ("%-7s %d samples: cost above optimum in %d, max. rel. excess %.1e, level diff %.1e, bound excess %.1e\n",
+		label, nsample, nworse, excess, dlvl, range > 0.0 ? range : 0.0);
+	printf ("        iterations %4.2f avg %2d max\n", (double)itsum/nsample, itmax);
+	return nworse == 0 && range <= 1e-12;
+}
+
+static void Time (const Layout &L, int nsolve, const char *label)
+{
+	const int nset = 256;
+	ThrustAllocator alloc (L.nthr, L.nax);
+	Apply (L, alloc);
+
+	static double pref[nset][TA_MAXTHRUSTER], demand[nset][TA_MAXAXIS];
+	double u[TA_MAXTHRUSTER], sum = 0.0;
+	int i, n;
+	for (n = 0; n < nset; n++) {
+		for (i = 0; i < L.nthr; i++) pref[n][i] = Rnd();
+		MakeDemand (L, pref[n], demand[n]);
+	}
+	clock_t t0 = clock();
+	for (n = 0; n < nsolve; n++) {
+		alloc.Solve (demand[n%nset], pref[n%nset], u);
+		sum += u[0];
+	}
+	clock_t t1 = clock();
+	printf ("%-7s %.0f ns/solve (checksum %.3f)\n", label,
+		1e9*(double)(t1-t0)/CLOCKS_PER_SEC/nsolve, sum/nsolve);
+}
+
+int main (int argc, char *argv[])
+{
+	const int nsample = 20000;
+	const int nsolve = argc > 1 ? atoi (argv[1]) : 2000000;
+	Layout hover, rnd;
+	bool ok = true;
+	int k;
+
+	srand (1);
+	MakeHover (hover);
+	ok = Check (hover, nsample, "hover") && ok;
+	for (k = 0; k < 4; k++) {
+		MakeRandom (rnd);
+		ok = Check (rnd, nsample/4, "6x3") && ok;
+	}
+	printf ("\n");
+	Time (hover, nsolve, "hover");
+	Time (rnd, nsolve/4, "6x3");
+
+	printf ("\n%s\n", ok ? "all checks passed" : "CHECK FAILED");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,269 @@
+// ==============================================================
+//             ORBITER MODULE: Common vessel tools
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// ActuatorSched.cpp
+// Implementation for class ActuatorScheduler:
+//   Sleep-list scheduler for animated vessel actuators.
+// ==============================================================
+
+#include "ActuatorSched.h"
+#include "Instrument.h"
+
+// ==============================================================
+
+ActuatorScheduler::ActuatorScheduler (VESSEL *v)
+: vessel(v)
+{
+}
+
+// --------------------------------------------------------------
+
+int ActuatorScheduler::AddActuator (UINT anim, double opspeed, double state,
+	DoneFunc done, void *context)
+{
+	Actuator a;
+	a.anim = anim;
+	a.opspeed = opspeed;
+	a.state = max (0.0, min (1.0, state));
+	a.lastspeed = (a.state >= 1.0 ? opspeed : -opspeed);
+	a.slot = -1;
+	a.bound = 0;
+	a.done = done;
+	a.step = 0;
+	a.context = context;
+	act.push_back (a);
+	return (int)act.size()-1;
+}
+
+// --------------------------------------------------------------
+
+int ActuatorScheduler::AddActuator (UINT anim, AnimState2 *state, StepFunc step, void *context)
+{
+	Actuator a;
+	a.anim = anim;
+	a.opspeed = state->inc_speed;
+	a.state = 0.0;
+	a.lastspeed = 0.0;
+	a.slot = -1;
+	a.bound = state;
+	a.done = 0;
+	a.step = step;
+	a.context = context;
+	act.push_back (a);
+	int id = (int)act.size()-1;
+
+	state->sched = this;
+	state->sid = id;
+	if (state->speed) WakeBound (id);
+	return id;
+}
+
+// --------------------------------------------------------------
+
+void ActuatorScheduler::Open (int id)
+{
+	if (State (id) < 1.0)
+		Wake (id, act[id].opspeed);
+}
+
+// --------------------------------------------------------------
+
+void ActuatorScheduler::Close (int id)
+{
+	if (State (id) > 0.0)
+		Wake (id, -act[id].opspeed);
+}
+
+// --------------------------------------------------------------
+
+void ActuatorScheduler::Revert (int id)
+{
+	if (Speed (id) > 0.0 || (!IsActive (id) && act[id].lastspeed > 0.0)) Close (id);
+	else Open (id);
+}
+
+// --------------------------------------------------------------
+
+void ActuatorScheduler::Stop (int id)
+{
+	Sleep (id);
+}
+
+// --------------------------------------------------------------
+
+void ActuatorScheduler::SetState (int id, double state, double speed)
+{
+	Actuator &a = act[id];
+	if (state >= 1.0) {
+		state = 1.0;
+		if (speed > 0.0) speed = 0.0;
+	} else if (state <= 0.0) {
+		state = 0.0;
+		if (speed < 0.0) speed = 0.0;
+	}
+	if (speed) {
+		Wake (id, speed);
+		astate[a.slot] = state;
+	} else {
+		Sleep (id);
+		a.state = state;
+		if (state >= 1.0) a.lastspeed = a.opspeed;
+		else if (state <= 0.0) a.lastspeed = -a.opspeed;
+	}
+	vessel->SetAnimation (a.anim, state);
+}
+
+// --------------------------------------------------------------
+
+double ActuatorScheduler::State (int id) const
+{
+	const Actuator &a = act[id];
+	if (a.bound) return a.bound->state;
+	return (a.slot >= 0 ? astate[a.slot] : a.state);
+}
+
+// --------------------------------------------------------------
+
+double ActuatorScheduler::Speed (int id) const
+{
+	const Actuator &a = act[id];
+	if (a.bound) return a.bound->speed;
+	return (a.slot >= 0 ? aspeed[a.slot] : 0.0);
+}
+
+// --------------------------------------------------------------
+
+void ActuatorScheduler::Step (double dt)
+{
+	if (bid.size()) StepBound (dt);
+
+	int i, n = (int)aid.size();
+	if (!n) return;
+
+	double *s = &astate[0];
+	const double *v = &aspeed[0];
+
+	// advance and clamp. No branches or calls, so the compiler can
+	// vectorise the loop
+	for (i = 0; i < n; i++) {
+		double si = s[i] + v[i]*dt;
+		s[i] = (si < 0.0 ? 0.0 : si > 1.0 ? 1.0 : si);
+	}
+
+	// push the new animation states
+	for (i = 0; i < n; i++)
+		vessel->SetAnimation (act[aid[i]].anim, s[i]);
+
+	// park actuators that have reached an end stop. Iterating backwards
+	// keeps the swap-remove in Sleep from skipping entries
+	for (i = n-1; i >= 0; i--) {
+		if ((v[i] > 0.0 && s[i] >= 1.0) || (v[i] < 0.0 && s[i] <= 0.0)) {
+			int id = aid[i];
+			Sleep (id);
+			if (act[id].done) fin.push_back (id);
+		}
+	}
+
+	// callbacks are deferred until the active list is consistent, so
+	// that they may set other actuators in motion
+	if (fin.size()) {
+		for (i = 0; i < (int)fin.size(); i++) {
+			const Actuator &a = act[fin[i]];
+			a.done (fin[i], a.state, a.context);
+		}
+		fin.clear();
+	}
+}
+
+// --------------------------------------------------------------
+
+void ActuatorScheduler::Wake (int id, double speed)
+{
+	Actuator &a = act[id];
+	if (a.slot < 0) {
+		a.slot = (int)aid.size();
+		astate.push_back (a.state);
+		aspeed.push_back (speed);
+		aid.push_back (id);
+	} else {
+		aspeed[a.slot] = speed;
+	}
+	a.lastspeed = speed;
+}
+
+// --------------------------------------------------------------
+
+void ActuatorScheduler::Sleep (int id)
+{
+	Actuator &a = act[id];
+	int i = a.slot;
+	if (i < 0) return;
+	a.state = astate[i];
+	a.slot = -1;
+
+	// move the last active entry into the vacated slot
+	int last = (int)aid.size()-1;
+	if (i < last) {
+		astate[i] = astate[last];
+		aspeed[i] = aspeed[last];
+		aid[i] = aid[last];
+		act[aid[i]].slot = i;
+	}
+	astate.pop_back();
+	aspeed.pop_back();
+	aid.pop_back();
+}
+
+// --------------------------------------------------------------
+
+void ActuatorScheduler::StepBound (double dt)
+{
+	// Iterating backwards keeps the swap-remove in SleepBound from
+	// skipping entries. Actuators woken by a callback are appended to
+	// the list and start moving with the next step
+	for (int i = (int)bid.size()-1; i >= 0; i--) {
+		int id = bid[i];
+		const Actuator &a = act[id];
+		AnimState2 *s = a.bound;
+		if (s->speed) { // as AnimState2::Process
+			double si = s->state + s->speed*dt;
+			if      (si <= 0.0) s->state = 0.0, s->speed = 0.0;
+			else if (si >= 1.0) s->state = 1.0, s->speed = 0.0;
+			else                s->state = si;
+			if (a.step) a.step (id, s, a.context);
+			vessel->SetAnimation (a.anim, s->state);
+		}
+		if (!s->speed) SleepBound (id);
+	}
+}
+
+// --------------------------------------------------------------
+
+void ActuatorScheduler::WakeBound (int id)
+{
+	Actuator &a = act[id];
+	if (a.slot < 0) {
+		a.slot = (int)bid.size();
+		bid.push_back (id);
+	}
+}
+
+// --------------------------------------------------------------
+
+void ActuatorScheduler::SleepBound (int id)
+{
+	Actuator &a = act[id];
+	int i = a.slot;
+	if (i < 0) return;
+	a.slot = -1;
+
+	int last = (int)bid.size()-1;
+	if (i < last) {
+		bid[i] = bid[last];
+		act[bid[i]].slot = i;
+	}
+	bid.pop_back();
+}
@@ -0,0 +1,149 @@
+// ==============================================================
+//             ORBITER MODULE: Common vessel tools
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// ActuatorSched.h
+// Interface for class ActuatorScheduler:
+//   Per-vessel scheduler for animated actuators (doors, hatches,
+//   antennas, gear etc.) moving between a closed (0) and open (1)
+//   state. Moving actuators are kept in a dense list and advanced in
+//   a single pass per frame; idle actuators are parked and cost
+//   nothing until they are set in motion again.
+//   An actuator either keeps its state in the scheduler, or is bound
+//   to an AnimState2 object of the caller.
+// ==============================================================
+
+#ifndef __ACTUATORSCHED_H
+#define __ACTUATORSCHED_H
+
+#include "Orbitersdk.h"
+#include <vector>
+
+class AnimState2;
+
+// ==============================================================
+
+class ActuatorScheduler {
+public:
+	/**
+	 * \brief Completion callback, invoked when an actuator reaches its
+	 *   open or closed end stop.
+	 * \param id actuator identifier
+	 * \param state final state (0 or 1)
+	 * \param context user data passed to AddActuator
+	 */
+	typedef void (*DoneFunc)(int id, double state, void *context);
+
+	/**
+	 * \brief Step callback for actuators bound to an AnimState2.
+	 * \param id actuator identifier
+	 * \param state actuator state, advanced by the current step
+	 * \param context user data passed to AddActuator
+	 * \note Invoked for each step in which the actuator moved, before its
+	 *   animation is applied, so the callback may modify the state (e.g.
+	 *   to stop at an intermediate position). At an end stop,
+	 *   state->IsActive() returns false.
+	 */
+	typedef void (*StepFunc)(int id, AnimState2 *state, void *context);
+
+	/**
+	 * \brief Create a scheduler for the animations of a vessel.
+	 * \param v vessel instance owning the animations
+	 */
+	ActuatorScheduler (VESSEL *v);
+
+	/**
+	 * \brief Register an actuator.
+	 * \param anim animation identifier, as returned by VESSEL::CreateAnimation
+	 * \param opspeed operating speed [1/s]
+	 * \param state initial state (0..1)
+	 * \param done optional completion callback
+	 * \param context user data passed to the callback
+	 * \return actuator identifier
+	 * \note The actuator starts idle. The animation is not updated until
+	 *   the actuator is moved or its state is set explicitly.
+	 */
+	int AddActuator (UINT anim, double opspeed, double state = 0.0,
+		DoneFunc done = 0, void *context = 0);
+
+	/**
+	 * \brief Register an actuator whose state is kept in an AnimState2.
+	 * \param anim animation identifier, as returned by VESSEL::CreateAnimation
+	 * \param state state object, bound to the scheduler for its lifetime
+	 * \param step optional step callback
+	 * \param context user data passed to the callback
+	 * \return actuator identifier
+	 * \note Setting the state object in motion (AnimState2::Open, Close,
+	 *   SetState etc.) wakes the actuator, and Step advances it. The caller
+	 *   must not call AnimState2::Process for a bound state. Open, Close,
+	 *   Revert, Stop and SetState of the scheduler apply to unbound
+	 *   actuators only.
+	 */
+	int AddActuator (UINT anim, AnimState2 *state, StepFunc step = 0, void *context = 0);
+
+	void Open (int id);    ///< start moving towards the open state
+	void Close (int id);   ///< start moving towards the closed state
+	void Revert (int id);  ///< reverse the current (or last) direction of motion
+	void Stop (int id);    ///< stop at the current state
+
+	/**
+	 * \brief Set state and rate of an actuator, and apply the animation.
+	 * \param id actuator identifier
+	 * \param state new state (clamped to 0..1)
+	 * \param speed new rate of change [1/s]. Motion beyond an end stop is discarded.
+	 * \note Typically used when reading the actuator state from a scenario.
+	 */
+	void SetState (int id, double state, double speed = 0.0);
+
+	double State (int id) const;
+	double Speed (int id) const;
+	inline bool IsActive (int id) const { return act[id].slot >= 0; }
+	inline int ActiveCount () const { return (int)(aid.size() + bid.size()); }
+
+	/**
+	 * \brief Advance all moving actuators.
+	 * \param dt time step [s]
+	 * \note Call once per frame from the vessel's clbkPostStep. Updates the
+	 *   animations of all moving actuators, parks the ones that have reached
+	 *   an end stop and fires their callbacks. Returns immediately if nothing
+	 *   is moving.
+	 */
+	void Step (double dt);
+
+private:
+	friend class AnimState2;
+
+	void Wake (int id, double speed);
+	void Sleep (int id);
+	void WakeBound (int id);
+	void SleepBound (int id);
+	void StepBound (double dt);
+
+	VESSEL *vessel;
+
+	struct Actuator {
+		UINT anim;         // animation identifier
+		double opspeed;    // operating speed [1/s]
+		double state;      // state while idle
+		double lastspeed;  // last rate of motion (sign used by Revert)
+		int slot;          // index into the active list, or -1 if idle
+		AnimState2 *bound; // bound state object, or 0
+		DoneFunc done;
+		StepFunc step;
+		void *context;
+	};
+	std::vector<Actuator> act;
+
+	// active list (dense, structure of arrays)
+	std::vector<double> astate; // states
+	std::vector<double> aspeed; // rates of change
+	std::vector<int> aid;       // actuator identifiers
+	std::vector<int> fin;       // actuators completed during the current step
+
+	// active bound actuators (states are kept in the AnimState2 objects)
+	std::vector<int> bid;
+};
+
+#endif // !__ACTUATORSCHED_H
@@ -0,0 +1,195 @@
+// ==============================================================
+//             ORBITER MODULE: Common vessel tools
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// AnimTree.cpp
+// Implementation for class AnimTree:
+//   Vessel-side evaluation of hierarchical animation transforms.
+// ==============================================================
+
+#include "AnimTree.h"
+
+// ==============================================================
+
+AnimTree::AnimTree ()
+{
+	dirty = false;
+}
+
+// --------------------------------------------------------------
+
+void AnimTree::AddAnimation (UINT anim, double defstate)
+{
+	if (anim >= animidx.size())
+		animidx.resize (anim+1, -1);
+	Animation a;
+	a.defstate = a.state = defstate;
+	animidx[anim] = (int)anim_.size();
+	anim_.push_back (a);
+}
+
+// --------------------------------------------------------------
+
+int AnimTree::AddComponent (UINT anim, double state0, double state1, const MGROUP_TRANSFORM *trans, int parent)
+{
+	Component c;
+	c.anim = animidx[anim];
+	c.parent = (parent < (int)comp_.size() ? parent : -1); // parents must precede their children
+	c.state0 = state0;
+	c.state1 = state1;
+	c.type = trans->Type();
+	c.ref = c.vec = _V(0,0,0);
+	c.angle = 0.0;
+	switch (c.type) {
+	case MGROUP_TRANSFORM::ROTATE: {
+		const MGROUP_ROTATE *rot = (const MGROUP_ROTATE*)trans;
+		c.ref = rot->ref;
+		c.vec = unit (rot->axis);
+		c.angle = rot->angle;
+		} break;
+	case MGROUP_TRANSFORM::TRANSLATE:
+		c.vec = ((const MGROUP_TRANSLATE*)trans)->shift;
+		break;
+	case MGROUP_TRANSFORM::SCALE: {
+		const MGROUP_SCALE *scl = (const MGROUP_SCALE*)trans;
+		c.ref = scl->ref;
+		c.vec = scl->scale;
+		} break;
+	default:
+		break;
+	}
+	c.R = _M(1,0,0, 0,1,0, 0,0,1);
+	c.t = _V(0,0,0);
+	c.dirty = false;
+	comp_.push_back (c);
+	int idx = (int)comp_.size()-1;
+	anim_[c.anim].comp.push_back (idx);
+	return idx;
+}
+
+// --------------------------------------------------------------
+
+void AnimTree::AddPoints (int comp, const VECTOR3 *rest, VECTOR3 *out, int npt)
+{
+	PointSet ps = {comp, (int)px.size(), npt, out};
+	for (int i = 0; i < npt; i++) {
+		px.push_back (rest[i].x);
+		py.push_back (rest[i].y);
+		pz.push_back (rest[i].z);
+		out[i] = Transform (comp, rest[i]);
+	}
+	pset.push_back (ps);
+}
+
+// --------------------------------------------------------------
+
+void AnimTree::SetState (UINT anim, double state)
+{
+	if (anim >= animidx.size() || animidx[anim] < 0) return;
+	Animation &a = anim_[animidx[anim]];
+	if (state == a.state) return;
+	a.state = state;
+	for (size_t i = 0; i < a.comp.size(); i++)
+		comp_[a.comp[i]].dirty = true;
+	dirty = true;
+}
+
+// --------------------------------------------------------------
+// Transform of a single component relative to its default state,
+// for a change df of its fractional state
+
+void AnimTree::LocalTransform (const Component &c, double df, MATRIX3 &R, VECTOR3 &t) const
+{
+	switch (c.type) {
+	case MGROUP_TRANSFORM::ROTATE: {
+		double a = c.angle*df;
+		double ca = cos(a), sa = sin(a), ca1 = 1.0-ca;
+		const VECTOR3 &k = c.vec;
+		R = _M(ca + k.x*k.x*ca1,      k.x*k.y*ca1 - k.z*sa, k.x*k.z*ca1 + k.y*sa,
+			   k.y*k.x*ca1 + k.z*sa, ca + k.y*k.y*ca1,      k.y*k.z*ca1 - k.x*sa,
+			   k.z*k.x*ca1 - k.y*sa, k.z*k.y*ca1 + k.x*sa, ca + k.z*k.z*ca1);
+		t = c.ref - mul (R, c.ref);
+		} break;
+	case MGROUP_TRANSFORM::TRANSLATE:
+		R = _M(1,0,0, 0,1,0, 0,0,1);
+		t = c.vec*df;
+		break;
+	case MGROUP_TRANSFORM::SCALE: {
+		VECTOR3 s = _V(1,1,1) + (c.vec-_V(1,1,1))*df;
+		R = _M(s.x,0,0, 0,s.y,0, 0,0,s.z);
+		t = c.ref - mul (R, c.ref);
+		} break;
+	default:
+		R = _M(1,0,0, 0,1,0, 0,0,1);
+		t = _V(0,0,0);
+		break;
+	}
+}
+
+// --------------------------------------------------------------
+
+static inline double Fraction (double state, double s0, double s1)
+{
+	if (s0 == s1) return (state >= s1 ? 1.0 : 0.0);
+	double f = (state-s0)/(s1-s0);
+	return (f < 0.0 ? 0.0 : f > 1.0 ? 1.0 : f);
+}
+
+// --------------------------------------------------------------
+
+bool AnimTree::Update ()
+{
+	if (!dirty) return false;
+	size_t i;
+
+	// Components are stored parent-first, so a single pass propagates
+	// changes down the affected subtrees. Untouched branches are skipped.
+	for (i = 0; i < comp_.size(); i++) {
+		Component &c = comp_[i];
+		const Component *p = (c.parent >= 0 ? &comp_[c.parent] : 0);
+		if (!c.dirty && !(p && p->dirty)) continue;
+		c.dirty = true;
+		const Animation &a = anim_[c.anim];
+		double df = Fraction (a.state, c.state0, c.state1) - Fraction (a.defstate, c.state0, c.state1);
+		MATRIX3 R;
+		VECTOR3 t;
+		LocalTransform (c, df, R, t);
+		if (p) {
+			c.R = mul (p->R, R);
+			c.t = mul (p->R, t) + p->t;
+		} else {
+			c.R = R;
+			c.t = t;
+		}
+	}
+
+	// transform the point sets of all changed components
+	for (i = 0; i < pset.size(); i++) {
+		const PointSet &ps = pset[i];
+		const Component &c = comp_[ps.comp];
+		if (!c.dirty) continue;
+		const MATRIX3 &R = c.R;
+		const double *x = &px[ps.ofs], *y = &py[ps.ofs], *z = &pz[ps.ofs];
+		VECTOR3 *out = ps.out;
+		for (int j = 0; j < ps.n; j++) {
+			out[j].x = R.m11*x[j] + R.m12*y[j] + R.m13*z[j] + c.t.x;
+			out[j].y = R.m21*x[j] + R.m22*y[j] + R.m23*z[j] + c.t.y;
+			out[j].z = R.m31*x[j] + R.m32*y[j] + R.m33*z[j] + c.t.z;
+		}
+	}
+
+	for (i = 0; i < comp_.size(); i++)
+		comp_[i].dirty = false;
+	dirty = false;
+	return true;
+}
+
+// --------------------------------------------------------------
+
+VECTOR3 AnimTree::Transform (int comp, const VECTOR3 &p) const
+{
+	const Component &c = comp_[comp];
+	return mul (c.R, p) + c.t;
+}
@@ -0,0 +1,118 @@
+// ==============================================================
+//             ORBITER MODULE: Common vessel tools
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// AnimTree.h
+// Interface for class AnimTree:
+//   Vessel-side evaluation of hierarchical animation transforms.
+//   Mirrors animations defined with VESSEL::AddAnimationComponent
+//   in a flat, parent-first transform table, so that the current
+//   positions of animated points (e.g. the tip of a manipulator
+//   arm) are available immediately after a state change, without
+//   waiting for the core to apply the animation to the visual.
+// ==============================================================
+
+#ifndef __ANIMTREE_H
+#define __ANIMTREE_H
+
+#include "Orbitersdk.h"
+#include <vector>
+
+// ==============================================================
+
+class AnimTree {
+public:
+	AnimTree ();
+
+	/**
+	 * \brief Mirror a vessel animation.
+	 * \param anim animation index, as returned by VESSEL::CreateAnimation
+	 * \param defstate default state, as passed to VESSEL::CreateAnimation
+	 */
+	void AddAnimation (UINT anim, double defstate);
+
+	/**
+	 * \brief Mirror an animation component.
+	 * \param anim animation index (must have been added with AddAnimation)
+	 * \param state0 first end state
+	 * \param state1 second end state
+	 * \param trans transformation. Only the transform parameters are used; the
+	 *   mesh groups or vertex lists are not modified.
+	 * \param parent parent component index, or -1
+	 * \return component index
+	 * \note Components must be added after their parents, as for
+	 *   VESSEL::AddAnimationComponent. The transform parameters are copied,
+	 *   so this must be called before the vessel animation is first applied
+	 *   (the core modifies the parameters of child transforms as their parents move).
+	 */
+	int AddComponent (UINT anim, double state0, double state1, const MGROUP_TRANSFORM *trans, int parent = -1);
+
+	/**
+	 * \brief Attach a set of points to a component.
+	 * \param comp component index
+	 * \param rest point positions in the default state (copied)
+	 * \param out array receiving the animated positions on each Update
+	 * \param npt number of points
+	 */
+	void AddPoints (int comp, const VECTOR3 *rest, VECTOR3 *out, int npt);
+
+	/**
+	 * \brief Set the state of a mirrored animation.
+	 * \note Transforms are only recomputed on the next call to Update.
+	 *   Unmirrored animation indices are ignored.
+	 */
+	void SetState (UINT anim, double state);
+
+	/**
+	 * \brief Recompute the transforms of all components affected by state
+	 *   changes since the last call, and the positions of their points.
+	 * \return true if any transforms were recomputed
+	 */
+	bool Update ();
+
+	/**
+	 * \brief Transform a point given in the default state of a component into
+	 *   its current position.
+	 */
+	VECTOR3 Transform (int comp, const VECTOR3 &p) const;
+
+	inline const MATRIX3 &Rotation (int comp) const { return comp_[comp].R; }
+	inline const VECTOR3 &Offset (int comp) const { return comp_[comp].t; }
+	inline int ComponentCount () const { return (int)comp_.size(); }
+
+private:
+	struct Component {
+		int anim;            // owning animation
+		int parent;          // parent component or -1
+		double state0, state1;
+		MGROUP_TRANSFORM::TYPE type;
+		VECTOR3 ref;         // reference point (rotation, scaling)
+		VECTOR3 vec;         // rotation axis, shift vector or scale factors
+		double angle;        // rotation range [rad]
+		MATRIX3 R;           // current transform (default -> current state)
+		VECTOR3 t;
+		bool dirty;
+	};
+	struct Animation {
+		double defstate, state;
+		std::vector<int> comp; // components of this animation
+	};
+	struct PointSet {
+		int comp;
+		int ofs, n;          // range in the point arrays
+		VECTOR3 *out;
+	};
+
+	void LocalTransform (const Component &c, double df, MATRIX3 &R, VECTOR3 &t) const;
+
+	std::vector<Component> comp_;
+	std::vector<Animation> anim_;
+	std::vector<int> animidx;  // vessel animation index -> anim_ entry, or -1
+	std::vector<PointSet> pset;
+	std::vector<double> px, py, pz; // rest positions of all points (SoA)
+	bool dirty;
+};
+
+#endif // !__ANIMTREE_H
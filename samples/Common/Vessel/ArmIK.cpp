@@ -0,0 +1,283 @@
+// ==============================================================
+//             ORBITER MODULE: Common vessel tools
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// ArmIK.cpp
+// Implementation for class ArmIK:
+//   Damped least squares inverse kinematics for serial manipulators.
+// ==============================================================
+
+#include "ArmIK.h"
+#include "Quat.h"
+
+// ==============================================================
+// Local helpers
+
+// In-place Cholesky factorisation of the leading n x n block of a
+// symmetric positive definite matrix (lower triangle is overwritten)
+static bool Cholesky (double a[ARMIK_MAXJOINT][ARMIK_MAXJOINT], int n)
+{
+	int i, j, k;
+	for (j = 0; j < n; j++) {
+		double d = a[j][j];
+		for (k = 0; k < j; k++) d -= a[j][k]*a[j][k];
+		if (d <= 0.0) return false;
+		a[j][j] = d = sqrt(d);
+		for (i = j+1; i < n; i++) {
+			double s = a[i][j];
+			for (k = 0; k < j; k++) s -= a[i][k]*a[j][k];
+			a[i][j] = s/d;
+		}
+	}
+	return true;
+}
+
+// Solve L L^T x = b for a factor returned by Cholesky (b is overwritten with x)
+static void CholeskySolve (const double a[ARMIK_MAXJOINT][ARMIK_MAXJOINT], int n, double *b)
+{
+	int i, k;
+	for (i = 0; i < n; i++) {
+		for (k = 0; k < i; k++) b[i] -= a[i][k]*b[k];
+		b[i] /= a[i][i];
+	}
+	for (i = n-1; i >= 0; i--) {
+		for (k = i+1; k < n; k++) b[i] -= a[k][i]*b[k];
+		b[i] /= a[i][i];
+	}
+}
+
+// ==============================================================
+
+ArmIK::ArmIK ()
+{
+	njoint = 0;
+	tpos = _V(0,0,0);
+	tdir = _V(0,0,1);
+	trot = _V(0,1,0);
+	wp = 1.0;
+	wr = 1.0;
+	lmax = 0.1;
+	w0 = 0.005;
+	dqmax = 0.2;
+	resid = 0.0;
+	niter = 0;
+}
+
+// --------------------------------------------------------------
+
+int ArmIK::AddJoint (const VECTOR3 &ref, const VECTOR3 &axis, double pmin, double pmax, double scale, double p0)
+{
+	if (njoint == ARMIK_MAXJOINT) return -1;
+	Joint &j = joint[njoint];
+	j.ref = ref;
+	j.axis = unit (axis);
+	j.pmin = pmin;
+	j.pmax = pmax;
+	j.scale = scale;
+	j.p0 = p0;
+	return njoint++;
+}
+
+// --------------------------------------------------------------
+
+int ArmIK::AddJoint (const MGROUP_ROTATE *rot, double defstate)
+{
+	return AddJoint (rot->ref, rot->axis, 0.0, 1.0, rot->angle, defstate);
+}
+
+// --------------------------------------------------------------
+
+void ArmIK::SetTip (const VECTOR3 &pos, const VECTOR3 &dir, const VECTOR3 &rot)
+{
+	tpos = pos;
+	tdir = unit (dir);
+	trot = unit (rot - tdir*dotp (rot, tdir));
+}
+
+// --------------------------------------------------------------
+
+void ArmIK::SetWeights (double wpos, double wrot)
+{
+	wp = wpos;
+	wr = wrot;
+}
+
+// --------------------------------------------------------------
+
+void ArmIK::SetDamping (double _lmax, double _w0)
+{
+	lmax = _lmax;
+	w0 = _w0;
+}
+
+// --------------------------------------------------------------
+// Joint pivots and axes, and end effector frame, for joint parameters p.
+// Each joint rotates the rest geometry of its subchain about its rest
+// axis, so the world transform is accumulated from the base. The
+// rotation is accumulated as a quaternion and converted to a matrix
+// once for the end effector frame.
+
+void ArmIK::Chain (const double *p, VECTOR3 *pv, VECTOR3 *av, VECTOR3 &pos, VECTOR3 &dir, VECTOR3 &rot) const
+{
+	Quat q;
+	VECTOR3 t = _V(0,0,0);
+	for (int i = 0; i < njoint; i++) {
+		const Joint &j = joint[i];
+		if (pv) pv[i] = mul (q, j.ref) + t;
+		if (av) av[i] = mul (q, j.axis);
+		Quat qi (j.axis, j.scale*(p[i]-j.p0));
+		t += mul (q, j.ref - mul (qi, j.ref));
+		q = q*qi;
+	}
+	MATRIX3 R = QuatToMatrix (unit (q));
+	pos = mul (R, tpos) + t;
+	dir = mul (R, tdir);
+	rot = mul (R, trot);
+}
+
+// --------------------------------------------------------------
+
+void ArmIK::Forward (const double *p, VECTOR3 &pos, VECTOR3 &dir, VECTOR3 &rot) const
+{
+	Chain (p, 0, 0, pos, dir, rot);
+}
+
+// --------------------------------------------------------------
+// Damped least squares iteration
+//   dp = (J^T J + lambda^2 I)^-1 J^T e
+// over the joints that are not blocked by their limits. J is the weighted
+// 6 x n Jacobian with columns scale_i [a_i x (tip - pivot_i); a_i], e the
+// weighted position and orientation error. The damping is applied only
+// when the manipulability of the active joints, normalised to 0..1 by
+// Hadamard's bound, drops below w0, and grows towards lmax at the singularity.
+
+bool ArmIK::Solve (double *p, const VECTOR3 &pos, const VECTOR3 &dir, const VECTOR3 &rot, int maxiter, double tol)
+{
+	VECTOR3 pv[ARMIK_MAXJOINT], av[ARMIK_MAXJOINT];
+	VECTOR3 jp[ARMIK_MAXJOINT], jr[ARMIK_MAXJOINT];  // Jacobian columns of active joints
+	double a[ARMIK_MAXJOINT][ARMIK_MAXJOINT], g[ARMIK_MAXJOINT];
+	int act[ARMIK_MAXJOINT];
+	VECTOR3 cpos, cdir, crot;
+	int i, k, m;
+
+	// target frame
+	VECTOR3 xd = unit (dir);
+	VECTOR3 xr = unit (rot - xd*dotp (rot, xd));
+	VECTOR3 xs = crossp (xd, xr);
+
+	for (niter = 0;; niter++) {
+		Chain (p, pv, av, cpos, cdir, crot);
+
+		// weighted error. For the orientation, 1/2 sum(c_k x t_k) over the
+		// axes of the current and target frames is the rotation vector
+		// to first order
+		VECTOR3 ep = (pos - cpos) * wp;
+		VECTOR3 er = (crossp (cdir, xd) + crossp (crot, xr) + crossp (crossp (cdir, crot), xs)) * (0.5*wr);
+		resid = sqrt (dotp (ep, ep) + dotp (er, er));
+		if (resid < tol) return true;
+		if (niter == maxiter) return false;
+
+		// Jacobian columns and gradient. Joints at a limit which the
+		// gradient would push further out are frozen for this step
+		for (i = m = 0; i < njoint; i++) {
+			const Joint &j = joint[i];
+			VECTOR3 cp = crossp (av[i], cpos - pv[i]) * (wp*j.scale);
+			VECTOR3 cr = av[i] * (wr*j.scale);
+			double gi = dotp (cp, ep) + dotp (cr, er);
+			if ((p[i] <= j.pmin && gi < 0.0) || (p[i] >= j.pmax && gi > 0.0))
+				continue;
+			jp[m] = cp;
+			jr[m] = cr;
+			g[m] = gi;
+			act[m++] = i;
+		}
+		if (!m) return false;
+
+		// normal matrix
+		double diag = 0.0;
+		for (i = 0; i < m; i++) {
+			for (k = 0; k <= i; k++)
+				a[i][k] = dotp (jp[i], jp[k]) + dotp (jr[i], jr[k]);
+			diag += a[i][i];
+		}
+		diag /= m;
+		if (diag <= 0.0) return false;
+		double eps = 1e-12*diag;
+
+		// manipulability
+		double w = 1.0;
+		double b[ARMIK_MAXJOINT][ARMIK_MAXJOINT];
+		for (i = 0; i < m; i++) {
+			for (k = 0; k < i; k++) b[i][k] = a[i][k];
+			b[i][i] = a[i][i] + eps;
+		}
+		if (Cholesky (b, m)) {
+			for (i = 0; i < m; i++) w *= b[i][i]/sqrt(a[i][i]+eps);
+		} else w = 0.0;
+
+		if (w < w0) {
+			double lambda2 = lmax*lmax * (1.0 - (w/w0)*(w/w0)) * diag + eps;
+			for (i = 0; i < m; i++) {
+				for (k = 0; k < i; k++) b[i][k] = a[i][k];
+				b[i][i] = a[i][i] + lambda2;
+			}
+			if (!Cholesky (b, m)) return false;
+		}
+		CholeskySolve (b, m, g);
+
+		// limit the step size, and apply within the joint limits
+		double dmax = 0.0;
+		for (i = 0; i < m; i++)
+			dmax = max (dmax, fabs (g[i]*joint[act[i]].scale));
+		double s = (dmax > dqmax ? dqmax/dmax : 1.0);
+		for (i = 0; i < m; i++) {
+			const Joint &j = joint[act[i]];
+			p[act[i]] = min (j.pmax, max (j.pmin, p[act[i]] + g[i]*s));
+		}
+	}
+}
+
+// --------------------------------------------------------------
+
+// Largest joint parameter change between two configurations
+static double MaxDelta (const double *p0, const double *p1, int n)
+{
+	double d = 0.0;
+	for (int i = 0; i < n; i++)
+		d = max (d, fabs (p1[i]-p0[i]));
+	return d;
+}
+
+bool ArmIK::Move (double *p, const VECTOR3 &dpos, const VECTOR3 &drot, double dpmax, int maxiter, double tol)
+{
+	VECTOR3 pos, dir, rot;
+	double p0[ARMIK_MAXJOINT];
+	int i;
+	for (i = 0; i < njoint; i++) p0[i] = p[i];
+	Forward (p, pos, dir, rot);
+
+	double f = 1.0; // scale factor for the commanded move
+	for (int pass = 0;; pass++) {
+		VECTOR3 xdir = dir, xrot = rot;
+		if (length (drot) > 0.0) {
+			Quat q = QuatExp (drot*f);
+			xdir = mul (q, dir);
+			xrot = mul (q, rot);
+		}
+		bool ok = Solve (p, pos+dpos*f, xdir, xrot, maxiter, tol);
+		double d = MaxDelta (p0, p, njoint);
+		if (dpmax <= 0.0 || d <= dpmax) return ok;
+
+		if (pass == 1) {
+			// the joint changes are nearly proportional to the move for
+			// small steps, so this only trims the remaining excess
+			double s = dpmax/d;
+			for (i = 0; i < njoint; i++) p[i] = p0[i] + (p[i]-p0[i])*s;
+			return false;
+		}
+		f *= dpmax/d;
+		for (i = 0; i < njoint; i++) p[i] = p0[i];
+	}
+}
@@ -0,0 +1,146 @@
+// ==============================================================
+//             ORBITER MODULE: Common vessel tools
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// ArmIK.h
+// Interface for class ArmIK:
+//   Inverse kinematics for serial manipulators with revolute joints
+//   (e.g. the Shuttle RMS). Joint parameters are solved for a target
+//   end effector position and orientation by damped least squares,
+//   with an analytic Jacobian, joint limits and adaptive damping near
+//   singular configurations. All work arrays are of fixed size, so
+//   the solver can run every frame for any number of arms.
+// ==============================================================
+
+#ifndef __ARMIK_H
+#define __ARMIK_H
+
+#include "Orbitersdk.h"
+
+const int ARMIK_MAXJOINT = 8;  // max number of joints per chain
+
+// ==============================================================
+
+class ArmIK {
+public:
+	ArmIK ();
+
+	/**
+	 * \brief Append a revolute joint to the chain.
+	 * \param ref rotation reference point in the rest configuration
+	 * \param axis rotation axis in the rest configuration
+	 * \param pmin lower joint parameter limit
+	 * \param pmax upper joint parameter limit
+	 * \param scale rotation angle per unit joint parameter [rad]
+	 * \param p0 joint parameter in the rest configuration
+	 * \return joint index, or -1 if the chain is full
+	 * \note Joints must be added from the base to the tip. The rotation
+	 *   angle of the joint is scale*(p-p0), applied in the same sense as
+	 *   an MGROUP_ROTATE transform.
+	 */
+	int AddJoint (const VECTOR3 &ref, const VECTOR3 &axis, double pmin, double pmax,
+		double scale = 1.0, double p0 = 0.0);
+
+	/**
+	 * \brief Append a joint driven by an animation rotation.
+	 * \param rot rotation transform, as passed to VESSEL::AddAnimationComponent
+	 * \param defstate default state of the animation
+	 * \note The joint parameter is the animation state in the range 0..1.
+	 *   Must be called before the animation is first applied, since the
+	 *   core modifies the transform parameters of child components.
+	 */
+	int AddJoint (const MGROUP_ROTATE *rot, double defstate);
+
+	/**
+	 * \brief Define the end effector frame in the rest configuration.
+	 * \param pos end effector position
+	 * \param dir end effector direction
+	 * \param rot end effector rotation reference (orthogonalised against dir)
+	 */
+	void SetTip (const VECTOR3 &pos, const VECTOR3 &dir, const VECTOR3 &rot);
+
+	/**
+	 * \brief Set the relative weights of position and orientation errors.
+	 * \param wpos position weight [1/m]
+	 * \param wrot orientation weight [1/rad]
+	 */
+	void SetWeights (double wpos, double wrot);
+
+	/**
+	 * \brief Set the singularity damping parameters.
+	 * \param lmax max. damping factor, relative to the rms norm of the Jacobian columns
+	 * \param w0 manipulability threshold (0..1) below which damping is applied
+	 */
+	void SetDamping (double lmax, double w0);
+
+	/**
+	 * \brief Set the max. joint rotation per solver iteration [rad].
+	 */
+	inline void SetMaxStep (double maxstep) { dqmax = maxstep; }
+
+	/**
+	 * \brief End effector frame for a set of joint parameters.
+	 * \param p joint parameters
+	 * \param pos end effector position
+	 * \param dir end effector direction (unit)
+	 * \param rot end effector rotation reference (unit)
+	 */
+	void Forward (const double *p, VECTOR3 &pos, VECTOR3 &dir, VECTOR3 &rot) const;
+
+	/**
+	 * \brief Solve for the joint parameters of a target end effector frame.
+	 * \param p joint parameters. On input, the starting configuration; on
+	 *   output, the solution, or the closest configuration found within the
+	 *   joint limits if the target can't be reached.
+	 * \param pos target position
+	 * \param dir target direction
+	 * \param rot target rotation reference
+	 * \param maxiter max. number of iterations
+	 * \param tol convergence limit for the weighted error norm
+	 * \return true if the solver converged
+	 */
+	bool Solve (double *p, const VECTOR3 &pos, const VECTOR3 &dir, const VECTOR3 &rot,
+		int maxiter = 20, double tol = 1e-4);
+
+	/**
+	 * \brief Move the end effector relative to its current frame.
+	 * \param p current joint parameters, updated on output
+	 * \param dpos translation
+	 * \param drot rotation vector (axis times angle [rad])
+	 * \param dpmax max. change of any joint parameter (0 for no limit)
+	 * \return true if the solver converged to the (possibly scaled) target
+	 * \note Translation and rotation are given in the frame of the chain base.
+	 *   The end effector rotates about its own position.
+	 * \note If the solution changes a joint parameter by more than dpmax,
+	 *   translation and rotation are scaled down so that the fastest joint
+	 *   moves by dpmax, and the move is solved again. The end effector then
+	 *   moves along the commanded direction by a smaller amount.
+	 */
+	bool Move (double *p, const VECTOR3 &dpos, const VECTOR3 &drot, double dpmax = 0.0,
+		int maxiter = 20, double tol = 1e-4);
+
+	inline int JointCount () const { return njoint; }
+	inline double Residual () const { return resid; } // weighted error norm after last Solve
+	inline int Iterations () const { return niter; }  // iterations used by last Solve
+
+private:
+	void Chain (const double *p, VECTOR3 *pv, VECTOR3 *av, VECTOR3 &pos, VECTOR3 &dir, VECTOR3 &rot) const;
+
+	struct Joint {
+		VECTOR3 ref, axis;   // rest configuration
+		double pmin, pmax;   // parameter limits
+		double scale, p0;    // angle = scale*(p-p0)
+	} joint[ARMIK_MAXJOINT];
+	int njoint;
+
+	VECTOR3 tpos, tdir, trot;  // end effector frame, rest configuration
+	double wp, wr;             // error weights
+	double lmax, w0;           // singularity damping
+	double dqmax;              // step limit [rad]
+	double resid;
+	int niter;
+};
+
+#endif // !__ARMIK_H
@@ -0,0 +1,229 @@
+// ==============================================================
+//             ORBITER MODULE: Common vessel tools
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// BltBatch.cpp
+// Implementation for class SurfaceAtlas:
+//   Packs small panel bitmaps into a shared source surface
+// Implementation for class BltBatch:
+//   Collects blitting operations and submits them grouped by
+//   target and source surface
+// ==============================================================
+
+#include "BltBatch.h"
+#include <algorithm>
+
+// ==============================================================
+
+SurfaceAtlas::SurfaceAtlas (int w, int h)
+{
+	W = w;
+	H = h;
+	surf = oapiCreateSurface (W, H);
+	shelfx = shelfy = shelfh = 0;
+}
+
+// --------------------------------------------------------------
+
+SurfaceAtlas::~SurfaceAtlas ()
+{
+	if (surf) oapiDestroySurface (surf);
+}
+
+// --------------------------------------------------------------
+
+int SurfaceAtlas::Add (SURFHANDLE src, int w, int h)
+{
+	if (!surf || !src || w > W) return -1;
+
+	if (shelfx + w > W) { // start a new shelf
+		shelfy += shelfh;
+		shelfx = shelfh = 0;
+	}
+	if (shelfy + h > H) return -1;
+
+	RECT r = {shelfx, shelfy, shelfx+w, shelfy+h};
+	oapiBlt (surf, src, r.left, r.top, 0, 0, w, h);
+	sprite.push_back (r);
+	shelfx += w;
+	if (h > shelfh) shelfh = h;
+	return (int)sprite.size()-1;
+}
+
+// --------------------------------------------------------------
+
+int SurfaceAtlas::Add (HBITMAP hBmp)
+{
+	BITMAP bm;
+	if (!hBmp) return -1;
+	if (!GetObject (hBmp, sizeof(BITMAP), &bm)) {
+		DeleteObject (hBmp);
+		return -1;
+	}
+	SURFHANDLE src = oapiCreateSurface (hBmp);
+	int id = Add (src, bm.bmWidth, bm.bmHeight);
+	if (src) oapiDestroySurface (src);
+	return id;
+}
+
+// --------------------------------------------------------------
+
+bool SurfaceAtlas::GetSprite (int id, int &x, int &y) const
+{
+	if (id < 0 || id >= (int)sprite.size()) return false;
+	x = sprite[id].left;
+	y = sprite[id].top;
+	return true;
+}
+
+// ==============================================================
+
+BltBatch::BltBatch ()
+{
+	ResetStats ();
+}
+
+// --------------------------------------------------------------
+
+void BltBatch::ResetStats ()
+{
+	memset (&stats, 0, sizeof(Stats));
+}
+
+// --------------------------------------------------------------
+
+void BltBatch::Blt (SURFHANDLE tgt, SURFHANDLE src, int tgtx, int tgty, int srcx, int srcy, int w, int h, DWORD ck)
+{
+	if (!tgt || !src || w <= 0 || h <= 0) return;
+
+	// Operations on different targets are submitted in separate groups
+	// in arbitrary order, so a dependency between targets must be
+	// resolved by submitting the queue first.
+	for (std::vector<BltOp>::const_iterator it = queue.begin(); it != queue.end(); it++) {
+		if (it->tgt == tgt) continue;
+		if (it->tgt == src || it->src == tgt) {
+			stats.nflush++;
+			Flush ();
+			break;
+		}
+	}
+
+	BltOp op = {tgt, src, tgtx, tgty, srcx, srcy, w, h, ck, 0};
+	queue.push_back (op);
+}
+
+// --------------------------------------------------------------
+
+void BltBatch::Blt (SURFHANDLE tgt, const SurfaceAtlas *atlas, int sprite, int tgtx, int tgty, int srcx, int srcy, int w, int h, DWORD ck)
+{
+	int x0, y0;
+	if (atlas && atlas->GetSprite (sprite, x0, y0))
+		Blt (tgt, atlas->Surface(), tgtx, tgty, x0+srcx, y0+srcy, w, h, ck);
+}
+
+// --------------------------------------------------------------
+
+static inline bool Overlap (int x1, int y1, int w1, int h1, int x2, int y2, int w2, int h2)
+{
+	return x1 < x2+w2 && x2 < x1+w1 && y1 < y2+h2 && y2 < y1+h1;
+}
+
+bool BltBatch::Depends (const BltOp &prev, const BltOp &op)
+{
+	// both write the same pixels
+	if (Overlap (prev.tgtx, prev.tgty, prev.w, prev.h, op.tgtx, op.tgty, op.w, op.h))
+		return true;
+	// op reads pixels of the target written by prev
+	if (op.src == op.tgt && Overlap (prev.tgtx, prev.tgty, prev.w, prev.h, op.srcx, op.srcy, op.w, op.h))
+		return true;
+	// op overwrites pixels of the target read by prev
+	if (prev.src == prev.tgt && Overlap (prev.srcx, prev.srcy, prev.w, prev.h, op.tgtx, op.tgty, op.w, op.h))
+		return true;
+	return false;
+}
+
+// --------------------------------------------------------------
+
+// Stable sort. Queues are usually short, and for those an insertion
+// sort avoids the temporary buffer allocated by std::stable_sort.
+template<class T, class Cmp> static void StableSort (T *a, DWORD n, Cmp cmp)
+{
+	if (n > 32) {
+		std::stable_sort (a, a+n, cmp);
+		return;
+	}
+	for (DWORD i = 1; i < n; i++) {
+		if (!cmp (a[i], a[i-1])) continue;
+		T tmp = a[i];
+		DWORD j = i;
+		do { a[j] = a[j-1]; } while (--j > 0 && cmp (tmp, a[j-1]));
+		a[j] = tmp;
+	}
+}
+
+// --------------------------------------------------------------
+
+bool BltBatch::CmpTgt (const BltOp &a, const BltOp &b)
+{
+	return a.tgt < b.tgt;
+}
+
+// --------------------------------------------------------------
+
+bool BltBatch::CmpLayerSrc (const BltOp &a, const BltOp &b)
+{
+	if (a.layer != b.layer) return a.layer < b.layer;
+	return a.src < b.src;
+}
+
+// --------------------------------------------------------------
+
+void BltBatch::Flush ()
+{
+	DWORD n = (DWORD)queue.size();
+	if (!n) return;
+
+	DWORD i, j, i0, i1;
+	bool mixed;
+
+	// operations on different targets are independent
+	for (i = 1, mixed = false; i < n && !mixed; i++)
+		mixed = (queue[i].tgt != queue[0].tgt);
+	if (mixed) StableSort (&queue[0], n, CmpTgt);
+
+	for (i0 = 0; i0 < n; i0 = i1) {
+		for (i1 = i0+1, mixed = false; i1 < n && queue[i1].tgt == queue[i0].tgt; i1++)
+			if (queue[i1].src != queue[i0].src) mixed = true;
+
+		// Assign layers: an operation must be submitted after any earlier
+		// dependent operation from another source. Operations from the
+		// same source keep their relative order through the stable sort.
+		// Nothing to do if all operations use the same source.
+		if (mixed) {
+			for (i = i0; i < i1; i++) {
+				BltOp &op = queue[i];
+				op.layer = 0;
+				for (j = i0; j < i; j++) {
+					const BltOp &prev = queue[j];
+					if (!Depends (prev, op)) continue;
+					DWORD layer = (prev.src == op.src ? prev.layer : prev.layer+1);
+					if (layer > op.layer) op.layer = layer;
+				}
+			}
+			StableSort (&queue[i0], i1-i0, CmpLayerSrc);
+		}
+
+		oapiBeginBltGroup (queue[i0].tgt);
+		for (i = i0; i < i1; i++) {
+			const BltOp &op = queue[i];
+			if (i == i0 || op.src != queue[i-1].src) stats.nsrc++;
+			oapiBlt (op.tgt, op.src, op.tgtx, op.tgty, op.srcx, op.srcy, op.w, op.h, op.ck);
+		}
+		oapiEndBltGroup ();
+		stats.ngroup++;
+	}
+	stats.nblt += n;
+	queue.clear();
+}
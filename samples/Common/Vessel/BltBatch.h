@@ -0,0 +1,131 @@
+// ==============================================================
+//             ORBITER MODULE: Common vessel tools
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// BltBatch.h
+// Interface for class SurfaceAtlas:
+//   Packs small panel bitmaps into a shared source surface
+// Interface for class BltBatch:
+//   Collects blitting operations and submits them grouped by
+//   target and source surface
+// ==============================================================
+
+#ifndef __BLTBATCH_H
+#define __BLTBATCH_H
+
+#include "Orbitersdk.h"
+#include <vector>
+
+// ==============================================================
+
+class SurfaceAtlas {
+public:
+	/**
+	 * \brief Create an empty atlas surface.
+	 * \param w atlas width [pixel]
+	 * \param h atlas height [pixel]
+	 */
+	SurfaceAtlas (int w, int h);
+	~SurfaceAtlas ();
+
+	/**
+	 * \brief Copy a source bitmap into the atlas.
+	 * \param src source surface
+	 * \param w source width [pixel]
+	 * \param h source height [pixel]
+	 * \return sprite index, or -1 if the atlas is full
+	 * \note Sprites are packed row by row ("shelf" packing). For best
+	 *   results, add sprites in order of decreasing height.
+	 * \note Should be called at panel load time, not per frame.
+	 */
+	int Add (SURFHANDLE src, int w, int h);
+
+	/**
+	 * \brief Copy a bitmap resource into the atlas.
+	 * \param hBmp bitmap handle (released by the atlas)
+	 * \return sprite index, or -1 if the atlas is full
+	 */
+	int Add (HBITMAP hBmp);
+
+	/**
+	 * \brief Atlas position of a sprite.
+	 * \param sprite sprite index
+	 * \param x left edge of the sprite in the atlas [pixel]
+	 * \param y top edge of the sprite in the atlas [pixel]
+	 * \return false if the sprite index is invalid
+	 */
+	bool GetSprite (int sprite, int &x, int &y) const;
+
+	inline SURFHANDLE Surface () const { return surf; }
+
+private:
+	SURFHANDLE surf;
+	int W, H;                    // atlas size
+	int shelfx, shelfy, shelfh;  // insertion point and height of the current shelf
+	std::vector<RECT> sprite;    // sprite positions
+};
+
+// ==============================================================
+
+class BltBatch {
+public:
+	BltBatch ();
+
+	/**
+	 * \brief Queue a blitting operation.
+	 * \note Parameters as for oapiBlt. Nothing is copied until Flush is called.
+	 * \note If the operation reads from a surface that is the target of a
+	 *   queued operation, or writes to a surface that a queued operation
+	 *   reads from, the queue is flushed first.
+	 * \note The caller must flush before accessing a target with
+	 *   oapiGetDC or oapiGetSketchpad, and before destroying a surface
+	 *   that is referenced by a queued operation.
+	 */
+	void Blt (SURFHANDLE tgt, SURFHANDLE src, int tgtx, int tgty, int srcx, int srcy, int w, int h, DWORD ck = SURF_NO_CK);
+
+	/**
+	 * \brief Queue a blitting operation from an atlas sprite.
+	 * \param srcx left edge of the source rectangle relative to the sprite [pixel]
+	 * \param srcy top edge of the source rectangle relative to the sprite [pixel]
+	 */
+	void Blt (SURFHANDLE tgt, const SurfaceAtlas *atlas, int sprite, int tgtx, int tgty, int srcx, int srcy, int w, int h, DWORD ck = SURF_NO_CK);
+
+	/**
+	 * \brief Submit all queued operations.
+	 * \note Operations are submitted in one blitting group per target
+	 *   surface, sorted by source surface. An operation is never moved
+	 *   across an earlier operation from a different source that writes
+	 *   to its target or source rectangle, or reads from its target
+	 *   rectangle, so the result is the same as that of submitting the
+	 *   operations in the order they were queued.
+	 */
+	void Flush ();
+
+	inline DWORD Count () const { return (DWORD)queue.size(); }
+
+	struct Stats {
+		DWORD nblt;    ///< operations submitted
+		DWORD ngroup;  ///< blitting groups (one per target and flush)
+		DWORD nsrc;    ///< source surface changes within the groups
+		DWORD nflush;  ///< flushes forced by surface dependencies
+	};
+	inline const Stats &GetStats () const { return stats; }
+	void ResetStats ();
+
+private:
+	struct BltOp {
+		SURFHANDLE tgt, src;
+		int tgtx, tgty, srcx, srcy, w, h;
+		DWORD ck;
+		DWORD layer;  // submission layer within the target group
+	};
+	static bool Depends (const BltOp &prev, const BltOp &op);
+	static bool CmpTgt (const BltOp &a, const BltOp &b);
+	static bool CmpLayerSrc (const BltOp &a, const BltOp &b);
+	std::vector<BltOp> queue;
+	Stats stats;
+};
+
+#endif // !__BLTBATCH_H
@@ -0,0 +1,309 @@
+// ==============================================================
+//             ORBITER MODULE: Common vessel tools
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// FailureModel.cpp
+// Implementation for class FailureModel:
+//   Declarative failure and damage conditions (threshold hazards,
+//   wear integrators, random failures) evaluated only when their
+//   monitored inputs change band or their scheduled time arrives
+// ==============================================================
+
+#include "FailureModel.h"
+#include <algorithm>
+
+static const double BIG = 1e300;
+
+// ==============================================================
+
+FailureModel::FailureModel ()
+{
+	started = false;
+	tnow = 0.0;
+}
+
+// --------------------------------------------------------------
+
+int FailureModel::AddInput ()
+{
+	Input in;
+	in.value = 0.0;
+	in.lo = -BIG;
+	in.hi = BIG;
+	in.band = 0;
+	in.dirty = false;
+	input.push_back (in);
+	return (int)input.size()-1;
+}
+
+// --------------------------------------------------------------
+
+int FailureModel::AddHazard (int inp, double threshold, bool above, double rate0, double rate1,
+	FailFunc func, void *context)
+{
+	Cond c;
+	c.type = HAZARD;
+	c.input = inp;
+	c.threshold = threshold;
+	c.above = above;
+	c.rate0 = rate0;
+	c.rate1 = rate1;
+	c.acc = 0.0;
+	c.target = SampleExp();
+	c.armed = true;
+	c.activeidx = -1;
+	c.func = func;
+	c.context = context;
+	cond.push_back (c);
+	input[inp].dirty = true;
+	return (int)cond.size()-1;
+}
+
+// --------------------------------------------------------------
+
+int FailureModel::AddWear (int inp, double threshold, bool above, double rate, double limit,
+	FailFunc func, void *context)
+{
+	int id = AddHazard (inp, threshold, above, 0.0, rate, func, context);
+	cond[id].type = WEAR;
+	cond[id].target = limit;
+	return id;
+}
+
+// --------------------------------------------------------------
+
+int FailureModel::AddRandom (double mtbf, FailFunc func, void *context)
+{
+	Cond c;
+	c.type = RANDOM;
+	c.input = -1;
+	c.threshold = 0.0;
+	c.above = true;
+	c.rate0 = mtbf;
+	c.rate1 = 0.0;
+	c.acc = 0.0;
+	c.target = BIG;
+	c.armed = true;
+	c.activeidx = -1;
+	c.func = func;
+	c.context = context;
+	cond.push_back (c);
+	int id = (int)cond.size()-1;
+	if (started) Schedule (id, tnow);
+	return id;
+}
+
+// --------------------------------------------------------------
+
+void FailureModel::Arm (int id, bool arm)
+{
+	cond[id].armed = arm;
+}
+
+// --------------------------------------------------------------
+
+void FailureModel::Reset (int id)
+{
+	Cond &c = cond[id];
+	c.acc = 0.0;
+	c.armed = true;
+	if (c.type == HAZARD) c.target = SampleExp();
+}
+
+// --------------------------------------------------------------
+
+double FailureModel::Wear (int id) const
+{
+	return cond[id].acc;
+}
+
+// --------------------------------------------------------------
+
+void FailureModel::SetInput (int inp, double value)
+{
+	Input &in = input[inp];
+	in.value = value;
+	if (in.dirty) {
+		Build (inp);
+		return;
+	}
+	if (value >= in.lo && value < in.hi) return; // still in band
+
+	int k, band = (int)(std::upper_bound (in.edge.begin(), in.edge.end(), value) - in.edge.begin());
+	size_t j;
+	if (band > in.band) {        // thresholds crossed upwards
+		for (k = in.band; k < band; k++)
+			for (j = 0; j < in.edgecond[k].size(); j++)
+				SetActive (in.edgecond[k][j], cond[in.edgecond[k][j]].above);
+	} else {                     // thresholds crossed downwards
+		for (k = band; k < in.band; k++)
+			for (j = 0; j < in.edgecond[k].size(); j++)
+				SetActive (in.edgecond[k][j], !cond[in.edgecond[k][j]].above);
+	}
+	in.band = band;
+	in.lo = (band > 0 ? in.edge[band-1] : -BIG);
+	in.hi = (band < (int)in.edge.size() ? in.edge[band] : BIG);
+}
+
+// --------------------------------------------------------------
+
+void FailureModel::Build (int inp)
+{
+	Input &in = input[inp];
+	size_t i, k;
+
+	in.edge.clear();
+	for (i = 0; i < cond.size(); i++)
+		if (cond[i].input == inp) in.edge.push_back (cond[i].threshold);
+	std::sort (in.edge.begin(), in.edge.end());
+	in.edge.erase (std::unique (in.edge.begin(), in.edge.end()), in.edge.end());
+
+	in.edgecond.assign (in.edge.size(), std::vector<int>());
+	for (i = 0; i < cond.size(); i++) {
+		if (cond[i].input != inp) continue;
+		k = std::lower_bound (in.edge.begin(), in.edge.end(), cond[i].threshold) - in.edge.begin();
+		in.edgecond[k].push_back ((int)i);
+		SetActive ((int)i, cond[i].above ? in.value >= cond[i].threshold : in.value < cond[i].threshold);
+	}
+
+	in.band = (int)(std::upper_bound (in.edge.begin(), in.edge.end(), in.value) - in.edge.begin());
+	in.lo = (in.band > 0 ? in.edge[in.band-1] : -BIG);
+	in.hi = (in.band < (int)in.edge.size() ? in.edge[in.band] : BIG);
+	in.dirty = false;
+}
+
+// --------------------------------------------------------------
+
+void FailureModel::SetActive (int id, bool act)
+{
+	Cond &c = cond[id];
+	if (act && c.activeidx < 0) {
+		c.activeidx = (int)active.size();
+		active.push_back (id);
+	} else if (!act && c.activeidx >= 0) {
+		int last = active.back();
+		active[c.activeidx] = last;
+		cond[last].activeidx = c.activeidx;
+		active.pop_back();
+		c.activeidx = -1;
+	}
+}
+
+// --------------------------------------------------------------
+
+void FailureModel::Schedule (int id, double t0)
+{
+	Cond &c = cond[id];
+	c.target = (c.rate0 > 0.0 ? t0 + c.rate0*SampleExp() : BIG);
+	QueueCmp cmp = {&cond};
+	queue.push_back (id);
+	std::push_heap (queue.begin(), queue.end(), cmp);
+}
+
+// --------------------------------------------------------------
+
+void FailureModel::Advance (double simt, double simdt)
+{
+	size_t i;
+	QueueCmp cmp = {&cond};
+	fired.clear();
+
+	if (!started) {
+		for (i = 0; i < cond.size(); i++)
+			if (cond[i].type == RANDOM) Schedule ((int)i, simt);
+		started = true;
+	}
+	tnow = simt;
+
+	// integrate the active threshold conditions
+	for (i = 0; i < active.size(); i++) {
+		Cond &c = cond[active[i]];
+		if (!c.armed) continue;
+		double e = fabs (input[c.input].value - c.threshold);
+		double rate = c.rate0 + c.rate1*e;
+		c.acc += rate*simdt;
+		if (c.acc >= c.target) {
+			if (c.type == HAZARD) { // draw the next target, stay armed
+				c.acc = 0.0;
+				c.target = SampleExp();
+			} else {                // worn out
+				c.armed = false;
+			}
+			fired.push_back (active[i]);
+		}
+	}
+
+	// due random failures
+	while (queue.size() && cond[queue[0]].target <= simt) {
+		std::pop_heap (queue.begin(), queue.end(), cmp);
+		int id = queue.back();
+		queue.pop_back();
+		if (cond[id].armed) fired.push_back (id);
+		Schedule (id, cond[id].target);
+	}
+
+	// callbacks are invoked last, so they can safely modify the model
+	for (i = 0; i < fired.size(); i++) {
+		Cond &c = cond[fired[i]];
+		double value = (c.type == HAZARD ? c.rate0 + c.rate1*fabs (input[c.input].value - c.threshold) :
+		                c.type == WEAR ? c.acc : c.rate0);
+		c.func (c.context, fired[i], value);
+	}
+}
+
+// --------------------------------------------------------------
+
+void FailureModel::SaveSnapshot (SnapshotWriter &snp) const
+{
+	size_t i;
+	snp.Put ((int)input.size());
+	snp.Put ((int)cond.size());
+	for (i = 0; i < input.size(); i++)
+		snp.Put (input[i].value);
+	for (i = 0; i < cond.size(); i++) {
+		snp.Put (cond[i].acc);
+		snp.Put (cond[i].target);
+		snp.Put (cond[i].armed);
+	}
+	snp.Put (started);
+	snp.Put (tnow);
+}
+
+// --------------------------------------------------------------
+
+bool FailureModel::LoadSnapshot (SnapshotReader &snp)
+{
+	size_t i;
+	int ninput, ncond;
+	if (!snp.Get (ninput) || !snp.Get (ncond) ||
+		ninput != (int)input.size() || ncond != (int)cond.size())
+		return false;
+	for (i = 0; i < input.size(); i++)
+		if (!snp.Get (input[i].value)) return false;
+	for (i = 0; i < cond.size(); i++)
+		if (!snp.Get (cond[i].acc) || !snp.Get (cond[i].target) || !snp.Get (cond[i].armed))
+			return false;
+	if (!snp.Get (started) || !snp.Get (tnow)) return false;
+
+	// bands and active set follow from the input values
+	for (i = 0; i < input.size(); i++)
+		Build ((int)i);
+
+	// due times of the random failures were restored with the conditions
+	QueueCmp cmp = {&cond};
+	queue.clear();
+	if (started)
+		for (i = 0; i < cond.size(); i++)
+			if (cond[i].type == RANDOM) queue.push_back ((int)i);
+	std::make_heap (queue.begin(), queue.end(), cmp);
+	return true;
+}
+
+// --------------------------------------------------------------
+
+double FailureModel::SampleExp ()
+{
+	return -log (max (oapiRand(), 1e-12));
+}
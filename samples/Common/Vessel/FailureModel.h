@@ -0,0 +1,177 @@
+// ==============================================================
+//             ORBITER MODULE: Common vessel tools
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// FailureModel.h
+// Interface for class FailureModel:
+//   Declarative failure and damage conditions (threshold hazards,
+//   wear integrators, random failures) evaluated only when their
+//   monitored inputs change band or their scheduled time arrives
+// ==============================================================
+
+#ifndef __FAILUREMODEL_H
+#define __FAILUREMODEL_H
+
+#include "Orbitersdk.h"
+#include "Snapshot.h"
+#include <vector>
+
+// ==============================================================
+
+class FailureModel {
+public:
+	/**
+	 * \brief Failure callback.
+	 * \param context user context, as passed when the condition was added
+	 * \param id condition index
+	 * \param value failure rate [1/s] (hazard), accumulated wear (wear),
+	 *   or mean time between failures [s] (random)
+	 */
+	typedef void (*FailFunc)(void *context, int id, double value);
+
+	FailureModel ();
+
+	/**
+	 * \brief Add a monitored input.
+	 * \return input index
+	 */
+	int AddInput ();
+
+	/**
+	 * \brief Add a hazard condition.
+	 * \param input monitored input
+	 * \param threshold input value beyond which the hazard is active
+	 * \param above true: active at or above threshold, false: active below
+	 * \param rate0, rate1 failure rate while active is rate0 + rate1*e,
+	 *   where e is the exceedance |value-threshold| [1/s]
+	 * \param func failure callback
+	 * \param context callback context
+	 * \return condition index
+	 * \note The failure time is found by integrating the rate up to a
+	 *   sampled exponential target, so no random numbers are drawn per
+	 *   step. After a failure a new target is drawn and the condition stays
+	 *   armed.
+	 */
+	int AddHazard (int input, double threshold, bool above, double rate0, double rate1,
+		FailFunc func, void *context);
+
+	/**
+	 * \brief Add a wear condition.
+	 * \param input monitored input
+	 * \param threshold input value beyond which wear accumulates
+	 * \param above true: active at or above threshold, false: active below
+	 * \param rate wear per unit exceedance per second
+	 * \param limit accumulated wear at which the component fails
+	 * \param func failure callback
+	 * \param context callback context
+	 * \return condition index
+	 * \note The condition is disarmed when it fails. Use Reset to re-arm it.
+	 */
+	int AddWear (int input, double threshold, bool above, double rate, double limit,
+		FailFunc func, void *context);
+
+	/**
+	 * \brief Add a random failure independent of any input.
+	 * \param mtbf mean time between failures [s]
+	 * \param func failure callback
+	 * \param context callback context
+	 * \return condition index
+	 * \note Failure times are sampled from the exponential distribution
+	 *   and kept in a time-ordered queue.
+	 */
+	int AddRandom (double mtbf, FailFunc func, void *context);
+
+	/**
+	 * \brief Arm or disarm a condition. Disarmed conditions do not fail.
+	 */
+	void Arm (int cond, bool arm);
+
+	/**
+	 * \brief Clear the accumulated hazard or wear of a condition and re-arm it.
+	 */
+	void Reset (int cond);
+
+	/**
+	 * \brief Accumulated wear of a condition (wear conditions only).
+	 */
+	double Wear (int cond) const;
+
+	/**
+	 * \brief Update a monitored input.
+	 * \note Cost is a single range check unless the value leaves its
+	 *   current band (the interval between adjacent thresholds defined for
+	 *   this input).
+	 */
+	void SetInput (int input, double value);
+
+	/**
+	 * \brief Advance the model and invoke the callbacks of failed conditions.
+	 * \param simt simulation time [s]
+	 * \param simdt time step [s]
+	 * \note Cost is proportional to the number of currently active
+	 *   conditions plus due random failures, independent of the total
+	 *   number of conditions.
+	 */
+	void Advance (double simt, double simdt);
+
+	/**
+	 * \brief Write the input values and the accumulated state of all conditions.
+	 */
+	void SaveSnapshot (SnapshotWriter &snp) const;
+
+	/**
+	 * \brief Restore the state written by SaveSnapshot.
+	 * \return false if the data don't match the defined inputs and conditions
+	 * \note The active set and the random failure queue are rebuilt from the
+	 *   restored values.
+	 */
+	bool LoadSnapshot (SnapshotReader &snp);
+
+private:
+	enum CondType { HAZARD, WEAR, RANDOM };
+
+	struct Cond {
+		CondType type;
+		int input;            // monitored input (HAZARD, WEAR)
+		double threshold;     // activation threshold
+		bool above;           // active above threshold?
+		double rate0, rate1;  // rate parameters (RANDOM: rate0 = mtbf)
+		double acc;           // accumulated hazard or wear
+		double target;        // failure target for acc (RANDOM: due time)
+		bool armed;
+		int activeidx;        // index in active list, or -1
+		FailFunc func;
+		void *context;
+	};
+
+	struct QueueCmp {
+		const std::vector<Cond> *c;
+		bool operator() (int a, int b) const { return (*c)[a].target > (*c)[b].target; }
+	};
+
+	struct Input {
+		double value;
+		double lo, hi;                  // current band
+		int band;                       // current band index
+		std::vector<double> edge;       // sorted unique thresholds
+		std::vector<std::vector<int> > edgecond; // conditions per threshold
+		bool dirty;                     // edges need rebuild
+	};
+
+	void Build (int input);
+	void SetActive (int cond, bool active);
+	void Schedule (int cond, double t0);
+	static double SampleExp ();
+
+	std::vector<Cond> cond;
+	std::vector<Input> input;
+	std::vector<int> active;  // active threshold conditions
+	std::vector<int> queue;   // random failures, min-heap by due time
+	std::vector<int> fired;   // work buffer: failed conditions in this step
+	bool started;             // random failures scheduled?
+	double tnow;              // time of last Advance
+};
+
+#endif // !__FAILUREMODEL_H
@@ -0,0 +1,575 @@
+// ==============================================================
+//             ORBITER MODULE: Common vessel tools
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// FlightRec.cpp
+// Implementation for classes FlightRecorder and FlightPlayer
+// ==============================================================
+
+#include "FlightRec.h"
+#include <string.h>
+#include <algorithm>
+
+// ==============================================================
+// File format
+//
+// header:  'ORFR', version
+// chunks:  tag, payload size, payload
+//   'STRS' string table entries: first id, count, {length, chars}
+//   'KEYF' keyframe: time, state count, {vessel, state},
+//                    event count, {vessel, type, time, length, chars}
+//   'DATA' records in order of time:
+//          sample: time, vessel, FR_SAMPLE, state
+//          event:  time, vessel, FR_EVENT, type, length, chars
+//   'INDX' full string table, keyframe count, {time, file offset},
+//          recording start and end time
+// trailer: file offset of the INDX chunk, 'FRIX'
+// ==============================================================
+
+const DWORD FR_MAGIC   = 0x5246524F; // 'ORFR'
+const DWORD FR_VERSION = 1;
+const DWORD FR_IXMAGIC = 0x58495246; // 'FRIX'
+const DWORD FR_STRS    = 0x53525453; // 'STRS'
+const DWORD FR_KEYF    = 0x4659454B; // 'KEYF'
+const DWORD FR_DATA    = 0x41544144; // 'DATA'
+const DWORD FR_INDX    = 0x58444E49; // 'INDX'
+
+const WORD FR_SAMPLE   = 1;
+const WORD FR_EVENT    = 2;
+
+const size_t FR_CHUNKSIZE = 0x10000; // data chunk size at which records are flushed
+
+// --------------------------------------------------------------
+// Serialisation helpers
+
+template<class T> static void Put (std::vector<char> &buf, const T &val)
+{
+	const char *p = (const char*)&val;
+	buf.insert (buf.end(), p, p+sizeof(T));
+}
+
+static void PutStr (std::vector<char> &buf, const char *str, size_t len)
+{
+	Put (buf, (WORD)len);
+	buf.insert (buf.end(), str, str+len);
+}
+
+template<class T> static bool Get (const char *&p, const char *end, T &val)
+{
+	if (p+sizeof(T) > end) return false;
+	memcpy (&val, p, sizeof(T));
+	p += sizeof(T);
+	return true;
+}
+
+static bool GetStr (const char *&p, const char *end, const char *&str, WORD &len)
+{
+	if (!Get (p, end, len) || p+len > end) return false;
+	str = p;
+	p += len;
+	return true;
+}
+
+// ==============================================================
+// class FlightRecorder
+// ==============================================================
+
+FlightRecorder::FlightRecorder ()
+{
+	f = 0;
+}
+
+// --------------------------------------------------------------
+
+FlightRecorder::~FlightRecorder ()
+{
+	Close ();
+}
+
+// --------------------------------------------------------------
+
+bool FlightRecorder::Open (const char *fname, double _keydt)
+{
+	Close ();
+	if (!(f = fopen (fname, "wb"))) return false;
+	DWORD hdr[2] = {FR_MAGIC, FR_VERSION};
+	fwrite (hdr, sizeof(DWORD), 2, f);
+
+	keydt = _keydt;
+	tkey = -1e100; // keyframe at the first record
+	t0 = t1 = 0.0;
+	strid.clear();
+	str.clear();
+	nstrout = 0;
+	buf.clear();
+	state.clear();
+	keyev.clear();
+	index.clear();
+	return true;
+}
+
+// --------------------------------------------------------------
+
+void FlightRecorder::Close ()
+{
+	if (!f) return;
+	Flush ();
+
+	std::vector<char> data;
+	Put (data, (DWORD)str.size());
+	for (size_t i = 0; i < str.size(); i++)
+		PutStr (data, str[i].c_str(), str[i].size());
+	Put (data, (DWORD)index.size());
+	for (size_t i = 0; i < index.size(); i++) {
+		Put (data, index[i].first);
+		Put (data, index[i].second);
+	}
+	Put (data, t0);
+	Put (data, t1);
+	__int64 ofs = _ftelli64 (f);
+	WriteChunk (FR_INDX, data);
+	fwrite (&ofs, sizeof(ofs), 1, f);
+	fwrite (&FR_IXMAGIC, sizeof(DWORD), 1, f);
+	fclose (f);
+	f = 0;
+}
+
+// --------------------------------------------------------------
+
+void FlightRecorder::Sample (double t, const char *vessel, const FR_STATE &s)
+{
+	if (!f) return;
+	if (t >= tkey) Keyframe (t);
+	WORD vid = Intern (vessel);
+	Put (buf, t);
+	Put (buf, vid);
+	Put (buf, FR_SAMPLE);
+	Put (buf, s);
+	state[vid] = s;
+	t1 = t;
+	if (buf.size() >= FR_CHUNKSIZE) Flush ();
+}
+
+// --------------------------------------------------------------
+
+void FlightRecorder::Sample (double t, VESSEL *v, OBJHANDLE hRef)
+{
+	FR_STATE s;
+	v->GetRelativePos (hRef, s.pos);
+	v->GetRelativeVel (hRef, s.vel);
+	v->GetGlobalOrientation (s.arot);
+	v->GetAngularVel (s.vrot);
+	Sample (t, v->GetName(), s);
+}
+
+// --------------------------------------------------------------
+
+void FlightRecorder::Event (double t, const char *vessel, const char *type, const char *event)
+{
+	if (!f) return;
+	if (t >= tkey) Keyframe (t);
+	WORD vid = Intern (vessel);
+	WORD tid = Intern (type);
+	size_t len = min (strlen (event), (size_t)0xFFFF);
+	Put (buf, t);
+	Put (buf, vid);
+	Put (buf, FR_EVENT);
+	Put (buf, tid);
+	PutStr (buf, event, len);
+	KeyEvent &ke = keyev[((DWORD)vid << 16) | tid];
+	ke.t = t;
+	ke.event.assign (event, len);
+	t1 = t;
+	if (buf.size() >= FR_CHUNKSIZE) Flush ();
+}
+
+// --------------------------------------------------------------
+
+WORD FlightRecorder::Intern (const char *s)
+{
+	std::map<std::string,WORD>::iterator it = strid.find (s);
+	if (it != strid.end()) return it->second;
+	if (str.size() == 0xFFFF) return 0xFFFF; // string table full
+	WORD id = (WORD)str.size();
+	str.push_back (s);
+	strid[s] = id;
+	return id;
+}
+
+// --------------------------------------------------------------
+
+void FlightRecorder::Keyframe (double t)
+{
+	Flush ();
+	if (index.empty()) t0 = t;
+
+	std::vector<char> data;
+	Put (data, t);
+	Put (data, (DWORD)state.size());
+	for (std::map<WORD,FR_STATE>::iterator it = state.begin(); it != state.end(); ++it) {
+		Put (data, it->first);
+		Put (data, it->second);
+	}
+	Put (data, (DWORD)keyev.size());
+	for (std::map<DWORD,KeyEvent>::iterator it = keyev.begin(); it != keyev.end(); ++it) {
+		Put (data, (WORD)(it->first >> 16));
+		Put (data, (WORD)(it->first & 0xFFFF));
+		Put (data, it->second.t);
+		PutStr (data, it->second.event.c_str(), it->second.event.size());
+	}
+	index.push_back (std::make_pair (t, _ftelli64 (f)));
+	WriteChunk (FR_KEYF, data);
+	tkey = t + keydt;
+}
+
+// --------------------------------------------------------------
+
+void FlightRecorder::Flush ()
+{
+	// strings are written ahead of the records referring to them, so that
+	// the file can be read without the index
+	if (nstrout < str.size()) {
+		std::vector<char> data;
+		Put (data, (DWORD)nstrout);
+		Put (data, (DWORD)(str.size()-nstrout));
+		for (; nstrout < str.size(); nstrout++)
+			PutStr (data, str[nstrout].c_str(), str[nstrout].size());
+		WriteChunk (FR_STRS, data);
+	}
+	if (buf.size()) {
+		WriteChunk (FR_DATA, buf);
+		buf.clear();
+	}
+}
+
+// --------------------------------------------------------------
+
+void FlightRecorder::WriteChunk (DWORD tag, const std::vector<char> &data)
+{
+	DWORD hdr[2] = {tag, (DWORD)data.size()};
+	fwrite (hdr, sizeof(DWORD), 2, f);
+	if (data.size()) fwrite (&data[0], 1, data.size(), f);
+}
+
+// ==============================================================
+// class FlightPlayer
+// ==============================================================
+
+FlightPlayer::FlightPlayer ()
+{
+	f = 0;
+	efunc = DispatchToVessel;
+	sfunc = 0;
+	context = 0;
+}
+
+// --------------------------------------------------------------
+
+FlightPlayer::~FlightPlayer ()
+{
+	Close ();
+}
+
+// --------------------------------------------------------------
+
+bool FlightPlayer::Open (const char *fname)
+{
+	Close ();
+	if (!(f = fopen (fname, "rb"))) return false;
+	DWORD hdr[2];
+	if (fread (hdr, sizeof(DWORD), 2, f) != 2 || hdr[0] != FR_MAGIC || hdr[1] != FR_VERSION) {
+		Close ();
+		return false;
+	}
+	str.clear();
+	index.clear();
+	t0 = t1 = 0.0;
+
+	// locate the index from the trailer
+	bool ok = false;
+	if (!_fseeki64 (f, -(__int64)(sizeof(__int64)+sizeof(DWORD)), SEEK_END)) {
+		__int64 ofs;
+		DWORD magic;
+		if (fread (&ofs, sizeof(ofs), 1, f) == 1 && fread (&magic, sizeof(magic), 1, f) == 1 && magic == FR_IXMAGIC)
+			ok = ReadIndex (ofs);
+	}
+	if (!ok && !Scan()) {
+		Close ();
+		return false;
+	}
+
+	// position at the first chunk; nothing is dispatched before the
+	// caller has set the callbacks
+	if (_fseeki64 (f, 2*sizeof(DWORD), SEEK_SET)) {
+		Close ();
+		return false;
+	}
+	return true;
+}
+
+// --------------------------------------------------------------
+
+void FlightPlayer::Close ()
+{
+	if (f) {
+		fclose (f);
+		f = 0;
+	}
+	state.clear();
+	chunk.clear();
+	cpos = 0;
+}
+
+// --------------------------------------------------------------
+
+void FlightPlayer::SetCallbacks (EventFunc _efunc, StateFunc _sfunc, void *_context)
+{
+	efunc = _efunc;
+	sfunc = _sfunc;
+	context = _context;
+}
+
+// --------------------------------------------------------------
+
+bool FlightPlayer::Seek (double t)
+{
+	if (!f || index.empty()) return false;
+
+	// latest keyframe not after t
+	std::vector<std::pair<double,__int64> >::iterator it =
+		std::upper_bound (index.begin(), index.end(), std::make_pair (t, (__int64)0x7FFFFFFFFFFFFFFF));
+	if (it != index.begin()) --it;
+
+	DWORD tag;
+	std::vector<char> data;
+	if (_fseeki64 (f, it->second, SEEK_SET) || !ReadChunk (tag, data) || tag != FR_KEYF || !ReadKeyframe (data))
+		return false;
+
+	// replay the events up to t, but only report the final states
+	StateFunc sf = sfunc;
+	sfunc = 0;
+	Advance (t);
+	sfunc = sf;
+	if (sfunc)
+		for (std::map<WORD,FR_STATE>::iterator is = state.begin(); is != state.end(); ++is)
+			sfunc (t, Str (is->first), is->second, context);
+	return true;
+}
+
+// --------------------------------------------------------------
+
+bool FlightPlayer::Advance (double t)
+{
+	if (!f) return false;
+	for (;;) {
+		if (cpos >= chunk.size()) {
+			DWORD tag;
+			do {
+				if (!ReadChunk (tag, chunk)) {
+					chunk.clear();
+					cpos = 0;
+					return false;
+				}
+				if (tag == FR_STRS) ReadStrings (&chunk[0], &chunk[0]+chunk.size());
+			} while (tag != FR_DATA);
+			cpos = 0;
+		}
+
+		const char *p = &chunk[0]+cpos, *end = &chunk[0]+chunk.size();
+		double rt;
+		WORD vid = 0, kind = 0;
+		if (!Get (p, end, rt) || rt > t) return true;
+		Get (p, end, vid);
+		Get (p, end, kind);
+		if (kind == FR_SAMPLE) {
+			FR_STATE s;
+			if (!Get (p, end, s)) break;
+			state[vid] = s;
+			if (sfunc) sfunc (rt, Str (vid), s, context);
+		} else if (kind == FR_EVENT) {
+			WORD tid, len;
+			const char *ev;
+			if (!Get (p, end, tid) || !GetStr (p, end, ev, len)) break;
+			if (efunc) {
+				std::string event (ev, len);
+				efunc (rt, Str (vid), Str (tid), event.c_str(), context);
+			}
+		} else break;
+		cpos = p - &chunk[0];
+	}
+	// corrupt record: skip the rest of the chunk
+	cpos = chunk.size();
+	return true;
+}
+
+// --------------------------------------------------------------
+
+bool FlightPlayer::State (const char *vessel, FR_STATE &s) const
+{
+	for (std::map<WORD,FR_STATE>::const_iterator it = state.begin(); it != state.end(); ++it)
+		if (!strcmp (Str (it->first), vessel)) {
+			s = it->second;
+			return true;
+		}
+	return false;
+}
+
+// --------------------------------------------------------------
+
+void FlightPlayer::DispatchToVessel (double t, const char *vessel, const char *type, const char *event, void *context)
+{
+	OBJHANDLE hVessel = oapiGetVesselByName ((char*)vessel);
+	if (hVessel) {
+		VESSEL *v = oapiGetVesselInterface (hVessel);
+		if (v->Version() >= 1)
+			((VESSEL2*)v)->clbkPlaybackEvent (oapiGetSimTime(), t, type, event);
+	}
+}
+
+// --------------------------------------------------------------
+
+bool FlightPlayer::ReadChunk (DWORD &tag, std::vector<char> &data)
+{
+	DWORD hdr[2];
+	__int64 pos = _ftelli64 (f);
+	if (pos + 2*sizeof(DWORD) > dataend || fread (hdr, sizeof(DWORD), 2, f) != 2) return false;
+	if (pos + 2*sizeof(DWORD) + hdr[1] > dataend) return false;
+	tag = hdr[0];
+	data.resize (hdr[1]);
+	return (!hdr[1] || fread (&data[0], 1, hdr[1], f) == hdr[1]);
+}
+
+// --------------------------------------------------------------
+
+void FlightPlayer::ReadStrings (const char *p, const char *end)
+{
+	DWORD id, n;
+	if (!Get (p, end, id) || !Get (p, end, n)) return;
+	for (DWORD i = 0; i < n; i++) {
+		const char *s;
+		WORD len;
+		if (!GetStr (p, end, s, len)) return;
+		if (str.size() <= id+i) str.resize (id+i+1);
+		str[id+i].assign (s, len);
+	}
+}
+
+// --------------------------------------------------------------
+
+bool FlightPlayer::ReadIndex (__int64 ofs)
+{
+	DWORD tag;
+	std::vector<char> data;
+	dataend = ofs + 2*sizeof(DWORD);
+	if (_fseeki64 (f, ofs, SEEK_SET) || fread (&tag, sizeof(DWORD), 1, f) != 1 || tag != FR_INDX)
+		return false;
+	DWORD size;
+	if (fread (&size, sizeof(DWORD), 1, f) != 1) return false;
+	data.resize (size);
+	if (size && fread (&data[0], 1, size, f) != size) return false;
+
+	const char *p = &data[0], *end = p+size;
+	DWORD n, i;
+	if (!Get (p, end, n)) return false;
+	str.resize (n);
+	for (i = 0; i < n; i++) {
+		const char *s;
+		WORD len;
+		if (!GetStr (p, end, s, len)) return false;
+		str[i].assign (s, len);
+	}
+	if (!Get (p, end, n)) return false;
+	index.resize (n);
+	for (i = 0; i < n; i++)
+		if (!Get (p, end, index[i].first) || !Get (p, end, index[i].second)) return false;
+	if (!Get (p, end, t0) || !Get (p, end, t1)) return false;
+	dataend = ofs; // playback stops at the index chunk
+	return true;
+}
+
+// --------------------------------------------------------------
+
+bool FlightPlayer::Scan ()
+{
+	// unterminated recording: collect strings and keyframes from the chunks
+	_fseeki64 (f, 0, SEEK_END);
+	dataend = _ftelli64 (f);
+	_fseeki64 (f, 2*sizeof(DWORD), SEEK_SET);
+	str.clear();
+	index.clear();
+
+	DWORD tag;
+	std::vector<char> data;
+	__int64 pos = _ftelli64 (f);
+	while (ReadChunk (tag, data)) {
+		const char *p = (data.size() ? &data[0] : 0), *end = p+data.size();
+		double t;
+		if (tag == FR_STRS) {
+			ReadStrings (p, end);
+		} else if (tag == FR_KEYF) {
+			if (Get (p, end, t)) {
+				if (index.empty()) t0 = t;
+				index.push_back (std::make_pair (t, pos));
+				t1 = t;
+			}
+		} else if (tag == FR_DATA) {
+			// time of the last record in the chunk
+			while (Get (p, end, t)) {
+				WORD vid = 0, kind = 0, tid, len;
+				const char *ev;
+				Get (p, end, vid);
+				Get (p, end, kind);
+				if (kind == FR_SAMPLE && p+sizeof(FR_STATE) <= end) p += sizeof(FR_STATE);
+				else if (kind != FR_EVENT || !Get (p, end, tid) || !GetStr (p, end, ev, len)) break;
+				t1 = t;
+			}
+		} else if (tag == FR_INDX) {
+			break;
+		}
+		pos = _ftelli64 (f);
+	}
+	dataend = pos; // ignore a truncated final chunk
+	return !index.empty();
+}
+
+// --------------------------------------------------------------
+
+bool FlightPlayer::ReadKeyframe (const std::vector<char> &data)
+{
+	const char *p = &data[0], *end = p+data.size();
+	double t;
+	DWORD i, n;
+	if (!Get (p, end, t) || !Get (p, end, n)) return false;
+
+	state.clear();
+	for (i = 0; i < n; i++) {
+		WORD vid;
+		FR_STATE s;
+		if (!Get (p, end, vid) || !Get (p, end, s)) return false;
+		state[vid] = s;
+	}
+	if (!Get (p, end, n)) return false;
+	for (i = 0; i < n; i++) {
+		WORD vid, tid, len;
+		double et;
+		const char *ev;
+		if (!Get (p, end, vid) || !Get (p, end, tid) || !Get (p, end, et) || !GetStr (p, end, ev, len))
+			return false;
+		if (efunc) {
+			std::string event (ev, len);
+			efunc (et, Str (vid), Str (tid), event.c_str(), context);
+		}
+	}
+	chunk.clear();
+	cpos = 0;
+	return true;
+}
+
+// --------------------------------------------------------------
+
+const char *FlightPlayer::Str (WORD id) const
+{
+	return (id < str.size() ? str[id].c_str() : "");
+}
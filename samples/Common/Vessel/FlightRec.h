@@ -0,0 +1,217 @@
+// ==============================================================
+//             ORBITER MODULE: Common vessel tools
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// FlightRec.h
+// Interface for classes FlightRecorder and FlightPlayer:
+//   Binary flight recordings of vessel state samples and playback
+//   events. Recordings are divided into chunks, with event types and
+//   vessel names stored once in a string table, keyframes at regular
+//   intervals and a time index of the keyframes at the end of the file.
+//   The player can jump to any time by locating the preceding keyframe
+//   in the index, and only replays the events recorded after it.
+// ==============================================================
+
+#ifndef __FLIGHTREC_H
+#define __FLIGHTREC_H
+
+#include "Orbitersdk.h"
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <map>
+
+/**
+ * \brief Vessel state sample.
+ */
+struct FR_STATE {
+	VECTOR3 pos;   ///< position [m]
+	VECTOR3 vel;   ///< velocity [m/s]
+	VECTOR3 arot;  ///< orientation (Euler angles) [rad]
+	VECTOR3 vrot;  ///< angular velocity [rad/s]
+};
+
+// ==============================================================
+
+/**
+ * \brief Writes a binary flight recording.
+ *
+ * Samples and events must be recorded in order of time. A keyframe
+ * with the latest state sample of each vessel and the latest event of
+ * each type and vessel is written automatically at the keyframe
+ * interval.
+ */
+class FlightRecorder {
+public:
+	FlightRecorder ();
+	~FlightRecorder ();
+
+	/**
+	 * \brief Create a recording file.
+	 * \param fname file name
+	 * \param keydt keyframe interval [s]
+	 * \return false if the file could not be created
+	 */
+	bool Open (const char *fname, double keydt = 10.0);
+
+	/**
+	 * \brief Write the index and close the file.
+	 */
+	void Close ();
+
+	inline bool IsOpen () const { return f != 0; }
+
+	/**
+	 * \brief Record a vessel state sample.
+	 * \param t simulation time [s]
+	 * \param vessel vessel name
+	 * \param s vessel state
+	 */
+	void Sample (double t, const char *vessel, const FR_STATE &s);
+
+	/**
+	 * \brief Record a vessel state sample, taking the state from a vessel.
+	 * \param t simulation time [s]
+	 * \param v vessel
+	 * \param hRef reference object for position and velocity
+	 */
+	void Sample (double t, VESSEL *v, OBJHANDLE hRef);
+
+	/**
+	 * \brief Record a playback event, as passed to VESSEL::RecordEvent.
+	 * \param t simulation time [s]
+	 * \param vessel vessel name
+	 * \param type event type (e.g. "GEAR")
+	 * \param event event data (e.g. "DOWN")
+	 */
+	void Event (double t, const char *vessel, const char *type, const char *event);
+
+private:
+	WORD Intern (const char *str);
+	void Keyframe (double t);
+	void Flush ();
+	void WriteChunk (DWORD tag, const std::vector<char> &data);
+
+	struct KeyEvent {
+		double t;
+		std::string event;
+	};
+
+	FILE *f;
+	double keydt;                          // keyframe interval [s]
+	double tkey;                           // time of next keyframe [s]
+	double t0, t1;                         // recording time span [s]
+	std::map<std::string,WORD> strid;      // string table lookup
+	std::vector<std::string> str;          // string table
+	size_t nstrout;                        // number of strings written to the file
+	std::vector<char> buf;                 // record buffer for the current data chunk
+	std::map<WORD,FR_STATE> state;         // latest sample per vessel
+	std::map<DWORD,KeyEvent> keyev;        // latest event per vessel and type
+	std::vector<std::pair<double,__int64> > index; // keyframe times and file offsets
+};
+
+// ==============================================================
+
+/**
+ * \brief Plays back a binary flight recording.
+ */
+class FlightPlayer {
+public:
+	/**
+	 * \brief Event callback.
+	 * \param t event time [s]
+	 * \param vessel vessel name
+	 * \param type event type
+	 * \param event event data
+	 * \param context user data passed to SetCallbacks
+	 */
+	typedef void (*EventFunc)(double t, const char *vessel, const char *type, const char *event, void *context);
+
+	/**
+	 * \brief State sample callback.
+	 * \param t sample time [s]
+	 * \param vessel vessel name
+	 * \param s vessel state
+	 * \param context user data passed to SetCallbacks
+	 */
+	typedef void (*StateFunc)(double t, const char *vessel, const FR_STATE &s, void *context);
+
+	FlightPlayer ();
+	~FlightPlayer ();
+
+	/**
+	 * \brief Open a recording.
+	 * \return false if the file is not a flight recording
+	 * \note If the recording was not closed properly, the keyframe index is
+	 *   rebuilt by scanning the file, and playback ends at the last complete chunk.
+	 * \note No events or samples are dispatched. Playback is positioned at
+	 *   the start of the recording, so that Advance plays it from the
+	 *   beginning. Call SetCallbacks first, then Advance or Seek.
+	 */
+	bool Open (const char *fname);
+	void Close ();
+
+	/**
+	 * \brief Set the functions receiving events and state samples.
+	 * \note Events are dispatched to the vessels' VESSEL2::clbkPlaybackEvent
+	 *   by default (see DispatchToVessel).
+	 */
+	void SetCallbacks (EventFunc efunc, StateFunc sfunc, void *context = 0);
+
+	/**
+	 * \brief Jump to a time.
+	 * \param t playback time [s]
+	 * \note Locates the latest keyframe before t with a binary search of the
+	 *   index. The events stored in the keyframe and all events between the
+	 *   keyframe and t are dispatched. The state callback is then called
+	 *   once for each vessel with its latest sample.
+	 */
+	bool Seek (double t);
+
+	/**
+	 * \brief Play forward up to a time, dispatching all events and state samples.
+	 * \param t playback time [s]
+	 * \return false at the end of the recording
+	 */
+	bool Advance (double t);
+
+	/**
+	 * \brief Latest state sample of a vessel.
+	 * \return false if no sample of the vessel has been played yet
+	 */
+	bool State (const char *vessel, FR_STATE &s) const;
+
+	inline double StartTime () const { return t0; }
+	inline double EndTime () const { return t1; }
+	inline int KeyframeCount () const { return (int)index.size(); }
+
+	/**
+	 * \brief Event callback passing events on to the named vessel's
+	 *   clbkPlaybackEvent method.
+	 */
+	static void DispatchToVessel (double t, const char *vessel, const char *type, const char *event, void *context);
+
+private:
+	bool ReadChunk (DWORD &tag, std::vector<char> &data);
+	void ReadStrings (const char *p, const char *end);
+	bool ReadIndex (__int64 ofs);
+	bool Scan ();
+	bool ReadKeyframe (const std::vector<char> &data);
+	const char *Str (WORD id) const;
+
+	FILE *f;
+	__int64 dataend;                       // end of chunk data
+	double t0, t1;                         // recording time span [s]
+	std::vector<std::string> str;          // string table
+	std::vector<std::pair<double,__int64> > index; // keyframe times and file offsets
+	std::map<WORD,FR_STATE> state;         // latest sample per vessel
+	std::vector<char> chunk;               // current data chunk
+	size_t cpos;                           // read position in chunk
+	EventFunc efunc;
+	StateFunc sfunc;
+	void *context;
+};
+
+#endif // !__FLIGHTREC_H
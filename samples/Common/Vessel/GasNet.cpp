@@ -0,0 +1,385 @@
+// ==============================================================
+//             ORBITER MODULE: Common vessel tools
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// GasNet.cpp
+// Implementation for class GasNetwork:
+//   Pressure balance between pressurised compartments linked by
+//   valves, hatches, leaks and docking tunnels. Networks of docked
+//   vessels can be connected and are then solved as one system.
+// ==============================================================
+
+#include "GasNet.h"
+
+std::vector<GasNetwork::Port> GasNetwork::port_;
+
+// ==============================================================
+
+GasNetwork::GasNetwork ()
+{
+	tstep = -1e10;
+}
+
+// --------------------------------------------------------------
+
+GasNetwork::~GasNetwork ()
+{
+	while (tunnel_.size())
+		Disconnect (tunnel_.back().net);
+	for (size_t i = 0; i < port_.size();)
+		if (port_[i].net == this) port_.erase (port_.begin()+i);
+		else i++;
+}
+
+// --------------------------------------------------------------
+
+int GasNetwork::AddCompartment (double volume, double p)
+{
+	Node n = {volume, p, false, -1};
+	node_.push_back (n);
+	return (int)node_.size()-1;
+}
+
+// --------------------------------------------------------------
+
+int GasNetwork::AddBoundary (double p)
+{
+	Node n = {0.0, p, true, -1};
+	node_.push_back (n);
+	return (int)node_.size()-1;
+}
+
+// --------------------------------------------------------------
+
+void GasNetwork::SetBoundary (int node, bool boundary, double volume)
+{
+	node_[node].boundary = boundary;
+	if (!boundary) node_[node].V = volume;
+}
+
+// --------------------------------------------------------------
+
+int GasNetwork::AddLink (int node1, int node2, double G)
+{
+	Link l = {node1, node2, G, -1.0, true};
+	link_.push_back (l);
+	return (int)link_.size()-1;
+}
+
+// --------------------------------------------------------------
+
+int GasNetwork::AddRegulator (int node, int source, double G, double pmax)
+{
+	Link l = {node, source, G, pmax, true};
+	link_.push_back (l);
+	return (int)link_.size()-1;
+}
+
+// --------------------------------------------------------------
+
+void GasNetwork::Connect (int node, GasNetwork *other, int othernode, double G)
+{
+	Tunnel t1 = {other, node, othernode, G};
+	Tunnel t2 = {this, othernode, node, G};
+	tunnel_.push_back (t1);
+	other->tunnel_.push_back (t2);
+}
+
+// --------------------------------------------------------------
+
+void GasNetwork::Disconnect (GasNetwork *other)
+{
+	size_t i;
+	for (i = 0; i < tunnel_.size();)
+		if (tunnel_[i].net == other) tunnel_.erase (tunnel_.begin()+i);
+		else i++;
+	for (i = 0; i < other->tunnel_.size();)
+		if (other->tunnel_[i].net == this) other->tunnel_.erase (other->tunnel_.begin()+i);
+		else i++;
+}
+
+// --------------------------------------------------------------
+
+bool GasNetwork::IsConnected (const GasNetwork *other) const
+{
+	for (size_t i = 0; i < tunnel_.size(); i++)
+		if (tunnel_[i].net == other) return true;
+	return false;
+}
+
+// --------------------------------------------------------------
+
+void GasNetwork::SaveSnapshot (SnapshotWriter &snp) const
+{
+	size_t i;
+	snp.Put ((DWORD)node_.size());
+	for (i = 0; i < node_.size(); i++) {
+		snp.Put (node_[i].p);
+		snp.Put (node_[i].V);
+		snp.Put (node_[i].boundary);
+	}
+	snp.Put ((DWORD)link_.size());
+	for (i = 0; i < link_.size(); i++) {
+		snp.Put (link_[i].G);
+		snp.Put (link_[i].pmax);
+	}
+}
+
+// --------------------------------------------------------------
+
+bool GasNetwork::LoadSnapshot (SnapshotReader &snp)
+{
+	DWORD i, n;
+	if (!snp.Get (n) || n != node_.size()) return false;
+	std::vector<Node> nd (node_);
+	for (i = 0; i < n; i++)
+		if (!snp.Get (nd[i].p) || !snp.Get (nd[i].V) || !snp.Get (nd[i].boundary)) return false;
+	if (!snp.Get (n) || n != link_.size()) return false;
+	std::vector<Link> ln (link_);
+	for (i = 0; i < n; i++)
+		if (!snp.Get (ln[i].G) || !snp.Get (ln[i].pmax)) return false;
+	node_.swap (nd);
+	link_.swap (ln);
+	tstep = -1e10;
+	return true;
+}
+
+// --------------------------------------------------------------
+
+void GasNetwork::RegisterPort (OBJHANDLE hVessel, int port, int node)
+{
+	for (size_t i = 0; i < port_.size(); i++)
+		if (port_[i].hVessel == hVessel && port_[i].port == port) {
+			port_[i].net = this;
+			port_[i].node = node;
+			return;
+		}
+	Port p = {hVessel, port, this, node};
+	port_.push_back (p);
+}
+
+// --------------------------------------------------------------
+
+bool GasNetwork::FindPort (OBJHANDLE hVessel, int port, GasNetwork *&net, int &node)
+{
+	for (size_t i = 0; i < port_.size(); i++)
+		if (port_[i].hVessel == hVessel && port_[i].port == port) {
+			net = port_[i].net;
+			node = port_[i].node;
+			return true;
+		}
+	return false;
+}
+
+// --------------------------------------------------------------
+// Collect all networks connected to this one
+
+void GasNetwork::Collect (std::vector<GasNetwork*> &cluster)
+{
+	cluster.clear();
+	cluster.push_back (this);
+	for (size_t k = 0; k < cluster.size(); k++) {
+		GasNetwork *net = cluster[k];
+		for (size_t i = 0; i < net->tunnel_.size(); i++) {
+			GasNetwork *other = net->tunnel_[i].net;
+			size_t j;
+			for (j = 0; j < cluster.size(); j++)
+				if (cluster[j] == other) break;
+			if (j == cluster.size()) cluster.push_back (other);
+		}
+	}
+}
+
+// --------------------------------------------------------------
+// Extend the matrix envelope for a flow path between two compartments
+
+void GasNetwork::Span (int i1, int i2)
+{
+	if (i1 < 0 || i2 < 0) return;
+	if (i1 > i2) first[i1] = min (first[i1], i2);
+	else         first[i2] = min (first[i2], i1);
+}
+
+// --------------------------------------------------------------
+// Add the contribution of a flow path to the system matrix. Only the
+// lower triangle is stored: element (i,j), first[i] <= j <= i, is at
+// A[diag[i]-i+j].
+
+void GasNetwork::Couple (int i1, double p1, bool bnd1, int i2, double p2, bool bnd2, double G)
+{
+	if (G <= 0.0 || (bnd1 && bnd2)) return;
+	if (bnd1) {
+		A[diag[i2]] += G;  b[i2] += G*p1;
+	} else if (bnd2) {
+		A[diag[i1]] += G;  b[i1] += G*p2;
+	} else {
+		A[diag[i1]] += G;  A[diag[i2]] += G;
+		if (i1 > i2) A[diag[i1]-i1+i2] -= G;
+		else         A[diag[i2]-i2+i1] -= G;
+	}
+}
+
+// --------------------------------------------------------------
+// In-place Cholesky factorisation of A. Fill-in is confined to the
+// envelope given by first[], so the cost scales with the square of
+// the bandwidth, which is small for the chains and trees of
+// compartments formed by docked modules.
+
+bool GasNetwork::Factorise (int n)
+{
+	int i, j, k;
+	for (i = 0; i < n; i++) {
+		int oi = diag[i]-i;
+		for (j = first[i]; j < i; j++) {
+			int oj = diag[j]-j;
+			double s = A[oi+j];
+			for (k = max (first[i], first[j]); k < j; k++) s -= A[oi+k]*A[oj+k];
+			A[oi+j] = s/A[diag[j]];
+		}
+		double d = A[diag[i]];
+		for (k = first[i]; k < i; k++) d -= A[oi+k]*A[oi+k];
+		if (d <= 0.0) return false;
+		A[diag[i]] = sqrt(d);
+	}
+	return true;
+}
+
+// --------------------------------------------------------------
+// Forward and back substitution with the Cholesky factor; result in b
+
+void GasNetwork::Substitute (int n)
+{
+	int i, k;
+	for (i = 0; i < n; i++) {
+		int oi = diag[i]-i;
+		double s = b[i];
+		for (k = first[i]; k < i; k++) s -= A[oi+k]*b[k];
+		b[i] = s/A[diag[i]];
+	}
+	for (i = n-1; i >= 0; i--) {
+		int oi = diag[i]-i;
+		double x = (b[i] /= A[diag[i]]);
+		for (k = first[i]; k < i; k++) b[k] -= A[oi+k]*x;
+	}
+}
+
+// --------------------------------------------------------------
+
+void GasNetwork::Step (double simt, double dt)
+{
+	if (simt == tstep || dt <= 0.0) return;
+
+	std::vector<GasNetwork*> cluster;
+	size_t c, i;
+	int n = 0, nz, pass;
+
+	// number the free compartments of all connected networks
+	Collect (cluster);
+	for (c = 0; c < cluster.size(); c++) {
+		GasNetwork *net = cluster[c];
+		net->tstep = simt;
+		for (i = 0; i < net->node_.size(); i++) {
+			Node &nd = net->node_[i];
+			nd.idx = (nd.boundary ? -1 : n++);
+		}
+		for (i = 0; i < net->link_.size(); i++)
+			net->link_[i].active = true;
+	}
+	if (!n) return;
+
+	// matrix envelope: the first coupled column of each row
+	first.resize (n);
+	diag.resize (n);
+	for (i = 0; i < (size_t)n; i++) first[i] = (int)i;
+	for (c = 0; c < cluster.size(); c++) {
+		GasNetwork *net = cluster[c];
+		for (i = 0; i < net->link_.size(); i++) {
+			const Link &l = net->link_[i];
+			Span (net->node_[l.n1].idx, net->node_[l.n2].idx);
+		}
+		for (i = 0; i < net->tunnel_.size(); i++) {
+			const Tunnel &t = net->tunnel_[i];
+			Span (net->node_[t.node].idx, t.net->node_[t.othernode].idx);
+		}
+	}
+	for (i = 0, nz = 0; i < (size_t)n; i++) {
+		nz += (int)i-first[i]+1;
+		diag[i] = nz-1;
+	}
+
+	// Backward Euler: (V/dt + L) p' = V/dt p + G p_boundary
+	// Regulators which would overshoot their set point are switched
+	// off and the step is repeated (at most once per regulator).
+	for (pass = 0; pass < 8; pass++) {
+		A.assign (nz, 0.0);
+		b.assign (n, 0.0);
+		for (c = 0; c < cluster.size(); c++) {
+			GasNetwork *net = cluster[c];
+			for (i = 0; i < net->node_.size(); i++) {
+				const Node &nd = net->node_[i];
+				if (nd.idx >= 0) {
+					A[diag[nd.idx]] += nd.V/dt;
+					b[nd.idx] += nd.V/dt*nd.p;
+				}
+			}
+			for (i = 0; i < net->link_.size(); i++) {
+				const Link &l = net->link_[i];
+				if (!l.active) continue;
+				const Node &n1 = net->node_[l.n1], &n2 = net->node_[l.n2];
+				Couple (n1.idx, n1.p, n1.boundary, n2.idx, n2.p, n2.boundary, l.G);
+			}
+			for (i = 0; i < net->tunnel_.size(); i++) {
+				const Tunnel &t = net->tunnel_[i];
+				if (t.net < net) continue; // each tunnel is listed by both ends
+				const Node &n1 = net->node_[t.node], &n2 = t.net->node_[t.othernode];
+				Couple (n1.idx, n1.p, n1.boundary, n2.idx, n2.p, n2.boundary, t.G);
+			}
+		}
+		if (!Factorise (n)) return; // singular: keep the current pressures
+		Substitute (n);
+
+		bool repeat = false;
+		for (c = 0; c < cluster.size(); c++) {
+			GasNetwork *net = cluster[c];
+			for (i = 0; i < net->link_.size(); i++) {
+				Link &l = net->link_[i];
+				if (l.pmax >= 0.0 && l.active && l.G > 0.0) {
+					int idx = net->node_[l.n1].idx;
+					if (idx >= 0 && b[idx] > l.pmax) {
+						l.active = false;
+						repeat = true;
+					}
+				}
+			}
+		}
+		if (!repeat) break;
+	}
+
+	// copy back, limiting regulated nodes to their set point
+	for (c = 0; c < cluster.size(); c++) {
+		GasNetwork *net = cluster[c];
+		for (i = 0; i < net->node_.size(); i++) {
+			Node &nd = net->node_[i];
+			if (nd.idx >= 0) nd.p = b[nd.idx];
+		}
+		for (i = 0; i < net->link_.size(); i++) {
+			const Link &l = net->link_[i];
+			if (l.pmax >= 0.0 && l.G > 0.0 && !l.active) {
+				Node &nd = net->node_[l.n1], &src = net->node_[l.n2];
+				if (!nd.boundary && nd.p < l.pmax && src.p > nd.p) {
+					// regulator was switched off for the whole step but would
+					// have fed until reaching the set point
+					double pn = min (l.pmax, nd.p + l.G*dt/nd.V*(src.p-nd.p));
+					if (!src.boundary)
+						pn = min (pn, (nd.p*nd.V + src.p*src.V)/(nd.V+src.V));
+					if (pn > nd.p) {
+						if (!src.boundary) src.p -= (pn-nd.p)*nd.V/src.V;
+						nd.p = pn;
+					}
+				}
+			}
+		}
+	}
+}
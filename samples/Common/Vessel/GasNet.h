@@ -0,0 +1,175 @@
+// ==============================================================
+//             ORBITER MODULE: Common vessel tools
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// GasNet.h
+// Interface for class GasNetwork:
+//   Pressure balance between pressurised compartments linked by
+//   valves, hatches, leaks and docking tunnels. Networks of docked
+//   vessels can be connected and are then solved as one system.
+// ==============================================================
+
+#ifndef __GASNET_H
+#define __GASNET_H
+
+#include "Orbitersdk.h"
+#include "Snapshot.h"
+#include <vector>
+
+// ==============================================================
+
+class GasNetwork {
+public:
+	GasNetwork ();
+	~GasNetwork ();
+
+	/**
+	 * \brief Add a compartment of fixed volume.
+	 * \param volume compartment volume [m^3]
+	 * \param p initial pressure [Pa]
+	 * \return node index
+	 */
+	int AddCompartment (double volume, double p);
+
+	/**
+	 * \brief Add a boundary node of prescribed pressure (ambient
+	 *   atmosphere, vacuum, supply tank).
+	 * \param p boundary pressure [Pa]
+	 * \return node index
+	 */
+	int AddBoundary (double p);
+
+	/**
+	 * \brief Switch a node between compartment and boundary.
+	 * \param volume compartment volume [m^3] (ignored for boundaries). Must
+	 *   be > 0.
+	 */
+	void SetBoundary (int node, bool boundary, double volume = 1.0);
+
+	inline bool IsBoundary (int node) const { return node_[node].boundary; }
+	inline double Pressure (int node) const { return node_[node].p; }
+	inline void SetPressure (int node, double p) { node_[node].p = p; }
+
+	/**
+	 * \brief Add a flow path between two nodes.
+	 * \param G flow conductance [m^3/s]: the volume flow at the pressure of
+	 *   the receiving node is G*(p1-p2)/p, so that V*dp/dt = G*dp_link.
+	 *   G=0 represents a closed valve.
+	 * \return link index
+	 */
+	int AddLink (int node1, int node2, double G);
+
+	/**
+	 * \brief Add a pressure regulator feeding a node from a source node.
+	 * \param pmax regulated pressure. The flow stops once the node reaches pmax.
+	 * \return link index
+	 */
+	int AddRegulator (int node, int source, double G, double pmax);
+
+	/**
+	 * \brief Change the conductance of a link (valve position etc.)
+	 */
+	inline void SetLink (int link, double G) { link_[link].G = G; }
+
+	/**
+	 * \brief Connect a node of this network to a node of another network
+	 *   (e.g. across a docking tunnel). Connected networks are solved as
+	 *   a single system.
+	 */
+	void Connect (int node, GasNetwork *other, int othernode, double G);
+
+	/**
+	 * \brief Remove all connections to another network.
+	 */
+	void Disconnect (GasNetwork *other);
+
+	bool IsConnected (const GasNetwork *other) const;
+
+	/**
+	 * \brief Advance the pressures of this network and all networks
+	 *   connected to it.
+	 * \param simt current simulation time [s]. A cluster of connected
+	 *   networks is only advanced once for a given simt.
+	 * \param dt time step [s]
+	 * \note The integrator is implicit (backward Euler) and therefore
+	 *   stable and free of overshoot for any step length. The total gas
+	 *   content (sum of p*V) of the compartments is conserved apart from
+	 *   exchange with boundary nodes.
+	 * \note If the system is singular (a compartment without volume), the
+	 *   pressures are left unchanged.
+	 */
+	void Step (double simt, double dt);
+
+	/**
+	 * \brief Register a node as the docking port node of a vessel, so that
+	 *   a docked vessel can find and connect to it.
+	 */
+	void RegisterPort (OBJHANDLE hVessel, int port, int node);
+
+	/**
+	 * \brief Find the network registered for a vessel docking port.
+	 * \return true if a network was registered for the port
+	 * \note Only networks created by the same module are visible.
+	 */
+	static bool FindPort (OBJHANDLE hVessel, int port, GasNetwork *&net, int &node);
+
+	/**
+	 * \brief Write the node pressures, node types and volumes, and the link
+	 *   conductances and regulator set points to a snapshot.
+	 * \note Connections to other networks are not written. The owner
+	 *   re-establishes them after loading.
+	 */
+	void SaveSnapshot (SnapshotWriter &snp) const;
+
+	/**
+	 * \brief Restore the state written by SaveSnapshot.
+	 * \return false if the data are incomplete or were written by a network
+	 *   with a different number of nodes or links. The network is unchanged
+	 *   in that case.
+	 */
+	bool LoadSnapshot (SnapshotReader &snp);
+
+private:
+	struct Node {
+		double V;        // volume [m^3]
+		double p;        // pressure [Pa]
+		bool boundary;   // prescribed pressure?
+		int idx;         // index in the combined system, or -1
+	};
+	struct Link {
+		int n1, n2;      // node indices
+		double G;        // conductance [m^3/s]
+		double pmax;     // regulated pressure for regulators, or <0
+		bool active;     // regulator currently feeding?
+	};
+	struct Tunnel {
+		GasNetwork *net; // connected network
+		int node, othernode;
+		double G;
+	};
+	struct Port {
+		OBJHANDLE hVessel;
+		int port;
+		GasNetwork *net;
+		int node;
+	};
+
+	void Collect (std::vector<GasNetwork*> &cluster);
+	void Span (int idx1, int idx2);
+	void Couple (int idx1, double p1, bool bnd1, int idx2, double p2, bool bnd2, double G);
+	bool Factorise (int n);
+	void Substitute (int n);
+
+	std::vector<Node> node_;
+	std::vector<Link> link_;
+	std::vector<Tunnel> tunnel_;
+	double tstep;                   // simulation time of last step
+	std::vector<double> A, b;       // system matrix (lower envelope, row by row) and right-hand side
+	std::vector<int> first;         // first nonzero column of each matrix row
+	std::vector<int> diag;          // index of each row's diagonal element in A
+	static std::vector<Port> port_; // docking port registry
+};
+
+#endif // !__GASNET_H
@@ -0,0 +1,292 @@
+// ==============================================================
+//             ORBITER MODULE: Common vessel tools
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// GearContact.cpp
+// Implementation for classes ElevationCache and GearContact:
+//   Landing gear contact model with per-strut spring-damper
+//   suspension, tyre friction ellipses and wheel brakes, using
+//   cached surface elevation queries
+// ==============================================================
+
+#include "GearContact.h"
+
+// ==============================================================
+// class ElevationCache
+// ==============================================================
+
+ElevationCache::ElevationCache (double _spacing)
+{
+	hPlanet = NULL;
+	func = NULL;
+	context = NULL;
+	rad = 1.0;
+	spacing = _spacing;
+	dang = spacing/rad;
+	Flush();
+}
+
+// --------------------------------------------------------------
+
+void ElevationCache::SetPlanet (OBJHANDLE _hPlanet)
+{
+	if (_hPlanet != hPlanet || func) {
+		hPlanet = _hPlanet;
+		func = NULL;
+		rad = oapiGetSize (hPlanet);
+		dang = spacing/rad;
+		Flush();
+	}
+}
+
+// --------------------------------------------------------------
+
+void ElevationCache::SetSource (ElevFunc _func, void *_context, double radius)
+{
+	func = _func;
+	context = _context;
+	rad = radius;
+	dang = spacing/rad;
+	Flush();
+}
+
+// --------------------------------------------------------------
+
+void ElevationCache::Flush ()
+{
+	for (int i = 0; i < EC_NSLOT; i++) {
+		slot[i].valid = false;
+		slot[i].used = 0;
+	}
+	nused = 0;
+}
+
+// --------------------------------------------------------------
+
+double ElevationCache::Node (int ilng, int ilat, int &nquery)
+{
+	const DWORD nset = EC_NSLOT/EC_NWAY;
+	DWORD h = ((DWORD)ilng*73856093u ^ (DWORD)ilat*19349663u) * 2654435761u;
+	Slot *set = slot + (h >> 16) % nset * EC_NWAY;
+	int i, lru = 0;
+	for (i = 0; i < EC_NWAY; i++) {
+		Slot &s = set[i];
+		if (s.valid && s.ilng == ilng && s.ilat == ilat) {
+			s.used = nused;
+			return s.elev;
+		}
+		if (set[i].used < set[lru].used || !set[i].valid) lru = i;
+	}
+	Slot &s = set[lru];
+	double lng = ilng*dang, lat = ilat*dang;
+	s.elev = (func ? func (context, lng, lat) : hPlanet ? oapiSurfaceElevation (hPlanet, lng, lat) : 0.0);
+	s.ilng = ilng;
+	s.ilat = ilat;
+	s.used = nused;
+	s.valid = true;
+	nquery++;
+	return s.elev;
+}
+
+// --------------------------------------------------------------
+
+int ElevationCache::Query (int n, const double *lng, const double *lat, double *elev, VECTOR3 *slope)
+{
+	int nquery = 0;
+	nused++;
+	for (int i = 0; i < n; i++) {
+		double u = lng[i]/dang, w = lat[i]/dang;
+		int i0 = (int)floor(u), j0 = (int)floor(w);
+		double fu = u-i0, fw = w-j0;
+		double e00 = Node (i0,   j0,   nquery);
+		double e10 = Node (i0+1, j0,   nquery);
+		double e01 = Node (i0,   j0+1, nquery);
+		double e11 = Node (i0+1, j0+1, nquery);
+		elev[i] = (e00*(1.0-fu) + e10*fu)*(1.0-fw) + (e01*(1.0-fu) + e11*fu)*fw;
+		if (slope) {
+			double d = dang*rad;
+			slope[i].x = ((e10-e00)*(1.0-fw) + (e11-e01)*fw)/(d*max(cos(lat[i]), 1e-3));
+			slope[i].y = 0.0;
+			slope[i].z = ((e01-e00)*(1.0-fu) + (e11-e10)*fu)/d;
+		}
+	}
+	return nquery;
+}
+
+// ==============================================================
+// class GearContact
+// ==============================================================
+
+GearContact::GearContact ()
+{
+	vmin = 0.2;
+	vmax = 1.0;
+}
+
+// --------------------------------------------------------------
+
+int GearContact::AddStrut (const VECTOR3 &pos, double stroke, double stiffness, double damping,
+	double mu_lat, double mu_lng, double mu_roll, double brakeforce, int brake)
+{
+	Strut s;
+	s.pos = pos;
+	s.stroke = stroke;
+	s.k = stiffness;
+	s.c = damping;
+	s.mu_lat = mu_lat;
+	s.mu_lng = mu_lng;
+	s.mu_roll = mu_roll;
+	s.brakeforce = brakeforce;
+	s.brake = brake;
+	s.steer = 0.0;
+	s.x = s.load = 0.0;
+	strut.push_back (s);
+
+	size_t n = strut.size();
+	wlng.resize (n);  wlat.resize (n);  welev.resize (n);
+	wslope.resize (n); wpos.resize (n);  wF.resize (n);  wr.resize (n);
+	return (int)n-1;
+}
+
+// --------------------------------------------------------------
+
+void GearContact::SetSteering (int i, double angle)
+{
+	strut[i].steer = angle;
+}
+
+// --------------------------------------------------------------
+
+void GearContact::SetHandover (double _vmin, double _vmax)
+{
+	vmin = _vmin;
+	vmax = max (_vmax, _vmin+1e-3);
+}
+
+// --------------------------------------------------------------
+
+bool GearContact::Update (VESSEL *v, double simdt)
+{
+	size_t i, n = strut.size();
+	bool contact = false;
+
+	// landed vessels and vessels well above ground are left alone
+	if ((v->GetFlightStatus() & 1) || v->GetAltitude (ALTMODE_GROUND) > v->GetSize()) {
+		for (i = 0; i < n; i++) strut[i].x = strut[i].load = 0.0;
+		return false;
+	}
+
+	double lng, lat, rad;
+	OBJHANDLE hRef = v->GetEquPos (lng, lat, rad);
+	if (!hRef) return false;
+	elev.SetPlanet (hRef);
+
+	// rotation vessel frame -> local horizon frame
+	VECTOR3 cx, cy, cz;
+	v->HorizonRot (_V(1,0,0), cx);
+	v->HorizonRot (_V(0,1,0), cy);
+	v->HorizonRot (_V(0,0,1), cz);
+	MATRIX3 R = _M(cx.x, cy.x, cz.x,  cx.y, cy.y, cz.y,  cx.z, cy.z, cz.z);
+
+	VECTOR3 vel, avel, pmi;
+	v->GetGroundspeedVector (FRAME_HORIZON, vel);
+	v->GetAngularVel (avel);
+	v->GetPMI (pmi);
+	double brake[2] = {v->GetWheelbrakeLevel (1), v->GetWheelbrakeLevel (2)};
+
+	if (Evaluate (rad-elev.Radius(), lng, lat, R, vel, avel, v->GetMass(), pmi, simdt, brake, &wF[0], &wr[0])) {
+		for (i = 0; i < n; i++)
+			if (strut[i].load > 0.0)
+				v->AddForce (tmul (R, wF[i]), wr[i]);
+		contact = true;
+	}
+	return contact;
+}
+
+// --------------------------------------------------------------
+
+int GearContact::Evaluate (double alt, double lng, double lat, const MATRIX3 &R, const VECTOR3 &vel,
+	const VECTOR3 &avel, double mass, const VECTOR3 &pmi, double simdt, const double *brake, VECTOR3 *F, VECTOR3 *r)
+{
+	static const double vslip = 0.1; // slip speed for full friction [m/s]
+	int i, n = (int)strut.size(), ncontact = 0;
+
+	for (i = 0; i < n; i++) {
+		strut[i].x = strut[i].load = 0.0;
+		F[i] = _V(0,0,0);
+		r[i] = strut[i].pos;
+	}
+
+	// hand over to the touchdown points at low ground speed
+	double f = (length(vel)-vmin)/(vmax-vmin);
+	if (f <= 0.0 || !n) return 0;
+	if (f > 1.0) f = 1.0;
+
+	// one batched elevation lookup for all wheels
+	double R0 = elev.Radius()+alt;
+	double clat = max (cos(lat), 1e-3);
+	for (i = 0; i < n; i++) {
+		wpos[i] = mul (R, strut[i].pos);
+		wlng[i] = lng + wpos[i].x/(R0*clat);
+		wlat[i] = lat + wpos[i].z/R0;
+	}
+	elev.Query (n, &wlng[0], &wlat[0], &welev[0], &wslope[0]);
+
+	for (i = 0; i < n; i++) {
+		Strut &s = strut[i];
+		double h = alt + wpos[i].y - welev[i];
+		VECTOR3 nml = unit (_V(-wslope[i].x, 1.0, -wslope[i].z));
+		double d = -h*nml.y;
+		if (d <= 0.0) continue;
+
+		// suspension
+		double x = min (d, s.stroke);
+		VECTOR3 vpt = vel + mul (R, crossp (s.pos, avel));
+		double N = s.k*x - s.c*dotp (vpt, nml);
+		if (N <= 0.0) continue;
+
+		// tyre axes in the ground plane
+		VECTOR3 fwd = mul (R, _V(sin(s.steer), 0, cos(s.steer)));
+		fwd = unit (fwd - nml*dotp (fwd, nml));
+		VECTOR3 side = crossp (nml, fwd);
+		double vl = dotp (vpt, fwd);
+		double vt = dotp (vpt, side);
+
+		// regularised Coulomb friction; the slip speed is widened where
+		// needed to keep the explicit step stable
+		double Flat = s.mu_lat*N;
+		double vs = max (vslip, Flat*simdt/MassShare (s.pos, tmul (R, side), mass, pmi, 2*n));
+		Flat *= -max (-1.0, min (1.0, vt/vs));
+		double Flng = s.mu_roll*N + (s.brake ? brake[s.brake-1]*s.brakeforce : 0.0);
+		vs = max (vslip, Flng*simdt/MassShare (s.pos, tmul (R, fwd), mass, pmi, 2*n));
+		Flng *= -max (-1.0, min (1.0, vl/vs));
+
+		// friction ellipse
+		double a = Flng/max(s.mu_lng*N, 1e-6), b = Flat/max(s.mu_lat*N, 1e-6);
+		double e = a*a + b*b;
+		if (e > 1.0) {
+			e = 1.0/sqrt(e);
+			Flng *= e, Flat *= e;
+		}
+
+		s.x = x;
+		s.load = N*f;
+		F[i] = (nml*N + fwd*Flng + side*Flat)*f;
+		r[i] = s.pos + _V(0,x,0);
+		ncontact++;
+	}
+	return ncontact;
+}
+
+// --------------------------------------------------------------
+
+double GearContact::MassShare (const VECTOR3 &pos, const VECTOR3 &dir, double mass, const VECTOR3 &pmi, int n)
+{
+	// effective mass of the vessel for a force along dir applied at pos,
+	// including the rotational response
+	VECTOR3 t = crossp (dir, pos);
+	double im = 1.0 + t.x*t.x/pmi.x + t.y*t.y/pmi.y + t.z*t.z/pmi.z;
+	return mass/(im*n);
+}
@@ -0,0 +1,217 @@
+// ==============================================================
+//             ORBITER MODULE: Common vessel tools
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// GearContact.h
+// Interface for classes ElevationCache and GearContact:
+//   Landing gear contact model with per-strut spring-damper
+//   suspension, tyre friction ellipses and wheel brakes, using
+//   cached surface elevation queries
+// ==============================================================
+
+#ifndef __GEARCONTACT_H
+#define __GEARCONTACT_H
+
+#include "Orbitersdk.h"
+#include <vector>
+
+#define EC_NSLOT 256   // number of elevation cache slots (power of 2)
+#define EC_NWAY  4     // slots per cache set
+
+// ==============================================================
+// Cache of surface elevation samples on a regular lng/lat grid.
+// Lookups for a batch of points are resolved by bilinear
+// interpolation between grid nodes; a node is queried from the
+// elevation source only once and reused while it stays in the
+// cache, so vessels that stand or roll slowly cause few queries.
+// The cache is set-associative (EC_NWAY slots per set, least
+// recently used slot replaced), so that the few nodes around a
+// vessel's wheels do not evict each other.
+// ==============================================================
+
+class ElevationCache {
+public:
+	/**
+	 * \brief Elevation source callback.
+	 * \param context user context, as passed to SetSource
+	 * \param lng longitude [rad]
+	 * \param lat latitude [rad]
+	 * \return elevation above mean radius [m]
+	 */
+	typedef double (*ElevFunc)(void *context, double lng, double lat);
+
+	/**
+	 * \brief Create a cache.
+	 * \param spacing grid node spacing at the equator [m]
+	 */
+	ElevationCache (double spacing = 5.0);
+
+	/**
+	 * \brief Select the planet to sample with oapiSurfaceElevation.
+	 * \note Flushes the cache if the planet changes.
+	 */
+	void SetPlanet (OBJHANDLE hPlanet);
+
+	/**
+	 * \brief Use a custom elevation source instead of oapiSurfaceElevation.
+	 * \param func elevation callback, or NULL to revert to oapiSurfaceElevation
+	 * \param context user context passed to func
+	 * \param radius mean radius of the body [m]
+	 * \note Flushes the cache.
+	 */
+	void SetSource (ElevFunc func, void *context, double radius);
+
+	/**
+	 * \brief Discard all cached samples.
+	 */
+	void Flush ();
+
+	/**
+	 * \brief Mean radius of the current body [m].
+	 */
+	inline double Radius () const { return rad; }
+
+	/**
+	 * \brief Elevations and slopes for a batch of surface points.
+	 * \param n number of points
+	 * \param lng, lat arrays of n point coordinates [rad]
+	 * \param elev array of n elevations receiving the result [m]
+	 * \param slope array of n slopes receiving the result (x: d(elev)/d(east),
+	 *   z: d(elev)/d(north), y unused), or NULL
+	 * \return number of source queries issued for this batch
+	 */
+	int Query (int n, const double *lng, const double *lat, double *elev, VECTOR3 *slope = NULL);
+
+private:
+	double Node (int ilng, int ilat, int &nquery);
+
+	struct Slot {
+		int ilng, ilat;  // grid node indices
+		double elev;     // elevation sample
+		DWORD used;      // query counter at last use
+		bool valid;
+	} slot[EC_NSLOT];
+	DWORD nused;         // query counter
+
+	OBJHANDLE hPlanet;   // planet for oapiSurfaceElevation
+	ElevFunc func;       // custom source, or NULL
+	void *context;       // custom source context
+	double rad;          // body mean radius [m]
+	double spacing;      // node spacing [m]
+	double dang;         // node spacing [rad]
+};
+
+// ==============================================================
+// Landing gear contact model. Each strut is a spring-damper along
+// the vessel's y-axis ending in a wheel. Forces are computed in
+// the local horizon frame and applied with VESSEL::AddForce.
+// ==============================================================
+
+class GearContact {
+public:
+	GearContact ();
+
+	/**
+	 * \brief Add a landing gear strut.
+	 * \param pos wheel contact point at full extension (vessel frame) [m]
+	 * \param stroke max. compression [m]
+	 * \param stiffness spring coefficient [N/m]
+	 * \param damping damping coefficient [N s/m]
+	 * \param mu_lat lateral tyre friction coefficient
+	 * \param mu_lng longitudinal tyre friction coefficient (grip limit
+	 *   for braking)
+	 * \param mu_roll rolling resistance coefficient
+	 * \param brakeforce max. brake force at the contact point [N] (brake
+	 *   torque divided by wheel radius)
+	 * \param brake wheel brake index (1=left, 2=right, as used by
+	 *   VESSEL::GetWheelbrakeLevel), or 0 for no brake
+	 * \return strut index
+	 * \note Lateral and longitudinal forces are bounded by the friction
+	 *   ellipse with semi-axes mu_lat*N and mu_lng*N, where N is the strut
+	 *   load.
+	 */
+	int AddStrut (const VECTOR3 &pos, double stroke, double stiffness, double damping,
+		double mu_lat, double mu_lng, double mu_roll, double brakeforce = 0.0, int brake = 0);
+
+	/**
+	 * \brief Set the steering angle of a strut [rad].
+	 * \note Positive angles turn the wheel towards +x.
+	 */
+	void SetSteering (int strut, double angle);
+
+	/**
+	 * \brief Set the ground speed range over which the model hands over
+	 *   to the vessel's touchdown points.
+	 * \param vmin below this ground speed [m/s] no strut forces are applied
+	 * \param vmax above this ground speed [m/s] full strut forces are applied
+	 * \note Vessels at rest should sit on their touchdown points, so that
+	 *   Orbiter can put them into the landed state.
+	 */
+	void SetHandover (double vmin, double vmax);
+
+	/**
+	 * \brief Elevation cache used by the model.
+	 * \note Can be given a custom elevation source for headless use.
+	 */
+	inline ElevationCache &Elevation () { return elev; }
+
+	/**
+	 * \brief Compute the strut forces for the current vessel state and
+	 *   apply them to the vessel.
+	 * \param v vessel instance
+	 * \param simdt time step [s]
+	 * \return true if any wheel is in ground contact
+	 * \note Should be called from clbkPreStep.
+	 * \note Does nothing for landed vessels.
+	 */
+	bool Update (VESSEL *v, double simdt);
+
+	/**
+	 * \brief Strut forces for a given state, without a vessel.
+	 * \param alt altitude of the vessel origin above mean radius [m]
+	 * \param lng, lat vessel position [rad]
+	 * \param R rotation from vessel frame to local horizon frame
+	 * \param vel vessel velocity in local horizon frame [m/s]
+	 * \param avel angular velocity in vessel frame [rad/s]
+	 * \param mass vessel mass [kg]
+	 * \param pmi principal moments of inertia, mass-normalised [m^2]
+	 * \param simdt time step [s]
+	 * \param brake wheel brake levels (left, right)
+	 * \param F array of strut forces receiving the result (horizon frame) [N]
+	 * \param r array of force attack points receiving the result (vessel frame) [m]
+	 * \return number of struts in ground contact
+	 * \note Used by Update; also allows running the model on a synthetic
+	 *   elevation source.
+	 */
+	int Evaluate (double alt, double lng, double lat, const MATRIX3 &R, const VECTOR3 &vel,
+		const VECTOR3 &avel, double mass, const VECTOR3 &pmi, double simdt, const double *brake, VECTOR3 *F, VECTOR3 *r);
+
+	inline int Count () const { return (int)strut.size(); }
+	inline double Compression (int i) const { return strut[i].x; }  // current strut compression [m]
+	inline double Load (int i) const { return strut[i].load; }      // current strut normal load [N]
+
+private:
+	// share of the vessel's effective mass for a wheel force along dir
+	// (vessel frame) at pos, split between n friction directions; sizes
+	// the friction slip speed
+	static double MassShare (const VECTOR3 &pos, const VECTOR3 &dir, double mass, const VECTOR3 &pmi, int n);
+
+	struct Strut {
+		VECTOR3 pos;                  // wheel contact point at full extension
+		double stroke, k, c;          // suspension
+		double mu_lat, mu_lng, mu_roll; // tyre friction
+		double brakeforce;            // max. brake force
+		int brake;                    // wheel brake index
+		double steer;                 // steering angle
+		double x, load;               // current compression and load
+	};
+	std::vector<Strut> strut;
+	ElevationCache elev;
+	double vmin, vmax;                // handover range
+	std::vector<double> wlng, wlat, welev; // work buffers
+	std::vector<VECTOR3> wslope, wpos, wF, wr;
+};
+
+#endif // !__GEARCONTACT_H
@@ -0,0 +1,311 @@
+// ==============================================================
+//             ORBITER MODULE: Common vessel tools
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// GimbalTrim.cpp
+// Implementation for class GimbalTrim:
+//   Computes pitch/yaw gimbal deflections for a cluster of engines
+//   so that the net thrust moment about the centre of gravity
+//   matches a commanded torque
+// ==============================================================
+
+#include "GimbalTrim.h"
+
+static const int GT_MAXVAR = GT_MAXGROUP*2;
+
+// ==============================================================
+// Minimise 1/2 d^T H d - g^T d subject to lo <= d <= hi, for a positive
+// definite H (primal active set method, starting from the feasible
+// point d = 0). Returns the number of iterations.
+
+static int BoxSolve (int m, double H[GT_MAXVAR][GT_MAXVAR], const double *g,
+	const double *lo, const double *hi, double *d)
+{
+	int i, j, k, n, iter;
+	int bound[GT_MAXVAR];  // 0=free, -1=held at lo, +1=held at hi
+	int idx[GT_MAXVAR];
+	double L[GT_MAXVAR][GT_MAXVAR], y[GT_MAXVAR];
+	double eps = 0.0;
+
+	for (i = 0; i < m; i++) {
+		d[i] = 0.0;
+		bound[i] = 0;
+		eps = max (eps, H[i][i]);
+	}
+	eps *= 1e-12;
+
+	for (iter = 1; iter <= 4*m+4; iter++) {
+
+		// minimiser over the free settings, with the held ones at their limits
+		for (n = i = 0; i < m; i++)
+			if (!bound[i]) idx[n++] = i;
+		for (j = 0; j < n; j++) {
+			y[j] = g[idx[j]];
+			for (k = 0; k < m; k++)
+				if (bound[k]) y[j] -= H[idx[j]][k]*d[k];
+			for (k = 0; k <= j; k++)
+				L[j][k] = H[idx[j]][idx[k]];
+		}
+		for (j = 0; j < n; j++) {  // Cholesky factorisation and solve
+			for (k = 0; k < j; k++) L[j][j] -= L[j][k]*L[j][k];
+			L[j][j] = sqrt (L[j][j]);
+			for (i = j+1; i < n; i++) {
+				for (k = 0; k < j; k++) L[i][j] -= L[i][k]*L[j][k];
+				L[i][j] /= L[j][j];
+			}
+		}
+		for (j = 0; j < n; j++) {
+			for (k = 0; k < j; k++) y[j] -= L[j][k]*y[k];
+			y[j] /= L[j][j];
+		}
+		for (j = n-1; j >= 0; j--) {
+			for (k = j+1; k < n; k++) y[j] -= L[k][j]*y[k];
+			y[j] /= L[j][j];
+		}
+
+		// step towards the minimiser until the first limit is hit
+		double alpha = 1.0;
+		int blk = -1;
+		for (j = 0; j < n; j++) {
+			i = idx[j];
+			double p = y[j]-d[i];
+			if (y[j] < lo[i] && p < 0.0) {
+				double a = (lo[i]-d[i])/p;
+				if (a < alpha) alpha = a, blk = j;
+			} else if (y[j] > hi[i] && p > 0.0) {
+				double a = (hi[i]-d[i])/p;
+				if (a < alpha) alpha = a, blk = j;
+			}
+		}
+		for (j = 0; j < n; j++)
+			d[idx[j]] += alpha*(y[j]-d[idx[j]]);
+		if (blk >= 0) {
+			i = idx[blk];
+			bound[i] = (y[blk] < lo[i] ? -1 : 1);
+			d[i] = (bound[i] < 0 ? lo[i] : hi[i]);
+			continue;
+		}
+
+		// optimal for the current set of held settings: release the one
+		// with the most strongly violated multiplier, or terminate
+		int rel = -1;
+		double rmax = eps;
+		for (i = 0; i < m; i++) {
+			if (!bound[i]) continue;
+			double r = -g[i];
+			for (k = 0; k < m; k++)
+				r += H[i][k]*d[k];
+			r *= bound[i]; // > 0: cost decreases when moving away from the limit
+			if (r > rmax) rmax = r, rel = i;
+		}
+		if (rel < 0) break;
+		bound[rel] = 0;
+	}
+	return iter;
+}
+
+// ==============================================================
+
+GimbalTrim::GimbalTrim (int nengine, int ngroup)
+{
+	int i;
+	neng = min (nengine, GT_MAXENGINE);
+	ngrp = (ngroup > 0 ? min (ngroup, GT_MAXGROUP) : neng);
+	for (i = 0; i < neng; i++) {
+		pos[i] = _V(0,0,0);
+		thrust[i] = 0.0;
+		grp[i] = min (i, ngrp-1);
+	}
+	for (i = 0; i < ngrp*2; i++) {
+		range[i][0] = -0.1;
+		range[i][1] =  0.1;
+	}
+	axw = _V(1,1,1);
+}
+
+// --------------------------------------------------------------
+
+void GimbalTrim::SetEngine (int engine, const VECTOR3 &p, int group)
+{
+	pos[engine] = p;
+	if (group >= 0) grp[engine] = min (group, ngrp-1);
+}
+
+// --------------------------------------------------------------
+
+void GimbalTrim::SetThrust (int engine, double F)
+{
+	thrust[engine] = F;
+}
+
+// --------------------------------------------------------------
+
+void GimbalTrim::SetRange (int group, double pmin, double pmax, double ymin, double ymax)
+{
+	range[group*2][0]   = pmin;
+	range[group*2][1]   = pmax;
+	range[group*2+1][0] = ymin;
+	range[group*2+1][1] = ymax;
+}
+
+// --------------------------------------------------------------
+
+void GimbalTrim::SetAxisWeight (const VECTOR3 &w)
+{
+	axw = w;
+}
+
+// --------------------------------------------------------------
+
+VECTOR3 GimbalTrim::Torque (const VECTOR3 &cg, const double *ptan, const double *ytan) const
+{
+	VECTOR3 T = {0,0,0};
+	for (int i = 0; i < neng; i++) {
+		if (!thrust[i]) continue;
+		int g = grp[i];
+		VECTOR3 F = _V(ytan[g], ptan[g], 1.0);
+		F *= thrust[i]/length(F);
+		T += crossp (F, pos[i]-cg);
+	}
+	return T;
+}
+
+// --------------------------------------------------------------
+
+bool GimbalTrim::Solve (const VECTOR3 &cg, const VECTOR3 &tcmd, double *ptan, double *ytan) const
+{
+	const int maxiter = 10;
+	int i, j, k, g, iter;
+	int nvar = ngrp*2;
+	double x[GT_MAXVAR], x0[GT_MAXVAR], xt[GT_MAXVAR], scale[GT_MAXVAR];
+	double J[3][GT_MAXVAR];
+	double H[GT_MAXVAR][GT_MAXVAR], b[GT_MAXVAR], lo[GT_MAXVAR], hi[GT_MAXVAR], dz[GT_MAXVAR];
+	double w[3] = {axw.x, axw.y, axw.z};
+	int idx[GT_MAXVAR], m = 0;
+
+	// start from the setting nearest to neutral; settings with an empty
+	// range are not solved for
+	for (k = 0; k < nvar; k++) {
+		x[k] = x0[k] = min (range[k][1], max (range[k][0], 0.0));
+		scale[k] = range[k][1]-range[k][0];
+		if (scale[k] > 0.0) idx[m++] = k;
+	}
+
+	double Fmax = 0.0;
+	for (i = 0; i < neng; i++)
+		Fmax = max (Fmax, thrust[i]);
+
+	double mu = 0.0;  // step damping, relative to the largest curvature
+	if (Fmax > 0.0 && m) {
+		for (iter = 0; iter < maxiter; iter++) {
+
+			// residual and Jacobian of the moment balance, with each
+			// setting normalised by its range
+			double r[3];
+			VECTOR3 T = {0,0,0};
+			for (j = 0; j < 3; j++)
+				for (k = 0; k < nvar; k++) J[j][k] = 0.0;
+			for (i = 0; i < neng; i++) {
+				if (!thrust[i]) continue;
+				g = grp[i];
+				VECTOR3 u = _V(x[g*2+1], x[g*2], 1.0);
+				VECTOR3 rc = pos[i]-cg;
+				double n = length(u);
+				double s = thrust[i]/n;
+				T += crossp (u*s, rc);
+				VECTOR3 dp = crossp ((_V(0,1,0) - u*(u.y/(n*n)))*s, rc);
+				VECTOR3 dy = crossp ((_V(1,0,0) - u*(u.x/(n*n)))*s, rc);
+				J[0][g*2] += dp.x;  J[0][g*2+1] += dy.x;
+				J[1][g*2] += dp.y;  J[1][g*2+1] += dy.y;
+				J[2][g*2] += dp.z;  J[2][g*2+1] += dy.z;
+			}
+			r[0] = tcmd.x-T.x;
+			r[1] = tcmd.y-T.y;
+			r[2] = tcmd.z-T.z;
+
+			// linearised problem in the normalised step dz (dx = scale*dz):
+			// minimise |W (J dx - r)|^2 + lambda |x + dx - x0|^2/scale^2
+			// within the gimbal ranges, where the small regularisation
+			// lambda selects the solution nearest to neutral
+			double dmax = 0.0;
+			for (j = 0; j < m; j++) {
+				for (k = 0; k <= j; k++) {
+					double h = 0.0;
+					for (i = 0; i < 3; i++)
+						h += J[i][idx[j]]*J[i][idx[k]]*w[i]*w[i];
+					H[j][k] = H[k][j] = h*scale[idx[j]]*scale[idx[k]];
+				}
+				double bj = 0.0;
+				for (i = 0; i < 3; i++)
+					bj += J[i][idx[j]]*r[i]*w[i]*w[i];
+				b[j] = bj*scale[idx[j]];
+				dmax = max (dmax, H[j][j]);
+			}
+			if (dmax <= 0.0) break;
+			double lambda = dmax*1e-12;
+			for (j = 0; j < m; j++) {
+				k = idx[j];
+				H[j][j] += lambda + mu*dmax;
+				b[j] -= lambda*(x[k]-x0[k])/scale[k];
+				lo[j] = (range[k][0]-x[k])/scale[k];
+				hi[j] = (range[k][1]-x[k])/scale[k];
+			}
+			BoxSolve (m, H, b, lo, hi, dz);
+
+			// apply the step, shortened until the cost decreases. The
+			// moment of engines in a common plane depends almost linearly
+			// on some combinations of settings, so a full step can jump
+			// across the valley of the cost function. A shortened step
+			// raises the damping mu of the following steps.
+			double c0 = Cost (cg, tcmd, x, x0, scale, lambda), alpha = 1.0, step = 0.0;
+			for (k = 0; k < nvar; k++) xt[k] = x[k];
+			for (i = 0; i < 10; i++, alpha *= 0.5) {
+				for (step = 0.0, j = 0; j < m; j++) {
+					k = idx[j];
+					xt[k] = min (range[k][1], max (range[k][0], x[k] + alpha*dz[j]*scale[k]));
+					step = max (step, alpha*fabs(dz[j]));
+				}
+				if (Cost (cg, tcmd, xt, x0, scale, lambda) <= c0) break;
+			}
+			if (i == 10) break;  // no further decrease
+			mu = (i ? max (mu*10.0, 1e-6) : mu*0.1);
+			for (j = 0; j < m; j++)
+				x[idx[j]] = xt[idx[j]];
+			if (step < 1e-10) break;
+		}
+	}
+
+	for (g = 0; g < ngrp; g++) {
+		ptan[g] = x[g*2];
+		ytan[g] = x[g*2+1];
+	}
+	return Fmax > 0.0;
+}
+
+// --------------------------------------------------------------
+
+double GimbalTrim::Cost (const VECTOR3 &cg, const VECTOR3 &tcmd, const double *x,
+	const double *x0, const double *scale, double lambda) const
+{
+	double pt[GT_MAXGROUP], yt[GT_MAXGROUP], c = 0.0;
+	int g, k;
+	for (g = 0; g < ngrp; g++) {
+		pt[g] = x[g*2];
+		yt[g] = x[g*2+1];
+	}
+	VECTOR3 dT = Torque (cg, pt, yt) - tcmd;
+	dT.x *= axw.x, dT.y *= axw.y, dT.z *= axw.z;
+	for (k = 0; k < ngrp*2; k++)
+		if (scale[k] > 0.0) c += (x[k]-x0[k])*(x[k]-x0[k])/(scale[k]*scale[k]);
+	return dotp (dT, dT) + lambda*c;
+}
+
+// --------------------------------------------------------------
+
+double GimbalTrim::RateLimit (double cur, double tgt, double maxstep)
+{
+	if (cur < tgt) return min (cur+maxstep, tgt);
+	else           return max (cur-maxstep, tgt);
+}
@@ -0,0 +1,117 @@
+// ==============================================================
+//             ORBITER MODULE: Common vessel tools
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// GimbalTrim.h
+// Interface for class GimbalTrim:
+//   Computes pitch/yaw gimbal deflections for a cluster of engines
+//   so that the net thrust moment about the centre of gravity
+//   matches a commanded torque
+// ==============================================================
+
+#ifndef __GIMBALTRIM_H
+#define __GIMBALTRIM_H
+
+#include "Orbitersdk.h"
+
+#define GT_MAXENGINE 8   // max. number of engines per cluster
+#define GT_MAXGROUP  8   // max. number of independently gimballed groups
+
+// ==============================================================
+
+class GimbalTrim {
+public:
+	/**
+	 * \brief Create a trim solver for an engine cluster.
+	 * \param nengine number of engines (<= GT_MAXENGINE)
+	 * \param ngroup number of gimbal groups (<= GT_MAXGROUP). Engines in
+	 *   the same group share their gimbal setting. 0 assigns each engine
+	 *   its own group.
+	 * \note Gimbal settings are expressed as tangents: an engine with
+	 *   pitch setting p and yaw setting y thrusts along (y,p,1)/|(y,p,1)|
+	 *   in vessel coordinates.
+	 */
+	GimbalTrim (int nengine, int ngroup = 0);
+
+	/**
+	 * \brief Define the thrust reference point and group of an engine.
+	 * \param engine engine index
+	 * \param pos thrust reference position in vessel frame [m]
+	 * \param group gimbal group index, or -1 to keep the current one
+	 */
+	void SetEngine (int engine, const VECTOR3 &pos, int group = -1);
+
+	/**
+	 * \brief Set the current thrust magnitude of an engine [N].
+	 */
+	void SetThrust (int engine, double F);
+
+	/**
+	 * \brief Set the gimbal range of a group.
+	 * \param group group index
+	 * \param pmin, pmax pitch range (tan)
+	 * \param ymin, ymax yaw range (tan)
+	 */
+	void SetRange (int group, double pmin, double pmax, double ymin, double ymax);
+
+	/**
+	 * \brief Set the weights of the torque residual components.
+	 * \note Default is (1,1,1). A zero component leaves the torque
+	 *   around that axis unconstrained.
+	 */
+	void SetAxisWeight (const VECTOR3 &w);
+
+	/**
+	 * \brief Net thrust moment of the cluster about a reference point.
+	 * \param cg reference point in vessel frame [m]
+	 * \param ptan, ytan pitch and yaw settings for each group
+	 * \return torque [Nm]
+	 */
+	VECTOR3 Torque (const VECTOR3 &cg, const double *ptan, const double *ytan) const;
+
+	/**
+	 * \brief Compute the gimbal settings that produce a commanded torque.
+	 * \param cg centre of gravity in vessel frame [m]
+	 * \param tcmd commanded torque about cg [Nm]
+	 * \param ptan, ytan arrays of ngroup entries receiving the pitch and
+	 *   yaw settings
+	 * \return false if the cluster produces no thrust (settings are then
+	 *   the ones nearest to neutral)
+	 * \note The settings are the minimum-norm solution (relative to the
+	 *   gimbal ranges) of the moment balance, found by a few Gauss-Newton
+	 *   steps. Each step solves the linearised balance subject to the
+	 *   gimbal ranges (active set method), so a setting held at a range
+	 *   limit is released again when the balance no longer requires it.
+	 *   If the commanded torque is out of range, the result minimises the
+	 *   weighted torque residual.
+	 */
+	bool Solve (const VECTOR3 &cg, const VECTOR3 &tcmd, double *ptan, double *ytan) const;
+
+	/**
+	 * \brief Move a gimbal setting towards its target at a limited rate.
+	 * \param cur current setting
+	 * \param tgt target setting
+	 * \param maxstep max. change in this step
+	 * \return new setting
+	 */
+	static double RateLimit (double cur, double tgt, double maxstep);
+
+private:
+	/**
+	 * \brief Cost function of Solve: squared weighted torque residual
+	 *   plus the regularisation term, for interleaved settings x.
+	 */
+	double Cost (const VECTOR3 &cg, const VECTOR3 &tcmd, const double *x,
+		const double *x0, const double *scale, double lambda) const;
+
+	int neng, ngrp;
+	VECTOR3 pos[GT_MAXENGINE];       // thrust reference positions
+	double thrust[GT_MAXENGINE];     // current thrust magnitudes
+	int grp[GT_MAXENGINE];           // gimbal group of each engine
+	double range[GT_MAXGROUP*2][2];  // min/max of each setting (pitch, yaw interleaved)
+	VECTOR3 axw;                     // torque residual weights
+};
+
+#endif // !__GIMBALTRIM_H
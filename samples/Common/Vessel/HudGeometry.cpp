@@ -0,0 +1,97 @@
+// ==============================================================
+//             ORBITER MODULE: Common vessel tools
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// HudGeometry.cpp
+// Implementation for class HUDGeometry:
+//   Retained mesh for vessel-specific HUD markers rendered in
+//   clbkRenderHUD
+// ==============================================================
+
+#include "HudGeometry.h"
+
+// ==============================================================
+
+HUDGeometry::HUDGeometry ()
+{
+	hMesh = NULL;
+	frame_cx = frame_cy = frame_unit = 0.0f;
+	frame_mask = 0;
+}
+
+// --------------------------------------------------------------
+
+HUDGeometry::~HUDGeometry ()
+{
+	if (hMesh) oapiDeleteMesh (hMesh);
+}
+
+// --------------------------------------------------------------
+
+int HUDGeometry::AddElement (const NTVERTEX *vtx, DWORD nvtx, const WORD *idx, DWORD nidx, float scale)
+{
+	if (elem.size() >= 32 || vtx0.size()+nvtx > 65536) return -1;
+
+	if (hMesh) {
+		oapiDeleteMesh (hMesh);
+		hMesh = NULL;
+	}
+
+	Element e = {(DWORD)vtx0.size(), nvtx, (DWORD)idx0.size(), nidx};
+	DWORD i;
+	for (i = 0; i < nvtx; i++) {
+		NTVERTEX v;
+		memset (&v, 0, sizeof(NTVERTEX));
+		v.x = vtx[i].x*scale;
+		v.y = vtx[i].y*scale;
+		v.tu = vtx[i].tu;
+		v.tv = vtx[i].tv;
+		vtx0.push_back (v);
+	}
+	for (i = 0; i < nidx; i++)
+		idx0.push_back ((WORD)(idx[i]+e.vofs));
+	elem.push_back (e);
+	return (int)elem.size()-1;
+}
+
+// --------------------------------------------------------------
+
+void HUDGeometry::Render (float cx, float cy, float unit, DWORD mask, SURFHANDLE *hTex)
+{
+	DWORD i, j, nidx;
+	MESHGROUP *grp;
+
+	if (!hMesh) {
+		if (!vtx0.size()) return;
+		MESHGROUP g = {&vtx0[0], &idx0[0], (DWORD)vtx0.size(), (DWORD)idx0.size(), 0, 0, 0, 0, 0};
+		hMesh = oapiCreateMesh (1, &g);
+		frame_unit = 0.0f;     // force vertex update
+		frame_mask = ~mask;    // force index update
+	}
+	grp = oapiMeshGroup (hMesh, 0);
+
+	if (cx != frame_cx || cy != frame_cy || unit != frame_unit) {
+		for (i = 0; i < grp->nVtx; i++) {
+			grp->Vtx[i].x = cx + vtx0[i].x*unit;
+			grp->Vtx[i].y = cy + vtx0[i].y*unit;
+		}
+		frame_cx = cx, frame_cy = cy, frame_unit = unit;
+	}
+
+	if (mask != frame_mask) {
+		for (i = nidx = 0; i < elem.size(); i++) {
+			if (mask & (1 << i)) {
+				const Element &e = elem[i];
+				for (j = 0; j < e.nidx; j++)
+					grp->Idx[nidx++] = idx0[e.iofs+j];
+			}
+		}
+		grp->nIdx = nidx;
+		frame_mask = mask;
+	}
+
+	if (grp->nIdx)
+		oapiRenderHUD (hMesh, hTex);
+}
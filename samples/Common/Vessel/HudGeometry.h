@@ -0,0 +1,67 @@
+// ==============================================================
+//             ORBITER MODULE: Common vessel tools
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// HudGeometry.h
+// Interface for class HUDGeometry:
+//   Retained mesh for vessel-specific HUD markers rendered in
+//   clbkRenderHUD
+// ==============================================================
+
+#ifndef __HUDGEOMETRY_H
+#define __HUDGEOMETRY_H
+
+#include "Orbitersdk.h"
+#include <vector>
+
+// ==============================================================
+
+class HUDGeometry {
+public:
+	HUDGeometry ();
+	~HUDGeometry ();
+
+	/**
+	 * \brief Add a HUD element.
+	 * \param vtx element vertices. x and y are offsets from the HUD centre
+	 *   in units of the scale passed to \ref Render. tu and tv are the
+	 *   HUD texture coordinates. The other vertex members are ignored.
+	 * \param nvtx number of vertices
+	 * \param idx element indices (relative to vtx)
+	 * \param nidx number of indices
+	 * \param scale additional scale factor applied to the element offsets
+	 * \return element index (0-31), or -1 on failure
+	 * \note Elements should be added once at initialisation. Each call after
+	 *   the first \ref Render discards the retained mesh.
+	 */
+	int AddElement (const NTVERTEX *vtx, DWORD nvtx, const WORD *idx, DWORD nidx, float scale = 1.0f);
+
+	/**
+	 * \brief Render a subset of the HUD elements.
+	 * \param cx HUD centre x [pixel]
+	 * \param cy HUD centre y [pixel]
+	 * \param unit pixel size of one element offset unit
+	 * \param mask bitmask of visible elements (bit n = element n)
+	 * \param hTex HUD texture
+	 * \note Vertex positions are only recomputed if cx, cy or unit have
+	 *   changed, and the index list is only rebuilt if the mask has changed
+	 *   since the last call.
+	 */
+	void Render (float cx, float cy, float unit, DWORD mask, SURFHANDLE *hTex);
+
+private:
+	struct Element {
+		DWORD vofs, nvtx;  // vertex range in vtx0
+		DWORD iofs, nidx;  // index range in idx0
+	};
+	std::vector<Element> elem;
+	std::vector<NTVERTEX> vtx0;  // element vertices, unit offsets from HUD centre
+	std::vector<WORD> idx0;      // element indices, offset into vtx0
+	MESHHANDLE hMesh;            // retained HUD mesh
+	float frame_cx, frame_cy, frame_unit; // frame of current vertex positions
+	DWORD frame_mask;                     // visibility mask of current index list
+};
+
+#endif // !__HUDGEOMETRY_H
@@ -11,6 +11,7 @@
 
 #include "Instrument.h"
 #include "Orbitersdk.h"
+#include <typeinfo>
 
 PanelElement::PanelElement (VESSEL3 *v)
 {
@@ -139,6 +140,8 @@ AnimState2::AnimState2 ()
 	speed = 0.0;
 	inc_speed =  1.0;
 	dec_speed = -1.0;
+	sched = 0;
+	sid = -1;
 }
 
 // --------------------------------------------------------------
@@ -149,6 +152,8 @@ AnimState2::AnimState2 (double operating_speed, double initial_state)
 	speed = 0.0;
 	inc_speed =  operating_speed;
 	dec_speed = -operating_speed;
+	sched = 0;
+	sid = -1;
 }
 
 // --------------------------------------------------------------
@@ -174,22 +179,27 @@ void AnimState2::SetState (double _state, double _speed)
 		if (speed < 0.0)
 			speed = 0.0;
 	}
+	Wake ();
 }
 
 // --------------------------------------------------------------
 
 void AnimState2::Open ()
 {
-	if (state < 1.0)
+	if (state < 1.0) {
 		speed = inc_speed;
+		Wake ();
+	}
 }
 
 // --------------------------------------------------------------
 
 void AnimState2::Close ()
 {
-	if (state > 0.0)
+	if (state > 0.0) {
 		speed = dec_speed;
+		Wake ();
+	}
 }
 
 // --------------------------------------------------------------
@@ -251,10 +261,39 @@ bool AnimState2::ParseScenarioLine (const char *line, const char *label)
 {
 	if (!_strnicmp (line, label, strlen(label))) {
 		sscanf (line+strlen(label), "%lf%lf", &state, &speed);
+		Wake ();
 		return true;
 	}
 	return false;
 }
+
+// --------------------------------------------------------------
+
+void AnimState2::SaveSnapshot (SnapshotWriter &snp) const
+{
+	snp.Put (state);
+	snp.Put (speed);
+}
+
+// --------------------------------------------------------------
+
+bool AnimState2::LoadSnapshot (SnapshotReader &snp)
+{
+	double s, v;
+	if (!snp.Get (s) || !snp.Get (v)) return false;
+	state = s, speed = v;
+	Wake ();
+	return true;
+}
+
+// --------------------------------------------------------------
+
+void AnimState2::Wake ()
+{
+	// a bound state is advanced by the scheduler while it moves
+	if (sched && speed)
+		sched->WakeBound (sid);
+}
 // ==============================================================
 
 Subsystem::Subsystem (ComponentVessel *v)
@@ -262,6 +301,8 @@ Subsystem::Subsystem (ComponentVessel *v)
 {
 	parent = 0;              // top-level subsystem
 	id = v->next_ssys_id++;  // assign a top-level subsystem id
+	maxstep = 0.0;
+	for (int i = 0; i < PROF_NCALLBACK; i++) profsite[i] = -1;
 }
 
 // --------------------------------------------------------------
@@ -271,6 +312,8 @@ Subsystem::Subsystem (Subsystem *p)
 {
 	vessel = p->vessel;
 	id = p->id;    // inherit the parent id
+	maxstep = 0.0;
+	for (int i = 0; i < PROF_NCALLBACK; i++) profsite[i] = -1;
 }
 
 // --------------------------------------------------------------
@@ -334,18 +377,122 @@ bool Subsystem::clbkParseScenarioLine (const char *line)
 
 // --------------------------------------------------------------
 
+WORD Subsystem::SnapshotVersion () const
+{
+	return 1;
+}
+
+// --------------------------------------------------------------
+
+void Subsystem::clbkSaveSnapshot (SnapshotWriter &snp)
+{
+}
+
+// --------------------------------------------------------------
+
+bool Subsystem::clbkLoadSnapshot (SnapshotReader &snp)
+{
+	return true;
+}
+
+// --------------------------------------------------------------
+
+void Subsystem::SaveSnapshotList (std::vector<Subsystem*> &list, SnapshotWriter &snp)
+{
+	// one section per subsystem, tagged by list position, with the subsystem's
+	// own data in a nested section followed by the sections of its children
+	for (size_t i = 0; i < list.size(); i++) {
+		Subsystem *s = list[i];
+		snp.BeginSection (SNAPSHOT_TAG('S','S',i & 0xFF,i >> 8), s->SnapshotVersion());
+		snp.BeginSection (SNAPSHOT_TAG('D','A','T','A'));
+		s->clbkSaveSnapshot (snp);
+		snp.EndSection ();
+		SaveSnapshotList (s->child, snp);
+		snp.EndSection ();
+	}
+}
+
+// --------------------------------------------------------------
+
+bool Subsystem::LoadSnapshotList (std::vector<Subsystem*> &list, SnapshotReader &snp)
+{
+	bool res = true;
+	WORD version;
+	for (size_t i = 0; i < list.size(); i++) {
+		Subsystem *s = list[i];
+		if (!snp.BeginSection (SNAPSHOT_TAG('S','S',i & 0xFF,i >> 8), version)) {
+			res = false;
+			continue;
+		}
+		if (version == s->SnapshotVersion() && snp.BeginSection (SNAPSHOT_TAG('D','A','T','A'), version)) {
+			if (!s->clbkLoadSnapshot (snp)) res = false;
+			snp.EndSection ();
+		} else res = false;
+		if (!LoadSnapshotList (s->child, snp)) res = false;
+		snp.EndSection ();
+	}
+	return res;
+}
+
+// --------------------------------------------------------------
+
 void Subsystem::clbkPreStep (double simt, double simdt, double mjd)
 {
-	for (std::vector<Subsystem*>::iterator it = child.begin(); it != child.end(); ++it)
+	for (std::vector<Subsystem*>::iterator it = child.begin(); it != child.end(); ++it) {
+		ProfScope ps((*it)->ProfSite (PROF_PRESTEP));
 		(*it)->clbkPreStep (simt, simdt, mjd);
+	}
 }
 
 // --------------------------------------------------------------
 
 void Subsystem::clbkPostStep (double simt, double simdt, double mjd)
 {
-	for (std::vector<Subsystem*>::iterator it = child.begin(); it != child.end(); ++it)
-		(*it)->clbkPostStep (simt, simdt, mjd);
+	PostStepList (child, simt, simdt, mjd);
+}
+
+// --------------------------------------------------------------
+
+bool Subsystem::clbkSteadyState (double simt, double simdt, double mjd)
+{
+	return false;
+}
+
+// --------------------------------------------------------------
+
+void Subsystem::SetStepLimit (double maxdt)
+{
+	maxstep = maxdt;
+}
+
+// --------------------------------------------------------------
+
+void Subsystem::PostStepList (std::vector<Subsystem*> &list, double simt, double simdt, double mjd)
+{
+	for (std::vector<Subsystem*>::iterator it = list.begin(); it != list.end(); ++it) {
+		Subsystem *s = *it;
+		if (s->maxstep > 0.0 && simdt > s->maxstep) {
+			ProfScope ps(s->ProfSite (PROF_STEADYSTATE));
+			if (s->clbkSteadyState (simt, simdt, mjd)) continue;
+		}
+		ProfScope ps(s->ProfSite (PROF_POSTSTEP));
+		s->clbkPostStep (simt, simdt, mjd);
+	}
+}
+
+// --------------------------------------------------------------
+
+int Subsystem::RegisterProfSite (ProfCallback cb)
+{
+	static const char *cbname[PROF_NCALLBACK] = {
+		"clbkPreStep", "clbkPostStep", "clbkSteadyState", "clbkDrawHUD"
+	};
+	const char *cname = typeid(*this).name();
+	if (!strncmp (cname, "class ", 6)) cname += 6;
+	char name[256];
+	_snprintf (name, 255, "%s::%s", cname, cbname[cb]);
+	name[255] = '\0';
+	return (profsite[cb] = Profiler::Site (name));
 }
 
 // --------------------------------------------------------------
@@ -428,6 +575,7 @@ bool Subsystem::clbkDrawHUD (int mode, const HUDPAINTSPEC *hps, oapi::Sketchpad
 {
 	bool b = false;
 	for (std::vector<Subsystem*>::iterator it = child.begin(); it != child.end(); ++it) {
+		ProfScope ps((*it)->ProfSite (PROF_DRAWHUD));
 		bool bi = (*it)->clbkDrawHUD (mode, hps, skp);
 		b = b || bi;
 	}
@@ -480,6 +628,7 @@ ComponentVessel::ComponentVessel (OBJHANDLE hVessel, int fmodel)
 : VESSEL4 (hVessel, fmodel)
 {
 	next_ssys_id = 0;
+	actuators = new ActuatorScheduler (this);
 }
 
 // --------------------------------------------------------------
@@ -490,6 +639,7 @@ ComponentVessel::~ComponentVessel ()
 	for (std::vector<Subsystem*>::iterator it = ssys.begin(); it != ssys.end(); ++it)
 		delete *it;
 
+	delete actuators;
 }
 
 // --------------------------------------------------------------
@@ -523,6 +673,38 @@ bool ComponentVessel::clbkParseScenarioLine (const char *line)
 
 // --------------------------------------------------------------
 
+void ComponentVessel::clbkSaveSnapshot (SnapshotWriter &snp)
+{
+	Subsystem::SaveSnapshotList (ssys, snp);
+}
+
+// --------------------------------------------------------------
+
+bool ComponentVessel::clbkLoadSnapshot (SnapshotReader &snp)
+{
+	return Subsystem::LoadSnapshotList (ssys, snp);
+}
+
+// --------------------------------------------------------------
+
+int ComponentVessel::clbkGeneric (int msgid, int prm, void *context)
+{
+	if (msgid == SNAPSHOT_VMSG) {
+		switch (prm) {
+		case VMSGSDK_QUERY:
+			return VMSGSDK_MAGIC;
+		case SNAPSHOT_SAVE:
+			clbkSaveSnapshot (*(SnapshotWriter*)context);
+			return 1;
+		case SNAPSHOT_LOAD:
+			return (clbkLoadSnapshot (*(SnapshotReader*)context) ? 1 : 0);
+		}
+	}
+	return 0;
+}
+
+// --------------------------------------------------------------
+
 void ComponentVessel::clbkPostCreation ()
 {
 	for (std::vector<Subsystem*>::iterator it = ssys.begin(); it != ssys.end(); ++it)
@@ -535,8 +717,10 @@ bool ComponentVessel::clbkDrawHUD (int mode, const HUDPAINTSPEC *hps, oapi::Sket
 {
 	VESSEL4::clbkDrawHUD (mode, hps, skp); // allow default HUD elements
 
-	for (std::vector<Subsystem*>::iterator it = ssys.begin(); it != ssys.end(); ++it)
+	for (std::vector<Subsystem*>::iterator it = ssys.begin(); it != ssys.end(); ++it) {
+		ProfScope ps((*it)->ProfSite (Subsystem::PROF_DRAWHUD));
 		(*it)->clbkDrawHUD (mode, hps, skp);
+	}
 
 	return true;
 }
@@ -565,16 +749,18 @@ bool ComponentVessel::clbkPlaybackEvent (double simt, double event_t, const char
 
 void ComponentVessel::clbkPreStep (double simt, double simdt, double mjd)
 {
-	for (std::vector<Subsystem*>::iterator it = ssys.begin(); it != ssys.end(); ++it)
+	for (std::vector<Subsystem*>::iterator it = ssys.begin(); it != ssys.end(); ++it) {
+		ProfScope ps((*it)->ProfSite (Subsystem::PROF_PRESTEP));
 		(*it)->clbkPreStep (simt, simdt, mjd);
+	}
 }
 
 // --------------------------------------------------------------
 
 void ComponentVessel::clbkPostStep (double simt, double simdt, double mjd)
 {
-	for (std::vector<Subsystem*>::iterator it = ssys.begin(); it != ssys.end(); ++it)
-		(*it)->clbkPostStep (simt, simdt, mjd);
+	actuators->Step (simdt);
+	Subsystem::PostStepList (ssys, simt, simdt, mjd);
 }
 
 // --------------------------------------------------------------
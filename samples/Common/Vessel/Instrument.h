@@ -16,6 +16,9 @@
 #define __INSTRUMENT_H
 
 #include "Orbitersdk.h"
+#include "Profiler.h"
+#include "Snapshot.h"
+#include "ActuatorSched.h"
 #include <vector>
 
 class VESSEL3;
@@ -92,12 +95,19 @@ public:
 	inline const double *StatePtr() const { return &state; }
 	void SaveState (FILEHANDLE scn, const char *label);
 	bool ParseScenarioLine (const char *line, const char *label);
+	void SaveSnapshot (SnapshotWriter &snp) const;
+	bool LoadSnapshot (SnapshotReader &snp);
 
 private:
+	friend class ActuatorScheduler;
+	void Wake ();
+
 	double state;
 	double speed;
 	double inc_speed;
 	double dec_speed;
+	ActuatorScheduler *sched; // scheduler advancing the state, or 0 (see ActuatorScheduler::AddActuator)
+	int sid;                  // actuator identifier in sched
 };
 
 // ==============================================================
@@ -117,6 +127,8 @@ class ComponentVessel;
  * passes the call on to the appropriate subsystem panel element.
  */
 class Subsystem {
+	friend class ComponentVessel;
+
 public:
 	/**
 	 * \brief Create a new top-level subsystem.
@@ -186,6 +198,35 @@ public:
 	 */
 	virtual bool clbkParseScenarioLine (const char *line);
 
+	/**
+	 * \brief Layout version of the data written by clbkSaveSnapshot.
+	 * \default Returns 1.
+	 * \note Increase the version when the snapshot layout changes. Snapshot data
+	 *   with a different version are not passed to clbkLoadSnapshot.
+	 */
+	virtual WORD SnapshotVersion () const;
+
+	/**
+	 * \brief Subsystem binary snapshot notification
+	 * \param snp snapshot to write to
+	 * \note Allows a subsystem to write its state in binary form. This is optional:
+	 *   subsystems which don't overload it are left unchanged when a snapshot is
+	 *   restored. Child subsystems are written separately and must not be saved here.
+	 * \default Writes nothing.
+	 * \sa ComponentVessel::clbkSaveSnapshot
+	 */
+	virtual void clbkSaveSnapshot (SnapshotWriter &snp);
+
+	/**
+	 * \brief Subsystem binary snapshot restore notification
+	 * \param snp snapshot to read from, positioned at the data written by clbkSaveSnapshot
+	 * \return false if the state could not be restored
+	 * \note Unlike clbkParseScenarioLine, this is called during the simulation and
+	 *   should update any animations and vessel parameters depending on the state.
+	 * \default Returns true.
+	 */
+	virtual bool clbkLoadSnapshot (SnapshotReader &snp);
+
 	/**
 	 * \brief Pre-frame update notification
 	 * \param simt Session logical runtime [s]
@@ -206,6 +247,28 @@ public:
 	 */
 	virtual void clbkPostStep (double simt, double simdt, double mjd);
 
+	/**
+	 * \brief Steady-state replacement for clbkPostStep at long frame intervals
+	 * \param simt Session logical runtime [s]
+	 * \param simdt last step interval [s]
+	 * \param mjd absolute time in MJD format [days]
+	 * \return true if the subsystem supports a steady-state update and has
+	 *   performed it, false otherwise
+	 * \default Returns false.
+	 * \note Called instead of clbkPostStep when the frame interval exceeds the
+	 *   step limit declared with SetStepLimit. If the function returns false,
+	 *   clbkPostStep is called instead.
+	 * \note Implementations should update the subsystem state directly to the
+	 *   value it would settle to over simdt (e.g. by an analytic solution or an
+	 *   equilibrium value), without a stability limit on simdt.
+	 */
+	virtual bool clbkSteadyState (double simt, double simdt, double mjd);
+
+	/**
+	 * \brief Returns the step limit declared with SetStepLimit [s], or 0 if unlimited
+	 */
+	inline double StepLimit() const { return maxstep; }
+
 	/**
 	 * \brief Set up the 2D instrument panel for the subsystem
 	 * \param panelid Panel ID, as passed to VESSEL3::clbkLoadPanel2D
@@ -299,12 +362,52 @@ protected:
 	 */
 	void AddSubsystem (Subsystem *subsys);
 
+	/**
+	 * \brief Declare the largest step interval for which clbkPostStep is stable.
+	 * \param maxdt step limit [s] (0 for unlimited)
+	 * \note When the frame interval exceeds maxdt, the parent calls
+	 *   clbkSteadyState instead of clbkPostStep.
+	 * \note Subsystems are not substepped: their post-step updates sample the
+	 *   vessel state, and thruster levels or forces they set hold for the
+	 *   whole of the next frame. Dynamics which only depend on the subsystem's
+	 *   own state should use an integrator that is stable for any step
+	 *   (see GasNetwork, ThermalNetwork).
+	 * \note Pre-step callbacks set up forces for the coming step and are always
+	 *   called once per frame.
+	 */
+	void SetStepLimit (double maxdt);
+
 private:
+	/**
+	 * \brief Call clbkPostStep, or clbkSteadyState beyond their step limits, for
+	 *   a list of subsystems
+	 */
+	static void PostStepList (std::vector<Subsystem*> &list, double simt, double simdt, double mjd);
+
+	/**
+	 * \brief Write and restore binary snapshots of a list of subsystems and their children
+	 */
+	static void SaveSnapshotList (std::vector<Subsystem*> &list, SnapshotWriter &snp);
+	static bool LoadSnapshotList (std::vector<Subsystem*> &list, SnapshotReader &snp);
+
+	enum ProfCallback { PROF_PRESTEP, PROF_POSTSTEP, PROF_STEADYSTATE, PROF_DRAWHUD, PROF_NCALLBACK };
+
+	/**
+	 * \brief Profiler site for one of the subsystem's callbacks, or -1 if profiling
+	 *   is disabled. Sites are registered on first use as "<class>::<callback>".
+	 */
+	inline int ProfSite (ProfCallback cb)
+	{ return Profiler::Enabled() ? (profsite[cb] >= 0 ? profsite[cb] : RegisterProfSite (cb)) : -1; }
+
+	int RegisterProfSite (ProfCallback cb);
+
 	Subsystem *parent;                  ///< parent systems (0 if top-level system)
 	std::vector<Subsystem*> child;      ///< list of child systems
 	std::vector<PanelElement*> element; ///< list of panel elements
 	ComponentVessel *vessel;            ///< associated vessel object
 	int id;                             ///< subsystem ID
+	double maxstep;                     ///< step limit [s] for clbkPostStep (0=none)
+	int profsite[PROF_NCALLBACK];       ///< profiler sites for the step and HUD callbacks
 };
 
 // ==============================================================
@@ -321,8 +424,33 @@ public:
 	void AddSubsystem (Subsystem *subsys);
 	inline int NumSubsystems() const { return ssys.size(); }
 
+	/**
+	 * \brief Returns the actuator scheduler of the vessel.
+	 * \note Subsystems register their animated actuators here, usually
+	 *   bound to an AnimState2 (see ActuatorScheduler::AddActuator). All
+	 *   moving actuators are advanced in a single pass at the start of
+	 *   clbkPostStep, before the subsystems are called.
+	 */
+	inline ActuatorScheduler *Actuators() { return actuators; }
+
 	void clbkSaveState (FILEHANDLE scn);
 	bool clbkParseScenarioLine (const char *line);
+
+	/**
+	 * \brief Write a binary snapshot of the vessel state.
+	 * \default Writes the snapshots of all subsystems.
+	 * \note Called via clbkGeneric (SNAPSHOT_VMSG). Derived classes with state of
+	 *   their own should call the base class method.
+	 */
+	virtual void clbkSaveSnapshot (SnapshotWriter &snp);
+
+	/**
+	 * \brief Restore a binary snapshot of the vessel state.
+	 * \default Restores the snapshots of all subsystems.
+	 */
+	virtual bool clbkLoadSnapshot (SnapshotReader &snp);
+
+	int clbkGeneric (int msgid, int prm, void *context);
 	void clbkPostCreation ();
 	bool clbkDrawHUD (int mode, const HUDPAINTSPEC *hps, oapi::Sketchpad *skp);
 	void clbkRenderHUD (int mode, const HUDPAINTSPEC *hps, SURFHANDLE hTex);
@@ -341,6 +469,7 @@ public:
 private:
 	std::vector<Subsystem*> ssys;   // list of subsystems
 	int next_ssys_id;               // next subsystem id to be assigned
+	ActuatorScheduler *actuators;   // steps the animated actuators of all subsystems
 };
 
 #endif // !__INSTRUMENT_H
\ No newline at end of file
@@ -0,0 +1,283 @@
+// ==============================================================
+//             ORBITER MODULE: Common vessel tools
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// Profiler.cpp
+// Implementation for class Profiler
+// ==============================================================
+
+#include "Profiler.h"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+// ==============================================================
+// Shared profiler data
+//
+// The data live in a file mapping private to the Orbiter process,
+// which each module maps on first use. This makes them independent
+// of the lifetime of any particular module.
+
+const DWORD PROF_MAGIC = 0x464F5250; // 'PROF'
+
+struct ProfEvent {
+	LONGLONG t0;         // start [counts]
+	LONG dt;             // duration [counts]
+	LONG site;           // site index
+};
+
+struct ProfThread {
+	volatile LONG tid;   // owning thread id (0: slot free)
+	volatile LONG head;  // number of events recorded
+	LONG reserved[2];
+	ProfEvent ev[PROF_RINGSIZE];
+};
+
+struct ProfSite {
+	char name[64];
+};
+
+struct ProfShared {
+	DWORD magic;
+	volatile LONG enabled;
+	volatile LONG nsite;
+	volatile LONG lock;  // site table spin lock
+	LONGLONG freq;       // counter frequency [1/s]
+	ProfSite site[PROF_MAXSITE];
+	ProfThread thread[PROF_MAXTHREAD];
+};
+
+ProfShared *Profiler::shm = 0;
+volatile LONG *Profiler::enabled = 0;
+DWORD Profiler::tls = TLS_OUT_OF_INDEXES;
+
+// Unmaps the shared data when the module is unloaded
+static struct ProfDetach {
+	HANDLE hMap;
+	ProfDetach (): hMap(0) {}
+	~ProfDetach () { if (hMap) CloseHandle (hMap); }
+} g_ProfDetach;
+
+// ==============================================================
+
+bool Profiler::Attach ()
+{
+	if (shm) return true;
+
+	char name[64];
+	sprintf (name, "Local\\OrbiterProfiler.%u", GetCurrentProcessId());
+	HANDLE hMap = CreateFileMapping (INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, sizeof(ProfShared), name);
+	if (!hMap) return false;
+	ProfShared *p = (ProfShared*)MapViewOfFile (hMap, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(ProfShared));
+	if (!p) {
+		CloseHandle (hMap);
+		return false;
+	}
+	if (GetLastError() != ERROR_ALREADY_EXISTS || p->magic != PROF_MAGIC) {
+		LARGE_INTEGER f;
+		QueryPerformanceFrequency (&f);
+		p->freq = f.QuadPart;
+		MemoryBarrier();
+		p->magic = PROF_MAGIC;
+	}
+	tls = TlsAlloc();
+	g_ProfDetach.hMap = hMap;
+	enabled = &p->enabled;
+	shm = p;
+	return true;
+}
+
+// --------------------------------------------------------------
+
+bool Profiler::Poll ()
+{
+	// attach retries are limited to one per second, so a failing
+	// attach doesn't cost a system call per timer
+	static DWORD tnext = 0;
+	DWORD t = GetTickCount();
+	if ((LONG)(t - tnext) < 0) return false;
+	tnext = t + 1000;
+	return Attach() && *enabled != 0;
+}
+
+// --------------------------------------------------------------
+
+int Profiler::Site (const char *name)
+{
+	if (!Attach()) return -1;
+
+	while (InterlockedCompareExchange (&shm->lock, 1, 0))
+		YieldProcessor();
+
+	int i, n = shm->nsite;
+	for (i = 0; i < n; i++)
+		if (!strncmp (shm->site[i].name, name, 63)) break;
+	if (i == n) {
+		if (n < PROF_MAXSITE) {
+			strncpy (shm->site[n].name, name, 63);
+			shm->site[n].name[63] = '\0';
+			MemoryBarrier();
+			shm->nsite = n+1;
+		} else i = -1;
+	}
+	InterlockedExchange (&shm->lock, 0);
+	return i;
+}
+
+// --------------------------------------------------------------
+
+const char *Profiler::SiteName (int site)
+{
+	return (shm && site >= 0 && site < shm->nsite ? shm->site[site].name : "");
+}
+
+// --------------------------------------------------------------
+
+void Profiler::Enable (bool enable)
+{
+	if (Attach())
+		InterlockedExchange (&shm->enabled, enable ? 1 : 0);
+}
+
+// --------------------------------------------------------------
+
+void Profiler::Stop (int site, LONGLONG t0)
+{
+	LARGE_INTEGER t1;
+	QueryPerformanceCounter (&t1);
+
+	// find the ring of the calling thread
+	ProfThread *th = (ProfThread*)TlsGetValue (tls);
+	if (!th) {
+		LONG tid = (LONG)GetCurrentThreadId();
+		for (int i = 0; i < PROF_MAXTHREAD && !th; i++) {
+			if (shm->thread[i].tid == tid ||
+				InterlockedCompareExchange (&shm->thread[i].tid, tid, 0) == 0)
+				th = shm->thread+i;
+		}
+		if (!th) return; // no free slot: drop the event
+		TlsSetValue (tls, th);
+	}
+
+	// single writer per ring: no interlocked operation required
+	LONG h = th->head;
+	ProfEvent &ev = th->ev[h & (PROF_RINGSIZE-1)];
+	ev.t0 = t0;
+	ev.dt = (LONG)(t1.QuadPart - t0);
+	ev.site = site;
+	MemoryBarrier();
+	th->head = h+1;
+}
+
+// --------------------------------------------------------------
+
+void Profiler::Snapshot (std::vector<Record> &rec, double window)
+{
+	rec.clear();
+	if (!shm) return;
+	LARGE_INTEGER now;
+	QueryPerformanceCounter (&now);
+	LONGLONG tmin = now.QuadPart - (LONGLONG)(window*shm->freq);
+
+	for (int i = 0; i < PROF_MAXTHREAD; i++) {
+		ProfThread *th = shm->thread+i;
+		if (!th->tid) continue;
+		LONG h = th->head;
+		MemoryBarrier();
+		LONG n = min (h, PROF_RINGSIZE);
+		size_t r0 = rec.size();
+		for (LONG j = h-n; j < h; j++) {
+			const ProfEvent &ev = th->ev[j & (PROF_RINGSIZE-1)];
+			Record r = {ev.t0, ev.dt, ev.site, (DWORD)th->tid};
+			rec.push_back (r);
+		}
+		// discard events the writer may have overwritten during the copy,
+		// including the slot it may be writing to (index h2)
+		MemoryBarrier();
+		LONG h2 = th->head;
+		LONG lost = max (0, h2 - PROF_RINGSIZE + 1 - (h-n));
+		if (lost) rec.erase (rec.begin()+r0, rec.begin()+r0+min (lost, n));
+
+		// discard events outside the sample window
+		size_t k = r0;
+		for (size_t j = r0; j < rec.size(); j++)
+			if (rec[j].t0 >= tmin && rec[j].site >= 0 && rec[j].site < shm->nsite)
+				rec[k++] = rec[j];
+		rec.resize (k);
+	}
+}
+
+// --------------------------------------------------------------
+
+static bool ProfStatsCmp (const ProfStats &a, const ProfStats &b)
+{
+	return a.total > b.total;
+}
+
+void Profiler::Collect (std::vector<ProfStats> &stats, double window)
+{
+	std::vector<Record> rec;
+	Snapshot (rec, window);
+	stats.clear();
+	if (rec.empty()) return;
+
+	// durations per site
+	int nsite = shm->nsite;
+	std::vector< std::vector<float> > dt (nsite);
+	double scale = 1e3/(double)shm->freq;
+	for (size_t i = 0; i < rec.size(); i++)
+		dt[rec[i].site].push_back ((float)(rec[i].dt*scale));
+
+	for (int s = 0; s < nsite; s++) {
+		std::vector<float> &d = dt[s];
+		size_t n = d.size();
+		if (!n) continue;
+		std::sort (d.begin(), d.end());
+		ProfStats st;
+		st.site = s;
+		st.count = (DWORD)n;
+		st.total = 0.0;
+		for (size_t i = 0; i < n; i++) st.total += d[i];
+		st.mean = st.total/n;
+		st.p50 = d[(n-1)*50/100];
+		st.p95 = d[(n-1)*95/100];
+		st.p99 = d[(n-1)*99/100];
+		st.max = d[n-1];
+		stats.push_back (st);
+	}
+	std::sort (stats.begin(), stats.end(), ProfStatsCmp);
+}
+
+// --------------------------------------------------------------
+
+int Profiler::ExportTrace (const char *fname, double window)
+{
+	std::vector<Record> rec;
+	Snapshot (rec, window);
+	FILE *f = fopen (fname, "wt");
+	if (!f) return -1;
+
+	LONGLONG tbase = (rec.size() ? rec[0].t0 : 0);
+	for (size_t i = 1; i < rec.size(); i++)
+		if (rec[i].t0 < tbase) tbase = rec[i].t0;
+	double scale = 1e6/(double)shm->freq; // trace times are in microseconds
+	DWORD pid = GetCurrentProcessId();
+
+	fprintf (f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	for (size_t i = 0; i < rec.size(); i++) {
+		char name[128], *c = name;
+		for (const char *s = shm->site[rec[i].site].name; *s && c < name+126; s++) {
+			if (*s == '"' || *s == '\\') *c++ = '\\';
+			*c++ = *s;
+		}
+		*c = '\0';
+		fprintf (f, "{\"name\":\"%s\",\"cat\":\"orbiter\",\"ph\":\"X\",\"pid\":%u,\"tid\":%u,\"ts\":%0.3f,\"dur\":%0.3f}%s\n",
+			name, pid, rec[i].tid, (rec[i].t0-tbase)*scale, rec[i].dt*scale,
+			i+1 < rec.size() ? "," : "");
+	}
+	fprintf (f, "]}\n");
+	fclose (f);
+	return (int)rec.size();
+}
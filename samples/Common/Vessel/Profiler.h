@@ -0,0 +1,148 @@
+// ==============================================================
+//             ORBITER MODULE: Common vessel tools
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// Profiler.h
+// Interface for class Profiler:
+//   Frame profiler for module callbacks. Code sections are timed with
+//   scoped timers (PROF_SCOPE) and recorded into per-thread event
+//   rings. All modules of the Orbiter process share the same site
+//   table and event rings, so that a single tool (e.g. the Framerate
+//   module's profiler dialog) can report percentiles per callback site
+//   and export Chrome trace files (chrome://tracing) for all of them.
+//   While profiling is disabled, a timer costs a single flag test.
+//   Defining PROFILER_OFF removes the timers at compile time.
+// ==============================================================
+
+#ifndef __PROFILER_H
+#define __PROFILER_H
+
+#include <windows.h>
+#include <vector>
+
+const int PROF_MAXSITE   = 512;     // max. number of timer sites
+const int PROF_MAXTHREAD = 8;       // max. number of profiled threads
+const int PROF_RINGSIZE  = 0x8000;  // events per thread (power of 2)
+
+struct ProfShared;
+
+/**
+ * \brief Timing statistics for a timer site. Times are in milliseconds.
+ */
+struct ProfStats {
+	int site;       ///< site index
+	DWORD count;    ///< number of events in the sample window
+	double total;   ///< total time
+	double mean;    ///< mean time per event
+	double p50, p95, p99;  ///< percentiles
+	double max;     ///< max. time per event
+};
+
+// ==============================================================
+
+class Profiler {
+	friend class ProfScope;
+
+public:
+	/**
+	 * \brief Register a timer site, or look up an existing one.
+	 * \param name site name, e.g. "DeltaGlider::clbkPostStep"
+	 * \return site index, or -1 if the site table is full
+	 */
+	static int Site (const char *name);
+
+	/**
+	 * \brief Returns the name of a site.
+	 */
+	static const char *SiteName (int site);
+
+	/**
+	 * \brief Start or stop recording events in all modules.
+	 */
+	static void Enable (bool enable);
+
+	/**
+	 * \brief Returns true while events are being recorded.
+	 * \note A module which has not yet registered any site attaches to the
+	 *   shared data here, so that timers in modules without PROF_SCOPE
+	 *   sites (e.g. subsystem timers) pick up Enable calls from other modules.
+	 */
+#ifdef PROFILER_OFF
+	static inline bool Enabled () { return false; }
+#else
+	static inline bool Enabled () { return shm ? *enabled != 0 : Poll(); }
+#endif
+
+	/**
+	 * \brief Statistics per site for the recent events of all threads.
+	 * \param stats list of sites with events, sorted by total time
+	 * \param window sample window length [s]
+	 * \note Only events still held in the per-thread rings are included.
+	 */
+	static void Collect (std::vector<ProfStats> &stats, double window);
+
+	/**
+	 * \brief Write the recent events of all threads to a Chrome trace
+	 *   (JSON) file.
+	 * \param fname file name
+	 * \param window time window [s]
+	 * \return number of events written, or -1 on error
+	 */
+	static int ExportTrace (const char *fname, double window);
+
+private:
+	struct Record {
+		LONGLONG t0;   // start [counts]
+		LONG dt;       // duration [counts]
+		int site;
+		DWORD tid;     // thread id
+	};
+	static bool Attach ();
+	static bool Poll ();
+	static void Stop (int site, LONGLONG t0);
+	static void Snapshot (std::vector<Record> &rec, double window);
+
+	static ProfShared *shm;       // shared profiler data
+	static volatile LONG *enabled;
+	static DWORD tls;             // TLS index for the thread slot of this module
+};
+
+// ==============================================================
+
+/**
+ * \brief Scoped timer. Records the time between construction and
+ *   destruction for a site, if profiling is enabled.
+ */
+class ProfScope {
+public:
+	inline ProfScope (int site) {
+		if (site >= 0 && Profiler::Enabled()) {
+			s = site;
+			LARGE_INTEGER t;
+			QueryPerformanceCounter (&t);
+			t0 = t.QuadPart;
+		} else s = -1;
+	}
+	inline ~ProfScope () { if (s >= 0) Profiler::Stop (s, t0); }
+
+private:
+	int s;
+	LONGLONG t0;
+};
+
+/**
+ * \brief Time the rest of the enclosing block as a named site.
+ */
+#ifdef PROFILER_OFF
+#define PROF_SCOPE(name)
+#else
+#define PROF_CONCAT2(a,b) a##b
+#define PROF_CONCAT(a,b) PROF_CONCAT2(a,b)
+#define PROF_SCOPE(name) \
+	static int PROF_CONCAT(prof_site_,__LINE__) = Profiler::Site (name); \
+	ProfScope PROF_CONCAT(prof_scope_,__LINE__) (PROF_CONCAT(prof_site_,__LINE__))
+#endif
+
+#endif // !__PROFILER_H
@@ -0,0 +1,351 @@
+// ==============================================================
+//             ORBITER MODULE: Common vessel tools
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// Quat.h
+// Header-only double precision quaternion and dual quaternion
+// classes, for composing attitudes and rigid transforms without
+// repeated 3x3 matrix products and re-orthonormalisation.
+//
+// Conventions follow the Orbiter API: mul(q,v) maps a vector from
+// the local into the parent frame, like mul(R,v) for the rotation
+// matrix R = QuatToMatrix(q), and tmul(q,v) applies the inverse.
+// q1*q2 corresponds to the matrix product R1*R2. Rotation vectors
+// (QuatExp, QuatLog) rotate in the same sense as MGROUP_ROTATE.
+// ==============================================================
+
+#ifndef __QUAT_H
+#define __QUAT_H
+
+#include "Orbitersdk.h"
+
+#if !defined(QUAT_NO_SIMD) && (defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__))
+#define QUAT_SSE2
+#include <emmintrin.h>
+#endif
+
+// ==============================================================
+// class Quat: rotation quaternion w + xi + yj + zk
+// ==============================================================
+
+class Quat {
+public:
+	double w, x, y, z;
+
+	inline Quat (): w(1.0), x(0.0), y(0.0), z(0.0) {}
+	inline Quat (double _w, double _x, double _y, double _z): w(_w), x(_x), y(_y), z(_z) {}
+
+	/**
+	 * \brief Rotation by angle [rad] about a unit axis.
+	 */
+	inline Quat (const VECTOR3 &axis, double angle)
+	{
+		double s = sin(0.5*angle);
+		w = cos(0.5*angle), x = axis.x*s, y = axis.y*s, z = axis.z*s;
+	}
+
+	inline VECTOR3 Vec () const { return _V(x, y, z); }
+};
+
+// --------------------------------------------------------------
+// Hamilton product. q1*q2 applies q2 first, then q1.
+
+inline Quat operator* (const Quat &a, const Quat &b)
+{
+#ifdef QUAT_SSE2
+	const __m128d neg0 = _mm_set_pd (0.0, -0.0);   // negate first element
+	const __m128d neg1 = _mm_set_pd (-0.0, 0.0);   // negate second element
+	const __m128d neg  = _mm_set1_pd (-0.0);
+	__m128d wx = _mm_loadu_pd (&b.w);              // (w2,x2)
+	__m128d yz = _mm_loadu_pd (&b.y);              // (y2,z2)
+	__m128d xw = _mm_shuffle_pd (wx, wx, 1);       // (x2,w2)
+	__m128d zy = _mm_shuffle_pd (yz, yz, 1);       // (z2,y2)
+	__m128d a01 = _mm_loadu_pd (&a.w);
+	__m128d a23 = _mm_loadu_pd (&a.y);
+	__m128d aw = _mm_unpacklo_pd (a01, a01), ax = _mm_unpackhi_pd (a01, a01);
+	__m128d ay = _mm_unpacklo_pd (a23, a23), az = _mm_unpackhi_pd (a23, a23);
+	__m128d rwx = _mm_add_pd (
+		_mm_add_pd (_mm_mul_pd (aw, wx), _mm_mul_pd (ax, _mm_xor_pd (xw, neg0))),
+		_mm_add_pd (_mm_mul_pd (ay, _mm_xor_pd (yz, neg0)), _mm_mul_pd (az, _mm_xor_pd (zy, neg))));
+	__m128d ryz = _mm_add_pd (
+		_mm_add_pd (_mm_mul_pd (aw, yz), _mm_mul_pd (ax, _mm_xor_pd (zy, neg0))),
+		_mm_add_pd (_mm_mul_pd (ay, _mm_xor_pd (wx, neg1)), _mm_mul_pd (az, xw)));
+	Quat q;
+	_mm_storeu_pd (&q.w, rwx);
+	_mm_storeu_pd (&q.y, ryz);
+	return q;
+#else
+	return Quat ((a.w*b.w - a.x*b.x) - (a.y*b.y + a.z*b.z),
+	             (a.w*b.x + a.x*b.w) + (a.y*b.z - a.z*b.y),
+	             (a.w*b.y - a.x*b.z) + (a.y*b.w + a.z*b.x),
+	             (a.w*b.z + a.x*b.y) - (a.y*b.x - a.z*b.w));
+#endif
+}
+
+inline Quat operator+ (const Quat &a, const Quat &b)
+{ return Quat (a.w+b.w, a.x+b.x, a.y+b.y, a.z+b.z); }
+
+inline Quat operator- (const Quat &a, const Quat &b)
+{ return Quat (a.w-b.w, a.x-b.x, a.y-b.y, a.z-b.z); }
+
+inline Quat operator- (const Quat &a)
+{ return Quat (-a.w, -a.x, -a.y, -a.z); }
+
+inline Quat operator* (const Quat &a, double f)
+{ return Quat (a.w*f, a.x*f, a.y*f, a.z*f); }
+
+inline Quat &operator*= (Quat &a, const Quat &b)
+{ return a = a*b; }
+
+inline double dotp (const Quat &a, const Quat &b)
+{ return a.w*b.w + a.x*b.x + a.y*b.y + a.z*b.z; }
+
+inline double length (const Quat &q)
+{ return sqrt (dotp (q, q)); }
+
+inline Quat unit (const Quat &q)
+{ return q * (1.0/length (q)); }
+
+/**
+ * \brief Conjugate. For unit quaternions, this is the inverse rotation.
+ */
+inline Quat conj (const Quat &q)
+{ return Quat (q.w, -q.x, -q.y, -q.z); }
+
+// --------------------------------------------------------------
+// Vector rotation: v + 2w(u x v) + 2u x (u x v), u = vector part
+
+inline VECTOR3 mul (const Quat &q, const VECTOR3 &v)
+{
+	VECTOR3 u = {q.x, q.y, q.z};
+	VECTOR3 t = crossp (u, v) * 2.0;
+	return v + t*q.w + crossp (u, t);
+}
+
+inline VECTOR3 tmul (const Quat &q, const VECTOR3 &v)
+{
+	VECTOR3 u = {-q.x, -q.y, -q.z};
+	VECTOR3 t = crossp (u, v) * 2.0;
+	return v + t*q.w + crossp (u, t);
+}
+
+// --------------------------------------------------------------
+// Conversion to and from rotation matrices
+
+inline MATRIX3 QuatToMatrix (const Quat &q)
+{
+	double xx = q.x*q.x, yy = q.y*q.y, zz = q.z*q.z;
+	double xy = q.x*q.y, xz = q.x*q.z, yz = q.y*q.z;
+	double wx = q.w*q.x, wy = q.w*q.y, wz = q.w*q.z;
+	return _M(1.0-2.0*(yy+zz), 2.0*(xy-wz),     2.0*(xz+wy),
+	          2.0*(xy+wz),     1.0-2.0*(xx+zz), 2.0*(yz-wx),
+	          2.0*(xz-wy),     2.0*(yz+wx),     1.0-2.0*(xx+yy));
+}
+
+/**
+ * \brief Rotation quaternion for a rotation matrix.
+ * \note Uses the largest of the four possible pivots (Shepperd's method),
+ *   so it is accurate for any rotation angle. The result has w >= 0.
+ */
+inline Quat QuatFromMatrix (const MATRIX3 &R)
+{
+	Quat q;
+	double tr = R.m11 + R.m22 + R.m33;
+	if (tr >= R.m11 && tr >= R.m22 && tr >= R.m33) {
+		double s = 2.0*sqrt (1.0 + tr);
+		q = Quat (0.25*s, (R.m32-R.m23)/s, (R.m13-R.m31)/s, (R.m21-R.m12)/s);
+	} else if (R.m11 >= R.m22 && R.m11 >= R.m33) {
+		double s = 2.0*sqrt (1.0 + R.m11 - R.m22 - R.m33);
+		q = Quat ((R.m32-R.m23)/s, 0.25*s, (R.m12+R.m21)/s, (R.m13+R.m31)/s);
+	} else if (R.m22 >= R.m33) {
+		double s = 2.0*sqrt (1.0 - R.m11 + R.m22 - R.m33);
+		q = Quat ((R.m13-R.m31)/s, (R.m12+R.m21)/s, 0.25*s, (R.m23+R.m32)/s);
+	} else {
+		double s = 2.0*sqrt (1.0 - R.m11 - R.m22 + R.m33);
+		q = Quat ((R.m21-R.m12)/s, (R.m13+R.m31)/s, (R.m23+R.m32)/s, 0.25*s);
+	}
+	return unit (q.w < 0.0 ? -q : q);
+}
+
+// --------------------------------------------------------------
+// Conversion to and from Euler angles, in the convention of
+// VESSELSTATUS2::arot and VESSEL::GetGlobalOrientation:
+// R = Rx(alpha) Ry(beta) Rz(gamma), see OrbiterAPI.h
+
+inline Quat QuatFromEuler (const VECTOR3 &arot)
+{
+	double sa = sin(0.5*arot.x), ca = cos(0.5*arot.x);
+	double sb = sin(0.5*arot.y), cb = cos(0.5*arot.y);
+	double sg = sin(0.5*arot.z), cg = cos(0.5*arot.z);
+	return Quat (ca,-sa,0,0) * Quat (cb,0,-sb,0) * Quat (cg,0,0,-sg);
+}
+
+inline VECTOR3 QuatToEuler (const Quat &q)
+{
+	double m11 = 1.0-2.0*(q.y*q.y+q.z*q.z), m12 = 2.0*(q.x*q.y-q.w*q.z);
+	double m13 = 2.0*(q.x*q.z+q.w*q.y);
+	double m23 = 2.0*(q.y*q.z-q.w*q.x), m33 = 1.0-2.0*(q.x*q.x+q.y*q.y);
+	return _V(atan2 (m23, m33), asin (max (-1.0, min (1.0, -m13))), atan2 (m12, m11));
+}
+
+// --------------------------------------------------------------
+// Exponential map: rotation vector (axis times angle [rad]) <-> quaternion
+
+inline Quat QuatExp (const VECTOR3 &v)
+{
+	double a = length (v);
+	double s = (a > 1e-6 ? sin(0.5*a)/a : 0.5 - a*a/48.0);
+	return Quat (cos(0.5*a), v.x*s, v.y*s, v.z*s);
+}
+
+/**
+ * \brief Rotation vector of a unit quaternion, for the shortest rotation
+ *   (angle in [0,pi]).
+ */
+inline VECTOR3 QuatLog (const Quat &q)
+{
+	double sgn = (q.w < 0.0 ? -1.0 : 1.0);
+	double s = sqrt (q.x*q.x + q.y*q.y + q.z*q.z);
+	double f = (s > 1e-12 ? 2.0*atan2 (s, sgn*q.w)/s : 2.0) * sgn;
+	return _V(q.x*f, q.y*f, q.z*f);
+}
+
+// --------------------------------------------------------------
+// Interpolation along the shortest path. Nlerp follows the same
+// arc as Slerp, but not at a constant angular rate. Slerp falls
+// back to Nlerp below ~3e-5 rad, where both agree to rounding.
+
+inline Quat Nlerp (const Quat &a, const Quat &b, double t)
+{
+	Quat bb = (dotp (a, b) < 0.0 ? -b : b);
+	return unit (a + (bb-a)*t);
+}
+
+inline Quat Slerp (const Quat &a, const Quat &b, double t)
+{
+	double c = dotp (a, b);
+	Quat bb = (c < 0.0 ? -b : b);
+	c = fabs (c);
+	if (c > 1.0-1e-10) return unit (a + (bb-a)*t);
+	double th = acos (c), s = 1.0/sin (th);
+	return a*(sin((1.0-t)*th)*s) + bb*(sin(t*th)*s);
+}
+
+// --------------------------------------------------------------
+// Batched operations
+
+/**
+ * \brief Element-wise products res[i] = a[i]*b[i], i = 0..n-1.
+ * \note res may alias a or b.
+ */
+inline void QuatMulArray (const Quat *a, const Quat *b, Quat *res, int n)
+{
+	for (int i = 0; i < n; i++)
+		res[i] = a[i]*b[i];
+}
+
+/**
+ * \brief Composition q[0]*q[1]*...*q[n-1] of a chain of rotations
+ *   (q[n-1] is applied first), normalised once at the end.
+ */
+inline Quat QuatChain (const Quat *q, int n)
+{
+	Quat r;
+	for (int i = 0; i < n; i++)
+		r = r*q[i];
+	return unit (r);
+}
+
+/**
+ * \brief Rotate n vectors by the same quaternion.
+ * \note The quaternion is converted to a matrix once, which is cheaper
+ *   than n quaternion rotations for n > 2.
+ */
+inline void QuatRotateArray (const Quat &q, const VECTOR3 *v, VECTOR3 *res, int n)
+{
+	MATRIX3 R = QuatToMatrix (q);
+	for (int i = 0; i < n; i++)
+		res[i] = mul (R, v[i]);
+}
+
+// ==============================================================
+// class DualQuat: rigid transform x -> mul(r,x) + t, stored as
+// r + e d with d = 1/2 t r
+// ==============================================================
+
+class DualQuat {
+public:
+	Quat r;  // rotation (real part)
+	Quat d;  // dual part
+
+	inline DualQuat (): d(0,0,0,0) {}
+	inline DualQuat (const Quat &rot, const VECTOR3 &trans)
+		: r(rot), d(Quat (0.0, trans.x, trans.y, trans.z) * rot * 0.5) {}
+	inline DualQuat (const MATRIX3 &R, const VECTOR3 &trans)
+		: r(QuatFromMatrix (R)), d(Quat (0.0, trans.x, trans.y, trans.z) * r * 0.5) {}
+
+	inline const Quat &Rotation () const { return r; }
+	inline VECTOR3 Translation () const { return (d * conj (r)).Vec() * 2.0; }
+};
+
+// --------------------------------------------------------------
+// a*b applies b first, then a
+
+inline DualQuat operator* (const DualQuat &a, const DualQuat &b)
+{
+	DualQuat q;
+	q.r = a.r*b.r;
+	q.d = a.r*b.d + a.d*b.r;
+	return q;
+}
+
+/**
+ * \brief Inverse of a unit dual quaternion.
+ */
+inline DualQuat conj (const DualQuat &q)
+{
+	DualQuat c;
+	c.r = conj (q.r);
+	c.d = conj (q.d);
+	return c;
+}
+
+/**
+ * \brief Normalise, and restore the orthogonality of real and dual part.
+ */
+inline DualQuat unit (const DualQuat &q)
+{
+	double f = 1.0/length (q.r);
+	DualQuat u;
+	u.r = q.r*f;
+	u.d = q.d*f;
+	u.d = u.d - u.r*dotp (u.r, u.d);
+	return u;
+}
+
+inline VECTOR3 mul (const DualQuat &q, const VECTOR3 &p)
+{
+	return mul (q.r, p) + q.Translation();
+}
+
+inline VECTOR3 tmul (const DualQuat &q, const VECTOR3 &p)
+{
+	return tmul (q.r, p - q.Translation());
+}
+
+/**
+ * \brief Blend of two rigid transforms (dual quaternion linear blending),
+ *   along the shortest rotation.
+ */
+inline DualQuat Nlerp (const DualQuat &a, const DualQuat &b, double t)
+{
+	double s = (dotp (a.r, b.r) < 0.0 ? -t : t);
+	DualQuat q;
+	q.r = a.r*(1.0-t) + b.r*s;
+	q.d = a.d*(1.0-t) + b.d*s;
+	return unit (q);
+}
+
+#endif // !__QUAT_H
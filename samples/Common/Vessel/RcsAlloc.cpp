@@ -0,0 +1,202 @@
+// ==============================================================
+//             ORBITER MODULE: Common vessel tools
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// RcsAlloc.cpp
+// Implementation for class RcsAllocator:
+//   Maps 6-DOF attitude/translation commands to individual RCS
+//   thruster levels from precomputed allocation tables
+// ==============================================================
+
+#include "RcsAlloc.h"
+
+// --------------------------------------------------------------
+// Solve min 1/2 u^T H u - g^T u subject to u >= 0 for an n x n
+// positive definite H (active set method, Lawson-Hanson style)
+// --------------------------------------------------------------
+static void SolveNonNeg (int n, const std::vector<double> &H, const std::vector<double> &g, std::vector<double> &u)
+{
+	const double eps = 1e-12;
+	std::vector<bool> freevar(n, false);
+	std::vector<double> a(n*(n+1)), z(n);
+	int i, j, k, r, iter;
+
+	u.assign (n, 0.0);
+	for (iter = 0; iter < 3*n+3; iter++) {
+		// release the bound variable with the largest descent gradient
+		int imax = -1;
+		double wmax = eps;
+		for (i = 0; i < n; i++) {
+			if (freevar[i]) continue;
+			double w = g[i];
+			for (j = 0; j < n; j++) w -= H[i*n+j]*u[j];
+			if (w > wmax) wmax = w, imax = i;
+		}
+		if (imax < 0) break;
+		freevar[imax] = true;
+
+		for (;;) {
+			// unconstrained minimiser over the free set
+			std::vector<int> idx;
+			for (i = 0; i < n; i++)
+				if (freevar[i]) idx.push_back (i);
+			int m = (int)idx.size();
+			for (r = 0; r < m; r++) {
+				for (k = 0; k < m; k++) a[r*(m+1)+k] = H[idx[r]*n+idx[k]];
+				a[r*(m+1)+m] = g[idx[r]];
+			}
+			for (k = 0; k < m; k++) { // Gaussian elimination with partial pivoting
+				int p = k;
+				for (r = k+1; r < m; r++)
+					if (fabs (a[r*(m+1)+k]) > fabs (a[p*(m+1)+k])) p = r;
+				if (p != k)
+					for (j = 0; j <= m; j++) { double t = a[k*(m+1)+j]; a[k*(m+1)+j] = a[p*(m+1)+j]; a[p*(m+1)+j] = t; }
+				for (r = k+1; r < m; r++) {
+					double f = a[r*(m+1)+k]/a[k*(m+1)+k];
+					for (j = k; j <= m; j++) a[r*(m+1)+j] -= f*a[k*(m+1)+j];
+				}
+			}
+			for (k = m-1; k >= 0; k--) {
+				double s = a[k*(m+1)+m];
+				for (j = k+1; j < m; j++) s -= a[k*(m+1)+j]*z[idx[j]];
+				z[idx[k]] = s/a[k*(m+1)+k];
+			}
+
+			// step towards the minimiser, fixing variables which reach 0
+			double alpha = 1.0;
+			for (r = 0; r < m; r++) {
+				i = idx[r];
+				if (z[i] <= 0.0) {
+					double al = (u[i] > z[i] ? u[i]/(u[i]-z[i]) : 0.0);
+					if (al < alpha) alpha = al;
+				}
+			}
+			for (r = 0; r < m; r++) {
+				i = idx[r];
+				u[i] += alpha*(z[i]-u[i]);
+			}
+			if (alpha >= 1.0) break;
+			for (r = 0; r < m; r++) {
+				i = idx[r];
+				if (u[i] <= eps) u[i] = 0.0, freevar[i] = false;
+			}
+		}
+	}
+}
+
+// ==============================================================
+
+RcsAllocator::RcsAllocator ()
+{
+	valid = false;
+	ref0 = _V(0,0,0);
+}
+
+// --------------------------------------------------------------
+
+int RcsAllocator::Setup (VESSEL *v)
+{
+	int i, j, k, a, n;
+	DWORD grp, m;
+
+	// collect the RCS thrusters (a thruster may be member of several groups)
+	th.clear();
+	for (grp = THGROUP_ATT_PITCHUP; grp <= THGROUP_ATT_BACK; grp++) {
+		THGROUP_TYPE thgt = (THGROUP_TYPE)grp;
+		for (m = 0; m < v->GetGroupThrusterCount (thgt); m++) {
+			THRUSTER_HANDLE h = v->GetGroupThruster (thgt, m);
+			for (i = 0; i < (int)th.size() && th[i] != h; i++);
+			if (i == (int)th.size()) th.push_back (h);
+		}
+	}
+	n = (int)th.size();
+	level.assign (n, 0.0);
+	valid = true;
+	if (!n) {
+		for (a = 0; a < 12; a++) table[a].clear();
+		return 0;
+	}
+	v->GetThrusterRef (th[0], ref0);
+
+	// effectiveness matrix: force (0-2) and torque (3-5) per thruster at full level
+	std::vector<double> B(6*n);
+	for (i = 0; i < n; i++) {
+		VECTOR3 pos, dir, F, T;
+		v->GetThrusterRef (th[i], pos);
+		v->GetThrusterDir (th[i], dir);
+		F = dir * v->GetThrusterMax0 (th[i]);
+		T = crossp (F, pos); // sign convention of vessel angular velocities
+		B[0*n+i] = F.x, B[1*n+i] = F.y, B[2*n+i] = F.z;
+		B[3*n+i] = T.x, B[4*n+i] = T.y, B[5*n+i] = T.z;
+	}
+
+	// axis weights: normalise each axis by its total authority
+	double W[6];
+	for (a = 0; a < 6; a++) {
+		double s = 0.0;
+		for (i = 0; i < n; i++) s += fabs (B[a*n+i]);
+		W[a] = (s ? 1.0/s : 0.0);
+	}
+
+	// normal matrix, with a small penalty on total thrust (propellant use)
+	const double lambda = 1e-6;
+	std::vector<double> H(n*n), g(n), u;
+	for (i = 0; i < n; i++)
+		for (j = 0; j < n; j++) {
+			double h = (i == j ? lambda : 0.0);
+			for (a = 0; a < 6; a++) h += B[a*n+i]*W[a]*W[a]*B[a*n+j];
+			H[i*n+j] = h;
+		}
+
+	// allocation for each command direction: unit demand on one axis, zero on the others
+	for (k = 0; k < 12; k++) {
+		a = k/2;
+		double sgn = (k & 1 ? -1.0 : 1.0);
+		double s = 0.0;
+		for (i = 0; i < n; i++) s += fabs (B[a*n+i]);
+		for (i = 0; i < n; i++)
+			g[i] = B[a*n+i]*W[a]*W[a]*sgn*s;
+		SolveNonNeg (n, H, g, u);
+		double umax = 0.0;
+		for (i = 0; i < n; i++) if (u[i] > umax) umax = u[i];
+		table[k].assign (n, 0.0);
+		if (umax > 0.0)
+			for (i = 0; i < n; i++) table[k][i] = u[i]/umax;
+	}
+	return n;
+}
+
+// --------------------------------------------------------------
+
+bool RcsAllocator::Valid (VESSEL *v) const
+{
+	if (!valid) return false;
+	if (!th.size()) return true;
+	VECTOR3 pos;
+	v->GetThrusterRef (th[0], pos);
+	return pos.x == ref0.x && pos.y == ref0.y && pos.z == ref0.z;
+}
+
+// --------------------------------------------------------------
+
+void RcsAllocator::SetLevels (VESSEL *v, const VECTOR3 &lin, const VECTOR3 &rot)
+{
+	int i, k, n = (int)th.size();
+	double cmd[6] = {lin.x, lin.y, lin.z, rot.x, rot.y, rot.z};
+	double lmax = 0.0;
+
+	for (i = 0; i < n; i++) level[i] = 0.0;
+	for (k = 0; k < 6; k++) {
+		if (!cmd[k]) continue;
+		const std::vector<double> &t = table[2*k + (cmd[k] < 0.0 ? 1 : 0)];
+		double c = fabs (cmd[k]);
+		for (i = 0; i < n; i++) level[i] += c*t[i];
+	}
+	for (i = 0; i < n; i++)
+		if (level[i] > lmax) lmax = level[i];
+	double scale = (lmax > 1.0 ? 1.0/lmax : 1.0);
+	for (i = 0; i < n; i++)
+		v->SetThrusterLevel (th[i], level[i]*scale);
+}
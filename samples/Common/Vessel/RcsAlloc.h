@@ -0,0 +1,89 @@
+// ==============================================================
+//             ORBITER MODULE: Common vessel tools
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// RcsAlloc.h
+// Interface for class RcsAllocator:
+//   Maps 6-DOF attitude/translation commands to individual RCS
+//   thruster levels from precomputed allocation tables
+// ==============================================================
+
+#ifndef __RCSALLOC_H
+#define __RCSALLOC_H
+
+#include "Orbitersdk.h"
+#include <vector>
+
+// ==============================================================
+
+class RcsAllocator {
+public:
+	RcsAllocator ();
+
+	/**
+	 * \brief Build the allocation tables for a vessel's RCS layout.
+	 * \param v vessel instance
+	 * \return number of RCS thrusters
+	 * \note Collects all thrusters assigned to the THGROUP_ATT_xxx groups
+	 *   and uses their current position, direction and max. thrust.
+	 * \note Must be called again after any change of the RCS layout,
+	 *   such as a change of the thruster definitions or group assignments,
+	 *   or a shift of the centre of gravity (see Valid).
+	 * \note For each of the 12 command directions (+/- force and torque along
+	 *   each vessel axis), the table holds the non-negative thruster levels
+	 *   which generate the command with minimal (weighted) cross-coupling on
+	 *   the other five axes, scaled so that the highest level is 1.
+	 */
+	int Setup (VESSEL *v);
+
+	/**
+	 * \brief Compute and apply the thruster levels for a command.
+	 * \param v vessel instance (as passed to Setup)
+	 * \param lin translation command per vessel axis (-1..1)
+	 * \param rot rotation command per vessel axis (-1..1). Positive values
+	 *   increase the angular velocity about the respective axis.
+	 * \note A command of +/-1 on a single axis corresponds to the maximum
+	 *   authority for that direction. Combined commands are superposed; if a
+	 *   thruster would saturate, the whole command is scaled down to keep its
+	 *   direction.
+	 * \note The levels of all RCS thrusters are set, overriding any levels
+	 *   set via the thruster groups (including manual keyboard or joystick
+	 *   input). A caller which only generates a rotation command should pass
+	 *   the current manual translation command in \a lin (see
+	 *   VESSEL::GetManualControlLevel) to preserve it.
+	 * \note Cost is O(thrusters) per call.
+	 */
+	void SetLevels (VESSEL *v, const VECTOR3 &lin, const VECTOR3 &rot);
+
+	/**
+	 * \brief Mark the allocation tables as outdated.
+	 * \note Call after a change of the thruster configuration or of the
+	 *   payload, which the allocator can't detect by itself. Valid returns
+	 *   false until the next Setup.
+	 */
+	inline void Invalidate () { valid = false; }
+
+	/**
+	 * \brief Returns true if the tables are up to date.
+	 * \param v vessel instance (as passed to Setup)
+	 * \return false before the first Setup, after Invalidate, or if the
+	 *   centre of gravity has been shifted since the last Setup. A shift
+	 *   (VESSEL::ShiftCG) moves all thruster positions, and is detected from
+	 *   the position of the first thruster.
+	 * \note Cost is O(1).
+	 */
+	bool Valid (VESSEL *v) const;
+
+	inline int Count () const { return (int)th.size(); }
+
+private:
+	bool valid;                       // tables up to date (see Invalidate)
+	VECTOR3 ref0;                     // position of th[0] at Setup
+	std::vector<THRUSTER_HANDLE> th;  // RCS thrusters
+	std::vector<double> table[12];    // levels per thruster for each command direction
+	std::vector<double> level;        // work buffer
+};
+
+#endif // !__RCSALLOC_H
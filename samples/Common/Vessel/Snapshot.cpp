@@ -0,0 +1,399 @@
+// ==============================================================
+//             ORBITER MODULE: Common vessel tools
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// Snapshot.cpp
+// Implementation for classes SnapshotWriter and SnapshotReader
+// ==============================================================
+
+#include "Snapshot.h"
+#include <stdio.h>
+#include <string.h>
+
+// ==============================================================
+// Blob layout
+//
+// header:  'OSNP', format version, reserved, size, CRC-32 of the data
+// section: tag, version, reserved, payload size, CRC-32 of the payload,
+//          payload (data and nested sections)
+
+const DWORD SNP_MAGIC   = SNAPSHOT_TAG('O','S','N','P');
+const WORD  SNP_VERSION = 1;
+const DWORD SNP_VESSEL  = SNAPSHOT_TAG('V','E','S','L');
+const DWORD SNP_STATUS  = SNAPSHOT_TAG('S','T','A','T');
+const DWORD SNP_CUSTOM  = SNAPSHOT_TAG('C','U','S','T');
+
+struct SNP_HEADER {
+	DWORD tag;
+	WORD version;
+	WORD reserved;
+	DWORD size;
+	DWORD crc;
+};
+
+// --------------------------------------------------------------
+
+static DWORD Crc32 (const char *data, size_t size)
+{
+	static DWORD table[256];
+	static bool init = false;
+	if (!init) {
+		for (DWORD i = 0; i < 256; i++) {
+			DWORD c = i;
+			for (int k = 0; k < 8; k++)
+				c = (c & 1 ? 0xEDB88320 ^ (c >> 1) : c >> 1);
+			table[i] = c;
+		}
+		init = true;
+	}
+	DWORD crc = 0xFFFFFFFF;
+	for (size_t i = 0; i < size; i++)
+		crc = table[(crc ^ (BYTE)data[i]) & 0xFF] ^ (crc >> 8);
+	return crc ^ 0xFFFFFFFF;
+}
+
+// ==============================================================
+// class SnapshotWriter
+// ==============================================================
+
+SnapshotWriter::SnapshotWriter ()
+{
+	Clear ();
+}
+
+// --------------------------------------------------------------
+
+void SnapshotWriter::Clear ()
+{
+	SNP_HEADER hdr = {SNP_MAGIC, SNP_VERSION, 0, 0, 0};
+	buf.resize (sizeof(SNP_HEADER));
+	memcpy (&buf[0], &hdr, sizeof(SNP_HEADER));
+	open.clear();
+}
+
+// --------------------------------------------------------------
+
+void SnapshotWriter::BeginSection (DWORD tag, WORD version)
+{
+	SNP_HEADER hdr = {tag, version, 0, 0, 0};
+	open.push_back (buf.size());
+	Write (&hdr, sizeof(SNP_HEADER));
+}
+
+// --------------------------------------------------------------
+
+void SnapshotWriter::EndSection ()
+{
+	if (open.empty()) return;
+	size_t ofs = open.back();
+	open.pop_back();
+	SNP_HEADER *hdr = (SNP_HEADER*)&buf[ofs];
+	size_t data = ofs + sizeof(SNP_HEADER);
+	hdr->size = (DWORD)(buf.size() - data);
+	hdr->crc = Crc32 (&buf[0]+data, hdr->size);
+}
+
+// --------------------------------------------------------------
+
+void SnapshotWriter::CancelSection ()
+{
+	if (open.empty()) return;
+	buf.resize (open.back());
+	open.pop_back();
+}
+
+// --------------------------------------------------------------
+
+void SnapshotWriter::Write (const void *data, size_t size)
+{
+	const char *p = (const char*)data;
+	buf.insert (buf.end(), p, p+size);
+}
+
+// --------------------------------------------------------------
+
+void SnapshotWriter::PutString (const char *str)
+{
+	WORD len = (WORD)strlen (str);
+	Put (len);
+	Write (str, len);
+}
+
+// --------------------------------------------------------------
+
+const char *SnapshotWriter::Data ()
+{
+	while (open.size()) EndSection (); // close any sections left open
+	SNP_HEADER *hdr = (SNP_HEADER*)&buf[0];
+	hdr->size = (DWORD)(buf.size() - sizeof(SNP_HEADER));
+	hdr->crc = Crc32 (&buf[0]+sizeof(SNP_HEADER), hdr->size);
+	return &buf[0];
+}
+
+// --------------------------------------------------------------
+
+bool SnapshotWriter::Save (const char *fname)
+{
+	const char *data = Data();
+	FILE *f = fopen (fname, "wb");
+	if (!f) return false;
+	bool ok = (fwrite (data, 1, buf.size(), f) == buf.size());
+	fclose (f);
+	return ok;
+}
+
+// ==============================================================
+// class SnapshotReader
+// ==============================================================
+
+SnapshotReader::SnapshotReader ()
+{
+	pos = 0;
+	ok = false;
+}
+
+// --------------------------------------------------------------
+
+bool SnapshotReader::Set (const void *data, size_t size)
+{
+	const char *p = (const char*)data;
+	buf.assign (p, p+size);
+	end.clear();
+	pos = 0;
+	ok = false;
+
+	if (size < sizeof(SNP_HEADER)) return false;
+	SNP_HEADER hdr;
+	memcpy (&hdr, p, sizeof(SNP_HEADER));
+	if (hdr.tag != SNP_MAGIC || hdr.version != SNP_VERSION || hdr.size != size - sizeof(SNP_HEADER) ||
+		hdr.crc != Crc32 (p+sizeof(SNP_HEADER), hdr.size))
+		return false;
+
+	pos = sizeof(SNP_HEADER);
+	end.push_back (size);
+	return ok = true;
+}
+
+// --------------------------------------------------------------
+
+bool SnapshotReader::Load (const char *fname)
+{
+	FILE *f = fopen (fname, "rb");
+	if (!f) return false;
+	fseek (f, 0, SEEK_END);
+	long size = ftell (f);
+	fseek (f, 0, SEEK_SET);
+	std::vector<char> data (size > 0 ? size : 1);
+	bool res = (size > 0 && fread (&data[0], 1, size, f) == (size_t)size);
+	fclose (f);
+	return res && Set (&data[0], size);
+}
+
+// --------------------------------------------------------------
+
+bool SnapshotReader::BeginSection (DWORD tag, WORD &version)
+{
+	if (end.empty()) return false;
+	size_t p = pos, e = end.back();
+	while (p + sizeof(SNP_HEADER) <= e) {
+		SNP_HEADER hdr;
+		memcpy (&hdr, &buf[p], sizeof(SNP_HEADER));
+		size_t data = p + sizeof(SNP_HEADER);
+		if (hdr.size > e - data) return false; // corrupt section header
+		if (hdr.tag == tag) {
+			if (hdr.crc != Crc32 (&buf[0]+data, hdr.size)) return false;
+			version = hdr.version;
+			pos = data;
+			end.push_back (data + hdr.size);
+			return true;
+		}
+		p = data + hdr.size;
+	}
+	return false;
+}
+
+// --------------------------------------------------------------
+
+void SnapshotReader::EndSection ()
+{
+	if (end.size() > 1) {
+		pos = end.back();
+		end.pop_back();
+	}
+}
+
+// --------------------------------------------------------------
+
+bool SnapshotReader::Read (void *data, size_t size)
+{
+	if (end.empty() || pos + size > end.back()) {
+		ok = false;
+		return false;
+	}
+	memcpy (data, &buf[pos], size);
+	pos += size;
+	return true;
+}
+
+// --------------------------------------------------------------
+
+bool SnapshotReader::GetString (char *str, size_t maxlen)
+{
+	WORD len;
+	if (!Get (len) || pos + len > end.back()) {
+		ok = false;
+		return false;
+	}
+	size_t n = min ((size_t)len, maxlen-1);
+	memcpy (str, &buf[pos], n);
+	str[n] = '\0';
+	pos += len;
+	return true;
+}
+
+// ==============================================================
+// Vessel snapshots
+// ==============================================================
+
+void SnapshotSaveVessel (VESSEL *v, SnapshotWriter &snp)
+{
+	DWORD i, n;
+	snp.BeginSection (SNP_VESSEL);
+	snp.PutString (v->GetName());
+
+	// generic state, with object handles replaced by names
+	VESSELSTATUS2 vs;
+	memset (&vs, 0, sizeof(vs));
+	vs.version = 2;
+	v->GetStatusEx (&vs);
+	char cbuf[256];
+	snp.BeginSection (SNP_STATUS);
+	snp.Put (vs.flag);
+	oapiGetObjectName (vs.rbody, cbuf, 256);
+	snp.PutString (cbuf);
+	if (vs.base) oapiGetObjectName (vs.base, cbuf, 256);
+	else cbuf[0] = '\0';
+	snp.PutString (cbuf);
+	snp.Put (vs.port);
+	snp.Put (vs.status);
+	snp.Put (vs.rpos);
+	snp.Put (vs.rvel);
+	snp.Put (vs.vrot);
+	snp.Put (vs.arot);
+	snp.Put (vs.surf_lng);
+	snp.Put (vs.surf_lat);
+	snp.Put (vs.surf_hdg);
+	snp.Put (n = v->GetPropellantCount());
+	for (i = 0; i < n; i++)
+		snp.Put (v->GetPropellantMass (v->GetPropellantHandleByIndex (i)));
+	snp.Put (n = v->GetThrusterCount());
+	for (i = 0; i < n; i++)
+		snp.Put (v->GetThrusterLevel (v->GetThrusterHandleByIndex (i)));
+	snp.EndSection ();
+
+	// vessel-specific state, if the vessel supports snapshots
+	if (VesselAcceptsMsg (v, SNAPSHOT_VMSG)) {
+		snp.BeginSection (SNP_CUSTOM);
+		if (((VESSEL3*)v)->clbkGeneric (SNAPSHOT_VMSG, SNAPSHOT_SAVE, &snp)) snp.EndSection ();
+		else snp.CancelSection ();
+	}
+	snp.EndSection ();
+}
+
+// --------------------------------------------------------------
+
+// Restore a vessel from the current vessel section, after its name
+static bool LoadVesselData (VESSEL *v, SnapshotReader &snp)
+{
+	WORD version;
+	char cbuf[256];
+	bool res = true;
+	DWORD i, n;
+
+	if (snp.BeginSection (SNP_STATUS, version)) {
+		VESSELSTATUS2 vs;
+		memset (&vs, 0, sizeof(vs));
+		vs.version = 2;
+		snp.Get (vs.flag);
+		vs.flag &= ~(VS_FUELRESET | VS_FUELLIST | VS_THRUSTRESET | VS_THRUSTLIST | VS_DOCKINFOLIST);
+		snp.GetString (cbuf, 256);
+		vs.rbody = oapiGetGbodyByName (cbuf);
+		snp.GetString (cbuf, 256);
+		vs.base = (vs.rbody && cbuf[0] ? oapiGetBaseByName (vs.rbody, cbuf) : 0);
+		snp.Get (vs.port);
+		snp.Get (vs.status);
+		snp.Get (vs.rpos);
+		snp.Get (vs.rvel);
+		snp.Get (vs.vrot);
+		snp.Get (vs.arot);
+		snp.Get (vs.surf_lng);
+		snp.Get (vs.surf_lat);
+		snp.Get (vs.surf_hdg);
+		if (vs.rbody && snp.Ok()) v->DefSetStateEx (&vs);
+		else res = false;
+
+		double m;
+		if (snp.Get (n) && n == v->GetPropellantCount()) {
+			for (i = 0; i < n && snp.Get (m); i++)
+				v->SetPropellantMass (v->GetPropellantHandleByIndex (i), m);
+		} else res = false;
+		if (snp.Get (n) && n == v->GetThrusterCount()) {
+			for (i = 0; i < n && snp.Get (m); i++)
+				v->SetThrusterLevel (v->GetThrusterHandleByIndex (i), m);
+		} else res = false;
+		snp.EndSection ();
+	} else res = false;
+
+	if (VesselAcceptsMsg (v, SNAPSHOT_VMSG) && snp.BeginSection (SNP_CUSTOM, version)) {
+		if (!((VESSEL3*)v)->clbkGeneric (SNAPSHOT_VMSG, SNAPSHOT_LOAD, &snp)) res = false;
+		snp.EndSection ();
+	}
+	return res && snp.Ok();
+}
+
+// --------------------------------------------------------------
+
+bool SnapshotLoadVessel (VESSEL *v, SnapshotReader &snp)
+{
+	WORD version;
+	char name[256];
+
+	// find the vessel's section
+	for (;;) {
+		if (!snp.BeginSection (SNP_VESSEL, version)) return false;
+		if (snp.GetString (name, 256) && !strcmp (name, v->GetName())) break;
+		snp.EndSection ();
+	}
+	bool res = LoadVesselData (v, snp);
+	snp.EndSection ();
+	return res;
+}
+
+// --------------------------------------------------------------
+
+void SnapshotSaveAll (SnapshotWriter &snp)
+{
+	for (DWORD i = 0; i < oapiGetVesselCount(); i++)
+		SnapshotSaveVessel (oapiGetVesselInterface (oapiGetVesselByIndex (i)), snp);
+}
+
+// --------------------------------------------------------------
+
+int SnapshotLoadAll (SnapshotReader &snp)
+{
+	int nload = 0;
+	WORD version;
+	char name[256];
+
+	// vessels are matched by name, since the vessel list may have been
+	// reordered since the snapshot was taken
+	while (snp.BeginSection (SNP_VESSEL, version)) {
+		OBJHANDLE hVessel = (snp.GetString (name, 256) ? oapiGetVesselByName (name) : 0);
+		if (hVessel && LoadVesselData (oapiGetVesselInterface (hVessel), snp))
+			nload++;
+		snp.EndSection ();
+	}
+	return nload;
+}
@@ -0,0 +1,179 @@
+// ==============================================================
+//             ORBITER MODULE: Common vessel tools
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// Snapshot.h
+// Interface for classes SnapshotWriter and SnapshotReader:
+//   Binary vessel state snapshots, as a fast alternative to the
+//   scenario text format for frequent in-session saves (e.g. rollback
+//   points). A snapshot is a memory blob consisting of tagged,
+//   versioned and checksummed sections, which may be nested.
+//   Vessels take part by responding to the SNAPSHOT_VMSG message in
+//   VESSEL3::clbkGeneric, returning 1 if handled, and by answering the
+//   handshake query of VesselMsg.h. ComponentVessel does this for all
+//   its subsystems. The scenario text format is unaffected.
+// ==============================================================
+
+#ifndef __SNAPSHOT_H
+#define __SNAPSHOT_H
+
+#include "Orbitersdk.h"
+#include "VesselMsg.h"
+#include <vector>
+
+#define SNAPSHOT_SAVE   1  ///< SNAPSHOT_VMSG prm: context is a SnapshotWriter*
+#define SNAPSHOT_LOAD   2  ///< SNAPSHOT_VMSG prm: context is a SnapshotReader*
+
+/**
+ * \brief Make a section tag from four characters.
+ */
+#define SNAPSHOT_TAG(a,b,c,d) ((DWORD)(a) | ((DWORD)(b) << 8) | ((DWORD)(c) << 16) | ((DWORD)(d) << 24))
+
+// ==============================================================
+
+/**
+ * \brief Builds a snapshot blob.
+ */
+class SnapshotWriter {
+public:
+	SnapshotWriter ();
+
+	/**
+	 * \brief Discard the contents and start a new blob.
+	 */
+	void Clear ();
+
+	/**
+	 * \brief Open a section. Sections can be nested.
+	 * \param tag section tag (see SNAPSHOT_TAG)
+	 * \param version layout version of the section data
+	 */
+	void BeginSection (DWORD tag, WORD version = 1);
+
+	/**
+	 * \brief Close the innermost open section and compute its checksum.
+	 */
+	void EndSection ();
+
+	/**
+	 * \brief Close the innermost open section, discarding it and its contents.
+	 */
+	void CancelSection ();
+
+	/**
+	 * \brief Append raw data to the current section.
+	 */
+	void Write (const void *data, size_t size);
+
+	template<class T> inline void Put (const T &val) { Write (&val, sizeof(T)); }
+
+	void PutString (const char *str);
+
+	/**
+	 * \brief Returns the completed blob.
+	 * \note All sections must have been closed.
+	 */
+	const char *Data ();
+	inline size_t Size () const { return buf.size(); }
+
+	/**
+	 * \brief Write the completed blob to a file.
+	 */
+	bool Save (const char *fname);
+
+private:
+	std::vector<char> buf;
+	std::vector<size_t> open;  // offsets of the open section headers
+};
+
+// ==============================================================
+
+/**
+ * \brief Reads a snapshot blob.
+ *
+ * Sections are looked up by tag in the order in which they were
+ * written, skipping sections the reader is not interested in.
+ * Sections with a checksum error are never entered.
+ */
+class SnapshotReader {
+public:
+	SnapshotReader ();
+
+	/**
+	 * \brief Set the blob to be read, and verify its header and checksum.
+	 * \return false if the data are not a valid snapshot
+	 */
+	bool Set (const void *data, size_t size);
+
+	/**
+	 * \brief Read a blob from a file.
+	 */
+	bool Load (const char *fname);
+
+	/**
+	 * \brief Enter the next section with the given tag at the current level.
+	 * \param tag section tag
+	 * \param version receives the section's layout version
+	 * \return false if no such section follows, or its checksum is wrong
+	 */
+	bool BeginSection (DWORD tag, WORD &version);
+
+	/**
+	 * \brief Leave the current section, skipping any unread data.
+	 */
+	void EndSection ();
+
+	/**
+	 * \brief Read raw data from the current section.
+	 * \return false if the section holds fewer than size bytes
+	 */
+	bool Read (void *data, size_t size);
+
+	template<class T> inline bool Get (T &val) { return Read (&val, sizeof(T)); }
+
+	bool GetString (char *str, size_t maxlen);
+
+	/**
+	 * \brief Returns false if any read went past the end of its section.
+	 */
+	inline bool Ok () const { return ok; }
+
+private:
+	std::vector<char> buf;
+	size_t pos;                // read position
+	std::vector<size_t> end;   // ends of the open sections
+	bool ok;
+};
+
+// ==============================================================
+
+/**
+ * \brief Write the state of a vessel: name, VESSELSTATUS2 parameters,
+ *   propellant masses, thruster levels, and the vessel's own data
+ *   (via SNAPSHOT_VMSG).
+ */
+void SnapshotSaveVessel (VESSEL *v, SnapshotWriter &snp);
+
+/**
+ * \brief Restore the state of a vessel written by SnapshotSaveVessel.
+ * \return false if the snapshot holds no data for the vessel, or the
+ *   vessel's own data could not be restored completely
+ */
+bool SnapshotLoadVessel (VESSEL *v, SnapshotReader &snp);
+
+/**
+ * \brief Write the states of all vessels.
+ */
+void SnapshotSaveAll (SnapshotWriter &snp);
+
+/**
+ * \brief Restore the states of all vessels present in the snapshot.
+ * \return number of vessels restored
+ * \note Vessels created or deleted since the snapshot was taken are
+ *   left as they are.
+ */
+int SnapshotLoadAll (SnapshotReader &snp);
+
+#endif // !__SNAPSHOT_H
@@ -0,0 +1,108 @@
+// ==============================================================
+//             ORBITER MODULE: Common vessel tools
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// TelemFrame.h
+// Layout of the telemetry export shared memory region.
+//
+// The TelemExport module publishes a fixed-layout binary record for
+// each vessel at the end of every time step into the file mapping
+// TELEM_SHM_NAME. Each record is protected by a sequence lock: the
+// writer makes the sequence counter odd while it updates the record,
+// and even again when done. Readers copy the record and retry if the
+// counter was odd or has changed in the meantime, so they never block
+// the simulation.
+//
+// The layout is shared by the TelemExport module, vessels and client
+// programs. This header depends only on windows.h, so that it can be
+// included by clients. See TelemExport\TelemReader.h for a reference
+// reader.
+// ==============================================================
+
+#ifndef __TELEMFRAME_H
+#define __TELEMFRAME_H
+
+#include <windows.h>
+
+#define TELEM_SHM_NAME   "Local\\OrbiterTelemetry"
+#define TELEM_MAGIC      0x4D4C4554   // 'TELM'
+#define TELEM_VERSION    1
+#define TELEM_MAXVESSEL  256          // number of vessel slots
+#define TELEM_MAXTANK    8            // propellant resources per vessel
+#define TELEM_NTHGROUP   15           // thruster groups THGROUP_MAIN to THGROUP_ATT_BACK
+#define TELEM_NCTRLSURF  6            // control surfaces AIRCTRL_ELEVATOR to AIRCTRL_RUDDERTRIM
+#define TELEM_MAXUSER    16           // vessel-defined values
+
+// Vessel state flags
+#define TELEM_LANDED     0x0001   ///< vessel is landed
+#define TELEM_CONTACT    0x0002   ///< vessel has ground contact
+#define TELEM_FOCUS      0x0004   ///< vessel has the input focus
+
+/**
+ * \brief Telemetry record of a single vessel.
+ * \note Vectors and the rotation matrix are given in the global
+ *   (ecliptic) frame, as returned by the Orbiter API.
+ */
+struct TELEM_VESSEL {
+	char name[32];                 ///< vessel name
+	char ref[32];                  ///< name of the gravity reference body
+	double simt;                   ///< simulation time of the record [s]
+	double mjd;                    ///< simulation date [MJD]
+	double gpos[3], gvel[3];       ///< global position [m] and velocity [m/s]
+	double rpos[3], rvel[3];       ///< position and velocity relative to ref
+	double rotm[9];                ///< rotation matrix vessel->global, row by row
+	double arot[3];                ///< global orientation Euler angles [rad]
+	double vrot[3];                ///< angular velocity in vessel frame [rad/s]
+	double alt;                    ///< altitude above mean radius of ref [m]
+	double pitch, bank, yaw;       ///< attitude relative to local horizon [rad]
+	double airspeed;               ///< airspeed [m/s]
+	double dynpres;                ///< dynamic pressure [Pa]
+	double mach;                   ///< Mach number
+	double mass, emptymass;        ///< total and empty mass [kg]
+	double propmass;               ///< total propellant mass [kg]
+	double tank[TELEM_MAXTANK];    ///< propellant mass per resource [kg]
+	double thgroup[TELEM_NTHGROUP];///< thruster group levels (0..1)
+	double ctrlsurf[TELEM_NCTRLSURF]; ///< control surface levels (-1..1)
+	double user[TELEM_MAXUSER];    ///< vessel-defined values (see TELEM_VMSG in VesselMsg.h)
+	DWORD ntank;                   ///< number of propellant resources (up to TELEM_MAXTANK)
+	DWORD nuser;                   ///< number of vessel-defined values
+	DWORD navmode;                 ///< bit n set if navmode n is active
+	DWORD flags;                   ///< TELEM_xxx state flags
+};
+
+/**
+ * \brief Vessel slot: sequence counter and record.
+ */
+struct TELEM_SLOT {
+	volatile LONG seq;             ///< odd while the record is being written
+	DWORD reserved;
+	TELEM_VESSEL rec;
+};
+
+/**
+ * \brief Header of the shared memory region, followed by
+ *   TELEM_MAXVESSEL slots.
+ */
+struct TELEM_HEADER {
+	DWORD magic;                   ///< TELEM_MAGIC while the exporter is running
+	DWORD version;                 ///< TELEM_VERSION
+	DWORD maxvessel;               ///< number of slots
+	DWORD slotsize;                ///< sizeof(TELEM_SLOT)
+	volatile LONG nvessel;         ///< number of slots in use
+	volatile LONG frame;           ///< incremented after each published step
+};
+
+inline TELEM_SLOT *TelemSlot (TELEM_HEADER *hdr, int i) { return (TELEM_SLOT*)(hdr+1) + i; }
+
+/**
+ * \brief Writer side of the sequence lock: enclose each update of a
+ *   slot record in TelemBeginUpdate and TelemEndUpdate.
+ * \note The interlocked increments are full memory barriers, so the
+ *   record writes can't move outside the odd counter phase.
+ */
+inline void TelemBeginUpdate (TELEM_SLOT *s) { InterlockedIncrement (&s->seq); }  // odd: update in progress
+inline void TelemEndUpdate (TELEM_SLOT *s) { InterlockedIncrement (&s->seq); }    // even: record consistent
+
+#endif // !__TELEMFRAME_H
@@ -0,0 +1,395 @@
+// ==============================================================
+//             ORBITER MODULE: Common vessel tools
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// Telemetry.cpp
+// Implementation for classes TelemetryStore and TelemetrySeries:
+//   Shared per-vessel time series of sampled flight parameters.
+// ==============================================================
+
+#include "Telemetry.h"
+#include <stdio.h>
+#include <string.h>
+
+// ==============================================================
+// Shared telemetry data
+//
+// The data live in a file mapping private to the Orbiter process,
+// which each module maps on first use. This makes them independent
+// of the lifetime of any particular module. Sampling functions and
+// triggers are called through the shared tables by whichever module
+// runs the update, so they are only valid while the registering
+// store exists.
+
+const DWORD TELEM_MAGIC = 0x4D4C4554; // 'TELM'
+
+struct TelemetryShared {
+	DWORD magic;
+	DWORD size;               // layout check
+	volatile LONG lock;       // table spin lock
+	volatile LONG nchannel;   // number of registered channels
+	struct Channel {
+		char name[32];
+		TelemetryFunc func;   // sampling function (0: none)
+		void *context;
+		int owner;            // store which registered the function
+	} chn[TELEMETRY_MAXCHANNEL];
+	struct Store {
+		int active;
+		double dt;            // sampling interval [s]
+		TelemetryTrigger trigger;
+		void *context;
+	} store[TELEMETRY_MAXSTORE];
+	TelemetrySeries series[TELEMETRY_MAXSERIES];
+};
+
+// Unmaps the shared data when the module is unloaded
+static struct TelemMap {
+	HANDLE hMap;
+	TelemetryShared *shm;
+	TelemMap (): hMap(0), shm(0) {}
+	~TelemMap () {
+		if (shm) UnmapViewOfFile (shm);
+		if (hMap) CloseHandle (hMap);
+	}
+} g_TelemMap;
+
+static TelemetryShared *TelemAttach ()
+{
+	if (g_TelemMap.shm) return g_TelemMap.shm;
+
+	char name[64];
+	sprintf (name, "Local\\OrbiterTelemetryStore.%u", GetCurrentProcessId());
+	HANDLE hMap = CreateFileMapping (INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, sizeof(TelemetryShared), name);
+	if (!hMap) return 0;
+	bool exists = (GetLastError() == ERROR_ALREADY_EXISTS);
+	TelemetryShared *p = (TelemetryShared*)MapViewOfFile (hMap, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(TelemetryShared));
+	if (!p) {
+		CloseHandle (hMap);
+		return 0;
+	}
+	if (exists && p->magic == TELEM_MAGIC && p->size != sizeof(TelemetryShared)) {
+		// mapping created by a module built with a different layout
+		UnmapViewOfFile (p);
+		CloseHandle (hMap);
+		return 0;
+	}
+	if (!exists || p->magic != TELEM_MAGIC) {
+		p->size = sizeof(TelemetryShared);
+		MemoryBarrier();
+		p->magic = TELEM_MAGIC;
+	}
+	g_TelemMap.hMap = hMap;
+	g_TelemMap.shm = p;
+	return p;
+}
+
+// ==============================================================
+// class TelemetrySeries
+// ==============================================================
+
+void TelemetrySeries::Init (OBJHANDLE hV)
+{
+	memset (this, 0, sizeof(TelemetrySeries));
+	hVessel = hV;
+}
+
+// --------------------------------------------------------------
+
+int TelemetrySeries::Refs () const
+{
+	int n = 0;
+	for (int i = 0; i < TELEMETRY_MAXSTORE; i++)
+		n += nref[i];
+	return n;
+}
+
+// --------------------------------------------------------------
+
+void TelemetrySeries::Record (double simt, const double *v, int nchannel)
+{
+	int i, j, ch = ofs/TELEMETRY_CHUNK;
+	int i0 = ch*TELEMETRY_CHUNK;
+	int i1 = i0 + TELEMETRY_CHUNK;
+	if (nvalid < TELEMETRY_NDATA) {
+		nvalid++;
+		if (i1 > nvalid) i1 = nvalid;
+	}
+
+	// a channel registered after recording has started remains zero
+	// for the existing samples
+	time[ofs] = (float)simt;
+	for (j = 0; j < nchannel; j++) {
+		Column *c = col+j;
+		c->val[ofs] = (float)v[j];
+
+		// rescan the chunk containing the new sample
+		float cmin = c->val[i0], cmax = cmin;
+		for (i = i0+1; i < i1; i++) {
+			if      (c->val[i] < cmin) cmin = c->val[i];
+			else if (c->val[i] > cmax) cmax = c->val[i];
+		}
+		c->cmin[ch] = cmin;
+		c->cmax[ch] = cmax;
+
+		// merge the chunk summaries
+		int nc = (nvalid + TELEMETRY_CHUNK-1) / TELEMETRY_CHUNK;
+		c->vmin = c->cmin[0], c->vmax = c->cmax[0];
+		for (i = 1; i < nc; i++) {
+			if (c->cmin[i] < c->vmin) c->vmin = c->cmin[i];
+			if (c->cmax[i] > c->vmax) c->vmax = c->cmax[i];
+		}
+	}
+	ofs = (ofs+1) % TELEMETRY_NDATA;
+}
+
+// --------------------------------------------------------------
+
+bool TelemetrySeries::Range (int ch, float &vmin, float &vmax) const
+{
+	if (!nvalid) return false;
+	vmin = col[ch].vmin;
+	vmax = col[ch].vmax;
+	return true;
+}
+
+// --------------------------------------------------------------
+
+float TelemetrySeries::Latest (int ch) const
+{
+	return (nvalid ? col[ch].val[(ofs+TELEMETRY_NDATA-1) % TELEMETRY_NDATA] : 0.0f);
+}
+
+// ==============================================================
+// class TelemetryStore
+// ==============================================================
+
+TelemetryStore::TelemetryStore (double dt)
+{
+	int i;
+	own = false;
+	id = -1;
+	shm = TelemAttach();
+	if (shm) {
+		Lock();
+		for (i = 0; i < TELEMETRY_MAXSTORE; i++)
+			if (!shm->store[i].active) {
+				shm->store[i].active = 1;
+				id = i;
+				break;
+			}
+		Unlock();
+	}
+	if (id < 0) { // no mapping, or no free store slot: record privately
+		oapiWriteLog ("TelemetryStore: shared data not available, recording privately");
+		shm = new TelemetryShared;
+		memset (shm, 0, sizeof(TelemetryShared));
+		own = true;
+		id = 0;
+		shm->store[id].active = 1;
+	}
+	shm->store[id].dt = dt;
+	shm->store[id].trigger = 0;
+	shm->store[id].context = 0;
+}
+
+// --------------------------------------------------------------
+
+TelemetryStore::~TelemetryStore ()
+{
+	int i;
+	Lock();
+	for (i = 0; i < TELEMETRY_MAXSERIES; i++) {
+		TelemetrySeries *s = shm->series+i;
+		if (s->hVessel && s->nref[id]) {
+			s->nref[id] = 0;
+			if (s->Refs()) SetInterval (s);
+			else s->hVessel = 0;
+		}
+	}
+	// the sampling functions are about to become invalid: other
+	// stores registering the same channels take them over
+	for (i = 0; i < shm->nchannel; i++)
+		if (shm->chn[i].func && shm->chn[i].owner == id) {
+			shm->chn[i].func = 0;
+			shm->chn[i].context = 0;
+		}
+	memset (shm->store+id, 0, sizeof(TelemetryShared::Store));
+	Unlock();
+	if (own) delete shm;
+}
+
+// --------------------------------------------------------------
+
+void TelemetryStore::Lock () const
+{
+	while (InterlockedCompareExchange (&shm->lock, 1, 0))
+		YieldProcessor();
+}
+
+// --------------------------------------------------------------
+
+void TelemetryStore::Unlock () const
+{
+	InterlockedExchange (&shm->lock, 0);
+}
+
+// --------------------------------------------------------------
+
+int TelemetryStore::AddChannel (const char *name, TelemetryFunc func, void *context)
+{
+	Lock();
+	int ch = FindChannel (name);
+	if (ch < 0 && shm->nchannel < TELEMETRY_MAXCHANNEL) {
+		ch = shm->nchannel;
+		strncpy (shm->chn[ch].name, name, 31); shm->chn[ch].name[31] = '\0';
+		MemoryBarrier();
+		shm->nchannel = ch+1;
+	}
+	if (ch >= 0) {
+		if (!shm->chn[ch].func) {
+			shm->chn[ch].func = func;
+			shm->chn[ch].context = context;
+			shm->chn[ch].owner = id;
+		}
+		Channel c = {ch, func, context};
+		chn.push_back (c);
+	}
+	Unlock();
+	return ch;
+}
+
+// --------------------------------------------------------------
+
+int TelemetryStore::FindChannel (const char *name) const
+{
+	for (int i = 0; i < shm->nchannel; i++)
+		if (!_stricmp (shm->chn[i].name, name)) return i;
+	return -1;
+}
+
+// --------------------------------------------------------------
+
+int TelemetryStore::ChannelCount () const
+{
+	return shm->nchannel;
+}
+
+// --------------------------------------------------------------
+
+const char *TelemetryStore::ChannelName (int ch) const
+{
+	return shm->chn[ch].name;
+}
+
+// --------------------------------------------------------------
+
+void TelemetryStore::SetTrigger (TelemetryTrigger func, void *context)
+{
+	shm->store[id].trigger = func;
+	shm->store[id].context = context;
+}
+
+// --------------------------------------------------------------
+
+void TelemetryStore::SetInterval (TelemetrySeries *s)
+{
+	// shortest interval of the subscribing stores
+	double dt = 0.0;
+	for (int i = 0; i < TELEMETRY_MAXSTORE; i++)
+		if (s->nref[i] && (!dt || shm->store[i].dt < dt))
+			dt = shm->store[i].dt;
+	s->dt = dt;
+	if (s->nvalid) {
+		double t = s->time[(s->ofs+TELEMETRY_NDATA-1) % TELEMETRY_NDATA] + dt;
+		if (t < s->tnext) s->tnext = t;
+	}
+}
+
+// --------------------------------------------------------------
+
+TelemetrySeries *TelemetryStore::Subscribe (OBJHANDLE hVessel)
+{
+	TelemetrySeries *s = 0, *sfree = 0;
+	Lock();
+	for (int i = 0; i < TELEMETRY_MAXSERIES; i++) {
+		TelemetrySeries *si = shm->series+i;
+		if (si->hVessel == hVessel) { s = si; break; }
+		if (!si->hVessel && !sfree) sfree = si;
+	}
+	if (!s && sfree) {
+		s = sfree;
+		s->Init (hVessel);
+	}
+	if (s) {
+		s->nref[id]++;
+		SetInterval (s);
+	}
+	Unlock();
+	return s;
+}
+
+// --------------------------------------------------------------
+
+void TelemetryStore::Unsubscribe (OBJHANDLE hVessel)
+{
+	Lock();
+	for (int i = 0; i < TELEMETRY_MAXSERIES; i++) {
+		TelemetrySeries *s = shm->series+i;
+		if (s->hVessel == hVessel) {
+			if (s->nref[id]) {
+				s->nref[id]--;
+				if (s->Refs()) SetInterval (s);
+				else s->hVessel = 0;
+			}
+			break;
+		}
+	}
+	Unlock();
+}
+
+// --------------------------------------------------------------
+
+void TelemetryStore::Update (double simt)
+{
+	int i, j, k;
+
+	// take over the channels of deleted stores
+	for (i = 0; i < (int)chn.size(); i++) {
+		TelemetryShared::Channel &c = shm->chn[chn[i].ch];
+		if (c.func) continue;
+		Lock();
+		if (!c.func) {
+			c.func = chn[i].func;
+			c.context = chn[i].context;
+			c.owner = id;
+		}
+		Unlock();
+	}
+
+	int nch = shm->nchannel;
+	if (!nch) return;
+
+	for (i = 0; i < TELEMETRY_MAXSERIES; i++) {
+		TelemetrySeries *s = shm->series+i;
+		if (!s->hVessel || simt < s->tnext || !oapiIsVessel (s->hVessel)) continue;
+		VESSEL *v = oapiGetVesselInterface (s->hVessel);
+
+		// sample if any of the subscribing stores asks for it
+		for (k = 0; k < TELEMETRY_MAXSTORE; k++) {
+			if (!s->nref[k]) continue;
+			const TelemetryShared::Store &st = shm->store[k];
+			if (!st.trigger || st.trigger (v, st.context)) break;
+		}
+		if (k == TELEMETRY_MAXSTORE) continue;
+
+		for (j = 0; j < nch; j++) {
+			const TelemetryShared::Channel &c = shm->chn[j];
+			sample[j] = (c.func ? c.func (v, c.context) : s->Latest (j));
+		}
+		s->Record (simt, sample, nch);
+		s->tnext = simt + s->dt;
+	}
+}
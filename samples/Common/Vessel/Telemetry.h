@@ -0,0 +1,213 @@
+// ==============================================================
+//             ORBITER MODULE: Common vessel tools
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// Telemetry.h
+// Interface for classes TelemetryStore and TelemetrySeries:
+//   Shared per-vessel time series of sampled flight parameters.
+//   Each channel is sampled once per vessel, no matter how many MFDs
+//   or dialogs display it. All modules of the Orbiter process share the
+//   same channel table and series, so that a channel registered by one
+//   module can be plotted by any other. Data are stored by column in
+//   ring buffers that can be passed directly to GraphMFD::AddPlot, with
+//   per-chunk min/max summaries so that value ranges are available
+//   without scanning the data.
+// ==============================================================
+
+#ifndef __TELEMETRY_H
+#define __TELEMETRY_H
+
+#include "Orbitersdk.h"
+#include <vector>
+
+const int TELEMETRY_CHUNK      = 16;    // samples per min/max summary
+const int TELEMETRY_NDATA      = 1024;  // samples per channel and vessel (multiple of TELEMETRY_CHUNK)
+const int TELEMETRY_MAXCHANNEL = 32;    // max. number of channels
+const int TELEMETRY_MAXSERIES  = 16;    // max. number of recorded vessels
+const int TELEMETRY_MAXSTORE   = 16;    // max. number of stores
+
+class TelemetryStore;
+struct TelemetryShared;
+
+/**
+ * \brief Sampling function for a telemetry channel.
+ * \param v vessel interface
+ * \param context user data passed to TelemetryStore::AddChannel
+ * \return sampled value
+ */
+typedef double (*TelemetryFunc)(VESSEL *v, void *context);
+
+/**
+ * \brief Trigger function, deciding if a vessel is to be sampled.
+ * \param v vessel interface
+ * \param context user data passed to TelemetryStore::SetTrigger
+ * \return true if a sample should be recorded
+ */
+typedef bool (*TelemetryTrigger)(VESSEL *v, void *context);
+
+// ==============================================================
+
+/**
+ * \brief Recorded telemetry of a single vessel.
+ *
+ * Instances live in the data shared by all stores of the process, and
+ * are obtained with TelemetryStore::Subscribe.
+ */
+class TelemetrySeries {
+	friend class TelemetryStore;
+
+public:
+	/**
+	 * \brief Ring buffer of a channel.
+	 * \note The buffer has Size() entries. The oldest sample is at
+	 *   index *Offset(). Unused entries are zero.
+	 */
+	inline float *Data (int ch) { return col[ch].val; }
+
+	inline float *Time () { return time; }      ///< ring buffer of sample times [s]
+	inline int *Offset () { return &ofs; }      ///< pointer to index of oldest sample
+	inline int Size () const { return TELEMETRY_NDATA; } ///< ring buffer length
+	inline int Count () const { return nvalid; }///< number of recorded samples
+	inline OBJHANDLE Vessel () const { return hVessel; }
+
+	/**
+	 * \brief Value range of a channel over all recorded samples.
+	 * \param ch channel index
+	 * \param vmin min. value on return
+	 * \param vmax max. value on return
+	 * \return false if no samples have been recorded yet
+	 * \note Does not scan the data. Cost is independent of the buffer length.
+	 */
+	bool Range (int ch, float &vmin, float &vmax) const;
+
+	/**
+	 * \brief Most recent value of a channel, or 0 if none was recorded.
+	 */
+	float Latest (int ch) const;
+
+private:
+	void Init (OBJHANDLE hVessel);
+	void Record (double simt, const double *v, int nchannel);
+	int Refs () const;
+
+	struct Column {
+		float val[TELEMETRY_NDATA];                     // ring buffer
+		float cmin[TELEMETRY_NDATA/TELEMETRY_CHUNK];    // per-chunk summaries
+		float cmax[TELEMETRY_NDATA/TELEMETRY_CHUNK];
+		float vmin, vmax;                               // summary over all chunks
+	};
+
+	OBJHANDLE hVessel;                 // recorded vessel (0: slot free)
+	int ofs;                           // index of oldest sample (= next write position)
+	int nvalid;                        // number of recorded samples
+	int nref[TELEMETRY_MAXSTORE];      // subscription count per store
+	double dt;                         // sampling interval [s]
+	double tnext;                      // time of next sample
+	float time[TELEMETRY_NDATA];       // sample times
+	Column col[TELEMETRY_MAXCHANNEL];
+};
+
+// ==============================================================
+
+/**
+ * \brief Telemetry recorder for a set of channels and vessels.
+ *
+ * A module typically creates a single store, registers its channels,
+ * and calls Update from opcPreStep. MFD and dialog instances subscribe
+ * to the vessels they display and plot the shared series.
+ *
+ * The channels and series live in a file mapping private to the Orbiter
+ * process, which each module maps on first use. Stores of different
+ * modules therefore see the same channels and the same series, and a
+ * vessel is sampled only once per interval, by whichever store calls
+ * Update first. Should the mapping fail, the store records privately.
+ * \note A store must be deleted before its module is unloaded (e.g. in
+ *   ExitModule), because the shared data refer to its sampling functions.
+ */
+class TelemetryStore {
+public:
+	/**
+	 * \brief Create a telemetry store.
+	 * \param dt sampling interval [s]
+	 * \note A vessel subscribed by several stores is sampled at the
+	 *   shortest of their intervals.
+	 */
+	TelemetryStore (double dt);
+	~TelemetryStore ();
+
+	/**
+	 * \brief Register a channel.
+	 * \param name channel name
+	 * \param func sampling function
+	 * \param context user data passed to the sampling function
+	 * \return channel index, or -1 if the channel table is full
+	 * \note If a channel of the same name exists already, its index is
+	 *   returned and the new sampling function is only used once the
+	 *   store that registered the channel first is deleted. Until then,
+	 *   a channel without a sampling function repeats its last value.
+	 */
+	int AddChannel (const char *name, TelemetryFunc func, void *context = 0);
+
+	/**
+	 * \brief Returns the index of a named channel, or -1 if not found.
+	 * \note Finds the channels registered by any module.
+	 */
+	int FindChannel (const char *name) const;
+
+	int ChannelCount () const;
+	const char *ChannelName (int ch) const;
+
+	/**
+	 * \brief Set a condition for recording samples.
+	 * \note While the trigger returns false for a vessel, the store asks
+	 *   for no samples of it. A vessel subscribed by several stores is
+	 *   sampled if any of them asks for it. By default, all subscribed
+	 *   vessels are sampled.
+	 */
+	void SetTrigger (TelemetryTrigger trigger, void *context = 0);
+
+	/**
+	 * \brief Subscribe to the telemetry of a vessel.
+	 * \param hVessel vessel handle
+	 * \return telemetry series of the vessel, or NULL if the series
+	 *   table is full
+	 * \note Sampling starts with the first subscription. Each call must be
+	 *   matched by a call to Unsubscribe.
+	 */
+	TelemetrySeries *Subscribe (OBJHANDLE hVessel);
+
+	/**
+	 * \brief Release a subscription.
+	 * \note When the last subscription of a vessel by any store is
+	 *   released, its series is deleted.
+	 */
+	void Unsubscribe (OBJHANDLE hVessel);
+
+	/**
+	 * \brief Record samples for all subscribed vessels that are due.
+	 * \param simt simulation time [s]
+	 * \note Call once per frame, e.g. from opcPreStep. Samples are taken
+	 *   for the series of all stores, not only for this one.
+	 */
+	void Update (double simt);
+
+private:
+	void Lock () const;
+	void Unlock () const;
+	void SetInterval (TelemetrySeries *s);
+
+	struct Channel {  // channel registered by this store
+		int ch;
+		TelemetryFunc func;
+		void *context;
+	};
+	std::vector<Channel> chn;
+	TelemetryShared *shm;    // shared data, or private data if the mapping failed
+	bool own;                // shm is private
+	int id;                  // store slot in shm
+	double sample[TELEMETRY_MAXCHANNEL];  // work buffer for one row of samples
+};
+
+#endif // !__TELEMETRY_H
@@ -0,0 +1,259 @@
+// ==============================================================
+//             ORBITER MODULE: Common vessel tools
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// ThermalNet.cpp
+// Implementation for class ThermalNetwork:
+//   Lumped-node heat balance with conduction and radiation links,
+//   solved implicitly (backward Euler) on a sparse (CSR) matrix
+// ==============================================================
+
+#include "ThermalNet.h"
+#include <algorithm>
+
+static const double SIGMA = 5.670373e-8; // Stefan-Boltzmann constant [W/(m^2 K^4)]
+
+// secant coefficient h with h*(Ta-Tb) = Ta^4-Tb^4
+static inline double RadCoeff (double Ta, double Tb)
+{
+	return (Ta*Ta + Tb*Tb)*(Ta + Tb);
+}
+
+// ==============================================================
+
+ThermalNetwork::ThermalNetwork ()
+{
+	flux = 0.0;
+	Tspace = 3.0;
+	linearise = false;
+}
+
+// --------------------------------------------------------------
+
+int ThermalNetwork::AddNode (double capacity, double temp)
+{
+	C.push_back (capacity);
+	T.push_back (temp);
+	emit.push_back (0.0);
+	absorb.push_back (0.0);
+	Q.push_back (0.0);
+	return (int)C.size()-1;
+}
+
+// --------------------------------------------------------------
+
+int ThermalNetwork::AddConduction (int node1, int node2, double G)
+{
+	Link l = {node1, node2, false, G, -1, -1};
+	link.push_back (l);
+	return (int)link.size()-1;
+}
+
+// --------------------------------------------------------------
+
+int ThermalNetwork::AddRadiation (int node1, int node2, double epsA)
+{
+	Link l = {node1, node2, true, epsA, -1, -1};
+	link.push_back (l);
+	return (int)link.size()-1;
+}
+
+// --------------------------------------------------------------
+
+void ThermalNetwork::SetLink (int i, double coeff)
+{
+	link[i].coeff = coeff;
+}
+
+// --------------------------------------------------------------
+
+void ThermalNetwork::SetEmitter (int node, double epsA)
+{
+	emit[node] = epsA;
+}
+
+// --------------------------------------------------------------
+
+void ThermalNetwork::SetAbsorber (int node, double alphaA)
+{
+	absorb[node] = alphaA;
+}
+
+// --------------------------------------------------------------
+
+void ThermalNetwork::SetHeatLoad (int node, double q)
+{
+	Q[node] = q;
+}
+
+// --------------------------------------------------------------
+
+void ThermalNetwork::SetIncidentFlux (double f)
+{
+	flux = f;
+}
+
+// --------------------------------------------------------------
+
+void ThermalNetwork::SetSpaceTemp (double temp)
+{
+	Tspace = temp;
+}
+
+// --------------------------------------------------------------
+
+void ThermalNetwork::SetLinearise (bool lin)
+{
+	linearise = lin;
+}
+
+// --------------------------------------------------------------
+
+void ThermalNetwork::Setup ()
+{
+	int i, k, n = (int)C.size();
+	size_t l;
+
+	// adjacency lists, including the diagonal
+	std::vector<std::vector<int> > adj (n);
+	for (i = 0; i < n; i++)
+		adj[i].push_back (i);
+	for (l = 0; l < link.size(); l++) {
+		adj[link[l].i].push_back (link[l].j);
+		adj[link[l].j].push_back (link[l].i);
+	}
+
+	// compressed rows with sorted unique column indices
+	rowptr.resize (n+1);
+	col.clear();
+	diag.resize (n);
+	rowptr[0] = 0;
+	for (i = 0; i < n; i++) {
+		std::sort (adj[i].begin(), adj[i].end());
+		adj[i].erase (std::unique (adj[i].begin(), adj[i].end()), adj[i].end());
+		for (k = 0; k < (int)adj[i].size(); k++) {
+			if (adj[i][k] == i) diag[i] = (int)col.size();
+			col.push_back (adj[i][k]);
+		}
+		rowptr[i+1] = (int)col.size();
+	}
+	val.resize (col.size());
+
+	// matrix positions of the link entries
+	for (l = 0; l < link.size(); l++) {
+		Link &lk = link[l];
+		lk.pij = (int)(std::lower_bound (col.begin()+rowptr[lk.i], col.begin()+rowptr[lk.i+1], lk.j) - col.begin());
+		lk.pji = (int)(std::lower_bound (col.begin()+rowptr[lk.j], col.begin()+rowptr[lk.j+1], lk.i) - col.begin());
+	}
+
+	b.resize (n);  x.resize (n);  r.resize (n);  z.resize (n);
+	p.resize (n);  Ap.resize (n); Tprev.resize (n); Tlin.resize (n);
+}
+
+// --------------------------------------------------------------
+// Backward Euler system (C/dt + K(Tlin)) T = C/dt T_prev + sources,
+// with the radiation terms replaced by their secant conductances
+// at Tlin. The matrix is symmetric positive definite.
+
+void ThermalNetwork::Assemble (double dt, const std::vector<double> &Tl)
+{
+	int i, n = (int)C.size();
+	size_t l;
+
+	std::fill (val.begin(), val.end(), 0.0);
+	for (i = 0; i < n; i++) {
+		double cdt = C[i]/dt;
+		double hs = SIGMA*emit[i]*RadCoeff (Tl[i], Tspace);
+		val[diag[i]] = cdt + hs;
+		b[i] = cdt*Tprev[i] + Q[i] + absorb[i]*flux + hs*Tspace;
+	}
+	for (l = 0; l < link.size(); l++) {
+		const Link &lk = link[l];
+		double g = (lk.rad ? SIGMA*lk.coeff*RadCoeff (Tl[lk.i], Tl[lk.j]) : lk.coeff);
+		val[diag[lk.i]] += g;
+		val[diag[lk.j]] += g;
+		val[lk.pij] -= g;
+		val[lk.pji] -= g;
+	}
+}
+
+// --------------------------------------------------------------
+// Jacobi-preconditioned conjugate gradients for val*x = b, starting
+// from the current x
+
+int ThermalNetwork::SolvePCG (int maxiter, double tol)
+{
+	int i, k, iter, n = (int)C.size();
+	double rz, rz_old, bnorm = 0.0, rnorm;
+
+	for (i = 0; i < n; i++) {
+		double s = 0.0;
+		for (k = rowptr[i]; k < rowptr[i+1]; k++)
+			s += val[k]*x[col[k]];
+		r[i] = b[i]-s;
+		z[i] = r[i]/val[diag[i]];
+		p[i] = z[i];
+		bnorm += b[i]*b[i];
+	}
+	double eps2 = tol*tol*bnorm;
+	rz = 0.0;
+	rnorm = 0.0;
+	for (i = 0; i < n; i++) {
+		rz += r[i]*z[i];
+		rnorm += r[i]*r[i];
+	}
+
+	for (iter = 0; iter < maxiter && rnorm > eps2; iter++) {
+		double pAp = 0.0;
+		for (i = 0; i < n; i++) {
+			double s = 0.0;
+			for (k = rowptr[i]; k < rowptr[i+1]; k++)
+				s += val[k]*p[col[k]];
+			Ap[i] = s;
+			pAp += p[i]*s;
+		}
+		double alpha = rz/pAp;
+		rz_old = rz;
+		rz = rnorm = 0.0;
+		for (i = 0; i < n; i++) {
+			x[i] += alpha*p[i];
+			r[i] -= alpha*Ap[i];
+			z[i] = r[i]/val[diag[i]];
+			rz += r[i]*z[i];
+			rnorm += r[i]*r[i];
+		}
+		double beta = rz/rz_old;
+		for (i = 0; i < n; i++)
+			p[i] = z[i] + beta*p[i];
+	}
+	return iter;
+}
+
+// --------------------------------------------------------------
+
+int ThermalNetwork::Step (double dt)
+{
+	const int maxpicard = 8;      // max. linearisation passes
+	const double Ttol = 1e-4;     // convergence of linearisation [K]
+	int i, n = (int)C.size(), iter = 0;
+	if (!n || dt <= 0.0) return 0;
+
+	Tprev = T;
+	Tlin = T;
+	x = T;
+	for (int pass = 0; pass < maxpicard; pass++) {
+		Assemble (dt, Tlin);
+		iter += SolvePCG (n+10, 1e-10);
+		if (linearise) break;
+		double dmax = 0.0;
+		for (i = 0; i < n; i++) {
+			dmax = max (dmax, fabs (x[i]-Tlin[i]));
+			Tlin[i] = x[i];
+		}
+		if (dmax < Ttol) break;
+	}
+	T = x;
+	return iter;
+}
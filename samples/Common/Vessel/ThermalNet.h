@@ -0,0 +1,133 @@
+// ==============================================================
+//             ORBITER MODULE: Common vessel tools
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// ThermalNet.h
+// Interface for class ThermalNetwork:
+//   Lumped-node heat balance with conduction and radiation links,
+//   solved implicitly (backward Euler) on a sparse (CSR) matrix
+// ==============================================================
+
+#ifndef __THERMALNET_H
+#define __THERMALNET_H
+
+#include "Orbitersdk.h"
+#include <vector>
+
+// ==============================================================
+
+class ThermalNetwork {
+public:
+	ThermalNetwork ();
+
+	/**
+	 * \brief Add a thermal node.
+	 * \param capacity heat capacity [J/K]
+	 * \param T initial temperature [K]
+	 * \return node index
+	 */
+	int AddNode (double capacity, double T);
+
+	/**
+	 * \brief Add a conductive link between two nodes.
+	 * \param G conductance [W/K]
+	 * \return link index
+	 */
+	int AddConduction (int node1, int node2, double G);
+
+	/**
+	 * \brief Add a radiative link between two nodes.
+	 * \param epsA effective radiative exchange area (emissivity x area x
+	 *   view factor) [m^2]
+	 * \return link index
+	 */
+	int AddRadiation (int node1, int node2, double epsA);
+
+	/**
+	 * \brief Change the coefficient (G or epsA) of a link.
+	 * \note Does not require a new call to Setup.
+	 */
+	void SetLink (int link, double coeff);
+
+	/**
+	 * \brief Set the radiative area of a node towards deep space
+	 *   (emissivity x area) [m^2].
+	 */
+	void SetEmitter (int node, double epsA);
+
+	/**
+	 * \brief Set the absorbing area of a node for incident flux
+	 *   (absorptivity x projected area) [m^2].
+	 */
+	void SetAbsorber (int node, double alphaA);
+
+	/**
+	 * \brief Set the internal heat load of a node [W].
+	 */
+	void SetHeatLoad (int node, double Q);
+
+	/**
+	 * \brief Set the incident (e.g. solar) flux [W/m^2].
+	 * \note Set to 0 while the vessel is in shadow.
+	 */
+	void SetIncidentFlux (double flux);
+
+	/**
+	 * \brief Set the background temperature for emitters [K] (default 3 K).
+	 */
+	void SetSpaceTemp (double T);
+
+	/**
+	 * \brief Select the treatment of radiation terms.
+	 * \param lin true: linearise radiation about the temperatures at the
+	 *   start of the step (one linear solve per step); false: iterate the
+	 *   linearisation to convergence (default)
+	 */
+	void SetLinearise (bool lin);
+
+	/**
+	 * \brief Build the sparse matrix structure.
+	 * \note Must be called after adding nodes or links and before Step.
+	 */
+	void Setup ();
+
+	/**
+	 * \brief Advance the temperatures by one time step.
+	 * \param dt time step [s]
+	 * \return total number of linear solver iterations
+	 * \note The implicit scheme is unconditionally stable, so large steps
+	 *   (time acceleration) are allowed.
+	 */
+	int Step (double dt);
+
+	inline int NodeCount () const { return (int)C.size(); }
+	inline double Temp (int node) const { return T[node]; }
+	inline void SetTemp (int node, double temp) { T[node] = temp; }
+
+private:
+	void Assemble (double dt, const std::vector<double> &Tlin);
+	int SolvePCG (int maxiter, double tol);
+
+	struct Link {
+		int i, j;        // connected nodes
+		bool rad;        // radiative link?
+		double coeff;    // G [W/K] or epsA [m^2]
+		int pij, pji;    // CSR positions of the off-diagonal entries
+	};
+
+	// nodes
+	std::vector<double> C, T;         // capacity, temperature
+	std::vector<double> emit, absorb; // emitter and absorber areas
+	std::vector<double> Q;            // heat loads
+	std::vector<Link> link;
+	double flux, Tspace;
+	bool linearise;
+
+	// CSR matrix and solver work vectors
+	std::vector<int> rowptr, col, diag;
+	std::vector<double> val, b, x, r, z, p, Ap, Tprev, Tlin;
+};
+
+#endif // !__THERMALNET_H
@@ -0,0 +1,184 @@
+// ==============================================================
+//             ORBITER MODULE: Common vessel tools
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// ThrustAlloc.cpp
+// Implementation for class ThrustAllocator:
+//   Maps a demanded force/torque vector to thruster levels in
+//   [0,1] for a small thruster layout (box-constrained least
+//   squares, active set method)
+// ==============================================================
+
+#include "ThrustAlloc.h"
+
+// ==============================================================
+
+ThrustAllocator::ThrustAllocator (int nthruster, int naxis)
+{
+	int i, j;
+	nthr = min (nthruster, TA_MAXTHRUSTER);
+	nax  = min (naxis, TA_MAXAXIS);
+	for (i = 0; i < TA_MAXAXIS; i++) {
+		W[i] = 1.0;
+		for (j = 0; j < TA_MAXTHRUSTER; j++)
+			B[i][j] = 0.0;
+	}
+	lambda = 1e-4;
+	Setup();
+}
+
+// --------------------------------------------------------------
+
+void ThrustAllocator::SetEffectiveness (int thruster, const double *eff)
+{
+	for (int i = 0; i < nax; i++)
+		B[i][thruster] = eff[i];
+}
+
+// --------------------------------------------------------------
+
+void ThrustAllocator::SetAxisWeight (int axis, double w)
+{
+	W[axis] = w;
+}
+
+// --------------------------------------------------------------
+
+void ThrustAllocator::SetRegularisation (double lmb)
+{
+	lambda = lmb;
+}
+
+// --------------------------------------------------------------
+
+void ThrustAllocator::Setup ()
+{
+	int i, j, k, r, c, mask;
+
+	for (i = 0; i < nthr; i++)
+		for (k = 0; k < nax; k++)
+			BtW[i][k] = B[k][i]*W[k]*W[k];
+
+	for (i = 0; i < nthr; i++)
+		for (j = 0; j < nthr; j++) {
+			double h = (i == j ? lambda : 0.0);
+			for (k = 0; k < nax; k++)
+				h += BtW[i][k]*B[k][j];
+			H[i][j] = h;
+		}
+
+	// invert the free-set submatrix for every subset of thrusters
+	// (Gauss-Jordan with partial pivoting; H is positive definite for lambda > 0)
+	for (mask = 0; mask < (1 << nthr); mask++) {
+		int idx[TA_MAXTHRUSTER], n = 0;
+		double a[TA_MAXTHRUSTER][2*TA_MAXTHRUSTER];
+		for (i = 0; i < nthr; i++)
+			if (mask & (1 << i)) idx[n++] = i;
+		for (r = 0; r < n; r++)
+			for (c = 0; c < n; c++) {
+				a[r][c] = H[idx[r]][idx[c]];
+				a[r][c+n] = (r == c ? 1.0 : 0.0);
+			}
+		for (c = 0; c < n; c++) {
+			int p = c;
+			for (r = c+1; r < n; r++)
+				if (fabs (a[r][c]) > fabs (a[p][c])) p = r;
+			if (p != c)
+				for (k = 0; k < 2*n; k++) { double t = a[c][k]; a[c][k] = a[p][k]; a[p][k] = t; }
+			double piv = a[c][c];
+			if (fabs (piv) < 1e-300) piv = 1e-300;
+			for (k = 0; k < 2*n; k++) a[c][k] /= piv;
+			for (r = 0; r < n; r++) {
+				if (r == c || !a[r][c]) continue;
+				double f = a[r][c];
+				for (k = 0; k < 2*n; k++) a[r][k] -= f*a[c][k];
+			}
+		}
+		for (i = 0; i < TA_MAXTHRUSTER; i++)
+			for (j = 0; j < TA_MAXTHRUSTER; j++)
+				Hinv[mask][i][j] = 0.0;
+		for (r = 0; r < n; r++)
+			for (c = 0; c < n; c++)
+				Hinv[mask][idx[r]][idx[c]] = a[r][c+n];
+	}
+}
+
+// --------------------------------------------------------------
+
+int ThrustAllocator::Solve (const double *demand, const double *pref, double *u) const
+{
+	const double eps = 1e-12;
+	int i, j, k, iter;
+	int bound[TA_MAXTHRUSTER];  // 0=free, -1=fixed at 0, +1=fixed at 1
+	double g[TA_MAXTHRUSTER], rhs[TA_MAXTHRUSTER], x[TA_MAXTHRUSTER];
+
+	// linear term of the cost function, and feasible starting point
+	for (i = 0; i < nthr; i++) {
+		double p = (pref ? pref[i] : 0.0);
+		g[i] = lambda*p;
+		for (k = 0; k < nax; k++)
+			g[i] += BtW[i][k]*demand[k];
+		u[i] = max (0.0, min (1.0, p));
+		bound[i] = 0;
+	}
+
+	for (iter = 1; iter <= 4*nthr+4; iter++) {
+		int mask = 0;
+		for (i = 0; i < nthr; i++)
+			if (!bound[i]) mask |= (1 << i);
+
+		// minimiser over the free thrusters, with the fixed ones at their bounds
+		for (i = 0; i < nthr; i++) {
+			if (bound[i]) continue;
+			rhs[i] = g[i];
+			for (j = 0; j < nthr; j++)
+				if (bound[j]) rhs[i] -= H[i][j]*u[j];
+		}
+		for (i = 0; i < nthr; i++) {
+			if (bound[i]) continue;
+			x[i] = 0.0;
+			for (j = 0; j < nthr; j++)
+				if (!bound[j]) x[i] += Hinv[mask][i][j]*rhs[j];
+		}
+
+		// step towards the minimiser until the first bound is hit
+		double alpha = 1.0;
+		int blk = -1;
+		for (i = 0; i < nthr; i++) {
+			if (bound[i]) continue;
+			double p = x[i]-u[i];
+			if (x[i] < 0.0 && p < 0.0) {
+				double a = -u[i]/p;
+				if (a < alpha) alpha = a, blk = i;
+			} else if (x[i] > 1.0 && p > 0.0) {
+				double a = (1.0-u[i])/p;
+				if (a < alpha) alpha = a, blk = i;
+			}
+		}
+		for (i = 0; i < nthr; i++)
+			if (!bound[i]) u[i] += alpha*(x[i]-u[i]);
+		if (blk >= 0) {
+			bound[blk] = (x[blk] < 0.0 ? -1 : 1);
+			u[blk] = (bound[blk] < 0 ? 0.0 : 1.0);
+			continue;
+		}
+
+		// optimal on the working set: release the fixed thruster with the
+		// most strongly violated multiplier, or terminate
+		int rel = -1;
+		double rmax = eps;
+		for (i = 0; i < nthr; i++) {
+			if (!bound[i]) continue;
+			double r = -g[i];
+			for (j = 0; j < nthr; j++)
+				r += H[i][j]*u[j];
+			r *= bound[i]; // > 0: cost decreases when moving away from the bound
+			if (r > rmax) rmax = r, rel = i;
+		}
+		if (rel < 0) break;
+		bound[rel] = 0;
+	}
+	return iter;
+}
@@ -0,0 +1,84 @@
+// ==============================================================
+//             ORBITER MODULE: Common vessel tools
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// ThrustAlloc.h
+// Interface for class ThrustAllocator:
+//   Maps a demanded force/torque vector to thruster levels in
+//   [0,1] for a small thruster layout (box-constrained least
+//   squares, active set method)
+// ==============================================================
+
+#ifndef __THRUSTALLOC_H
+#define __THRUSTALLOC_H
+
+#include "Orbitersdk.h"
+
+#define TA_MAXTHRUSTER 6   // max. number of thrusters per allocator
+#define TA_MAXAXIS     6   // max. number of controlled axes
+
+// ==============================================================
+
+class ThrustAllocator {
+public:
+	/**
+	 * \brief Create an allocator for a thruster layout.
+	 * \param nthruster number of thrusters (<= TA_MAXTHRUSTER)
+	 * \param naxis number of controlled force/torque axes (<= TA_MAXAXIS)
+	 */
+	ThrustAllocator (int nthruster, int naxis);
+
+	/**
+	 * \brief Set the effect of a thruster at level 1 on all controlled axes.
+	 * \param thruster thruster index
+	 * \param eff array of naxis contributions
+	 */
+	void SetEffectiveness (int thruster, const double *eff);
+
+	/**
+	 * \brief Set the weight of an axis residual in the cost function.
+	 * \note Default weight is 1 for all axes.
+	 */
+	void SetAxisWeight (int axis, double w);
+
+	/**
+	 * \brief Set the weight of the deviation from the preferred levels.
+	 * \note A small positive value (default 1e-4) makes the solution unique
+	 *   when the layout has more thrusters than axes.
+	 */
+	void SetRegularisation (double lambda);
+
+	/**
+	 * \brief Precompute the factorisations for the current layout.
+	 * \note Must be called after the layout has been defined or modified,
+	 *   and before the first call to Solve.
+	 */
+	void Setup ();
+
+	/**
+	 * \brief Compute thruster levels for a demand vector.
+	 * \param demand array of naxis demanded axis values
+	 * \param pref array of nthruster preferred levels (also used as
+	 *   starting point), or NULL for 0
+	 * \param level array of nthruster levels receiving the result
+	 * \return number of active set iterations
+	 * \note Minimises |W (B level - demand)|^2 + lambda |level - pref|^2
+	 *   subject to 0 <= level <= 1, where B is the effectiveness matrix and
+	 *   W the diagonal axis weight matrix.
+	 */
+	int Solve (const double *demand, const double *pref, double *level) const;
+
+private:
+	int nthr, nax;
+	double B[TA_MAXAXIS][TA_MAXTHRUSTER];  // effectiveness matrix
+	double W[TA_MAXAXIS];                  // axis weights
+	double lambda;                         // regularisation weight
+	double BtW[TA_MAXTHRUSTER][TA_MAXAXIS]; // B^T W^2
+	double H[TA_MAXTHRUSTER][TA_MAXTHRUSTER]; // B^T W^2 B + lambda I
+	double Hinv[1<<TA_MAXTHRUSTER][TA_MAXTHRUSTER][TA_MAXTHRUSTER];
+	// inverse of the submatrix of H for each free set (bit i = thruster i free)
+};
+
+#endif // !__THRUSTALLOC_H
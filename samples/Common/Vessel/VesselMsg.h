@@ -0,0 +1,56 @@
+// ==============================================================
+//             ORBITER MODULE: Common vessel tools
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// VesselMsg.h
+// Generic vessel messages (VESSEL3::clbkGeneric) exchanged between
+// the SDK sample modules and vessels.
+//
+// Message IDs above VMSG_USER are not reserved by anybody, so a
+// third-party vessel may use one of the IDs below for a purpose of its
+// own. Modules that pass a pointer with a message must therefore first
+// ask the vessel whether it understands the message (VesselAcceptsMsg).
+// A vessel that handles a message must answer the query with
+// VMSGSDK_MAGIC, without accessing the context:
+//
+//   case SNAPSHOT_VMSG:
+//     if (prm == VMSGSDK_QUERY) return VMSGSDK_MAGIC;
+//     ...
+// ==============================================================
+
+#ifndef __VESSELMSG_H
+#define __VESSELMSG_H
+
+#include "Orbitersdk.h"
+
+// Message IDs. All IDs used by the sample modules are defined here.
+#define SNAPSHOT_VMSG    (VMSG_USER + 0x534E)  ///< binary state snapshots (see Snapshot.h)
+#define TELEM_VMSG       (VMSG_USER + 0x454C)  ///< vessel-defined telemetry values (see below)
+
+// TELEM_VMSG: the TelemExport module requests vessel-defined subsystem
+// values. prm is the max. number of values, context points to a double
+// array of that size. The vessel returns the number of values written.
+
+/**
+ * \brief prm value of the handshake query. The context pointer is NULL.
+ */
+#define VMSGSDK_QUERY    0x51534D56  // 'VMSQ'
+
+/**
+ * \brief Answer to the handshake query by a vessel that handles the message.
+ */
+#define VMSGSDK_MAGIC    0x4B44534F  // 'OSDK'
+
+/**
+ * \brief Returns true if the vessel handles message msgid as defined
+ *   in this file, and may be passed its context data.
+ */
+inline bool VesselAcceptsMsg (VESSEL *v, int msgid)
+{
+	return v->Version() >= 2 &&
+		((VESSEL3*)v)->clbkGeneric (msgid, VMSGSDK_QUERY, 0) == VMSGSDK_MAGIC;
+}
+
+#endif // !__VESSELMSG_H
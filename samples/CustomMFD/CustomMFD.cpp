@@ -14,12 +14,13 @@
 #include <stdio.h>
 #include <math.h>
 #include "orbitersdk.h"
+#include "..\Common\Vessel\Telemetry.h"
 #include "CustomMFD.h"
 
 // ==============================================================
 // Global variables
 
-const int ndata = 200;  // data points
+const int ndata = 200;  // reference curve points
 const double sample_dt = 5.0; // data point interval
 
 static struct {  // "Ascent MFD" parameters
@@ -27,15 +28,59 @@ static struct {  // "Ascent MFD" parameters
 } g_AscentMFD;
 
 static struct {  // global data storage
-	double tnext;  // time of next sample
-	int   sample;  // current sample index
-	float *time;   // sample time
-	float *alt;    // altitude data
-	float *pitch;  // pitch data
-	float *rvel;   // radial velocity data
-	float *tvel;   // tangential velocity data
+	TelemetryStore *store;  // shared telemetry of all displayed vessels
+	int alt, pitch, rvel, tvel;  // channel indices
+	OBJHANDLE hFocus;       // vessel tracked independent of MFD instances
 } g_Data;
 
+// ==============================================================
+// Telemetry channels
+
+static bool RecordTrigger (VESSEL *v, void *context)
+{
+	return v->GetAltitude() > v->GetSize(); // start recording
+}
+
+static double SampleAlt (VESSEL *v, void *context)
+{
+	return v->GetAltitude()*1e-3;
+}
+
+static double SamplePitch (VESSEL *v, void *context)
+{
+	return v->GetPitch()*DEG;
+}
+
+// get radial and tangential velocity components
+static void SampleVelocity (VESSEL *v, double &vrad, double &vtan)
+{
+	VECTOR3 vel, pos;
+	double a, r2, v2, vr2, vt2;
+	v->GetRelativeVel (v->GetSurfaceRef(), vel);
+	v->GetRelativePos (v->GetSurfaceRef(), pos);
+	r2 = pos.x*pos.x + pos.y*pos.y + pos.z*pos.z;
+	v2 = vel.x*vel.x + vel.y*vel.y + vel.z*vel.z;
+	a  = (vel.x*pos.x + vel.y*pos.y + vel.z*pos.z) / r2;
+	vr2 = a*a * r2;
+	vt2 = v2 - vr2;
+	vrad = (vr2 >= 0.0 ? a >= 0.0 ? sqrt(vr2) : -sqrt(vr2) : 0.0)*1e-3;
+	vtan = (vt2 >= 0.0 ? sqrt(vt2) : 0.0)*1e-3;
+}
+
+static double SampleRvel (VESSEL *v, void *context)
+{
+	double vrad, vtan;
+	SampleVelocity (v, vrad, vtan);
+	return vrad;
+}
+
+static double SampleTvel (VESSEL *v, void *context)
+{
+	double vrad, vtan;
+	SampleVelocity (v, vrad, vtan);
+	return vtan;
+}
+
 // ==============================================================
 // API interface
 
@@ -48,13 +93,13 @@ DLLCLBK void InitModule (HINSTANCE hDLL)
 	spec.context = NULL;
 	spec.msgproc = AscentMFD::MsgProc;
 
-	g_Data.tnext  = 0.0;
-	g_Data.sample = 0;
-	g_Data.time   = new float[ndata];   memset (g_Data.time,  0, ndata*sizeof(float));
-	g_Data.alt    = new float[ndata];   memset (g_Data.alt,   0, ndata*sizeof(float));
-	g_Data.pitch  = new float[ndata];   memset (g_Data.pitch, 0, ndata*sizeof(float));
-	g_Data.rvel   = new float[ndata];   memset (g_Data.rvel,  0, ndata*sizeof(float));
-	g_Data.tvel   = new float[ndata];   memset (g_Data.tvel,  0, ndata*sizeof(float));
+	g_Data.store  = new TelemetryStore (sample_dt);
+	g_Data.alt    = g_Data.store->AddChannel ("Alt", SampleAlt);
+	g_Data.pitch  = g_Data.store->AddChannel ("Pitch", SamplePitch);
+	g_Data.rvel   = g_Data.store->AddChannel ("Vrad", SampleRvel);
+	g_Data.tvel   = g_Data.store->AddChannel ("Vtan", SampleTvel);
+	g_Data.store->SetTrigger (RecordTrigger);
+	g_Data.hFocus = 0;
 
 	g_AscentMFD.mode = oapiRegisterMFDMode (spec);
 }
@@ -62,46 +107,21 @@ DLLCLBK void InitModule (HINSTANCE hDLL)
 DLLCLBK void ExitModule (HINSTANCE hDLL)
 {
 	oapiUnregisterMFDMode (g_AscentMFD.mode);
-	delete []g_Data.time;
-	delete []g_Data.alt;
-	delete []g_Data.pitch;
-	delete []g_Data.rvel;
-	delete []g_Data.tvel;
+	delete g_Data.store;
 }
 
-// We record vessel parameters outside the MFD to keep tracking
+// We record the focus vessel parameters outside the MFD to keep tracking
 // even if the MFD mode doesn't exist
 
 DLLCLBK void opcPreStep (double simt, double simdt, double mjd)
 {
-	if (simt >= g_Data.tnext) {
-		VESSEL *v = oapiGetFocusInterface();
-		VECTOR3 vel, pos;
-		double a, r2, v2, vr2, vt2;
-		double alt = v->GetAltitude();
-		if (alt > v->GetSize()) { // start recording
-			g_Data.time[g_Data.sample]  = (float)simt;
-			g_Data.alt[g_Data.sample]   = (float)(alt*1e-3);
-			g_Data.pitch[g_Data.sample] = (float)(v->GetPitch()*DEG);
-			v->GetRelativeVel (v->GetSurfaceRef(), vel);
-			// get radial and tangential velocity components
-			v->GetRelativePos (v->GetSurfaceRef(), pos);
-			r2 = pos.x*pos.x + pos.y*pos.y + pos.z*pos.z;
-			v2 = vel.x*vel.x + vel.y*vel.y + vel.z*vel.z;
-			a  = (vel.x*pos.x + vel.y*pos.y + vel.z*pos.z) / r2;
-			vr2 = a*a * r2;
-			vt2 = v2 - vr2;
-			g_Data.rvel[g_Data.sample] = (vr2 >= 0.0 ? a >= 0.0 ? (float)sqrt(vr2) : -(float)sqrt(vr2) : 0.0f)*1e-3f;
-			g_Data.tvel[g_Data.sample] = (vt2 >= 0.0 ? (float)sqrt(vt2) : 0.0f)*1e-3f;
-			g_Data.sample = (g_Data.sample+1) % ndata;
-			g_Data.tnext += sample_dt;
-		}
-
-		// DEBUG
-		ELEMENTS el;
-		double mjd;
-		OBJHANDLE hRef = v->GetElements (el, mjd);
+	OBJHANDLE hFocus = oapiGetFocusObject();
+	if (hFocus != g_Data.hFocus) {
+		g_Data.store->Subscribe (hFocus);
+		if (g_Data.hFocus) g_Data.store->Unsubscribe (g_Data.hFocus);
+		g_Data.hFocus = hFocus;
 	}
+	g_Data.store->Update (simt);
 }
 
 // ==============================================================
@@ -116,26 +136,29 @@ AscentMFD::AscentMFD (DWORD w, DWORD h, VESSEL *vessel)
 	ref_alt = new float[ndata];
 	ref_tvel = new float[ndata];
 	ref = vessel->GetSurfaceRef();
+	hVessel = vessel->GetHandle();
+	tm = g_Data.store->Subscribe (hVessel); // NULL if the telemetry table is full
+	float *alt = (tm ? tm->Data (g_Data.alt) : 0);
 
 	g = AddGraph ();
 	SetAxisTitle (g, 0, "Time: s");
 	SetAxisTitle (g, 1, "Alt: km");
-	AddPlot (g, g_Data.time, g_Data.alt, ndata, 1, &g_Data.sample);
+	if (tm) AddPlot (g, tm->Time(), alt, tm->Size(), 1, tm->Offset());
 
 	g = AddGraph ();
 	SetAxisTitle (g, 0, "Alt: km");
 	SetAxisTitle (g, 1, "Pitch: deg");
-	AddPlot (g, g_Data.alt, g_Data.pitch, ndata, 1, &g_Data.sample);
+	if (tm) AddPlot (g, alt, tm->Data (g_Data.pitch), tm->Size(), 1, tm->Offset());
 
 	g = AddGraph ();
 	SetAxisTitle (g, 0, "Alt: km");
 	SetAxisTitle (g, 1, "Vel: km/s");
-	AddPlot (g, g_Data.alt, g_Data.rvel, ndata, 1, &g_Data.sample);
+	if (tm) AddPlot (g, alt, tm->Data (g_Data.rvel), tm->Size(), 1, tm->Offset());
 
 	g = AddGraph ();
 	SetAxisTitle (g, 0, "Alt: km");
 	SetAxisTitle (g, 1, "Vel: km/s");
-	AddPlot (g, g_Data.alt, g_Data.tvel, ndata, 1, &g_Data.sample);
+	if (tm) AddPlot (g, alt, tm->Data (g_Data.tvel), tm->Size(), 1, tm->Offset());
 	AddPlot (g, ref_alt, ref_tvel, ndata, 5);
 
 	alt_auto = true;
@@ -146,6 +169,7 @@ AscentMFD::AscentMFD (DWORD w, DWORD h, VESSEL *vessel)
 
 AscentMFD::~AscentMFD ()
 {
+	if (tm) g_Data.store->Unsubscribe (hVessel);
 	delete []ref_alt;
 	delete []ref_tvel;
 }
@@ -231,10 +255,8 @@ void AscentMFD::Update (HDC hDC)
 	Title (hDC, "Ascent profile");
 
 	if (alt_auto) {
-		float altmin, altmax, tmp;
-		FindRange (g_Data.alt, ndata, altmin, altmax);
-		if (altmin > altmax)
-			tmp = altmin, altmin = altmax, altmax = tmp;
+		float altmin = 0.0f, altmax = 0.0f;
+		if (tm) tm->Range (g_Data.alt, altmin, altmax);
 		if (altmin == altmax)
 			altmin -= 0.5, altmax += 0.5;
 		SetRange (0, 1, altmin, altmax);
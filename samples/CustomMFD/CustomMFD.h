@@ -1,6 +1,8 @@
 #ifndef __CUSTOMMFD_H
 #define __CUSTOMMFD_H
 
+class TelemetrySeries;
+
 class AscentMFD: public GraphMFD {
 public:
 	AscentMFD (DWORD w, DWORD h, VESSEL *vessel);
@@ -22,6 +24,8 @@ public:
 private:
 	void InitReferences (void);
 	OBJHANDLE ref;
+	OBJHANDLE hVessel;    // vessel displayed by the MFD
+	TelemetrySeries *tm;  // shared telemetry of the vessel
 	double tgt_alt;
 	bool  alt_auto;
 	bool  vrad_auto, vtan_auto;
@@ -68,6 +68,22 @@ bool AAPSubsystem::clbkParseScenarioLine (const char *line)
 
 // --------------------------------------------------------------
 
+void AAPSubsystem::clbkSaveSnapshot (SnapshotWriter &snp)
+{
+	aap->SaveSnapshot (snp);
+}
+
+// --------------------------------------------------------------
+
+bool AAPSubsystem::clbkLoadSnapshot (SnapshotReader &snp)
+{
+	if (!aap->LoadSnapshot (snp)) return false;
+	DG()->TriggerPanelRedrawArea (0, ELID_AAP);
+	return true;
+}
+
+// --------------------------------------------------------------
+
 void AAPSubsystem::AttachHSI (InstrHSI *_hsi)
 {
 	aap->AttachHSI(_hsi);
@@ -289,6 +305,31 @@ void AAP::SetState (const char *str)
 	}
 }
 
+void AAP::SaveSnapshot (SnapshotWriter &snp) const
+{
+	for (int i = 0; i < 3; i++) {
+		snp.Put (active[i]);
+		snp.Put (tgt[i]);
+	}
+}
+
+bool AAP::LoadSnapshot (SnapshotReader &snp)
+{
+	int i;
+	bool act[3];
+	double val[3];
+	for (i = 0; i < 3; i++)
+		if (!snp.Get (act[i]) || !snp.Get (val[i])) return false;
+	for (i = 0; i < 3; i++) {
+		bool retarget = (active[i] && act[i] && tgt[i] != val[i]);
+		tgt[i] = val[i];
+		if (retarget) SetValue (i, tgt[i]);  // segment stays active: pass the new target to the script
+		else          SetActive (i, act[i]);
+	}
+	if (hsi) hsi->SetCrs (tgt[2]);
+	return true;
+}
+
 // ==============================================================
 
 void AAP::UpdateStr (char *str, char *pstr, int n, NTVERTEX *vtx)
@@ -38,6 +38,8 @@ public:
 	bool clbkLoadPanel2D (int panelid, PANELHANDLE hPanel, DWORD viewW, DWORD viewH);
 	void clbkSaveState (FILEHANDLE scn);
 	bool clbkParseScenarioLine (const char *line);
+	void clbkSaveSnapshot (SnapshotWriter &snp);
+	bool clbkLoadSnapshot (SnapshotReader &snp);
 	void AttachHSI (InstrHSI *_hsi);
 
 private:
@@ -57,6 +59,8 @@ public:
 	void AttachHSI (InstrHSI *_hsi) { hsi = _hsi; }
 	void WriteScenario (FILEHANDLE scn);
 	void SetState (const char *str);
+	void SaveSnapshot (SnapshotWriter &snp) const;
+	bool LoadSnapshot (SnapshotReader &snp);
 
 protected:
 	void ToggleActive (int block);
@@ -227,6 +227,9 @@ Airbrake::Airbrake (AerodynCtrlSubsystem *_subsys)
 		VC_AIRBRAKELEVER_ref, VC_AIRBRAKELEVER_axis, (float)(-40*RAD));
 	anim_airbrakelever = DG()->CreateAnimation(0.8);
 	DG()->AddAnimationComponent (anim_airbrakelever, 0, 1, &AirbrakeLeverTransform);
+
+	DG()->Actuators()->AddActuator (anim_brake, &brake_state, BrakeStep, this);
+	DG()->Actuators()->AddActuator (anim_airbrakelever, &lever_state, LeverStep, this);
 }
 
 // --------------------------------------------------------------
@@ -261,27 +264,23 @@ void Airbrake::Retract ()
 
 // --------------------------------------------------------------
 
-void Airbrake::clbkPostStep (double simt, double simdt, double mjd)
+void Airbrake::BrakeStep (int id, AnimState2 *state, void *context)
 {
-	// animate airbrake
-	if (brake_state.Process (simdt)) {
-		if (airbrake_tgt == 1) { // intermediate position
-			if ((brake_state.IsClosing() && brake_state.State() < 0.5) ||
-				(brake_state.IsOpening() && brake_state.State() > 0.5))
-				brake_state.SetState (0.5, 0.0);
-		}
-		DG()->SetAnimation (anim_brake, brake_state.State());
-		DG()->UpdateStatusIndicators();
-	}
+	// airbrake moved (animated by the actuator scheduler)
+	Airbrake *ab = (Airbrake*)context;
+	LeverStep (id, state, context);
+	ab->DG()->UpdateStatusIndicators();
+}
 
-	// animate airbrake lever
-	if (lever_state.Process (simdt)) {
-		if (airbrake_tgt == 1) { // intermediate position
-			if ((lever_state.IsClosing() && lever_state.State() < 0.5) ||
-				(lever_state.IsOpening() && lever_state.State() > 0.5))
-				lever_state.SetState (0.5, 0.0);
-		}
-		DG()->SetAnimation (anim_airbrakelever, lever_state.State());
+// --------------------------------------------------------------
+
+void Airbrake::LeverStep (int id, AnimState2 *state, void *context)
+{
+	Airbrake *ab = (Airbrake*)context;
+	if (ab->airbrake_tgt == 1) { // intermediate position
+		if ((state->IsClosing() && state->State() < 0.5) ||
+			(state->IsOpening() && state->State() > 0.5))
+			state->SetState (0.5, 0.0);
 	}
 }
 
@@ -341,6 +340,26 @@ bool Airbrake::clbkParseScenarioLine (const char *line)
 
 // --------------------------------------------------------------
 
+void Airbrake::clbkSaveSnapshot (SnapshotWriter &snp)
+{
+	brake_state.SaveSnapshot (snp);
+	lever_state.SaveSnapshot (snp);
+	snp.Put (airbrake_tgt);
+}
+
+// --------------------------------------------------------------
+
+bool Airbrake::clbkLoadSnapshot (SnapshotReader &snp)
+{
+	if (!brake_state.LoadSnapshot (snp) || !lever_state.LoadSnapshot (snp) || !snp.Get (airbrake_tgt))
+		return false;
+	clbkPostCreation ();
+	DG()->TriggerPanelRedrawArea (0, ELID_LEVER);
+	return true;
+}
+
+// --------------------------------------------------------------
+
 void Airbrake::clbkPostCreation ()
 {
 	DG()->SetAnimation (anim_brake, brake_state.State());
@@ -478,6 +497,23 @@ bool ElevatorTrim::clbkParseScenarioLine (const char *line)
 
 // --------------------------------------------------------------
 
+void ElevatorTrim::clbkSaveSnapshot (SnapshotWriter &snp)
+{
+	snp.Put (DG()->GetControlSurfaceLevel (AIRCTRL_ELEVATORTRIM));
+}
+
+// --------------------------------------------------------------
+
+bool ElevatorTrim::clbkLoadSnapshot (SnapshotReader &snp)
+{
+	double trim;
+	if (!snp.Get (trim)) return false;
+	DG()->SetControlSurfaceLevel (AIRCTRL_ELEVATORTRIM, trim, true);
+	return true;
+}
+
+// --------------------------------------------------------------
+
 bool ElevatorTrim::clbkLoadPanel2D (int panelid, PANELHANDLE hPanel, DWORD viewW, DWORD viewH)
 {
 	if (panelid != 0) return false;
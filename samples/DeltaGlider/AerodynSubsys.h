@@ -88,16 +88,20 @@ public:
 	void Retract ();
 	inline const AnimState2 &State() const { return brake_state; }
 	inline int TargetState() const { return airbrake_tgt; } // 0,1,2
-	void clbkPostStep (double simt, double simdt, double mjd);
 	bool clbkLoadPanel2D (int panelid, PANELHANDLE hPanel, DWORD viewW, DWORD viewH);
 	bool clbkLoadVC (int vcid);
 	void clbkSaveState (FILEHANDLE scn);
 	bool clbkParseScenarioLine (const char *line);
+	void clbkSaveSnapshot (SnapshotWriter &snp);
+	bool clbkLoadSnapshot (SnapshotReader &snp);
 	void clbkPostCreation ();
 	bool clbkPlaybackEvent (double simt, double event_t, const char *event_type, const char *event);
 	int clbkConsumeBufferedKey (DWORD key, bool down, char *kstate);
 
 private:
+	static void BrakeStep (int id, AnimState2 *state, void *context);
+	static void LeverStep (int id, AnimState2 *state, void *context);
+
 	AirbrakeLever *lever;
 	int ELID_LEVER;
 	int airbrake_tgt;
@@ -133,6 +137,8 @@ public:
 	ElevatorTrim (AerodynCtrlSubsystem *_subsys);
 	void clbkSaveState (FILEHANDLE scn);
 	bool clbkParseScenarioLine (const char *line);
+	void clbkSaveSnapshot (SnapshotWriter &snp);
+	bool clbkLoadSnapshot (SnapshotReader &snp);
 	bool clbkLoadPanel2D (int panelid, PANELHANDLE hPanel, DWORD viewW, DWORD viewH);
 	bool clbkLoadVC (int vcid);
 
@@ -16,6 +16,17 @@
 #include "meshres_vc.h"
 #include "dg_vc_anim.h"
 
+// thermal network parameters
+static const double TN_CABIN_CAP     = 2.0e5;  // cabin and avionics heat capacity [J/K]
+static const double TN_COOLANT_CAP   = 4.0e4;  // coolant loop heat capacity [J/K]
+static const double TN_RADIATOR_CAP  = 1.5e4;  // radiator panel heat capacity [J/K]
+static const double TN_HULL_CAP      = 8.0e5;  // hull heat capacity [J/K]
+static const double TN_CABIN_LOAD    = 2.5e3;  // avionics and crew heat load [W]
+static const double TN_RADIATOR_EPSA = 2.0*12.0*0.9; // radiator emitting area (2 faces) x emissivity [m^2]
+static const double TN_HULL_EPSA     = 110.0*0.8;    // hull emitting area x emissivity [m^2]
+static const double TN_HULL_ALPHAA   = 30.0*0.3;     // hull projected sunlit area x absorptivity [m^2]
+static const double SOLAR_FLUX_1AU   = 1361.0; // solar constant at 1 AU [W/m^2]
+
 // ==============================================================
 // Cooling subsystem
 // ==============================================================
@@ -48,6 +59,13 @@ const AnimState2 &CoolingSubsystem::RadiatorState() const
 	return radiatorctrl->State();
 }
 
+// --------------------------------------------------------------
+
+double CoolingSubsystem::CoolantTemp() const
+{
+	return radiatorctrl->CoolantTemp();
+}
+
 // ==============================================================
 // Radiator control
 // ==============================================================
@@ -78,6 +96,22 @@ RadiatorControl::RadiatorControl (CoolingSubsystem *_subsys)
 	DG()->AddAnimationComponent (anim_radiator, 0.25, 0.5, &Radiator);
 	DG()->AddAnimationComponent (anim_radiator, 0.5, 0.75, &RRadiator);
 	DG()->AddAnimationComponent (anim_radiator, 0.75, 1, &LRadiator);
+	DG()->Actuators()->AddActuator (anim_radiator, &radiator_state, RadiatorStep, this);
+
+	// Thermal network: the avionics are cooled by the coolant loop, which
+	// rejects heat through the radiator panels (when deployed) and the hull
+	tn_cabin    = thermal.AddNode (TN_CABIN_CAP, 293.0);
+	tn_coolant  = thermal.AddNode (TN_COOLANT_CAP, 285.0);
+	tn_radiator = thermal.AddNode (TN_RADIATOR_CAP, 280.0);
+	tn_hull     = thermal.AddNode (TN_HULL_CAP, 280.0);
+	thermal.AddConduction (tn_cabin, tn_coolant, 400.0);
+	thermal.AddConduction (tn_coolant, tn_radiator, 600.0);
+	thermal.AddConduction (tn_coolant, tn_hull, 60.0);
+	thermal.AddConduction (tn_cabin, tn_hull, 20.0);
+	thermal.SetHeatLoad (tn_cabin, TN_CABIN_LOAD);
+	thermal.SetEmitter (tn_hull, TN_HULL_EPSA);
+	thermal.SetAbsorber (tn_hull, TN_HULL_ALPHAA);
+	thermal.Setup ();
 
 }
 
@@ -137,25 +171,105 @@ void RadiatorControl::clbkPostCreation ()
 
 void RadiatorControl::clbkSaveState (FILEHANDLE scn)
 {
+	char cbuf[256];
 	radiator_state.SaveState (scn, "RADIATOR");
+	sprintf (cbuf, "%0.2f %0.2f %0.2f %0.2f", thermal.Temp (tn_cabin), thermal.Temp (tn_coolant),
+		thermal.Temp (tn_radiator), thermal.Temp (tn_hull));
+	oapiWriteScenario_string (scn, "THERMAL", cbuf);
 }
 
 // --------------------------------------------------------------
 
 bool RadiatorControl::clbkParseScenarioLine (const char *line)
 {
+	if (!_strnicmp (line, "THERMAL", 7)) {
+		double T[4];
+		if (sscanf (line+7, "%lf%lf%lf%lf", T+0, T+1, T+2, T+3) == 4) {
+			thermal.SetTemp (tn_cabin, T[0]);
+			thermal.SetTemp (tn_coolant, T[1]);
+			thermal.SetTemp (tn_radiator, T[2]);
+			thermal.SetTemp (tn_hull, T[3]);
+		}
+		return true;
+	}
 	return radiator_state.ParseScenarioLine (line, "RADIATOR");
 }
 
 // --------------------------------------------------------------
 
+void RadiatorControl::clbkSaveSnapshot (SnapshotWriter &snp)
+{
+	radiator_state.SaveSnapshot (snp);
+	snp.Put (thermal.Temp (tn_cabin));
+	snp.Put (thermal.Temp (tn_coolant));
+	snp.Put (thermal.Temp (tn_radiator));
+	snp.Put (thermal.Temp (tn_hull));
+}
+
+// --------------------------------------------------------------
+
+bool RadiatorControl::clbkLoadSnapshot (SnapshotReader &snp)
+{
+	double T[4];
+	if (!radiator_state.LoadSnapshot (snp) ||
+		!snp.Get (T[0]) || !snp.Get (T[1]) || !snp.Get (T[2]) || !snp.Get (T[3]))
+		return false;
+	thermal.SetTemp (tn_cabin, T[0]);
+	thermal.SetTemp (tn_coolant, T[1]);
+	thermal.SetTemp (tn_radiator, T[2]);
+	thermal.SetTemp (tn_hull, T[3]);
+	clbkPostCreation ();
+	sw->SetState (radiator_extend ? DGSwitch1::UP : DGSwitch1::DOWN);
+	DG()->TriggerRedrawArea (1, 0, ELID_SWITCH);
+	return true;
+}
+
+// --------------------------------------------------------------
+
+void RadiatorControl::RadiatorStep (int id, AnimState2 *state, void *context)
+{
+	((RadiatorControl*)context)->DG()->UpdateStatusIndicators();
+}
+
+// --------------------------------------------------------------
+
 void RadiatorControl::clbkPostStep (double simt, double simdt, double mjd)
 {
-	// animate radiator
-	if (radiator_state.Process (simdt)) {
-		DG()->SetAnimation (anim_radiator, radiator_state.State());
-		DG()->UpdateStatusIndicators();
+	// heat balance (the radiator is animated by the actuator scheduler)
+	UpdateThermalInputs ();
+	thermal.Step (simdt);
+}
+
+// --------------------------------------------------------------
+
+void RadiatorControl::UpdateThermalInputs ()
+{
+	// radiator emitting area scales with deployment
+	thermal.SetEmitter (tn_radiator, TN_RADIATOR_EPSA*radiator_state.State());
+
+	// sink temperature: ambient air inside an atmosphere, else deep space
+	double p = DG()->GetAtmPressure();
+	thermal.SetSpaceTemp (p > 1.0 ? DG()->GetAtmTemperature() : 3.0);
+
+	// solar flux, zero in the shadow of the reference body
+	VECTOR3 gpos, spos, ppos;
+	OBJHANDLE hSun = oapiGetGbodyByIndex (0);
+	OBJHANDLE hRef = DG()->GetSurfaceRef();
+	DG()->GetGlobalPos (gpos);
+	oapiGetGlobalPos (hSun, &spos);
+	VECTOR3 dsun = spos-gpos;
+	double dist = length (dsun);
+	double flux = SOLAR_FLUX_1AU * (AU*AU)/(dist*dist);
+	if (hRef && hRef != hSun) {
+		oapiGetGlobalPos (hRef, &ppos);
+		VECTOR3 dp = ppos-gpos;
+		double s = dotp (dp, dsun)/dist;     // projection of planet centre on sun direction
+		if (s > 0.0) {
+			double rad = oapiGetSize (hRef);
+			if (length (dp - dsun*(s/dist)) < rad) flux = 0.0;
+		}
 	}
+	thermal.SetIncidentFlux (flux);
 }
 
 // --------------------------------------------------------------
@@ -13,6 +13,7 @@
 
 #include "DGSubsys.h"
 #include "DGSwitches.h"
+#include "..\Common\Vessel\ThermalNet.h"
 
 // ==============================================================
 // Cooling subsystem
@@ -26,6 +27,7 @@ public:
 	void OpenRadiator ();
 	void CloseRadiator ();
 	const AnimState2 &RadiatorState() const;
+	double CoolantTemp() const;
 
 private:
 	RadiatorControl *radiatorctrl;
@@ -45,9 +47,12 @@ public:
 	void Revert ();
 	inline const AnimState2 &State() const { return radiator_state; }
 	inline bool GetRadiator () const { return radiator_extend; }
+	inline double CoolantTemp () const { return thermal.Temp (tn_coolant); }
 	void clbkPostCreation();
 	void clbkSaveState (FILEHANDLE scn);
 	bool clbkParseScenarioLine (const char *line);
+	void clbkSaveSnapshot (SnapshotWriter &snp);
+	bool clbkLoadSnapshot (SnapshotReader &snp);
 	void clbkPostStep (double simt, double simdt, double mjd);
 	bool clbkLoadPanel2D (int panelid, PANELHANDLE hPanel, DWORD viewW, DWORD viewH);
 	bool clbkLoadVC (int vcid);
@@ -56,11 +61,17 @@ public:
 	int clbkConsumeBufferedKey (DWORD key, bool down, char *kstate);
 
 private:
+	static void RadiatorStep (int id, AnimState2 *state, void *context);
+
 	bool radiator_extend;
 	AnimState2 radiator_state;
 	RadiatorSwitch *sw;
 	int ELID_SWITCH;
 	UINT anim_radiator;         // handle for radiator animation
+
+	void UpdateThermalInputs ();
+	ThermalNetwork thermal;     // cabin/coolant loop heat balance
+	int tn_cabin, tn_coolant, tn_radiator, tn_hull; // network nodes
 };
 
 // ==============================================================
@@ -22,6 +22,8 @@
 #include "AvionicsSubsys.h"
 #include "MfdSubsys.h"
 #include "ScnEditorAPI.h"
+#include "..\Common\Vessel\VesselMsg.h"
+#include "..\Common\Vessel\FlightRec.h"
 #include "PressureSubsys.h"
 #include "CoolingSubsys.h"
 #include "LightSubsys.h"
@@ -48,6 +50,18 @@ static HELPCONTEXT g_hc = {
 	"html/vessels/deltaglider.chm::/deltaglider.hhk"
 };
 
+static const double FLIGHTREC_DT = 1.0;  // binary recording state sample interval [s]
+
+// Binary recording of all DG instances in the session, open while any
+// of them is being recorded by Orbiter
+static FlightRecorder g_flightrec;
+static int g_flightrec_nvessel = 0;      // number of instances being recorded
+
+// HUD marker element masks (in order of definition in DefineHUDGeometry)
+static const DWORD HUDELEM_GEAR     = 0x1;
+static const DWORD HUDELEM_NOSECONE = 0x2;
+static const DWORD HUDELEM_AIRBRAKE = 0x4;
+
 static const DWORD ntdvtx_geardown = 13;
 static TOUCHDOWNVTX tdvtx_geardown[ntdvtx_geardown] = {
 	{_V( 0   ,-2.57,10   ), 1e6, 1e5, 1.6, 0.1},
@@ -65,6 +79,24 @@ static TOUCHDOWNVTX tdvtx_geardown[ntdvtx_geardown] = {
 	{_V( 0   ,-0.6 ,10.65), 1e7, 1e5, 3.0}
 };
 
+// gear down, with the gear contact model enabled: the wheel points act as
+// bump stops at the static strut compression
+static TOUCHDOWNVTX tdvtx_geardown_strut[ntdvtx_geardown] = {
+	{_V( 0   ,-2.57+GEAR_STATIC_SAG,10   ), 1e6, 1e5, 1.6, 0.1},
+	{_V(-3.5 ,-2.57+GEAR_STATIC_SAG,-1   ), 1e6, 1e5, 3.0, 0.2},
+	{_V( 3.5 ,-2.57+GEAR_STATIC_SAG,-1   ), 1e6, 1e5, 3.0, 0.2},
+	{_V(-8.5 ,-0.3 ,-7.05), 1e7, 1e5, 3.0},
+	{_V( 8.5 ,-0.3 ,-7.05), 1e7, 1e5, 3.0},
+	{_V(-8.5 ,-0.4 ,-3   ), 1e7, 1e5, 3.0},
+	{_V( 8.5 ,-0.4 ,-3   ), 1e7, 1e5, 3.0},
+	{_V(-8.85, 2.3 ,-5.05), 1e7, 1e5, 3.0},
+	{_V( 8.85, 2.3 ,-5.05), 1e7, 1e5, 3.0},
+	{_V(-8.85, 2.3 ,-7.05), 1e7, 1e5, 3.0},
+	{_V( 8.85, 2.3 ,-7.05), 1e7, 1e5, 3.0},
+	{_V( 0   , 2   , 6.2 ), 1e7, 1e5, 3.0},
+	{_V( 0   ,-0.6 ,10.65), 1e7, 1e5, 3.0}
+};
+
 static const DWORD ntdvtx_gearup = 13;
 static TOUCHDOWNVTX tdvtx_gearup[ntdvtx_gearup] = {
 	{_V( 0   ,-1.5 ,9),     1e7, 1e5, 3.0, 3.0},
@@ -130,6 +162,15 @@ void HLiftCoeff (VESSEL *v, double beta, double M, double Re, void *context, dou
 	*cd = 0.015 + oapiGetInducedDrag (*cl, 1.5, 0.6) + oapiGetWaveDrag (M, 0.75, 1.0, 1.1, 0.04);
 }
 
+// ==============================================================
+// Failure model callbacks
+// ==============================================================
+
+static void DGStructuralFailure (void *context, int id, double rate)
+{
+	((DeltaGlider*)context)->StructuralFailure (rate);
+}
+
 // ==============================================================
 // Specialised vessel class DeltaGlider
 // ==============================================================
@@ -171,6 +212,8 @@ DeltaGlider::DeltaGlider (OBJHANDLE hObj, int fmodel)
 	panelcol          = 0;
 	campos            = CAM_GENERIC;
 	th_main_level     = 0.0;
+	flightrec_on      = false;
+	flightrec_tsample = 0.0;
 	skinpath[0] = '\0';
 	for (i = 0; i < 3; i++)
 		skin[i] = 0;
@@ -189,7 +232,18 @@ DeltaGlider::DeltaGlider (OBJHANDLE hObj, int fmodel)
 	lwingstatus = rwingstatus = 1.0;
 	for (i = 0; i < 4; i++) aileronfail[i] = false;
 
+	// airframe failure conditions: wingload stress or excessive dynamic
+	// pressure
+	fm_load = failmodel.AddInput ();
+	fm_dynp = failmodel.AddInput ();
+	if (bDamageEnabled) {
+		failmodel.AddHazard (fm_load, WINGLOAD_MAX, true,  0.0, 5e-5, DGStructuralFailure, this);
+		failmodel.AddHazard (fm_load, WINGLOAD_MIN, false, 0.0, 5e-5, DGStructuralFailure, this);
+		failmodel.AddHazard (fm_dynp, DYNP_MAX,     true,  0.0, 1e-5, DGStructuralFailure, this);
+	}
+
 	DefineAnimations();
+	DefineHUDGeometry();
 }
 
 // --------------------------------------------------------------
@@ -203,6 +257,9 @@ DeltaGlider::~DeltaGlider ()
 
 	for (i = 0; i < 3; i++)
 		if (skin[i]) oapiReleaseTexture (skin[i]);
+
+	if (flightrec_on && !--g_flightrec_nvessel)
+		g_flightrec.Close ();
 }
 
 // --------------------------------------------------------------
@@ -218,6 +275,71 @@ void DeltaGlider::SetEmptyMass () const
 	ComponentVessel::SetEmptyMass (emass);
 }
 
+// --------------------------------------------------------------
+// Define the retained geometry for vessel-specific HUD markers
+// --------------------------------------------------------------
+void DeltaGlider::DefineHUDGeometry ()
+{
+	static float texw = 512.0f, texh = 256.0f;
+	int i;
+
+	// gear deployment indicator
+	NTVERTEX vgear[12];
+	static WORD igear[18] = {
+		0,3,1, 3,0,2,
+		4,7,5, 7,4,6,
+		8,11,9, 11,8,10
+	};
+	float x[12] = {-4,-2,-4,-2,2,4,2,4,-1,1,-1,1};
+	float y[12] = {-2,-2,-4,-4,-2,-2,-4,-4,-6,-6,-8,-8};
+	for (i = 0; i < 12; i++) {
+		vgear[i].x = x[i];
+		vgear[i].y = y[i];
+		vgear[i].tu = (405.0f + (18.0f * (i%2)))/texw;
+		vgear[i].tv = (104.0f - (18.0f * ((i%4)/2)))/texh;
+	}
+	hudgeom.AddElement (vgear, 12, igear, 18);
+
+	// nosecone indicator
+	NTVERTEX vnose[16];
+	static WORD inose[36] = {
+		0,1,2, 2,3,0,
+		0,6,1, 6,7,1,
+		1,8,2, 8,9,2,
+		2,10,3, 10,11,3,
+		3,4,0, 0,4,5,
+		12,15,13, 12,14,15
+	};
+	float xn[16] = {0,1,0,-1,-31,-30,30,31,31,30,-30,-31,  -13,13,-13,13};
+	float yn[16] = {-1,0,1,0,-30,-31,-31,-30,30,31,31,30,  -25,-25,-28.9f,-28.9f};
+	float un[16] = {392.5f, 397.0f, 392.5f, 388.0f, 388.0f, 392.5f, 392.5f, 397.0f, 397.0f, 392.5f, 392.5f, 388.0f,    124.0f, 204.0f, 124.0f, 204.0f};
+	float vn[16] = {92.0f, 96.5f, 101.0f, 96.5f, 96.5f, 92.0f, 92.0f, 96.5f, 96.5f, 101.0f, 101.0f, 96.5f,             118.0f, 118.0f, 106.0f, 106.0f};
+	for (i = 0; i < 16; i++) {
+		vnose[i].x = xn[i];
+		vnose[i].y = yn[i];
+		vnose[i].tu = un[i]/texw;
+		vnose[i].tv = vn[i]/texh;
+	}
+	hudgeom.AddElement (vnose, 16, inose, 36, 0.4f);
+
+	// airbrake indicator
+	NTVERTEX vbrk[4];
+	static WORD ibrk[6] = {
+		0,3,1, 0,2,3
+	};
+	float xb[4] = {-9.1f, 9.1f, -9.1f, 9.1f};
+	float yb[4] = {-30.0f, -30.0f, -33.9f, -33.9f};
+	float ub[4] = {205.0f, 261.0f, 205.0f, 261.0f};
+	float vb[4] = {118.0f, 118.0f, 106.0f, 106.0f};
+	for (i = 0; i < 4; i++) {
+		vbrk[i].x = xb[i];
+		vbrk[i].y = yb[i];
+		vbrk[i].tu = ub[i]/texw;
+		vbrk[i].tv = vb[i]/texh;
+	}
+	hudgeom.AddElement (vbrk, 4, ibrk, 6, 0.4f);
+}
+
 // --------------------------------------------------------------
 // Define animation sequences for moving parts
 // --------------------------------------------------------------
@@ -377,8 +499,9 @@ bool DeltaGlider::clbkDrawHUD (int mode, const HUDPAINTSPEC *hps, oapi::Sketchpa
 				skp->Line (cx-d,cy+d,cx+d,cy-d);
 			}
 			char *str = "NOSECONE";
-			int w = skp->GetTextWidth (str);
-			skp->Text (cx-w/2, cy-d, str, 8);
+			skp->SetTextAlign (oapi::Sketchpad::CENTER);
+			skp->Text (cx, cy-d, str, 8);
+			skp->SetTextAlign (oapi::Sketchpad::LEFT);
 		}
 	}
 	return true;
@@ -388,110 +511,33 @@ void DeltaGlider::clbkRenderHUD (int mode, const HUDPAINTSPEC *hps, SURFHANDLE h
 {
 	ComponentVessel::clbkRenderHUD (mode, hps, hTex);
 
-	static float texw = 512.0f, texh = 256.0f;
-	float cx = (float)hps->CX, cy = (float)hps->CY;
-	int i, nvtx = 0, nidx = 0;
-	static NTVERTEX vtx[12+16+4];
-	static WORD idx[18+36+6];
-	static float scl = 0;
-	static NTVERTEX vgear[12];
-	static NTVERTEX vnose[16];
-	static NTVERTEX vbrk[4];
-	static WORD igear[18] = {
-		0,3,1, 3,0,2,
-		4,7,5, 7,4,6,
-		8,11,9, 11,8,10
-	};
-	static WORD inose[36] = {
-		0,1,2, 2,3,0,
-		0,6,1, 6,7,1,
-		1,8,2, 8,9,2,
-		2,10,3, 10,11,3,
-		3,4,0, 0,4,5,
-		12,15,13, 12,14,15
-	};
-	static WORD ibrk[6] = {
-		0,3,1, 0,2,3
-	};
-
-	if (scl != hps->Markersize*0.25f) { // resize
-		scl = hps->Markersize*0.25f;
-		memset (vgear, 0, 12*sizeof(NTVERTEX));
-		float x[12] = {-4,-2,-4,-2,2,4,2,4,-1,1,-1,1};
-		float y[12] = {-2,-2,-4,-4,-2,-2,-4,-4,-6,-6,-8,-8};
-		for (i = 0; i < 12; i++) {
-			vgear[i].x = cx + x[i]*scl;
-			vgear[i].y = cy + y[i]*scl;
-			vgear[i].tu = (405.0f + (18.0f * (i%2)))/texw;
-			vgear[i].tv = (104.0f - (18.0f * ((i%4)/2)))/texh;
-		}
-		memset (vnose, 0, 16*sizeof(NTVERTEX));
-		float xn[16] = {0,1,0,-1,-31,-30,30,31,31,30,-30,-31,  -13,13,-13,13};
-		float yn[16] = {-1,0,1,0,-30,-31,-31,-30,30,31,31,30,  -25,-25,-28.9,-28.9};
-		float un[16] = {392.5f, 397.0f, 392.5f, 388.0f, 388.0f, 392.5f, 392.5f, 397.0f, 397.0f, 392.5f, 392.5f, 388.0f,    124.0f, 204.0f, 124.0f, 204.0f};
-		float vn[16] = {92.0f, 96.5f, 101.0f, 96.5f, 96.5f, 92.0f, 92.0f, 96.5f, 96.5f, 101.0f, 101.0f, 96.5f,             118.0f, 118.0f, 106.0f, 106.0f};
-		for (i = 0; i < 16; i++) {
-			vnose[i].x = cx + xn[i]*scl*0.4f;
-			vnose[i].y = cy + yn[i]*scl*0.4f;
-			vnose[i].tu = un[i]/texw;
-			vnose[i].tv = vn[i]/texh;
-		}
-		memset (vbrk, 0, 4*sizeof(NTVERTEX));
-		float xb[4] = {-9.1f, 9.1f, -9.1f, 9.1f};
-		float yb[4] = {-30.0f, -30.0f, -33.9f, -33.9f};
-		float ub[4] = {205.0f, 261.0f, 205.0f, 261.0f};
-		float vb[4] = {118.0f, 118.0f, 106.0f, 106.0f};
-		for (i = 0; i < 4; i++) {
-			vbrk[i].x = cx + xb[i]*scl*0.4f;
-			vbrk[i].y = cy + yb[i]*scl*0.4f;
-			vbrk[i].tu = ub[i]/texw;
-			vbrk[i].tv = vb[i]/texh;
-		}
-	}
+	DWORD mask = 0;
+	double tmp;
 
 	// show gear deployment status
-	if (ssys_gear->GearState().IsOpen() || (!ssys_gear->GearState().IsClosed() && fmod (oapiGetSimTime(), 1.0) < 0.5)) {
-		memcpy (vtx+nvtx, vgear, 12*sizeof(NTVERTEX));
-		for (i = 0; i < 18; i++) idx[nidx+i] = igear[i]+nvtx;
-		nvtx += 12;
-		nidx += 18;
-	}
+	if (ssys_gear->GearState().IsOpen() || (!ssys_gear->GearState().IsClosed() && fmod (oapiGetSimTime(), 1.0) < 0.5))
+		mask |= HUDELEM_GEAR;
 
 	// show nosecone status
 	if (oapiGetHUDMode() == HUD_DOCKING && !ssys_docking->NconeState().IsOpen()) {
-		double tmp;
-		if (ssys_docking->NconeState().IsClosed() || modf (oapiGetSimTime(), &tmp) < 0.5) {
-			memcpy (vtx+nvtx, vnose, 16*sizeof(NTVERTEX));
-			for (i = 0; i < 36; i++) idx[nidx+i] = inose[i]+nvtx;
-			nvtx += 16;
-			nidx += 36;
-		}
+		if (ssys_docking->NconeState().IsClosed() || modf (oapiGetSimTime(), &tmp) < 0.5)
+			mask |= HUDELEM_NOSECONE;
 	}
 
 	// show airbrake status
 	if (!ssys_aerodyn->AirbrakeState().IsClosed()) {
-		double tmp;
-		if (ssys_aerodyn->AirbrakeState().IsOpen() || modf (oapiGetSimTime(), &tmp) < 0.5) {
-			memcpy (vtx+nvtx, vbrk, 4*sizeof(NTVERTEX));
-			for (i = 0; i < 6; i++) idx[nidx+i] = ibrk[i]+nvtx;
-			nvtx += 4;
-			nidx += 6;
-		}
+		if (ssys_aerodyn->AirbrakeState().IsOpen() || modf (oapiGetSimTime(), &tmp) < 0.5)
+			mask |= HUDELEM_AIRBRAKE;
 	}
 
-	if (nvtx) {
-		MESHGROUP grp = {vtx, idx, nvtx, nidx, 0, 0, 0, 0, 0};
-		MESHHANDLE hmesh = oapiCreateMesh (1, &grp);
-		oapiRenderHUD (hmesh, &hTex);
-		oapiDeleteMesh (hmesh);
-	}
+	hudgeom.Render ((float)hps->CX, (float)hps->CY, hps->Markersize*0.25f, mask, &hTex);
 }
 
 void DeltaGlider::SetGearParameters (double state)
 {
 	if (state == 1.0) {
 		if (!bGearIsDown) {
-			SetTouchdownPoints (tdvtx_geardown, ntdvtx_geardown);
+			SetTouchdownPoints (ssys_gear->ContactModel() ? tdvtx_geardown_strut : tdvtx_geardown, ntdvtx_geardown);
 			SetNosewheelSteering (true);
 			bGearIsDown = true;
 		}
@@ -531,52 +577,43 @@ double DeltaGlider::GetMaxHoverThrust () const
 
 void DeltaGlider::TestDamage ()
 {
-	bool newdamage = false;
-	double dt = oapiGetSimStep();
-
-	// airframe damage as a result of wingload stress
-	// or excessive dynamic pressure
-
-	double load = GetLift() / 190.0; // L/S
-	double dynp = GetDynPressure();  // dynamic pressure
-	if (load > WINGLOAD_MAX || load < WINGLOAD_MIN || dynp > DYNP_MAX) {
-		double alpha = max ((dynp-DYNP_MAX) * 1e-5,
-			(load > 0 ? load-WINGLOAD_MAX : WINGLOAD_MIN-load) * 5e-5);
-		double p = 1.0 - exp (-alpha*dt); // probability of failure
-		if (oapiRand() < p) {
-			// simulate structural failure by distorting the airfoil definition
-			int rfail = rand();
-			switch (rfail & 3) {
-			case 0: // fail left wing
-				lwingstatus *= exp (-alpha*oapiRand());
-				break;
-			case 1: // fail right wing
-				rwingstatus *= exp (-alpha*oapiRand());
-				break;
-			case 2: { // fail left aileron
-				if (hlaileron) {
-					DelControlSurface (hlaileron);
-					hlaileron = NULL;
-				}
-				aileronfail[rfail&4?0:1] = true;
-				} break;
-			case 3: { // fail right aileron
-				if (hraileron) {
-					DelControlSurface (hraileron);
-					hraileron = NULL;
-				}
-				aileronfail[rfail&4?2:3] = true;
-				} break;
-			}
-			newdamage = true;
+	// update the monitored inputs; failure conditions are only evaluated
+	// while an input is beyond one of its thresholds
+	failmodel.SetInput (fm_load, GetLift() / 190.0); // L/S
+	failmodel.SetInput (fm_dynp, GetDynPressure());  // dynamic pressure
+	failmodel.Advance (oapiGetSimTime(), oapiGetSimStep());
+}
+
+void DeltaGlider::StructuralFailure (double alpha)
+{
+	// simulate structural failure by distorting the airfoil definition
+	int rfail = rand();
+	switch (rfail & 3) {
+	case 0: // fail left wing
+		lwingstatus *= exp (-alpha*oapiRand());
+		break;
+	case 1: // fail right wing
+		rwingstatus *= exp (-alpha*oapiRand());
+		break;
+	case 2: { // fail left aileron
+		if (hlaileron) {
+			DelControlSurface (hlaileron);
+			hlaileron = NULL;
 		}
+		aileronfail[rfail&4?0:1] = true;
+		} break;
+	case 3: { // fail right aileron
+		if (hraileron) {
+			DelControlSurface (hraileron);
+			hraileron = NULL;
+		}
+		aileronfail[rfail&4?2:3] = true;
+		} break;
 	}
 
-	if (newdamage) {
-		ssys_failure->MWSActivate();
-		ApplyDamage ();
-		//UpdateDamageDialog (this);
-	}
+	ssys_failure->MWSActivate();
+	ApplyDamage ();
+	//UpdateDamageDialog (this);
 }
 
 void DeltaGlider::ApplyDamage ()
@@ -849,6 +886,8 @@ void DeltaGlider::clbkSetClassCaps (FILEHANDLE cfg)
 	int i;
 	if (oapiReadItem_bool (cfg, "SCRAMJET", b) && b) // set up scramjet configuration
 		AddSubsystem (ssys_scram = new ScramSubsystem (this));
+	if (oapiReadItem_bool (cfg, "GEAR_CONTACT_MODEL", b) && b) // use strut contact model for the landing gear
+		ssys_gear->EnableContactModel (true);
 
 	ComponentVessel::SetEmptyMass (ssys_scram ? EMPTY_MASS_SC : EMPTY_MASS);
 	VECTOR3 r[2] = {{0,0,6}, {0,0,-4}};
@@ -864,7 +903,7 @@ void DeltaGlider::clbkSetClassCaps (FILEHANDLE cfg)
 	SetPMI (_V(15.5,22.1,7.7));
 
 	SetDockParams (_V(0,-0.49,10.076), _V(0,0,1), _V(0,1,0));
-	SetTouchdownPoints (tdvtx_geardown, ntdvtx_geardown);
+	SetTouchdownPoints (ssys_gear->ContactModel() ? tdvtx_geardown_strut : tdvtx_geardown, ntdvtx_geardown);
 	SetNosewheelSteering (true);
 	bGearIsDown = true;
 	EnableTransponder (true);
@@ -1149,6 +1188,86 @@ void DeltaGlider::clbkSaveState (FILEHANDLE scn)
 		oapiWriteScenario_int (scn, "TANKCONFIG", tankconfig);
 }
 
+// --------------------------------------------------------------
+// Write binary snapshot
+// --------------------------------------------------------------
+void DeltaGlider::clbkSaveSnapshot (SnapshotWriter &snp)
+{
+	int i;
+
+	// damage state and passengers
+	snp.BeginSection (SNAPSHOT_TAG('D','G','L','D'));
+	snp.Put (lwingstatus);
+	snp.Put (rwingstatus);
+	for (i = 0; i < 4; i++) snp.Put (aileronfail[i]);
+	for (i = 0; i < 4; i++) snp.Put (psngr[i]);
+	failmodel.SaveSnapshot (snp);
+	snp.EndSection ();
+
+	// subsystem states
+	ComponentVessel::clbkSaveSnapshot (snp);
+}
+
+// --------------------------------------------------------------
+// Restore binary snapshot
+// --------------------------------------------------------------
+bool DeltaGlider::clbkLoadSnapshot (SnapshotReader &snp)
+{
+	int i;
+	WORD version;
+	double lw, rw;
+	bool af[4], ps[4], res = false;
+
+	if (snp.BeginSection (SNAPSHOT_TAG('D','G','L','D'), version)) {
+		if (version == 1) {
+			res = snp.Get (lw) && snp.Get (rw);
+			for (i = 0; i < 4 && res; i++) res = snp.Get (af[i]);
+			for (i = 0; i < 4 && res; i++) res = snp.Get (ps[i]);
+			res = res && failmodel.LoadSnapshot (snp);
+		}
+		snp.EndSection ();
+	}
+	if (res) {
+		lwingstatus = lw;
+		rwingstatus = rw;
+		for (i = 0; i < 4; i++) {
+			aileronfail[i] = af[i];
+			psngr[i] = ps[i];
+		}
+
+		// failed ailerons have no control surface
+		if (aileronfail[0] || aileronfail[1]) {
+			if (hlaileron) {
+				DelControlSurface (hlaileron);
+				hlaileron = NULL;
+			}
+		} else if (!hlaileron)
+			hlaileron = CreateControlSurface3 (AIRCTRL_AILERON, 0.3, 1.7, _V( 7.5,0,-7.2), AIRCTRL_AXIS_XPOS, 1.0, anim_raileron);
+		if (aileronfail[2] || aileronfail[3]) {
+			if (hraileron) {
+				DelControlSurface (hraileron);
+				hraileron = NULL;
+			}
+		} else if (!hraileron)
+			hraileron = CreateControlSurface3 (AIRCTRL_AILERON, 0.3, 1.7, _V(-7.5,0,-7.2), AIRCTRL_AXIS_XNEG, 1.0, anim_laileron);
+
+		if (lwingstatus < 1 || rwingstatus < 1 || !(hlaileron && hraileron))
+			ssys_failure->MWSActivate();
+		else
+			ssys_failure->MWSReset();
+		ApplyDamage ();
+		SetPassengerVisuals ();
+		SetEmptyMass ();
+	}
+
+	// subsystem states
+	if (!ComponentVessel::clbkLoadSnapshot (snp)) res = false;
+
+	UpdateStatusIndicators ();
+	UpdateCtrlDialog (this);
+	return res;
+}
+
 // --------------------------------------------------------------
 // Finalise vessel creation
 // --------------------------------------------------------------
@@ -1300,11 +1419,49 @@ void DeltaGlider::clbkPostStep (double simt, double simdt, double mjd)
 	th_main_level = GetThrusterGroupLevel (THGROUP_MAIN);
 
 	// damage/failure system
-	if (bDamageEnabled) TestDamage ();
+	TestDamage ();
+
+	UpdateFlightRec (simt);
 
 	ComponentVessel::clbkPostStep (simt, simdt, mjd);
 }
 
+// --------------------------------------------------------------
+// Record an event with Orbiter's recorder and the binary recording
+// --------------------------------------------------------------
+void DeltaGlider::RecordEvent (const char *event_type, const char *event) const
+{
+	VESSEL::RecordEvent (event_type, event);
+	if (flightrec_on && g_flightrec.IsOpen())
+		g_flightrec.Event (oapiGetSimTime(), GetName(), event_type, event);
+}
+
+// --------------------------------------------------------------
+// Join and leave the session's binary recording
+// (Flights\DeltaGlider.frec) with Orbiter's flight recorder, and
+// record state samples. The file is opened when the first DG starts
+// recording and closed when the last one stops, so that a single
+// FlightPlayer can play back all of them.
+// --------------------------------------------------------------
+void DeltaGlider::UpdateFlightRec (double simt)
+{
+	bool rec = Recording();
+	if (rec != flightrec_on) {
+		flightrec_on = rec;
+		if (rec) {
+			if (!g_flightrec_nvessel++)
+				g_flightrec.Open ("Flights\\DeltaGlider.frec");
+			flightrec_tsample = simt;
+		} else if (!--g_flightrec_nvessel) {
+			g_flightrec.Close ();
+		}
+	}
+	if (flightrec_on && g_flightrec.IsOpen() && simt >= flightrec_tsample) {
+		g_flightrec.Sample (simt, this, GetGravityRef());
+		flightrec_tsample = simt + FLIGHTREC_DT;
+	}
+}
+
 bool DeltaGlider::clbkLoadGenericCockpit ()
 {
 	SetCameraOffset (_V(0,1.467,6.782));
@@ -1404,7 +1561,9 @@ bool DeltaGlider::clbkPanelRedrawEvent (int id, int event, SURFHANDLE surf, void
 {
 	if (context) {
 		PanelElement *pe = (PanelElement*)context;
-		return pe->Redraw2D (surf);
+		bool redraw = pe->Redraw2D (surf);
+		bltbatch.Flush();
+		return redraw;
 	}
 
 	return false;
@@ -1527,8 +1686,11 @@ bool DeltaGlider::clbkVCRedrawEvent (int id, int event, SURFHANDLE surf)
 		return RedrawPanel_ScramTempDisp (surf);
 	}
 
-	// distribute to subsystems
-	return ComponentVessel::clbkVCRedrawEvent (id, event, vcmesh, surf);
+	// distribute to subsystems; blits queued by the panel elements
+	// are submitted before the surface is handed back
+	bool redraw = ComponentVessel::clbkVCRedrawEvent (id, event, vcmesh, surf);
+	bltbatch.Flush();
+	return redraw;
 }
 
 // --------------------------------------------------------------
@@ -1556,8 +1718,14 @@ int DeltaGlider::clbkGeneric (int msgid, int prm, void *context)
 		return Lua_InitInterpreter (context);
 	case VMSG_LUAINSTANCE:
 		return Lua_InitInstance (context);
+	case TELEM_VMSG:
+		// vessel-defined telemetry values: [0] coolant loop temperature [K]
+		if (prm == VMSGSDK_QUERY) return VMSGSDK_MAGIC;
+		if (prm < 1) return 0;
+		((double*)context)[0] = ssys_cooling->CoolantTemp();
+		return 1;
 	}
-	return 0;
+	return ComponentVessel::clbkGeneric (msgid, prm, context);
 }
 
 
@@ -22,6 +22,9 @@
 
 #include "orbitersdk.h"
 #include "..\Common\Vessel\Instrument.h"
+#include "..\Common\Vessel\HudGeometry.h"
+#include "..\Common\Vessel\BltBatch.h"
+#include "..\Common\Vessel\FailureModel.h"
 
 // ==============================================================
 // Some vessel class caps
@@ -63,6 +66,13 @@ const double GEAR_OPERATING_SPEED = 0.15;
 // Opening/closing speed of landing gear (1/sec)
 // => gear cycle ~ 6.7 sec
 
+const double GEAR_STATIC_SAG = 0.15;
+// Strut compression at which the touchdown points take over when the
+// gear contact model is enabled [m]
+
+const double GEAR_STEER_RANGE = 30.0*RAD;
+// Max. nosewheel steering angle for the gear contact model [rad]
+
 const double NOSE_OPERATING_SPEED = 0.05;
 // Opening/closing speed of nose cone docking mechanism (1/sec)
 // => cycle = 20 sec
@@ -181,6 +191,7 @@ public:
 	short FlightModel() const { return flightmodel; }
 	void SetEmptyMass () const;
 	void DefineAnimations ();
+	void DefineHUDGeometry ();
 	void InitPanel (int panel);
 	void InitVC (int vc);
 	inline bool ScramVersion() const { return ssys_scram != NULL; }
@@ -204,19 +215,26 @@ public:
 	void   SetMainRetroLevel (int which, double lmain, double lretro);
 	void   EnableRetroThrusters (bool state);
 	void   GetMainThrusterDir (int which, VECTOR3 &dir) const { GetThrusterDir(th_main[which], dir); }
+	void   GetMainThrusterRef (int which, VECTOR3 &pos) const { GetThrusterRef(th_main[which], pos); }
 	void   SetMainThrusterDir (int which, const VECTOR3 &dir) { SetThrusterDir(th_main[which], dir); }
 	double GetHoverThrusterLevel (int th) const { return GetThrusterLevel(th_hover[th]); }
 	void   SetHoverThrusterLevel (int th, double lvl) { SetThrusterLevel(th_hover[th], lvl); }
 	double GetMaxHoverThrust () const;
 
 	void TestDamage ();
+	void StructuralFailure (double alpha);
 	void ApplyDamage ();
 	void RepairDamage ();
 
+	// Hides VESSEL::RecordEvent: also writes the event to the binary recording
+	void RecordEvent (const char *event_type, const char *event) const;
+
 	// Overloaded callback functions
 	void clbkSetClassCaps (FILEHANDLE cfg);
 	void clbkLoadStateEx (FILEHANDLE scn, void *vs);
 	void clbkSaveState (FILEHANDLE scn);
+	void clbkSaveSnapshot (SnapshotWriter &snp);
+	bool clbkLoadSnapshot (SnapshotReader &snp);
 	void clbkPostCreation ();
 	void clbkVisualCreated (VISHANDLE vis, int refcount);
 	void clbkVisualDestroyed (VISHANDLE vis, int refcount);
@@ -246,6 +264,8 @@ public:
 	// parameters for failure modelling
 	double lwingstatus, rwingstatus;
 	bool aileronfail[4];
+	FailureModel failmodel;     // failure conditions of all subsystems
+	int fm_load, fm_dynp;       // failure model inputs: wing load, dynamic pressure
 
 	void SetGearParameters (double state);
 
@@ -284,6 +304,8 @@ public:
 	inline PressureSubsystem *SubsysPressure() { return ssys_pressurectrl; }
 	inline CoolingSubsystem *SubsysCooling() { return ssys_cooling; }
 	inline LightCtrlSubsystem *SubsysLights() { return ssys_light; }
+	inline FailureModel &FailModel() { return failmodel; }
+	inline BltBatch &BltQueue() { return bltbatch; }
 
 	// script interface-related methods
 	int Lua_InitInterpreter (void *context);
@@ -292,6 +314,7 @@ public:
 private:
 	void ApplySkin();                            // apply custom skin
 	void PaintMarkings (SURFHANDLE tex);         // paint individual vessel markings
+	void UpdateFlightRec (double simt);          // follow Orbiter's recorder state
 
 	// Vessel subsystems -------------------------------------------------------------
 	HUDControl           *ssys_hud;              // HUD control system
@@ -325,6 +348,10 @@ private:
 	AIRFOILHANDLE hwing;                         // airfoil handle for wings
 	CTRLSURFHANDLE hlaileron, hraileron;         // control surface handles
 	int panelcol;                                // panel light colour index, 0=default
+	HUDGeometry hudgeom;                         // retained HUD marker mesh
+	BltBatch bltbatch;                           // panel element blits, submitted after each redraw event
+	bool flightrec_on;                           // Orbiter recorder state at the last step (see g_flightrec)
+	double flightrec_tsample;                    // time of the next recorded state sample [s]
 
 	int mainflowidx[2], retroflowidx[2], hoverflowidx, scflowidx[2];
 	int mainTSFCidx, scTSFCidx[2];
@@ -128,6 +128,8 @@ NoseconeCtrl::NoseconeCtrl (DockingCtrlSubsystem *_subsys)
 	anim_noselever = DG()->CreateAnimation (0.5);
 	DG()->AddAnimationComponent (anim_noselever, 0, 1, &NoseconeLeverTransform);
 
+	DG()->Actuators()->AddActuator (anim_nose, &ncone_state, NconeStep, this);
+	DG()->Actuators()->AddActuator (anim_noselever, &nlever_state);
 }
 
 // --------------------------------------------------------------
@@ -176,19 +178,11 @@ void NoseconeCtrl::RevertNcone ()
 
 // --------------------------------------------------------------
 
-void NoseconeCtrl::clbkPostStep (double simt, double simdt, double mjd)
+void NoseconeCtrl::NconeStep (int id, AnimState2 *state, void *context)
 {
-	// animate nose cone
-	if (ncone_state.Process (simdt)) {
-		DG()->SetAnimation (anim_nose, ncone_state.State());
-		DG()->TriggerRedrawArea (0, 0, ELID_INDICATOR);
-		DG()->UpdateStatusIndicators();
-	}
-
-	// animate VC nosecone lever
-	if (nlever_state.Process (simdt)) {
-		DG()->SetAnimation (anim_noselever, nlever_state.State());
-	}
+	NoseconeCtrl *nc = (NoseconeCtrl*)context;
+	nc->DG()->TriggerRedrawArea (0, 0, nc->ELID_INDICATOR);
+	nc->DG()->UpdateStatusIndicators();
 }
 
 // --------------------------------------------------------------
@@ -244,6 +238,26 @@ bool NoseconeCtrl::clbkParseScenarioLine (const char *line)
 
 // --------------------------------------------------------------
 
+void NoseconeCtrl::clbkSaveSnapshot (SnapshotWriter &snp)
+{
+	ncone_state.SaveSnapshot (snp);
+	nlever_state.SaveSnapshot (snp);
+}
+
+// --------------------------------------------------------------
+
+bool NoseconeCtrl::clbkLoadSnapshot (SnapshotReader &snp)
+{
+	if (!ncone_state.LoadSnapshot (snp) || !nlever_state.LoadSnapshot (snp))
+		return false;
+	clbkPostCreation ();
+	DG()->TriggerPanelRedrawArea (0, ELID_LEVER);
+	DG()->TriggerRedrawArea (0, 0, ELID_INDICATOR);
+	return true;
+}
+
+// --------------------------------------------------------------
+
 void NoseconeCtrl::clbkPostCreation ()
 {
 	DG()->SetAnimation (anim_nose, ncone_state.State());
@@ -418,6 +432,7 @@ UndockCtrl::UndockCtrl (DockingCtrlSubsystem *_subsys)
 		VC_UNDOCKLEVER_ref, VC_UNDOCKLEVER_axis, (float)(-90*RAD));
 	anim_undocklever = DG()->CreateAnimation (0);
 	DG()->AddAnimationComponent (anim_undocklever, 0, 1, &UndockLeverTransform);
+	DG()->Actuators()->AddActuator (anim_undocklever, &undock_state);
 }
 
 // --------------------------------------------------------------
@@ -437,15 +452,6 @@ void UndockCtrl::ReleaseLever ()
 
 // --------------------------------------------------------------
 
-void UndockCtrl::clbkPostStep (double simt, double simdt, double mjd)
-{
-	// animate undock lever
-	if (undock_state.Process (simdt))
-		DG()->SetAnimation (anim_undocklever, undock_state.State());
-}
-
-// --------------------------------------------------------------
-
 bool UndockCtrl::clbkLoadPanel2D (int panelid, PANELHANDLE hPanel, DWORD viewW, DWORD viewH)
 {
 	if (panelid != 0) return false;
@@ -540,6 +546,7 @@ EscapeLadderCtrl::EscapeLadderCtrl (DockingCtrlSubsystem *_subsys)
 	anim_ladder = DG()->CreateAnimation (0);
 	DG()->AddAnimationComponent (anim_ladder, 0, 0.5, &Ladder1);
 	DG()->AddAnimationComponent (anim_ladder, 0.5, 1, &Ladder2);
+	DG()->Actuators()->AddActuator (anim_ladder, &ladder_state, LadderStep, this);
 }
 
 // --------------------------------------------------------------
@@ -576,13 +583,10 @@ void EscapeLadderCtrl::clbkPostCreation ()
 
 // --------------------------------------------------------------
 
-void EscapeLadderCtrl::clbkPostStep (double simt, double simdt, double mjd)
+void EscapeLadderCtrl::LadderStep (int id, AnimState2 *state, void *context)
 {
-	// animate escape ladder
-	if (ladder_state.Process (simdt)) {
-		DG()->SetAnimation (anim_ladder, ladder_state.State());
-		DG()->TriggerRedrawArea (0, 0, ELID_INDICATOR);
-	}
+	EscapeLadderCtrl *lc = (EscapeLadderCtrl*)context;
+	lc->DG()->TriggerRedrawArea (0, 0, lc->ELID_INDICATOR);
 }
 
 // --------------------------------------------------------------
@@ -601,6 +605,23 @@ bool EscapeLadderCtrl::clbkParseScenarioLine (const char *line)
 
 // --------------------------------------------------------------
 
+void EscapeLadderCtrl::clbkSaveSnapshot (SnapshotWriter &snp)
+{
+	ladder_state.SaveSnapshot (snp);
+}
+
+// --------------------------------------------------------------
+
+bool EscapeLadderCtrl::clbkLoadSnapshot (SnapshotReader &snp)
+{
+	if (!ladder_state.LoadSnapshot (snp)) return false;
+	clbkPostCreation ();
+	DG()->TriggerRedrawArea (0, 0, ELID_INDICATOR);
+	return true;
+}
+
+// --------------------------------------------------------------
+
 bool EscapeLadderCtrl::clbkPlaybackEvent (double simt, double event_t, const char *event_type, const char *event)
 {
 	if (!_stricmp (event_type, "LADDER")) {
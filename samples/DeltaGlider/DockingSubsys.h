@@ -59,16 +59,19 @@ public:
 	void OpenNcone();
 	void CloseNcone();
 	void RevertNcone ();
-	void clbkPostStep (double simt, double simdt, double mjd);
 	bool clbkLoadPanel2D (int panelid, PANELHANDLE hPanel, DWORD viewW, DWORD viewH);
 	bool clbkLoadVC (int vcid);
 	void clbkSaveState (FILEHANDLE scn);
 	bool clbkParseScenarioLine (const char *line);
+	void clbkSaveSnapshot (SnapshotWriter &snp);
+	bool clbkLoadSnapshot (SnapshotReader &snp);
 	void clbkPostCreation ();
 	bool clbkPlaybackEvent (double simt, double event_t, const char *event_type, const char *event);
 	int clbkConsumeBufferedKey (DWORD key, bool down, char *kstate);
 
 private:
+	static void NconeStep (int id, AnimState2 *state, void *context);
+
 	NoseconeLever *lever;
 	NoseconeIndicator *indicator;
 
@@ -123,7 +126,6 @@ public:
 	UndockCtrl (DockingCtrlSubsystem *_subsys);
 	void PullLever ();
 	void ReleaseLever ();
-	void clbkPostStep (double simt, double simdt, double mjd);
 	bool clbkLoadPanel2D (int panelid, PANELHANDLE hPanel, DWORD viewW, DWORD viewH);
 	bool clbkLoadVC (int vcid);
 
@@ -164,14 +166,17 @@ public:
 	void RetractLadder ();
 	inline const AnimState2 &State() const { return ladder_state; }
 	void clbkPostCreation ();
-	void clbkPostStep (double simt, double simdt, double mjd);
 	void clbkSaveState (FILEHANDLE scn);
 	bool clbkParseScenarioLine (const char *line);
+	void clbkSaveSnapshot (SnapshotWriter &snp);
+	bool clbkLoadSnapshot (SnapshotReader &snp);
 	bool clbkPlaybackEvent (double simt, double event_t, const char *event_type, const char *event);
 	bool clbkLoadPanel2D (int panelid, PANELHANDLE hPanel, DWORD viewW, DWORD viewH);
 	bool clbkLoadVC (int vcid);
 
 private:
+	static void LadderStep (int id, AnimState2 *state, void *context);
+
 	LadderSwitch *sw;
 	LadderIndicator *indicator;
 	int ELID_SWITCH;
@@ -49,6 +49,20 @@ const AnimState2 &GearSubsystem::GearState() const
 	return gearctrl->GearState();
 }
 
+// --------------------------------------------------------------
+
+void GearSubsystem::EnableContactModel (bool enable)
+{
+	gearctrl->EnableContactModel (enable);
+}
+
+// --------------------------------------------------------------
+
+bool GearSubsystem::ContactModel () const
+{
+	return gearctrl->ContactModel ();
+}
+
 // ==============================================================
 // Gear control: lever+indicator
 // ==============================================================
@@ -62,6 +76,14 @@ GearControl::GearControl (GearSubsystem *_subsys)
 	ELID_LEVER = AddElement (lever = new GearLever (this));
 	ELID_INDICATOR = AddElement (indicator = new GearIndicator (this));
 
+	// Strut contact model (nose, left, right wheel). Wheel positions match
+	// the gear-down touchdown points; the static compression at typical
+	// mass is about GEAR_STATIC_SAG.
+	contact_model = false;
+	contact.AddStrut (_V( 0  ,-2.57,10), 0.35, 2e5, 2.4e4, 1.6, 1.6, 0.1);
+	contact.AddStrut (_V(-3.5,-2.57,-1), 0.35, 5e5, 6.1e4, 3.0, 3.0, 0.2, 1e5, 1);
+	contact.AddStrut (_V( 3.5,-2.57,-1), 0.35, 5e5, 6.1e4, 3.0, 3.0, 0.2, 1e5, 2);
+
 	// Landing gear animation
 	static UINT NWheelStrutGrp[2] = {GRP_NWheelStrut1,GRP_NWheelStrut2};
 	static MGROUP_ROTATE NWheelStrut (0, NWheelStrutGrp, 2,
@@ -123,6 +145,9 @@ GearControl::GearControl (GearSubsystem *_subsys)
 		VC_GEARLEVER_ref, VC_GEARLEVER_axis, (float)(-70*RAD));
 	anim_gearlever = DG()->CreateAnimation (0.5);
 	DG()->AddAnimationComponent (anim_gearlever, 0, 1, &GearLeverTransform);
+
+	DG()->Actuators()->AddActuator (anim_gear, &gear_state, GearStep, this);
+	DG()->Actuators()->AddActuator (anim_gearlever, &glever_state);
 }
 
 // --------------------------------------------------------------
@@ -170,20 +195,25 @@ void GearControl::RevertGear ()
 
 // --------------------------------------------------------------
 
-void GearControl::clbkPostStep (double simt, double simdt, double mjd)
+void GearControl::clbkPreStep (double simt, double simdt, double mjd)
 {
-	// animate landing gear
-	if (gear_state.Process (simdt)) {
-		DG()->SetAnimation (anim_gear, gear_state.State());
-		DG()->SetGearParameters (gear_state.State());
-		DG()->TriggerRedrawArea (0, 0, ELID_INDICATOR);
-		DG()->UpdateStatusIndicators();
+	if (contact_model && gear_state.IsOpen()) {
+		// nosewheel steering from the yaw command
+		double lvl = DG()->GetManualControlLevel(THGROUP_ATT_YAWRIGHT, MANCTRL_ROTMODE);
+		if (!lvl) lvl = -DG()->GetManualControlLevel(THGROUP_ATT_YAWLEFT, MANCTRL_ROTMODE);
+		contact.SetSteering (0, lvl*GEAR_STEER_RANGE);
+		contact.Update (DG(), simdt);
 	}
+}
 
-	// animate gear lever
-	if (glever_state.Process (simdt)) {
-		DG()->SetAnimation (anim_gearlever, glever_state.State());
-	}
+// --------------------------------------------------------------
+
+void GearControl::GearStep (int id, AnimState2 *state, void *context)
+{
+	GearControl *gc = (GearControl*)context;
+	gc->DG()->SetGearParameters (state->State());
+	gc->DG()->TriggerRedrawArea (0, 0, gc->ELID_INDICATOR);
+	gc->DG()->UpdateStatusIndicators();
 }
 
 // --------------------------------------------------------------
@@ -242,6 +272,26 @@ bool GearControl::clbkParseScenarioLine (const char *line)
 
 // --------------------------------------------------------------
 
+void GearControl::clbkSaveSnapshot (SnapshotWriter &snp)
+{
+	gear_state.SaveSnapshot (snp);
+	glever_state.SaveSnapshot (snp);
+}
+
+// --------------------------------------------------------------
+
+bool GearControl::clbkLoadSnapshot (SnapshotReader &snp)
+{
+	if (!gear_state.LoadSnapshot (snp) || !glever_state.LoadSnapshot (snp))
+		return false;
+	clbkPostCreation ();
+	DG()->TriggerPanelRedrawArea (0, ELID_LEVER);
+	DG()->TriggerRedrawArea (2, 0, ELID_INDICATOR);
+	return true;
+}
+
+// --------------------------------------------------------------
+
 void GearControl::clbkPostCreation ()
 {
 	DG()->SetAnimation (anim_gear, gear_state.State());
@@ -14,6 +14,7 @@
 #include "DeltaGlider.h"
 #include "DGSubsys.h"
 #include "DGSwitches.h"
+#include "..\Common\Vessel\GearContact.h"
 
 // ==============================================================
 // Landing gear subsystem
@@ -28,6 +29,8 @@ public:
 	void LowerGear ();
 	void RaiseGear ();
 	const AnimState2 &GearState() const;
+	void EnableContactModel (bool enable);
+	bool ContactModel () const;
 
 private:
 	GearControl *gearctrl;
@@ -48,20 +51,28 @@ public:
 	void RaiseGear ();
 	void RevertGear ();
 	inline const AnimState2 &GearState() const { return gear_state; }
-	void clbkPostStep (double simt, double simdt, double mjd);
+	inline void EnableContactModel (bool enable) { contact_model = enable; }
+	inline bool ContactModel () const { return contact_model; }
+	void clbkPreStep (double simt, double simdt, double mjd);
 	bool clbkLoadPanel2D (int panelid, PANELHANDLE hPanel, DWORD viewW, DWORD viewH);
 	bool clbkLoadVC (int vcid);
 	void clbkSaveState (FILEHANDLE scn);
 	bool clbkParseScenarioLine (const char *line);
+	void clbkSaveSnapshot (SnapshotWriter &snp);
+	bool clbkLoadSnapshot (SnapshotReader &snp);
 	void clbkPostCreation ();
 	bool clbkDrawHUD (int mode, const HUDPAINTSPEC *hps, oapi::Sketchpad *skp);
 	bool clbkPlaybackEvent (double simt, double event_t, const char *event_type, const char *event);
 	int clbkConsumeBufferedKey (DWORD key, bool down, char *kstate);
 
 private:
+	static void GearStep (int id, AnimState2 *state, void *context);
+
 	AnimState2 gear_state, glever_state;
 	UINT anim_gear;             // handle for landing gear animation
 	UINT anim_gearlever;        // VC gear lever
+	GearContact contact;        // strut contact model
+	bool contact_model;         // use the strut contact model while the gear is down
 
 	GearLever *lever;
 	GearIndicator *indicator;
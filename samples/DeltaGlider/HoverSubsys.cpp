@@ -97,9 +97,10 @@ HoverSubsystemComponent::HoverSubsystemComponent (HoverSubsystem *_subsys)
 // ==============================================================
 
 HoverAttitudeComponent::HoverAttitudeComponent (HoverSubsystem *_subsys)
-: HoverSubsystemComponent(_subsys)
+: HoverSubsystemComponent(_subsys), alloc(3, 3)
 {
 	mode = 0;
+	alloc_ready = false;
 
 	phover = phover_cmd = 0.0;
 	rhover = rhover_cmd = 0.0;
@@ -153,72 +154,71 @@ void HoverAttitudeComponent::AutoHoverAtt ()
 
 // --------------------------------------------------------------
 
+void HoverAttitudeComponent::SetupAllocator ()
+{
+	// effect of each hover engine at full thrust on lift, pitch moment and
+	// roll moment, in units of the front engine max. thrust
+	int i, j;
+	double fref = 0.0;
+	VECTOR3 pos;
+	for (i = 0; i < 3; i++) {
+		THRUSTER_HANDLE th = DG()->GetGroupThruster (THGROUP_HOVER, i);
+		double f = DG()->GetThrusterMax0 (th);
+		if (!i) fref = (f ? f : 1.0);
+		f /= fref;
+		DG()->GetThrusterRef (th, pos);
+		hover_eff[i][0] = f;
+		hover_eff[i][1] = f*pos.z;
+		hover_eff[i][2] = f*pos.x;
+		alloc.SetEffectiveness (i, hover_eff[i]);
+	}
+	// normalise the axis residuals by their range
+	for (j = 0; j < 3; j++) {
+		for (hover_span[j] = 0.0, i = 0; i < 3; i++)
+			hover_span[j] += fabs (hover_eff[i][j]);
+		alloc.SetAxisWeight (j, hover_span[j] ? 1.0/hover_span[j] : 1.0);
+	}
+	alloc.Setup();
+	alloc_ready = true;
+}
+
+// --------------------------------------------------------------
+
 void HoverAttitudeComponent::TrackHoverAtt ()
 {
 	if (mode) {
 		phover = DG()->GetPitch();
 		rhover = DG()->GetBank();
-		const double fb_scale = 3.0/4.55; // scaling between front and back hovers (distance from CG)
-		double Lf = HoverSubsys()->GetThrusterLevel(0);
-		double Ll = HoverSubsys()->GetThrusterLevel(1);
-		double Lr = HoverSubsys()->GetThrusterLevel(2);
-		double Lb = (Ll+Lr)*0.5;
-		double Lm = (Lf+Lb)*0.5;
-		double Tf = Lf;
-		double Tb = Lb*fb_scale;
-		double Tm = (Tf+Tb)*0.5;
-		if (fabs(phover) <= MAX_AUTO_HOVER_ATT && fabs(rhover) <= MAX_AUTO_HOVER_ATT) { // within control range
-			const double p_alpha = 0.2;
-			const double p_beta = 0.6;
-			const double r_alpha = 0.2;
-			const double r_beta = 0.6;
-			double dp = phover - phover_cmd;
-			double dr = rhover - rhover_cmd;
-			VECTOR3 avel;
-			DG()->GetAngularVel(avel);
-			double dpv =  avel.x;
-			double drv = -avel.z;
-			double balance_fb = -p_alpha*dp - p_beta*dpv;
-			double balance_lr = -r_alpha*dr - r_beta*drv;
-			if (Lf || Lb) {
-				// front/back balance
-				double Lf_cmd = Lm+balance_fb;
-				double Lb_cmd = Lm-balance_fb;
-				double D = (Lf_cmd-Lf + (Lb_cmd-Lb)*fb_scale)/(1.0+fb_scale);
-				Lf_cmd -= D;
-				Lb_cmd -= D;
-
-				double Lmin = min (Lf_cmd, Lb_cmd);
-				double Lmax = max (Lf_cmd, Lb_cmd);
-				if (Lmin < 0.0) {
-					if (Lf_cmd < 0.0) Lf_cmd = 0.0, Lb_cmd += Lmin/fb_scale;
-					else              Lb_cmd = 0.0, Lf_cmd += Lmin*fb_scale;
-				}
-				if (Lmax > 1.0) {
-					if (Lf_cmd > 1.0) Lf_cmd = 1.0, Lb_cmd += (Lmax-1.0)/fb_scale;
-					else              Lb_cmd = 1.0, Lf_cmd += (Lmax-1.0)*fb_scale;
-				}
-				// left/right balance
-				double Ll_cmd = Lb_cmd-balance_lr;
-				double Lr_cmd = Lb_cmd+balance_lr;
-				Lmin = min (Ll_cmd, Lr_cmd);
-				Lmax = max (Ll_cmd, Lr_cmd);
-				if (Lmin < 0.0) {
-					if (Ll_cmd < 0.0) Ll_cmd = 0.0, Lr_cmd += Lmin;
-					else              Lr_cmd = 0.0, Ll_cmd += Lmin;
-				}
-				if (Lmax > 1.0) {
-					if (Ll_cmd > 1.0) Ll_cmd = 1.0, Lr_cmd += Lmax-1.0;
-					else              Lr_cmd = 1.0, Ll_cmd += Lmax-1.0;
-				}
-				HoverSubsys()->SetThrusterLevel (0, Lf_cmd);
-				HoverSubsys()->SetThrusterLevel (1, Ll_cmd);
-				HoverSubsys()->SetThrusterLevel (2, Lr_cmd);
-			}
-		} else {
-			double L_cmd = 2.0*Tm / (1.0 + fb_scale);
-			for (int i = 0; i < 3; i++)
-				HoverSubsys()->SetThrusterLevel (i, L_cmd);
+		if (!alloc_ready) SetupAllocator();
+
+		int i;
+		double L[3], L_cmd[3];
+		double demand[3] = {0.0, 0.0, 0.0}; // lift, pitch moment, roll moment
+		for (i = 0; i < 3; i++) {
+			L[i] = HoverSubsys()->GetThrusterLevel(i);
+			demand[0] += L[i]*hover_eff[i][0]; // maintain current total hover thrust
+		}
+		if (demand[0]) {
+			if (fabs(phover) <= MAX_AUTO_HOVER_ATT && fabs(rhover) <= MAX_AUTO_HOVER_ATT) { // within control range
+				const double p_alpha = 0.2;
+				const double p_beta = 0.6;
+				const double r_alpha = 0.2;
+				const double r_beta = 0.6;
+				double dp = phover - phover_cmd;
+				double dr = rhover - rhover_cmd;
+				VECTOR3 avel;
+				DG()->GetAngularVel(avel);
+				double dpv =  avel.x;
+				double drv = -avel.z;
+				double balance_fb = -p_alpha*dp - p_beta*dpv;
+				double balance_lr = -r_alpha*dr - r_beta*drv;
+				demand[1] = balance_fb*hover_span[1];
+				demand[2] = balance_lr*hover_span[2];
+			} // otherwise, just balance the pitch and roll moments
+
+			alloc.Solve (demand, L, L_cmd);
+			for (i = 0; i < 3; i++)
+				HoverSubsys()->SetThrusterLevel (i, L_cmd[i]);
 		}
 	} else {
 		phover = rhover = phover_cmd = rhover_cmd = 0.0;
@@ -257,6 +257,30 @@ bool HoverAttitudeComponent::clbkParseScenarioLine (const char *line)
 
 // --------------------------------------------------------------
 
+void HoverAttitudeComponent::clbkSaveSnapshot (SnapshotWriter &snp)
+{
+	snp.Put (mode);
+	snp.Put (phover);
+	snp.Put (phover_cmd);
+	snp.Put (rhover);
+	snp.Put (rhover_cmd);
+}
+
+// --------------------------------------------------------------
+
+bool HoverAttitudeComponent::clbkLoadSnapshot (SnapshotReader &snp)
+{
+	if (!snp.Get (mode) || !snp.Get (phover) || !snp.Get (phover_cmd) ||
+		!snp.Get (rhover) || !snp.Get (rhover_cmd))
+		return false;
+	modedial->SetPosition (mode);
+	DG()->TriggerRedrawArea (0, 0, ELID_MODEDIAL);
+	DG()->TriggerRedrawArea (0, 0, ELID_DISPLAY);
+	return true;
+}
+
+// --------------------------------------------------------------
+
 void HoverAttitudeComponent::clbkPostStep (double simt, double simdt, double mjd)
 {
 	if (mode == 1) AutoHoverAtt();
@@ -332,6 +356,11 @@ HoverHoldComponent::HoverHoldComponent (HoverSubsystem *_subsys)
 	ELID_ALTSET      = AddElement (altset   = new HoverAltSwitch (this));
 	ELID_ALTRESET    = AddElement (altreset = new HoverAltResetBtn (this));
 	ELID_MODEBUTTONS = AddElement (modebuttons = new HoverAltModeButtons (this));
+
+	// the vertical speed controller samples the vessel state and its level
+	// holds for a whole frame, so at long frame intervals it switches to its
+	// steady form
+	SetStepLimit (0.5);
 }
 
 // --------------------------------------------------------------
@@ -418,7 +447,7 @@ void HoverHoldComponent::SetHoverMode (HoverMode mode)
 
 // --------------------------------------------------------------
 
-void HoverHoldComponent::HoverHoldVspd (double vh_tgt)
+void HoverHoldComponent::HoverHoldVspd (double vh_tgt, bool steady)
 {
 	double t = oapiGetSimTime();
 	double dt = t - holdT;
@@ -433,6 +462,11 @@ void HoverHoldComponent::HoverHoldVspd (double vh_tgt)
 
 	double dvh = vh_tgt-vh;
 	double a_tgt = dvh;
+	if (steady) {
+		// long frame intervals (time acceleration): close the speed error
+		// over one frame rather than 1s, which would overshoot
+		a_tgt /= max (dt, 1.0);
+	}
 	double da = a_tgt - ah;
 	double a_max = DG()->GetMaxHoverThrust()/DG()->GetMass();
 	double dlvl = da/a_max;
@@ -473,6 +507,36 @@ bool HoverHoldComponent::clbkParseScenarioLine (const char *line)
 
 // --------------------------------------------------------------
 
+void HoverHoldComponent::clbkSaveSnapshot (SnapshotWriter &snp)
+{
+	snp.Put (active);
+	snp.Put (hovermode);
+	snp.Put (holdalt);
+	snp.Put (holdvspd);
+}
+
+// --------------------------------------------------------------
+
+bool HoverHoldComponent::clbkLoadSnapshot (SnapshotReader &snp)
+{
+	bool act;
+	HoverMode hmode;
+	double alt, vspd;
+	if (!snp.Get (act) || !snp.Get (hmode) || !snp.Get (alt) || !snp.Get (vspd))
+		return false;
+	// re-engage the hold (and its navmode) with the restored settings
+	Activate (false);
+	hovermode = hmode;
+	holdalt = alt;
+	holdvspd = vspd;
+	if (act) Activate (true);
+	modebuttons->UpdateMode ();
+	DG()->TriggerRedrawArea (0, 0, ELID_MODEBUTTONS);
+	return true;
+}
+
+// --------------------------------------------------------------
+
 void HoverHoldComponent::clbkPostStep (double simt, double simdt, double mjd)
 {
 	// vertical speed hover autopilot
@@ -482,6 +546,15 @@ void HoverHoldComponent::clbkPostStep (double simt, double simdt, double mjd)
 
 // --------------------------------------------------------------
 
+bool HoverHoldComponent::clbkSteadyState (double simt, double simdt, double mjd)
+{
+	if (active && hovermode == HOLD_VSPD)
+		HoverHoldVspd (holdvspd, true);
+	return true;
+}
+
+// --------------------------------------------------------------
+
 bool HoverHoldComponent::clbkLoadPanel2D (int panelid, PANELHANDLE hPanel, DWORD viewW, DWORD viewH)
 {
 	if (panelid != 0) return false;
@@ -1002,6 +1075,13 @@ void HoverAltModeButtons::ResetVC (DEVMESHHANDLE hMesh)
 {
 	for (int i = 0; i < 2; i++)
 		btn[i]->ResetVC (hMesh);
+	UpdateMode ();
+}
+
+// --------------------------------------------------------------
+
+void HoverAltModeButtons::UpdateMode ()
+{
 	if (vmode != ctrl->GetHoverMode()) {
 		vmode = ctrl->GetHoverMode();
 		for (int i = 0; i < 2; i++)
@@ -1148,13 +1228,13 @@ bool HoverHoldAltIndicator::Redraw ()
 	if (!btgt) return refresh;
 
 	if (holdmode_disp != ctrl->hovermode) {
-		oapiBlt (btgt, bsrc, 314, 2, (ctrl->hovermode-1)*25, 14, 25, 8);
+		ctrl->DG()->BltQueue().Blt (btgt, bsrc, 314, 2, (ctrl->hovermode-1)*25, 14, 25, 8);
 		holdmode_disp = ctrl->hovermode;
 		refresh = true;
 	}
 
 	if (hold_disp != ctrl->active) {
-		oapiBlt (btgt, bsrc, 348, 2, ctrl->active ? 51:78, 14, 27, 8);
+		ctrl->DG()->BltQueue().Blt (btgt, bsrc, 348, 2, ctrl->active ? 51:78, 14, 27, 8);
 		hold_disp = ctrl->active;
 		refresh = true;
 	}
@@ -1196,7 +1276,7 @@ void HoverHoldAltIndicator::UpdateReadout (const char *tgtstr, char *curstr)
 				case 'G': srcx = 15*8; break;
 				default:  srcx = 16*8; break;
 			}
-			oapiBlt (btgt, bsrc, tgtx, tgty, srcx, srcy, w, h);
+			ctrl->DG()->BltQueue().Blt (btgt, bsrc, tgtx, tgty, srcx, srcy, w, h);
 			curstr[i] = c;
 		}
 		tgtx += w;
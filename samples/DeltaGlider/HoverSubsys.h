@@ -14,6 +14,7 @@
 #include "DeltaGlider.h"
 #include "DGSubsys.h"
 #include "DGSwitches.h"
+#include "..\Common\Vessel\ThrustAlloc.h"
 #include <vector>
 
 // ==============================================================
@@ -76,9 +77,11 @@ public:
 	bool IncPHover (int dir);     // manually change hover pitch command
 	bool IncRHover (int dir);     // manually change hover roll command
 	void AutoHoverAtt ();         // set hover pitch/roll commands from user input
-	void TrackHoverAtt ();
+	void TrackHoverAtt ();        // balance hover engines to track pitch/roll commands
 	void clbkSaveState (FILEHANDLE scn);
 	bool clbkParseScenarioLine (const char *line);
+	void clbkSaveSnapshot (SnapshotWriter &snp);
+	bool clbkLoadSnapshot (SnapshotReader &snp);
 	void clbkPostStep (double simt, double simdt, double mjd);
 	bool clbkLoadPanel2D (int panelid, PANELHANDLE hPanel, DWORD viewW, DWORD viewH);
 	bool clbkLoadVC (int vcid);
@@ -89,6 +92,12 @@ private:
 	double phover, phover_cmd;    // current/commanded hover pitch angle (tan)
 	double rhover, rhover_cmd;    // current/commanded hover roll angle (tan)
 
+	void SetupAllocator ();       // define hover engine layout for the thrust allocator
+	ThrustAllocator alloc;        // maps lift/pitch/roll demand to hover engine levels
+	double hover_eff[3][3];       // lift, pitch and roll effect of each hover engine
+	double hover_span[3];         // total effect range per axis
+	bool alloc_ready;             // allocator layout defined?
+
 	HoverCtrlDial *modedial;      // mode dial object
 	PHoverCtrl    *phoverswitch;  // pitch hover balance switch object
 	RHoverCtrl    *rhoverswitch;  // roll hover balance switch object
@@ -129,12 +138,15 @@ public:
 	HoverMode GetHoverMode () const { return hovermode; }
 	void clbkSaveState (FILEHANDLE scn);
 	bool clbkParseScenarioLine (const char *line);
+	void clbkSaveSnapshot (SnapshotWriter &snp);
+	bool clbkLoadSnapshot (SnapshotReader &snp);
 	void clbkPostStep (double simt, double simdt, double mjd);
+	bool clbkSteadyState (double simt, double simdt, double mjd);
 	bool clbkLoadPanel2D (int panelid, PANELHANDLE hPanel, DWORD viewW, DWORD viewH);
 	bool clbkLoadVC (int vcid);
 
 protected:
-	void HoverHoldVspd (double vspd);
+	void HoverHoldVspd (double vspd, bool steady = false);
 
 private:
 	double holdalt;     // current hold altitude
@@ -274,6 +286,7 @@ public:
 	bool ProcessMouseVC (int event, VECTOR3 &p);
 	void Reset2D (MESHHANDLE hMesh);
 	void ResetVC (DEVMESHHANDLE hMesh);
+	void UpdateMode ();  // set the VC button states from the current hover mode
 
 private:
 	HoverHoldComponent *ctrl;
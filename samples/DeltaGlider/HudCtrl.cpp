@@ -47,7 +47,7 @@ HUDControl::HUDControl (DeltaGlider *vessel)
 	anim_vc_hud = DG()->CreateAnimation (0);
 	DG()->AddAnimationComponent (anim_vc_hud, 0, 0.4, &HudTransform1);
 	DG()->AddAnimationComponent (anim_vc_hud, 0.4, 1, &HudTransform2);
-
+	DG()->Actuators()->AddActuator (anim_vc_hud, &hud_state, HudStep, this);
 }
 
 // --------------------------------------------------------------
@@ -131,14 +131,11 @@ void HUDControl::ModHUDBrightness (bool increase)
 
 // --------------------------------------------------------------
 
-void HUDControl::clbkPostStep (double simt, double simdt, double mjd)
+void HUDControl::HudStep (int id, AnimState2 *state, void *context)
 {
-	// animate HUD
-	if (hud_state.Process (simdt)) {
-		DG()->SetAnimation (anim_vc_hud, hud_state.State());
-		if (hud_state.IsClosed())
-			oapiSetHUDMode (last_mode);
-	}
+	// HUD unfolded: restore the display mode
+	if (state->IsClosed())
+		oapiSetHUDMode (((HUDControl*)context)->last_mode);
 }
 
 // --------------------------------------------------------------
@@ -39,13 +39,14 @@ public:
 	void ExtendHud();
 	void RevertHud ();
 	void ModHUDBrightness (bool increase);
-	void clbkPostStep (double simt, double simdt, double mjd);
 	bool clbkLoadPanel2D (int panelid, PANELHANDLE hPanel, DWORD viewW, DWORD viewH);
 	bool clbkLoadVC (int vcid);
 	void clbkResetVC (int vcid, DEVMESHHANDLE hMesh);
 	int clbkConsumeBufferedKey (DWORD key, bool down, char *kstate);
 
 private:
+	static void HudStep (int id, AnimState2 *state, void *context);
+
 	int last_mode;
 	AnimState2 hud_state;
 
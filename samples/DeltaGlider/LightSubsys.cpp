@@ -127,6 +127,26 @@ bool InstrumentLight::clbkParseScenarioLine (const char *line)
 
 // --------------------------------------------------------------
 
+void InstrumentLight::clbkSaveSnapshot (SnapshotWriter &snp)
+{
+	snp.Put (light_on);
+	snp.Put (light_col);
+	snp.Put (brightness);
+}
+
+// --------------------------------------------------------------
+
+bool InstrumentLight::clbkLoadSnapshot (SnapshotReader &snp)
+{
+	bool on;
+	if (!snp.Get (on) || !snp.Get (light_col) || !snp.Get (brightness)) return false;
+	DG()->SetAnimation (anim_dial, brightness);
+	SetLight (on, true);
+	return true;
+}
+
+// --------------------------------------------------------------
+
 bool InstrumentLight::clbkLoadVC (int vcid)
 {
 	if (vcid != 0) return false;
@@ -286,6 +306,25 @@ bool CockpitLight::clbkParseScenarioLine (const char *line)
 
 // --------------------------------------------------------------
 
+void CockpitLight::clbkSaveSnapshot (SnapshotWriter &snp)
+{
+	snp.Put (light_mode);
+	snp.Put (brightness);
+}
+
+// --------------------------------------------------------------
+
+bool CockpitLight::clbkLoadSnapshot (SnapshotReader &snp)
+{
+	int mode;
+	if (!snp.Get (mode) || !snp.Get (brightness)) return false;
+	DG()->SetAnimation (anim_dial, brightness);
+	SetLight (mode, true);
+	return true;
+}
+
+// --------------------------------------------------------------
+
 bool CockpitLight::clbkLoadVC (int vcid)
 {
 	if (vcid != 0) return false;
@@ -415,6 +454,23 @@ bool LandDockLight::clbkParseScenarioLine (const char *line)
 
 // --------------------------------------------------------------
 
+void LandDockLight::clbkSaveSnapshot (SnapshotWriter &snp)
+{
+	snp.Put (light_mode);
+}
+
+// --------------------------------------------------------------
+
+bool LandDockLight::clbkLoadSnapshot (SnapshotReader &snp)
+{
+	int mode;
+	if (!snp.Get (mode)) return false;
+	SetLight (mode);
+	return true;
+}
+
+// --------------------------------------------------------------
+
 bool LandDockLight::clbkLoadPanel2D (int panelid, PANELHANDLE hPanel, DWORD viewW, DWORD viewH)
 {
 	if (panelid != 1) return false;
@@ -544,6 +600,23 @@ bool StrobeLight::clbkParseScenarioLine (const char *line)
 
 // --------------------------------------------------------------
 
+void StrobeLight::clbkSaveSnapshot (SnapshotWriter &snp)
+{
+	snp.Put (light_on);
+}
+
+// --------------------------------------------------------------
+
+bool StrobeLight::clbkLoadSnapshot (SnapshotReader &snp)
+{
+	bool on;
+	if (!snp.Get (on)) return false;
+	SetLight (on);
+	return true;
+}
+
+// --------------------------------------------------------------
+
 bool StrobeLight::clbkLoadPanel2D (int panelid, PANELHANDLE hPanel, DWORD viewW, DWORD viewH)
 {
 	if (panelid != 1) return false;
@@ -673,6 +746,23 @@ bool NavLight::clbkParseScenarioLine (const char *line)
 
 // --------------------------------------------------------------
 
+void NavLight::clbkSaveSnapshot (SnapshotWriter &snp)
+{
+	snp.Put (light_on);
+}
+
+// --------------------------------------------------------------
+
+bool NavLight::clbkLoadSnapshot (SnapshotReader &snp)
+{
+	bool on;
+	if (!snp.Get (on)) return false;
+	SetLight (on);
+	return true;
+}
+
+// --------------------------------------------------------------
+
 bool NavLight::clbkLoadPanel2D (int panelid, PANELHANDLE hPanel, DWORD viewW, DWORD viewH)
 {
 	if (panelid != 1) return false;
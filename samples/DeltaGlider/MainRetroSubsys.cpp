@@ -264,7 +264,7 @@ bool MainRetroThrottleLevers::ProcessMouseVC (int event, VECTOR3 &p)
 // ==============================================================
 
 GimbalControl::GimbalControl (MainRetroSubsystem *_subsys)
-: DGSubsystem(_subsys)
+: DGSubsystem(_subsys), trim(2)
 {
 	mode = 0;
 	mpmode = mymode = 0;
@@ -272,6 +272,7 @@ GimbalControl::GimbalControl (MainRetroSubsystem *_subsys)
 		mpgimbal[i] = mpgimbal_cmd[i] = 0.0;
 		mygimbal[i] = mygimbal_cmd[i] = 0.0;
 		mpswitch[i] = myswitch[i] = 0;
+		trim.SetRange (i, -MAIN_PGIMBAL_RANGE, MAIN_PGIMBAL_RANGE, -MAIN_YGIMBAL_RANGE, MAIN_YGIMBAL_RANGE);
 	}
 	ELID_MODEDIAL      = AddElement (modedial      = new MainGimbalDial (this));
 	ELID_PGIMBALSWITCH = AddElement (pgimbalswitch = new PMainGimbalCtrl (this));
@@ -341,6 +342,18 @@ void GimbalControl::AutoMainGimbal ()
 {
 	int i;
 	double lvl, mlvl, plvl[2];
+	double ptrim[2], ytrim[2];
+	VECTOR3 ref;
+
+	// Trim settings that balance the main thrust moment about the CG
+	// (compensates for main thrust differences with the yaw gimbals, and
+	// for a vertical CG offset with the pitch gimbals)
+	for (i = 0; i < 2; i++) {
+		DG()->GetMainThrusterRef (i, ref);
+		trim.SetEngine (i, ref);
+		trim.SetThrust (i, DG()->GetMainThrusterLevel (i));
+	}
+	trim.Solve (_V(0,0,0), _V(0,0,0), ptrim, ytrim);
 
 	// Pitch gimbal
 	// a) pitch command
@@ -354,69 +367,61 @@ void GimbalControl::AutoMainGimbal ()
 	plvl[0] += lvl;
 	plvl[1] -= lvl;
 
-	// scale to range and apply
+	// scale to range and apply on top of trim
 	mlvl = max(fabs(plvl[0]), fabs(plvl[1]));
 	if (mlvl > 1.0) 
 		for (i = 0; i < 2; i++) plvl[i] /= mlvl;
 	for (i = 0; i < 2; i++)
-		mpgimbal_cmd[i] = plvl[i]*MAIN_PGIMBAL_RANGE;
+		mpgimbal_cmd[i] = min (MAIN_PGIMBAL_RANGE, max (-MAIN_PGIMBAL_RANGE, ptrim[i] + plvl[i]*MAIN_PGIMBAL_RANGE));
 
 	// Yaw gimbal
-	// a) compensate for main thrust differences
-	double t0 = DG()->GetMainThrusterLevel (0);
-	double t1 = DG()->GetMainThrusterLevel (1);
-	double tt = t0+t1;
-	mlvl = (tt ? (t0-t1)/tt : 0.0);
-	
-	// b) yaw command
 	lvl = DG()->GetManualControlLevel(THGROUP_ATT_YAWLEFT, MANCTRL_ROTMODE);
 	if (!lvl) lvl = -DG()->GetManualControlLevel(THGROUP_ATT_YAWRIGHT, MANCTRL_ROTMODE);
-	mlvl += lvl;
 
-	// scale to range and apply
-	mlvl = min (1.0, max (-1.0, mlvl));
+	// scale to range and apply on top of trim
 	for (i = 0; i < 2; i++)
-		mygimbal_cmd[i] = mlvl*MAIN_YGIMBAL_RANGE;
+		mygimbal_cmd[i] = min (MAIN_YGIMBAL_RANGE, max (-MAIN_YGIMBAL_RANGE, ytrim[i] + lvl*MAIN_YGIMBAL_RANGE));
 }
 
 // --------------------------------------------------------------
 
 void GimbalControl::TrackMainGimbal ()
 {
-	VECTOR3 dir;
 	bool update = false;
 	int i;
 	double dphi = oapiGetSimStep()*MAIN_GIMBAL_SPEED;
 	for (i = 0; i < 2; i++) {
 		if (mpgimbal[i] != mpgimbal_cmd[i]) {
 			update = true;
-			if (mpgimbal[i] < mpgimbal_cmd[i])
-				mpgimbal[i] = min (mpgimbal[i]+dphi, mpgimbal_cmd[i]);
-			else
-				mpgimbal[i] = max (mpgimbal[i]-dphi, mpgimbal_cmd[i]);
+			mpgimbal[i] = GimbalTrim::RateLimit (mpgimbal[i], mpgimbal_cmd[i], dphi);
 		}
 		if (mygimbal[i] != mygimbal_cmd[i]) {
 			update = true;
-			if (mygimbal[i] < mygimbal_cmd[i])
-				mygimbal[i] = min (mygimbal[i]+dphi, mygimbal_cmd[i]);
-			else
-				mygimbal[i] = max (mygimbal[i]-dphi, mygimbal_cmd[i]);
+			mygimbal[i] = GimbalTrim::RateLimit (mygimbal[i], mygimbal_cmd[i], dphi);
 		}
 	}
 	if (update) {
-		for (i = 0; i < 2; i++) {
-			DG()->GetMainThrusterDir (i, dir);
-			dir /= dir.z;
-			dir.y = mpgimbal[i];
-			dir.x = mygimbal[i];
-			DG()->SetMainThrusterDir (i, unit(dir));
-		}
+		ApplyMainGimbal ();
 		DG()->TriggerRedrawArea (0, 0, ELID_DISPLAY);
 	}
 }
 
 // --------------------------------------------------------------
 
+void GimbalControl::ApplyMainGimbal ()
+{
+	VECTOR3 dir;
+	for (int i = 0; i < 2; i++) {
+		DG()->GetMainThrusterDir (i, dir);
+		dir /= dir.z;
+		dir.y = mpgimbal[i];
+		dir.x = mygimbal[i];
+		DG()->SetMainThrusterDir (i, unit(dir));
+	}
+}
+
+// --------------------------------------------------------------
+
 void GimbalControl::clbkSaveState (FILEHANDLE scn)
 {
 	if (mode) {
@@ -448,6 +453,35 @@ bool GimbalControl::clbkParseScenarioLine (const char *line)
 
 // --------------------------------------------------------------
 
+void GimbalControl::clbkSaveSnapshot (SnapshotWriter &snp)
+{
+	snp.Put (mode);
+	for (int i = 0; i < 2; i++) {
+		snp.Put (mpgimbal[i]);
+		snp.Put (mpgimbal_cmd[i]);
+		snp.Put (mygimbal[i]);
+		snp.Put (mygimbal_cmd[i]);
+	}
+}
+
+// --------------------------------------------------------------
+
+bool GimbalControl::clbkLoadSnapshot (SnapshotReader &snp)
+{
+	if (!snp.Get (mode)) return false;
+	for (int i = 0; i < 2; i++)
+		if (!snp.Get (mpgimbal[i]) || !snp.Get (mpgimbal_cmd[i]) ||
+			!snp.Get (mygimbal[i]) || !snp.Get (mygimbal_cmd[i]))
+			return false;
+	ApplyMainGimbal ();
+	modedial->SetPosition (mode);
+	DG()->TriggerRedrawArea (0, 0, ELID_MODEDIAL);
+	DG()->TriggerRedrawArea (0, 0, ELID_DISPLAY);
+	return true;
+}
+
+// --------------------------------------------------------------
+
 void GimbalControl::clbkPostStep (double simt, double simdt, double mjd)
 {
 	if (mode == 1) AutoMainGimbal();
@@ -986,7 +1020,7 @@ RetroCoverControl::RetroCoverControl (MainRetroSubsystem *_subsys)
 	DG()->AddAnimationComponent (anim_rcover, 0, 1, &RCoverBL);
 	DG()->AddAnimationComponent (anim_rcover, 0, 1, &RCoverTR);
 	DG()->AddAnimationComponent (anim_rcover, 0, 1, &RCoverBR);
-
+	DG()->Actuators()->AddActuator (anim_rcover, &rcover_state, CoverStep, this);
 }
 
 // --------------------------------------------------------------
@@ -1038,17 +1072,30 @@ bool RetroCoverControl::clbkParseScenarioLine (const char *line)
 
 // --------------------------------------------------------------
 
-void RetroCoverControl::clbkPostStep (double simt, double simdt, double mjd)
+void RetroCoverControl::clbkSaveSnapshot (SnapshotWriter &snp)
 {
-	// animate retro covers
-	if (rcover_state.Process (simdt)) {
-		DG()->SetAnimation (anim_rcover, rcover_state.State());
-		DG()->UpdateStatusIndicators();
-		if (rcover_state.IsOpen())
-			DG()->EnableRetroThrusters(true);
-		DG()->TriggerRedrawArea (0, 0, ELID_INDICATOR);
-	}
+	rcover_state.SaveSnapshot (snp);
+}
+
+// --------------------------------------------------------------
+
+bool RetroCoverControl::clbkLoadSnapshot (SnapshotReader &snp)
+{
+	if (!rcover_state.LoadSnapshot (snp)) return false;
+	clbkPostCreation ();
+	DG()->TriggerRedrawArea (0, 0, ELID_INDICATOR);
+	return true;
+}
 
+// --------------------------------------------------------------
+
+void RetroCoverControl::CoverStep (int id, AnimState2 *state, void *context)
+{
+	RetroCoverControl *rc = (RetroCoverControl*)context;
+	rc->DG()->UpdateStatusIndicators();
+	if (state->IsOpen())
+		rc->DG()->EnableRetroThrusters(true);
+	rc->DG()->TriggerRedrawArea (0, 0, rc->ELID_INDICATOR);
 }
 
 // --------------------------------------------------------------
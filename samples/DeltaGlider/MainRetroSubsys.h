@@ -14,6 +14,7 @@
 #include "DeltaGlider.h"
 #include "DGSubsys.h"
 #include "DGSwitches.h"
+#include "..\Common\Vessel\GimbalTrim.h"
 #include <vector>
 
 // ==============================================================
@@ -107,6 +108,8 @@ public:
 	void TrackMainGimbal ();                                   // follow gimbals to commanded values
 	void clbkSaveState (FILEHANDLE scn);
 	bool clbkParseScenarioLine (const char *line);
+	void clbkSaveSnapshot (SnapshotWriter &snp);
+	bool clbkLoadSnapshot (SnapshotReader &snp);
 	void clbkPostStep (double simt, double simdt, double mjd);
 	bool clbkLoadPanel2D (int panelid, PANELHANDLE hPanel, DWORD viewW, DWORD viewH);
 	bool clbkLoadVC (int vcid);
@@ -117,6 +120,7 @@ private:
 	double mygimbal[2], mygimbal_cmd[2]; // current/commanded main engine yaw gimbal angle (tan)
 	int mpswitch[2], mpmode; // main gimbal pitch button states
 	int myswitch[2], mymode; // main gimbal yaw button states
+	GimbalTrim trim;         // moment balance solver for auto gimbal mode
 
 	MainGimbalDial *modedial;       // mode dial object
 	PMainGimbalCtrl *pgimbalswitch; // pitch gimbal switch object
@@ -127,6 +131,8 @@ private:
 	int ELID_PGIMBALSWITCH;       // element ID: pitch gimbal switches
 	int ELID_YGIMBALSWITCH;       // element ID: yaw gimbal switches
 	int ELID_DISPLAY;             // element ID: gimbal display
+
+	void ApplyMainGimbal ();      // set main thruster directions from current gimbal angles
 };
 
 // ==============================================================
@@ -219,12 +225,15 @@ public:
 	void clbkPostCreation();
 	void clbkSaveState (FILEHANDLE scn);
 	bool clbkParseScenarioLine (const char *line);
-	void clbkPostStep (double simt, double simdt, double mjd);
+	void clbkSaveSnapshot (SnapshotWriter &snp);
+	bool clbkLoadSnapshot (SnapshotReader &snp);
 	bool clbkLoadPanel2D (int panelid, PANELHANDLE hPanel, DWORD viewW, DWORD viewH);
 	bool clbkLoadVC (int vcid);
 	bool clbkPlaybackEvent (double simt, double event_t, const char *event_type, const char *event);
 
 private:
+	static void CoverStep (int id, AnimState2 *state, void *context);
+
 	AnimState2 rcover_state;
 	RetroCoverSwitch *sw;
 	RetroCoverIndicator *indicator;
@@ -267,9 +267,10 @@ bool MfdButtonCol::Redraw2D (SURFHANDLE surf)
 {
 	int btn, x, /*y,*/ len, i, w;
 	const char *label;
+	BltBatch &blt = subsys->DG()->BltQueue();
 
 	for (btn = 0; btn < nbtn; btn++)
-		oapiBlt (surf, surf, xcnt-14, lbly[btn], 773, 22, 28, CHH); // blank label
+		blt.Blt (surf, surf, xcnt-14, lbly[btn], 773, 22, 28, CHH); // blank label
 
 	for (btn = 0; btn < 6; btn++) {
 		if (label = oapiMFDButtonLabel (subsys->MfdId(), btn+sd*6)) {
@@ -278,7 +279,7 @@ bool MfdButtonCol::Redraw2D (SURFHANDLE surf)
 			for (i = 0, x = xcnt-w/2; i < len; i++) {
 				w = CHW[label[i]];
 				if (w) {
-					oapiBlt (surf, surf, x, lbly[btn], CHX[label[i]], CHY, w, CHH);
+					blt.Blt (surf, surf, x, lbly[btn], CHX[label[i]], CHY, w, CHH);
 					x += w;
 				}
 			}
@@ -341,13 +342,14 @@ bool MfdButtonCol::RedrawVC (DEVMESHHANDLE hMesh, SURFHANDLE surf)
 		const int CHY = 1012;
 
 		surf = subsys->VcTex();
+		BltBatch &blt = subsys->DG()->BltQueue();
 
 		const int xcnt0 = 148, dx = 40, wlbl = 32, hlbl = 12;
 		const char *label;
 		int btn, xcnt, x, y = 14+sd*41+subsys->MfdId()*82, w, len, i;
 
 		for (btn = 0; btn < 6; btn++)
-			oapiBlt (surf, surf, xcnt0-wlbl/2+btn*dx, y, 0, 128, wlbl, hlbl); // blank label
+			blt.Blt (surf, surf, xcnt0-wlbl/2+btn*dx, y, 0, 128, wlbl, hlbl); // blank label
 
 		for (btn = 0; btn < 6; btn++) {
 			if (label = oapiMFDButtonLabel (subsys->MfdId(), btn+sd*6)) {
@@ -357,7 +359,7 @@ bool MfdButtonCol::RedrawVC (DEVMESHHANDLE hMesh, SURFHANDLE surf)
 				for (i = 0, x = xcnt-w/2; i < len; i++) {
 					w = CHW[label[i]];
 					if (w) {
-						oapiBlt (surf, surf, x, y, CHX[label[i]], CHY, w, hlbl);
+						blt.Blt (surf, surf, x, y, CHX[label[i]], CHY, w, hlbl);
 						x += w;
 					}
 				}
@@ -296,7 +296,7 @@ void AngRateIndicator::BlitReadout (int which, int axis, const char *str, SURFHA
 				case 'G': srcx = 15*8; break;
 				default:  srcx = 16*8; break;
 			}
-			oapiBlt (tgt, bsrc, tgtx, tgty, srcx, srcy, w, h);
+			((DeltaGlider*)vessel)->BltQueue().Blt (tgt, bsrc, tgtx, tgty, srcx, srcy, w, h);
 			tgtstr[i] = c;
 		}
 		tgtx += w;
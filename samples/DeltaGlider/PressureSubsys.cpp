@@ -29,9 +29,21 @@ PressureSubsystem::PressureSubsystem (DeltaGlider *vessel)
 {
 	extern GDIParams g_Param;
 
-	p_cabin = p_airlock = 100e3;
-	p_ext_hatch = p_ext_lock = 0.0;
 	docked = false;
+	dock_net = 0;
+	v_extdock = 2.0;
+
+	gn_cabin    = gas.AddCompartment (v_cabin, 100e3);
+	gn_airlock  = gas.AddCompartment (v_airlock, 100e3);
+	gn_exthatch = gas.AddBoundary (0.0);
+	gn_extlock  = gas.AddBoundary (0.0);
+	gn_supply   = gas.AddBoundary (400e3);
+	gl_hatch    = gas.AddLink (gn_cabin, gn_exthatch, 0.0);
+	gl_olock    = gas.AddLink (gn_airlock, gn_extlock, 0.0);
+	gl_ilock    = gas.AddLink (gn_cabin, gn_airlock, 0.0);
+	gl_csupply  = gas.AddRegulator (gn_cabin, gn_supply, 0.0, p_target);
+	gl_asupply  = gas.AddRegulator (gn_airlock, gn_supply, 0.0, p_target);
+	gas.RegisterPort (vessel->GetHandle(), 0, gn_extlock);
 
 	AddSubsystem (airlockctrl = new AirlockCtrl (this));
 	AddSubsystem (hatchctrl = new TophatchCtrl (this));
@@ -121,92 +133,104 @@ void PressureSubsystem::RepairDamage ()
 
 // --------------------------------------------------------------
 
+WORD PressureSubsystem::SnapshotVersion () const
+{
+	return 2; // v2: valves and gas network
+}
+
+// --------------------------------------------------------------
+
+void PressureSubsystem::clbkSaveSnapshot (SnapshotWriter &snp)
+{
+	for (int i = 0; i < 5; i++)
+		snp.Put (valve_status[i]);
+	snp.Put (docked);
+	gas.SaveSnapshot (snp);
+}
+
+// --------------------------------------------------------------
+
+bool PressureSubsystem::clbkLoadSnapshot (SnapshotReader &snp)
+{
+	int i, vs[5];
+	bool dck;
+	for (i = 0; i < 5; i++)
+		if (!snp.Get (vs[i])) return false;
+	if (!snp.Get (dck) || !gas.LoadSnapshot (snp)) return false;
+
+	for (i = 0; i < 5; i++) {
+		valve_status[i] = vs[i];
+		valve_switch[i]->SetState (vs[i] ? DGSwitch1::UP : DGSwitch1::DOWN);
+		DG()->TriggerRedrawArea (1, 0, ELID_PVALVESWITCH[i]);
+	}
+
+	// Drop the docking tunnel. The restored network state includes the
+	// node type of the space outside the airlock; clbkPostStep connects
+	// to the docked vessel again if the dock is still engaged.
+	if (dock_net) {
+		if (gas.IsConnected (dock_net)) gas.Disconnect (dock_net);
+		dock_net = 0;
+	}
+	docked = dck;
+	return true;
+}
+
+// --------------------------------------------------------------
+
 void PressureSubsystem::clbkPostStep (double simt, double simdt, double mjd)
 {
 	DGSubsystem::clbkPostStep (simt, simdt, mjd);
 
 	docked = DG()->DockingStatus(0) != 0;
 	double p_static = DG()->GetAtmPressure();
-	p_ext_hatch = p_static;
+	gas.SetPressure (gn_exthatch, p_static);
 	if (!docked) {
-		p_ext_lock = p_static;
+		if (dock_net) {
+			if (gas.IsConnected (dock_net)) gas.Disconnect (dock_net);
+			dock_net = 0;
+		}
+		if (!gas.IsBoundary (gn_extlock)) gas.SetBoundary (gn_extlock, true);
+		double p_ext_lock = p_static;
 		if (!DG()->SubsysDocking()->NconeState().IsClosed())
 			p_ext_lock += DG()->GetDynPressure() * DG()->SubsysDocking()->NconeState().State();
-	}
-	else v_extdock = 2.0; // for now
-
-	double cs, pdiff, dvol, dpc, dpa, pc, pa;
-
-	// exchange cabin - ext.hatch
-	cs = (valve_status[1] ? 2e-4:0.0);
-	cs += 0.1*HatchState().State();
-	if (cs) {
-		pdiff = p_ext_hatch-p_cabin;
-		dvol = pdiff*cs*simdt*1e3;
-		dpc = dvol/v_cabin;
-		pc = p_cabin + dpc;
-		if (p_cabin > p_ext_hatch) pc = max(pc,p_ext_hatch);
-		else                       pc = min(pc,p_ext_hatch);
-		p_cabin = pc;
-	}
-
-	// exchange airlock - ext.lock
-	cs = (valve_status[3] ? 2e-4:0.0);
-	cs += 1.0*OLockState().State();
-	if (cs) {
-		pdiff = p_ext_lock-p_airlock;
-		dvol = pdiff*cs*simdt*1e3;
-		dpa = dvol/v_airlock;
-		pa = p_airlock + dpa;
-		if (docked) {
-			dpc = -dvol/v_extdock;
-			pc = p_ext_lock + dpc;
-			if ((p_airlock-p_ext_lock)*(pa-pc) < 0.0)
-				pa = pc = (pa*v_airlock + pc*v_extdock)/(v_airlock+v_extdock);
-			p_ext_lock = pc;
-		} else {
-			if (p_airlock > p_ext_lock) pa = max(pa,p_ext_lock);
-			else                        pa = min(pa,p_ext_lock);
-		}
-		p_airlock = pa;
+		gas.SetPressure (gn_extlock, p_ext_lock);
+	} else {
+		// the space outside the airlock becomes part of the docking tunnel
+		if (gas.IsBoundary (gn_extlock)) gas.SetBoundary (gn_extlock, false, v_extdock);
+		if (!dock_net) ConnectDock ();
 	}
 
-	// exchange cabin - airlock
-	cs = (valve_status[2] ? 2e-4:0.0);
-	cs += 1.0*ILockState().State();
-	if (cs) {
-		pdiff = p_cabin-p_airlock;
-		dvol = pdiff*cs*simdt*1e3;
-		dpc = -dvol/v_cabin;
-		dpa = dvol/v_airlock;
-		pc = p_cabin + dpc;
-		pa = p_airlock + dpa;
-		if ((p_airlock-p_cabin)*(pa-pc) < 0.0)
-			pa = pc = (pa*v_airlock + pc*v_cabin)/(v_airlock+v_cabin);
-		p_cabin = pc;
-		p_airlock = pa;
-	}
+	// valve and door conductances [m^3/s]
+	gas.SetLink (gl_hatch, ((valve_status[1] ? 2e-4:0.0) + 0.1*HatchState().State())*1e3);
+	gas.SetLink (gl_olock, ((valve_status[3] ? 2e-4:0.0) + 1.0*OLockState().State())*1e3);
+	gas.SetLink (gl_ilock, ((valve_status[2] ? 2e-4:0.0) + 1.0*ILockState().State())*1e3);
+	gas.SetLink (gl_csupply, (valve_status[0] ? 5e-5:0.0)*1e3);
+	gas.SetLink (gl_asupply, (valve_status[4] ? 5e-5:0.0)*1e3);
 
-	// supply cabin
-	cs = (valve_status[0] ? 5e-5:0.0);
-	if (cs) {
-		pdiff = 400e3-p_cabin;
-		dvol = pdiff*cs*simdt*1e3;
-		dpc = dvol/v_cabin;
-		pc = p_cabin + dpc;
-		pc = min (pc, p_target);
-		p_cabin = pc;
-	}
+	gas.Step (simt, simdt);
+}
 
-	// supply airlock
-	cs = (valve_status[4] ? 5e-5:0.0);
-	if (cs) {
-		pdiff = 400e3-p_airlock;
-		dvol = pdiff*cs*simdt*1e3;
-		dpa = dvol/v_airlock;
-		pa = p_airlock + dpa;
-		pa = min (pa, p_target);
-		p_airlock = pa;
+// --------------------------------------------------------------
+// Merge the pressure network of a docked vessel which exposes one
+// at the mating port into ours
+
+void PressureSubsystem::ConnectDock ()
+{
+	const double G_tunnel = 10.0; // docking tunnel conductance [m^3/s]
+	OBJHANDLE hDocked = DG()->GetDockStatus (DG()->GetDockHandle (0));
+	if (!hDocked) return;
+	VESSEL *v = oapiGetVesselInterface (hDocked);
+	for (UINT i = 0; i < v->DockCount(); i++) {
+		if (v->GetDockStatus (v->GetDockHandle (i)) == DG()->GetHandle()) {
+			GasNetwork *net;
+			int node;
+			if (GasNetwork::FindPort (hDocked, i, net, node) && !net->IsBoundary (node)) {
+				if (!gas.IsConnected (net))
+					gas.Connect (gn_extlock, net, node, G_tunnel);
+				dock_net = net;
+			}
+			break;
+		}
 	}
 }
 
@@ -303,6 +327,9 @@ AirlockCtrl::AirlockCtrl (PressureSubsystem *_subsys)
 	anim_ilock = DG()->CreateAnimation (0);
 	DG()->AddAnimationComponent (anim_ilock, 0, 1, &ILock);
 	DG()->AddAnimationComponent (anim_ilock, 0, 1, &VCILock);
+
+	DG()->Actuators()->AddActuator (anim_olock, &ostate, LockStep, this);
+	DG()->Actuators()->AddActuator (anim_ilock, &istate, LockStep, this);
 }
 
 // --------------------------------------------------------------
@@ -399,6 +426,28 @@ bool AirlockCtrl::clbkParseScenarioLine (const char *line)
 
 // --------------------------------------------------------------
 
+void AirlockCtrl::clbkSaveSnapshot (SnapshotWriter &snp)
+{
+	ostate.SaveSnapshot (snp);
+	istate.SaveSnapshot (snp);
+}
+
+// --------------------------------------------------------------
+
+bool AirlockCtrl::clbkLoadSnapshot (SnapshotReader &snp)
+{
+	if (!ostate.LoadSnapshot (snp) || !istate.LoadSnapshot (snp))
+		return false;
+	clbkPostCreation ();
+	osw->SetState (ostate.IsClosed() || ostate.IsClosing() ? DGSwitch1::DOWN : DGSwitch1::UP);
+	isw->SetState (istate.IsClosed() || istate.IsClosing() ? DGSwitch1::DOWN : DGSwitch1::UP);
+	DG()->TriggerRedrawArea (1, 0, ELID_OSWITCH);
+	DG()->TriggerRedrawArea (1, 0, ELID_ISWITCH);
+	return true;
+}
+
+// --------------------------------------------------------------
+
 void AirlockCtrl::clbkPostCreation ()
 {
 	DG()->SetAnimation (anim_olock, ostate.State());
@@ -407,19 +456,9 @@ void AirlockCtrl::clbkPostCreation ()
 
 // --------------------------------------------------------------
 
-void AirlockCtrl::clbkPostStep (double simt, double simdt, double mjd)
+void AirlockCtrl::LockStep (int id, AnimState2 *state, void *context)
 {
-	// animate outer airlock
-	if (ostate.Process (simdt)) {
-		DG()->SetAnimation (anim_olock, ostate.State());
-		DG()->UpdateStatusIndicators();
-	}
-
-	// animate inner airlock
-	if (istate.Process (simdt)) {
-		DG()->SetAnimation (anim_ilock, istate.State());
-		DG()->UpdateStatusIndicators();
-	}
+	((AirlockCtrl*)context)->DG()->UpdateStatusIndicators();
 }
 
 // --------------------------------------------------------------
@@ -593,6 +632,13 @@ bool InnerLockSwitch::ProcessMouseVC (int event, VECTOR3 &p)
 // Top hatch controls
 // ==============================================================
 
+static void HatchFailureCallback (void *context, int id, double rate)
+{
+	((TophatchCtrl*)context)->HatchFailure();
+}
+
+// --------------------------------------------------------------
+
 TophatchCtrl::TophatchCtrl (PressureSubsystem *_subsys)
 : DGSubsystem(_subsys)
 {
@@ -600,6 +646,10 @@ TophatchCtrl::TophatchCtrl (PressureSubsystem *_subsys)
 	hatch_vent   = NULL;
 	hatchfail    = 0;
 
+	// damage condition: dynamic pressure on the open hatch
+	fm_hatch     = DG()->FailModel().AddInput ();
+	fm_hatchcond = DG()->FailModel().AddHazard (fm_hatch, 30e3, true, 0.2, 0.0, HatchFailureCallback, this);
+
 	ELID_SWITCH = AddElement (sw = new HatchCtrlSwitch (this));
 
 	// Top hatch animation
@@ -628,6 +678,7 @@ TophatchCtrl::TophatchCtrl (PressureSubsystem *_subsys)
 	DG()->AddAnimationComponent (anim_hatch, 0.25, 0.8, &RearLadder2);
 	DG()->AddAnimationComponent (anim_hatch, 0, 0.25, &VCRearLadder1);
 	DG()->AddAnimationComponent (anim_hatch, 0.25, 0.8, &VCRearLadder2);
+	DG()->Actuators()->AddActuator (anim_hatch, &hatch_state, HatchStep, this);
 }
 
 // --------------------------------------------------------------
@@ -656,7 +707,7 @@ void TophatchCtrl::OpenHatch ()
 		hatch_vent = DG()->AddParticleStream (&airvent, pos, dir, &lvl);
 		hatch_vent_t = oapiGetSimTime();
 	}
-	hatch_state.Open();
+	if (!hatchfail) hatch_state.Open(); // a jammed hatch doesn't move
 	sw->SetState(DGSwitch1::UP);
 	DG()->TriggerRedrawArea(1, 0, ELID_SWITCH);
 	DG()->UpdateStatusIndicators();
@@ -670,7 +721,7 @@ void TophatchCtrl::CloseHatch ()
 {
 	extern void UpdateCtrlDialog (DeltaGlider *dg, HWND hWnd=0);
 
-	hatch_state.Close();
+	if (!hatchfail) hatch_state.Close();
 	sw->SetState(DGSwitch1::DOWN);
 	DG()->TriggerRedrawArea(1, 0, ELID_SWITCH);
 	DG()->UpdateStatusIndicators();
@@ -704,6 +755,35 @@ bool TophatchCtrl::clbkParseScenarioLine (const char *line)
 
 // --------------------------------------------------------------
 
+WORD TophatchCtrl::SnapshotVersion () const
+{
+	return 2; // v2: hatch failure state
+}
+
+// --------------------------------------------------------------
+
+void TophatchCtrl::clbkSaveSnapshot (SnapshotWriter &snp)
+{
+	hatch_state.SaveSnapshot (snp);
+	snp.Put (hatchfail);
+}
+
+// --------------------------------------------------------------
+
+bool TophatchCtrl::clbkLoadSnapshot (SnapshotReader &snp)
+{
+	if (!hatch_state.LoadSnapshot (snp) || !snp.Get (hatchfail)) return false;
+	if (hatchfail) hatch_state.Stop();
+	ShowHatch (hatchfail < 2);
+	DG()->FailModel().Arm (fm_hatchcond, hatchfail < 2); // a torn-off hatch can't fail again
+	clbkPostCreation ();
+	sw->SetState (hatch_state.IsClosed() || hatch_state.IsClosing() ? DGSwitch1::DOWN : DGSwitch1::UP);
+	DG()->TriggerRedrawArea (1, 0, ELID_SWITCH);
+	return true;
+}
+
+// --------------------------------------------------------------
+
 void TophatchCtrl::clbkPostCreation ()
 {
 	DG()->SetAnimation (anim_hatch, hatch_state.State());	
@@ -711,40 +791,53 @@ void TophatchCtrl::clbkPostCreation ()
 
 // --------------------------------------------------------------
 
-void TophatchCtrl::clbkPostStep (double simt, double simdt, double mjd)
+void TophatchCtrl::HatchStep (int id, AnimState2 *state, void *context)
 {
-	// animate top hatch
-	if (!hatchfail && hatch_state.Process (simdt)) {
-		DG()->SetAnimation (anim_hatch, hatch_state.State());
-		DG()->UpdateStatusIndicators();
-	}
+	((TophatchCtrl*)context)->DG()->UpdateStatusIndicators();
+}
 
+// --------------------------------------------------------------
+
+void TophatchCtrl::clbkPostStep (double simt, double simdt, double mjd)
+{
 	// air venting particle stream
 	if (hatch_vent && simt > hatch_vent_t + 1.0) {
 		DG()->DelExhaustStream (hatch_vent);
 		hatch_vent = NULL;
 	}
 
-	// test for damage condition
-	if (hatchfail < 2 && hatch_state.State() > 0.05 && DG()->GetDynPressure() > 30e3) {
-		if (oapiRand() < 1.0 - exp(-simdt*0.2)) {
-			if (++hatchfail == 1) {  // jam hatch
-				hatch_state.SetState (0.2, 0.0);
-				DG()->SetAnimation(anim_hatch, 0.2);
-			} else {                 // tear off hatch
-				static UINT HatchGrp[2] = {12,88};
-				GROUPEDITSPEC ges;
-				ges.flags = GRPEDIT_SETUSERFLAG;
-				ges.UsrFlag = 3;
-				for (int i = 0; i < 2; i++)
-					oapiEditMeshGroup (DG()->exmesh, HatchGrp[i], &ges);
-			}
-		}
+	// monitored input for the damage condition
+	DG()->FailModel().SetInput (fm_hatch, hatch_state.State() > 0.05 ? DG()->GetDynPressure() : 0.0);
+}
+
+// --------------------------------------------------------------
+
+void TophatchCtrl::HatchFailure ()
+{
+	if (++hatchfail == 1) {  // jam hatch
+		hatch_state.SetState (0.2, 0.0);
+		DG()->SetAnimation(anim_hatch, 0.2);
+	} else {                 // tear off hatch
+		ShowHatch (false);
+		DG()->FailModel().Arm (fm_hatchcond, false);
 	}
 }
 
 // --------------------------------------------------------------
 
+void TophatchCtrl::ShowHatch (bool show)
+{
+	if (!DG()->exmesh) return;
+	static UINT HatchGrp[2] = {12,88};
+	GROUPEDITSPEC ges;
+	ges.flags = GRPEDIT_SETUSERFLAG;
+	ges.UsrFlag = (show ? 0 : 3);
+	for (int i = 0; i < 2; i++)
+		oapiEditMeshGroup (DG()->exmesh, HatchGrp[i], &ges);
+}
+
+// --------------------------------------------------------------
+
 bool TophatchCtrl::clbkLoadPanel2D (int panelid, PANELHANDLE hPanel, DWORD viewW, DWORD viewH)
 {
 	if (panelid != 1) return false;
@@ -790,13 +883,10 @@ void TophatchCtrl::RepairDamage ()
 	if (hatchfail) {
 		hatch_state.SetState (0.0, 0.0);
 		DG()->SetAnimation (anim_hatch, 0.0);
-		static UINT HatchGrp[2] = {12,88};
-		GROUPEDITSPEC ges;
-		ges.flags = GRPEDIT_SETUSERFLAG;
-		ges.UsrFlag = 0;
-		for (int i = 0; i < 2; i++)
-			oapiEditMeshGroup (DG()->exmesh, HatchGrp[i], &ges);
+		ShowHatch (true);
+		hatchfail = 0;
 	}
+	DG()->FailModel().Reset (fm_hatchcond); // re-arm, clear accumulated hazard
 }
 
 // ==============================================================
@@ -985,7 +1075,7 @@ void PressureIndicator::BlitReadout (int which, const char *str)
 				case 'G': srcx = 15*8; break;
 				default:  srcx = 16*8; break;
 			}
-			oapiBlt (btgt, bsrc, tgtx, tgty, srcx, srcy, w, h);
+			subsys->DG()->BltQueue().Blt (btgt, bsrc, tgtx, tgty, srcx, srcy, w, h);
 			tgtstr[i] = c;
 		}
 		tgtx += w;
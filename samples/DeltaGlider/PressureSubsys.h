@@ -14,6 +14,7 @@
 #include "DeltaGlider.h"
 #include "DGSubsys.h"
 #include "DGSwitches.h"
+#include "..\Common\Vessel\GasNet.h"
 
 // ==============================================================
 
@@ -30,10 +31,11 @@ class PressureSubsystem: public DGSubsystem {
 public:
 	PressureSubsystem (DeltaGlider *vessel);
 	~PressureSubsystem ();
-	inline double PCabin() const { return p_cabin; }
-	inline double PAirlock() const { return p_airlock; }
-	inline double PExtHatch() const { return p_ext_hatch; }
-	inline double PExtLock() const { return p_ext_lock; }
+	inline double PCabin() const { return gas.Pressure (gn_cabin); }
+	inline double PAirlock() const { return gas.Pressure (gn_airlock); }
+	inline double PExtHatch() const { return gas.Pressure (gn_exthatch); }
+	inline double PExtLock() const { return gas.Pressure (gn_extlock); }
+	inline GasNetwork *GasNet() { return &gas; }
 	inline int GetPValve (int i) const { return valve_status[i]; }
 	inline void SetPValve (int i, int status) { valve_status[i] = status; }
 	const AnimState2 &OLockState () const;
@@ -46,14 +48,24 @@ public:
 	void CloseHatch ();
 	const AnimState2 &HatchState() const;
 	void RepairDamage ();
+	WORD SnapshotVersion () const;
+	void clbkSaveSnapshot (SnapshotWriter &snp);
+	bool clbkLoadSnapshot (SnapshotReader &snp);
 	void clbkPostStep (double simt, double simdt, double mjd);
 	bool clbkLoadPanel2D (int panelid, PANELHANDLE hPanel, DWORD viewW, DWORD viewH);
 	bool clbkLoadVC (int vcid);     // create the VC elements for this module
 
 private:
+	void ConnectDock ();
+
 	bool docked;
-	double p_cabin, p_airlock;      // current pressure in cabin and airlock [Pa]
-	double p_ext_hatch, p_ext_lock; // current pressure outside hatch and airlock [Pa]
+	GasNetwork gas;                 // compartment pressure network
+	int gn_cabin, gn_airlock;       // cabin and airlock nodes
+	int gn_exthatch, gn_extlock;    // nodes outside hatch and airlock
+	int gn_supply;                  // supply tank node
+	int gl_hatch, gl_olock, gl_ilock; // hatch and airlock door links
+	int gl_csupply, gl_asupply;     // cabin and airlock supply regulators
+	GasNetwork *dock_net;           // network of the docked vessel, if connected
 	static double v_cabin;          // cabin volume [m^3]
 	static double v_airlock;        // airlock volume [m^3]
 	double v_extdock;               // volume of compartment outside airlock
@@ -90,14 +102,17 @@ public:
 	inline const AnimState2 &ILockState() const { return istate; }
 	void clbkSaveState (FILEHANDLE scn);
 	bool clbkParseScenarioLine (const char *line);
+	void clbkSaveSnapshot (SnapshotWriter &snp);
+	bool clbkLoadSnapshot (SnapshotReader &snp);
 	void clbkPostCreation ();
-	void clbkPostStep (double simt, double simdt, double mjd);
 	bool clbkLoadPanel2D (int panelid, PANELHANDLE hPanel, DWORD viewW, DWORD viewH);
 	bool clbkLoadVC (int vcid);
 	bool clbkPlaybackEvent (double simt, double event_t, const char *event_type, const char *event);
 	int clbkConsumeBufferedKey (DWORD key, bool down, char *kstate);
 
 private:
+	static void LockStep (int id, AnimState2 *state, void *context);
+
 	AnimState2 ostate, istate;
 
 	OuterLockSwitch *osw;
@@ -154,8 +169,12 @@ public:
 	void Revert ();
 	inline const AnimState2 &State() const { return hatch_state; }
 	void RepairDamage();
+	void HatchFailure();
 	void clbkSaveState (FILEHANDLE scn);
 	bool clbkParseScenarioLine (const char *line);
+	WORD SnapshotVersion () const;
+	void clbkSaveSnapshot (SnapshotWriter &snp);
+	bool clbkLoadSnapshot (SnapshotReader &snp);
 	void clbkPostCreation ();
 	void clbkPostStep (double simt, double simdt, double mjd);
 	bool clbkLoadPanel2D (int panelid, PANELHANDLE hPanel, DWORD viewW, DWORD viewH);
@@ -163,6 +182,9 @@ public:
 	bool clbkPlaybackEvent (double simt, double event_t, const char *event_type, const char *event);
 
 private:
+	static void HatchStep (int id, AnimState2 *state, void *context);
+	void ShowHatch (bool show);     // hide the hatch mesh groups once it is torn off
+
 	AnimState2 hatch_state;
 	HatchCtrlSwitch *sw;
 	int ELID_SWITCH;
@@ -170,6 +192,7 @@ private:
 	double hatch_vent_t;
 	UINT anim_hatch;            // handle for top hatch animation
 	int hatchfail;
+	int fm_hatch, fm_hatchcond; // failure model input and condition for the open hatch
 };
 
 // ==============================================================
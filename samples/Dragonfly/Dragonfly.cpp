@@ -843,7 +843,7 @@ void Dragonfly::LoadPanel(int id)
     CurrentPANEL=id;
 }
 
-void Dragonfly::PanelEvent(int id,int event,SURFHANDLE surf)
+bool Dragonfly::PanelEvent(int id,int event,SURFHANDLE surf)
 {
 Internals.PanelList[CurrentPANEL].surf=surf;	//get the surface handle, since intruments will be using this
 switch (event) {
@@ -851,14 +851,13 @@ switch (event) {
 		Internals.PanelList[CurrentPANEL].Paint(id);
 		break;
 	case PANEL_REDRAW_ALWAYS:
-		Internals.PanelList[CurrentPANEL].Refresh(id);
-		break;
+		return Internals.PanelList[CurrentPANEL].Refresh(id); //scheduled, may be skipped
 	case PANEL_REDRAW_USER:
 		Internals.PanelList[CurrentPANEL].Paint(id);
 		break;
 
 };
-
+return true;
 };
 
 
@@ -972,8 +971,7 @@ bool Dragonfly::clbkLoadPanel (int id)
 
 bool Dragonfly::clbkPanelRedrawEvent (int id, int event, SURFHANDLE surf)
 {
-	PanelEvent (id, event, surf);
-	return true;
+	return PanelEvent (id, event, surf);
 }
 
 bool Dragonfly::clbkPanelMouseEvent (int id, int event, int mx, int my)
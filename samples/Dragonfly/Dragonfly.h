@@ -45,7 +45,7 @@ public:
 	void LoadState (FILEHANDLE scn, void *vs);
 	void SaveState (FILEHANDLE scn);
 	void LoadPanel(int id);
-	void PanelEvent(int id,int event,SURFHANDLE surf);
+	bool PanelEvent(int id,int event,SURFHANDLE surf);
 	void MouseEvent(int id,int event,int mx,int my);
     
 	void DockEvent (int dock, OBJHANDLE connected);
@@ -4,6 +4,7 @@
 
 #include "orbitersdk.h"
 #include "instruments.h"
+#include "..\Common\Vessel\BltBatch.h"
 
 typedef struct
 { int x;
@@ -43,6 +44,11 @@ class Panel
    CTEXT_LIST* CText_list;
    BORDER_LIST* Border_list;
    instrument_list *instruments;
+   BltBatch blt;		//instrument blits, submitted at the end of each redraw event
+   instrument **inst_index;	//instruments by panel area index
+   int inst_num;
+   double group_t[REFRESH_GROUPS];			//frame in which a group was last refreshed
+   instrument *group_wait[REFRESH_GROUPS];	//group member deferred to the next frame
    int text_num,screw_num,ctext_num,border_num;
    int neighbours[4];
    int idx;				//index of panel 
@@ -57,7 +63,8 @@ class Panel
    void AddInstrument(instrument* new_inst);
    void RegisterYourInstruments();
    void Paint(int index);	//all the instruments;
-   void Refresh(int index);	//for instruments who need constant refresh;
+   bool Refresh(int index);	//for instruments who need constant refresh; returns false if skipped
+   void LogRefreshCost();	//write per-instrument refresh cost to the log
    void LBD(int index,int x,int y);
    void RBD(int index,int x,int y);
    void BU(int index);
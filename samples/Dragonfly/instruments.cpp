@@ -15,6 +15,13 @@ instrument::instrument(int x, int y,Panel* i_parent)
 { ScrX=x;ScrY=y;parent=i_parent;
   parent->AddInstrument(this);
 type=30; //void instrument
+refresh_dt=0;refresh_due=0;refresh_group=0;refresh_force=true;
+refresh_t=0;refresh_step=0;
+refresh_ticks=0;refresh_num=0;refresh_skip=0;
+};
+void instrument::SetRefreshRate(double rate, int group)
+{ refresh_dt=(rate>0?1.0/rate:0);
+  refresh_group=group;
 };
 
 
@@ -23,6 +30,7 @@ TB::TB(int x, int y, float *i_SRC,Panel *i_parent):instrument(x,y,i_parent)
 { SRC=i_SRC;
   last_d=2; //we sure need a redraw :-)
 type=31;//TB
+SetRefreshRate(10);
 }
 void TB::RegisterMe(int index)
 {
@@ -54,10 +62,10 @@ void TB::PaintMe()
  oapiReleaseDC(parent->surf,hDC);
 */
 if (*SRC)
-{oapiBlt(parent->surf,hTbSRF,0,0,20,0,20,20);
+{parent->blt.Blt(parent->surf,hTbSRF,0,0,20,0,20,20);
 last_d=1;}
 else {
- oapiBlt(parent->surf,hTbSRF,0,0,0,0,20,20);
+ parent->blt.Blt(parent->surf,hTbSRF,0,0,0,0,20,20);
  last_d=0;
 }
 
@@ -67,6 +75,9 @@ void TB::RefreshMe()
 { if (*SRC) {if (last_d==0) PaintMe();}
   else { if (last_d==1) PaintMe();}
 }
+bool TB::Changed()
+{ return (last_d!=(*SRC?1:0));
+}
 
 Switch::Switch(int x, int y, int i_pos,int i_num_pos,int i_sp, int *i_SRC,Panel *i_parent):instrument(x,y,i_parent)
 { pos=i_pos;num_pos=i_num_pos;
@@ -80,7 +91,7 @@ void Switch::RegisterMe(int index)
 };
 void Switch::PaintMe()
 { 
-oapiBlt(parent->surf,hSwitchSRF,0,0,50+pos*50,0,50,50);
+parent->blt.Blt(parent->surf,hSwitchSRF,0,0,50+pos*50,0,50,50);
 };
 
 void Switch::LBD(int x, int y)
@@ -113,7 +124,7 @@ void CB::RegisterMe(int index)
 void CB::PaintMe()
 
 {
-oapiBlt(parent->surf,hCbSRF,0,0,pos*50,0,50,50);
+parent->blt.Blt(parent->surf,hCbSRF,0,0,pos*50,0,50,50);
 };
 void CB::LBD(int x,int y)
 { if (pos) pos=0;
@@ -146,9 +157,9 @@ void Slider::RegisterMe(int index)
 };
 void Slider::PaintMe()
 { //copy the main surface
-oapiBlt(parent->surf,hSliderSRF,0,0,0,0,34,20);
+parent->blt.Blt(parent->surf,hSliderSRF,0,0,0,0,34,20);
 //then the sliding thingie
-oapiBlt(parent->surf,hSliderSRF,7,5,35+(int)(am_i/2),4,22,10);
+parent->blt.Blt(parent->surf,hSliderSRF,7,5,35+(int)(am_i/2),4,22,10);
 };
 void Slider::RefreshMe()
 { if ((*SRC)&&(am_i>0))  {
@@ -260,6 +271,7 @@ else {
   temps=oapiCreateSurface(40,40);
   lastdraw=-5*3.1415/8;
 type=37;//Egauge
+SetRefreshRate(30);
  };
 
 void screwdraw(HDC h,int x, int y)
@@ -316,17 +328,23 @@ oapiBlt(temps,parent->surf,0,0,30,30,40,40); //save this onto a back-surf
  };
 
 
+float EGauge::Angle()
+{float Pi=3.1415;
+float ang= -(((*SRC/scale)-MinV)/(MaxV-MinV)* 5*Pi/4)+5*Pi/8;          // get turn angle for the indicator
+if (ang>5*Pi/8) ang=5*Pi/8;	// if too large
+if (ang<-5*Pi/8) ang = -5*Pi/8;  // or too small
+return ang;
+};
+bool EGauge::Changed()
+{ return (fabs(Angle()-lastdraw)>0.002);	//pointer still moving?
+};
 void EGauge::RefreshMe()
 {
  oapiBlt(parent->surf,temps,30,30,0,0,40,40);//clean the surface 
 HDC hDC=oapiGetDC(parent->surf);				// then get a DC to draw new pointer
-float ang;
-float Pi=3.1415;
-//check for need to redraw ?
-ang= -(((*SRC/scale)-MinV)/(MaxV-MinV)* 5*Pi/4)+5*Pi/8;          // get turn angle for the indicator
-if (ang>5*Pi/8) ang=5*Pi/8;	// if too large
-if (ang<-5*Pi/8) ang = -5*Pi/8;  // or too small
-if (abs(ang-lastdraw)>0.3) ang=lastdraw+(ang>lastdraw?0.3:-0.3)+(ang-lastdraw)/100;//slowly move to the value 
+float ang=Angle();
+float dmax=(float)(9.0*refresh_step);	//slowly move to the value: 9 rad/s plus 30% of the remaining error per second
+if (fabs(ang-lastdraw)>dmax) ang=lastdraw+(ang>lastdraw?dmax:-dmax)+(ang-lastdraw)*(float)(0.3*refresh_step);
 lastdraw=ang;
 
 POINT S[3],TR[3];
@@ -351,6 +369,7 @@ HGauge::HGauge(int x,int y, int i_w,int i_h,float* i_SRC1,float* i_SRC2,char i_u
   strcpy(unit,i_unit);
   temps=oapiCreateSurface(31,190);lastdraw1=0;lastdraw2=0;
 type=38;//Hgauge
+SetRefreshRate(20);
 };
 void HGauge::RegisterMe(int index)
 {oapiRegisterPanelArea(index,_R(ScrX,ScrY,ScrX+85,ScrY+190),PANEL_REDRAW_ALWAYS,PANEL_MOUSE_IGNORE,PANEL_MAP_CURRENT);
@@ -403,23 +422,31 @@ void HGauge::PaintMe()
 
 
 
+};
+int HGauge::Pos(float *S)
+{int num=(190-45)- (*S/scale-MinV)/(MaxV-MinV) * (190-85); 
+  if (num<20) num=20; //get the value scaled
+  return num;
+};
+bool HGauge::Changed()
+{ return ((Pos(SRC1)!=lastdraw1)||(Pos(SRC2)!=lastdraw2));	//arrows still moving?
 };
 void HGauge::RefreshMe()
 {int num;
+int dmax=max(1,(int)(200.0*refresh_step));	//arrows move 200 pixel/s plus 4 times the remaining distance per second
 //get the naked stripes,
-oapiBlt(parent->surf,temps,12,0,0,0,9,190);
-oapiBlt(parent->surf,temps,85-22,0,10,0,9,190);
+parent->blt.Blt(parent->surf,temps,12,0,0,0,9,190);
+parent->blt.Blt(parent->surf,temps,85-22,0,10,0,9,190);
 
-  num=(190-45)- (*SRC1/scale-MinV)/(MaxV-MinV) * (190-85); 
-  if (num<20) num=20; //get the value scaled
-  if (abs(lastdraw1-num)>10) num=lastdraw1+(lastdraw1>num?-10:10)+(num-lastdraw1)/5;   
+  num=Pos(SRC1);
+  if (abs(lastdraw1-num)>dmax) num=lastdraw1+(lastdraw1>num?-dmax:dmax)+(int)((num-lastdraw1)*4.0*refresh_step);
   lastdraw1=num;
-  oapiBlt(parent->surf,temps,12,num,20,1,8,10,0xFFFFFF);
+  parent->blt.Blt(parent->surf,temps,12,num,20,1,8,10,0xFFFFFF);
  
-  num=(190-45)- (*SRC2/scale-MinV)/(MaxV-MinV) * (190-85); if (num<20) num=20;
-  if (abs(lastdraw2-num)>10) num=lastdraw2+(lastdraw2>num?-10:10)+(num-lastdraw2)/5;
+  num=Pos(SRC2);
+  if (abs(lastdraw2-num)>dmax) num=lastdraw2+(lastdraw2>num?-dmax:dmax)+(int)((num-lastdraw2)*4.0*refresh_step);
   lastdraw2=num;
-  oapiBlt(parent->surf,temps,85-21,num,21,10,8,10,0xFFFFFF);
+  parent->blt.Blt(parent->surf,temps,85-21,num,21,10,8,10,0xFFFFFF);
     
       };
 //---------------------------- ROTARY --------------------------------------------
@@ -462,7 +489,7 @@ for (int i=0; i<poznr;i++)					// now put all texts arround the circle
 }
 
  oapiReleaseDC(parent->surf,hDC);
- oapiBlt(parent->surf,hRotarySRF,36,41,400+(set-(int)(poznr/2))*100,0,100,100); //copy the backgorund
+ parent->blt.Blt(parent->surf,hRotarySRF,36,41,400+(set-(int)(poznr/2))*100,0,100,100); //copy the backgorund
 };
 void Rotary::LBD(int x,int y)
 {if (set>0)
@@ -512,6 +539,7 @@ DigClock::DigClock(int x, int y, char *i_SRC,int i_lng,Panel *i_parent):instrume
  type=40;//digclock
  local_srf=oapiCreateSurface(2+len*22,44);
 powered=0;
+SetRefreshRate(10);
 };
 DigClock::~DigClock()
 {oapiDestroySurface(local_srf);
@@ -533,11 +561,16 @@ LineTo(hDC,0,0);LineTo(hDC,0,43);
 oapiReleaseDC(local_srf,hDC);
 
 for (int i=0;i<len;i++)
-{	oapiBlt(local_srf,hClockSRF,22*i+1,1,220,0,22,42);//all blanc
+{	parent->blt.Blt(local_srf,hClockSRF,22*i+1,1,220,0,22,42);//all blanc
 local[i]=0;};
-oapiBlt(parent->surf,local_srf,0,0,0,0,2+len*22,44);
+parent->blt.Blt(parent->surf,local_srf,0,0,0,0,2+len*22,44);
 
 }
+bool DigClock::Changed()
+{ int pwr=(*(((Dragonfly*)parent->v)->DC_power)>0);
+  if (pwr!=powered) return true;
+  return (pwr && strncmp(local,SRC,len));
+};
 void DigClock::RefreshMe()
 { SRC[len]=0;
 if (*(((Dragonfly*)parent->v)->DC_power)>0) 
@@ -546,17 +579,17 @@ if (strcmp(local,SRC)) {
 	for (int i=0;i<len;i++)
 			if (local[i]!=SRC[i])	{
 				local[i]=SRC[i];
-				if ((local[i]>47)&&local[i]<58)  oapiBlt(local_srf,hClockSRF,22*i+1,1,22*(local[i]-48),0,22,42);
+				if ((local[i]>47)&&local[i]<58)  parent->blt.Blt(local_srf,hClockSRF,22*i+1,1,22*(local[i]-48),0,22,42);
 			    else 
-					if (local[i]==' ' ) oapiBlt(local_srf,hClockSRF,22*i+1,1,0,0,22,42); //space must be 0
+					if (local[i]==' ' ) parent->blt.Blt(local_srf,hClockSRF,22*i+1,1,0,0,22,42); //space must be 0
 					else  
 						if ((local[i]==':')||(local[i]=='.'))
-							oapiBlt(local_srf,hClockSRF,22*i+1,1,242,0,22,42); //:
+							parent->blt.Blt(local_srf,hClockSRF,22*i+1,1,242,0,22,42); //:
 						else 
-							oapiBlt(local_srf,hClockSRF,22*i+1,1,220,0,22,42);//rest
+							parent->blt.Blt(local_srf,hClockSRF,22*i+1,1,220,0,22,42);//rest
 //					sprintf(oapiDebugString(),"%s %i ",local,local[0]);
 									}
-oapiBlt(parent->surf,local_srf,0,0,0,0,2+len*22,44);
+parent->blt.Blt(parent->surf,local_srf,0,0,0,0,2+len*22,44);
 }
 }
 else
@@ -577,6 +610,7 @@ bool bounds::test()
 CW::CW(int x,int y,char *i_text,Panel *i_parent):instrument(x,y,i_parent)
 {b_list.next=NULL;last=&b_list;
  strcpy(text,i_text);alarm=1;
+ SetRefreshRate(5);
  temps=oapiCreateSurface(100,31);
 //
 HDC hDC2=oapiGetDC(temps);
@@ -606,7 +640,7 @@ void CW::RegisterMe(int index)
 }
 void CW::PaintMe()
 { 
-oapiBlt(parent->surf,temps,0,0,alarm*50,0,50,31);
+parent->blt.Blt(parent->surf,temps,0,0,alarm*50,0,50,31);
 
  }
 void CW::RefreshMe()
@@ -687,7 +721,7 @@ void Bitmap::RegisterMe(int index)
 oapiRegisterPanelArea(index,_R(ScrX,ScrY,ScrX+wdht,ScrY+hght),PANEL_REDRAW_INIT,PANEL_MOUSE_IGNORE);
 };
 void Bitmap::PaintMe()
-{ 	 oapiBlt(parent->surf,hFront_Panel_SRF[number],0,0,0,0,wdht,hght);
+{ 	 parent->blt.Blt(parent->surf,hFront_Panel_SRF[number],0,0,0,0,wdht,hght);
 };
 
 SSTRUCT_ITEM::SSTRUCT_ITEM(OBJHANDLE i_vs)
@@ -736,7 +770,7 @@ oapiRegisterPanelArea(index,_R(ScrX,ScrY,ScrX+202,ScrY+179),PANEL_REDRAW_ALWAYS,
 };
 void Docker::PaintMe()
 { 	
-oapiBlt(parent->surf,hDockBSRF,0,0,0,0,202,179);
+parent->blt.Blt(parent->surf,hDockBSRF,0,0,0,0,202,179);
 cgofs=((Dragonfly*)(parent->v))->cgofs;
 SURFHANDLE temps=oapiCreateSurface(202,179);
 HDC hDC=oapiGetDC(temps);
@@ -787,18 +821,19 @@ else {strcpy(text,"LOCAL");
 oapiReleaseDC(temps,hDC);
 if (dockflap){
 		if (docked_port)
-					oapiBlt(parent->surf,hDockSW1SRF,128,11,74,0,66,46);//a button you can push}
+					parent->blt.Blt(parent->surf,hDockAtlas,DockSW1,128,11,74,0,66,46);//a button you can push}
 		else   
- 					oapiBlt(parent->surf,hDockSW1SRF,128,11,146,0,66,46);//a button you can push
+ 					parent->blt.Blt(parent->surf,hDockAtlas,DockSW1,128,11,146,0,66,46);//a button you can push
 	}
 if (cgswitch)
-	oapiBlt(parent->surf,hDockSW2SRF,18,98,(cgswitch+1)*27,0,27,16);
+	parent->blt.Blt(parent->surf,hDockAtlas,DockSW2,18,98,(cgswitch+1)*27,0,27,16);
   
 if (*(((Dragonfly*)parent->v)->DC_power)>0) 
-     oapiBlt(parent->surf,temps,0,0,0,0,202,179,0x000000);
+     parent->blt.Blt(parent->surf,temps,0,0,0,0,202,179,0x000000);
+parent->blt.Flush();	//temps is released here
 oapiDestroySurface(temps);
 if (cgmode)
- oapiBlt(parent->surf,hDockDlSRF,21,73,21,0,21,21);
+ parent->blt.Blt(parent->surf,hDockAtlas,DockDl,21,73,21,0,21,21);
 };
 int Docker::BuildShipList(SSTRUCT_ITEM *ship)
 {OBJHANDLE newship;
@@ -933,10 +968,10 @@ void NAVFRQ::RegisterMe(int index)
 oapiRegisterPanelArea(index,_R(ScrX,ScrY,ScrX+201,ScrY+63),PANEL_REDRAW_INIT,15);
 };
 void NAVFRQ::PaintMe()
-{oapiBlt(parent->surf,hNavSRF,0,0,0,0,201,63);
-if (nav==2) oapiBlt(parent->surf,hDockDlSRF,21,14,21,0,21,21);
+{parent->blt.Blt(parent->surf,hNavSRF,0,0,0,0,201,63);
+if (nav==2) parent->blt.Blt(parent->surf,hDockAtlas,DockDl,21,14,21,0,21,21);
 if (frswitch)
-	oapiBlt(parent->surf,hDockSW2SRF,18,39,(frswitch+1)*27,0,27,16);
+	parent->blt.Blt(parent->surf,hDockAtlas,DockSW2,18,39,(frswitch+1)*27,0,27,16);
 if (*(((Dragonfly*)parent->v)->DC_power)>0)  {
 SURFHANDLE temps=oapiCreateSurface(101,26);
 HDC hDC=oapiGetDC(temps);
@@ -953,7 +988,8 @@ TextOut (hDC, 10, 2, text, strlen (text));
 sprintf(text, "NAV2: %5.2f MHz", 108.0+(0.05*frq2));
 TextOut (hDC, 10, 13, text, strlen (text));
 oapiReleaseDC(temps,hDC);
-oapiBlt(parent->surf,temps,80,20,0,0,80,25);
+parent->blt.Blt(parent->surf,temps,80,20,0,0,80,25);
+parent->blt.Flush();	//temps is released here
 oapiDestroySurface(temps);
 }
 };
@@ -993,6 +1029,7 @@ oapiTriggerPanelRedrawArea(parent->idx,idx);
 ADI::ADI(int x,int y, Panel *i_parent):instrument(x,y,i_parent)
 {
 type= 44; //ADI ball
+SetRefreshRate(30,REFRESH_GROUP_HEAVY);	//never in the same frame as the radar
 init=0;
 radius=10;
 int i;
@@ -1250,32 +1287,33 @@ void ADI::GetReference()
 void ADI::MoveBall()
 {   float delta;
 	float Pi=acos(-1.0);
+	float dmax=(float)(1.5*refresh_step);	//max. ball rate 1.5 rad/s
     over_rate=0.0;
     delta=target.z-now.z;
-	if (delta>0.05) {if (delta>Pi) {now.z+=2*Pi;MoveBall();
+	if (delta>dmax) {if (delta>Pi) {now.z+=2*Pi;MoveBall();
 									return;}
-						now.z+=0.05;over_rate=1.;}
-	else if (delta<-0.05){ if (delta<-Pi) {now.z-=2*Pi;MoveBall();
+						now.z+=dmax;over_rate=1.;}
+	else if (delta<-dmax){ if (delta<-Pi) {now.z-=2*Pi;MoveBall();
 								return;}
-						now.z-=0.05;over_rate=1.;}
+						now.z-=dmax;over_rate=1.;}
 	else now.z+=delta;
 
 	delta=target.y-now.y;
-	if (delta>0.05) {if (delta>Pi) {now.y+=2*Pi;MoveBall();
+	if (delta>dmax) {if (delta>Pi) {now.y+=2*Pi;MoveBall();
 									return;}
-					now.y+=0.05;over_rate=1.;}
-	else if (delta<-0.05) {if (delta<-Pi) {now.y-=2*Pi;MoveBall();
+					now.y+=dmax;over_rate=1.;}
+	else if (delta<-dmax) {if (delta<-Pi) {now.y-=2*Pi;MoveBall();
 								return;}
-						now.y-=0.05;over_rate=1.;}
+						now.y-=dmax;over_rate=1.;}
 	else now.y+=delta;
 
 	delta=target.x-now.x;
-	if (delta>0.05) {if (delta>Pi) {now.x+=2*Pi;MoveBall();
+	if (delta>dmax) {if (delta>Pi) {now.x+=2*Pi;MoveBall();
 									return;}
-						now.x+=0.05;over_rate=1.;}
-	else if (delta<-0.05) {if (delta<-Pi) {now.x-=2*Pi;MoveBall();
+						now.x+=dmax;over_rate=1.;}
+	else if (delta<-dmax) {if (delta<-Pi) {now.x-=2*Pi;MoveBall();
 								return;}
-						now.x-=0.05;over_rate=1.;}
+						now.x-=dmax;over_rate=1.;}
 	else now.x+=delta;
 
 	glLoadIdentity(); 
@@ -1350,6 +1388,7 @@ range=150; //meters;
 vessel_index=0;    //no target
 list_index=0;	//1- go to next vessel , 0 - stay here
 phase=0;
+SetRefreshRate(30,REFRESH_GROUP_HEAVY);
 new_range=1;
 last_antena_yaw=-1;
 powered=0;
@@ -1435,7 +1474,7 @@ if (*(((Dragonfly*)parent->v)->DC_power)>0)
 
 	oapiBlt(parent->surf,radar_background,60,50,0,0,100,100); //blt the radar backstuff
 	oapiBlt(parent->surf,hRadBkSRF,190,50,0,0,100,100); //blt the radar stuff
-	phase+=oapiGetSysStep()*16;if (phase>4) phase=0; //shift phase by 1/frame
+	phase+=refresh_step*16;if (phase>4) phase=0; //shift phase (independent of refresh rate)
 
 int mod;
 int k=1;	//vessel index in the radar list
@@ -1496,6 +1535,7 @@ if ((bt>=0)&&(bt<=2)) {
 FuelMeter::FuelMeter(int x, int y ,Panel *i_parent):instrument(x,y,i_parent)
 {
 old_fuel=1;powered=0;
+SetRefreshRate(2);
 };
 
 void FuelMeter::RegisterMe(int index)
@@ -1505,6 +1545,11 @@ void FuelMeter::RegisterMe(int index)
 void FuelMeter::PaintMe()
 { oapiBlt(parent->surf,hFuelSRF,0,0,0,0,81,250);
 };
+bool FuelMeter::Changed()
+{ int pwr=(*(((Dragonfly*)parent->v)->DC_power)>0);
+  if (pwr!=powered) return true;
+  return (pwr && ((old_fuel>0)||(parent->v->GetPropellantFlowrate (((Dragonfly*)(parent->v))->ph_main))));
+};
 void FuelMeter::RefreshMe()
 {
 if (*(((Dragonfly*)parent->v)->DC_power)>0) 
@@ -1551,13 +1596,14 @@ else
 
 VROT::VROT(int x, int y, Panel *i_parent):instrument(x,y,i_parent)
 {powered=0;
+SetRefreshRate(20);
 };
 void VROT::RegisterMe(int index)
 {oapiRegisterPanelArea(index,_R(ScrX,ScrY,ScrX+300,ScrY+110),PANEL_REDRAW_ALWAYS,PANEL_MOUSE_IGNORE,PANEL_MAP_CURRENT);
  powered=0;
 };
 void VROT::PaintMe()
-{oapiBlt(parent->surf,hVrotBkSRF,0,0,0,0,300,110);
+{parent->blt.Blt(parent->surf,hVrotBkSRF,0,0,0,0,300,110);
 };
 void VROT::RefreshMe()
 {
@@ -1568,13 +1614,13 @@ parent->v->GetStatus(vs);
 int i;
 i=100*vs.vrot.x;
 if (i>6) i=6;if (i<-6) i=-6;
-oapiBlt(parent->surf,hVrotSRF,36,23,403-i*67,3,67,38);
+parent->blt.Blt(parent->surf,hVrotSRF,36,23,403-i*67,3,67,38);
 i=100*vs.vrot.y;
 if (i>6) i=6;if (i<-6) i=-6;
-oapiBlt(parent->surf,hVrotSRF,121,23,403-i*67,3,67,38);
+parent->blt.Blt(parent->surf,hVrotSRF,121,23,403-i*67,3,67,38);
 i=-100*vs.vrot.z;
 if (i>6) i=6;if (i<-6) i=-6;
-oapiBlt(parent->surf,hVrotSRF,202,23,403-i*67,3,67,38);
+parent->blt.Blt(parent->surf,hVrotSRF,202,23,403-i*67,3,67,38);
 }
 else 
 { if (powered) PaintMe();
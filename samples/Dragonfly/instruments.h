@@ -10,6 +10,9 @@
 
 class Panel;
 
+#define REFRESH_GROUPS		4	//number of refresh groups (group 0 = no exclusion)
+#define REFRESH_GROUP_HEAVY	1	//expensive instruments, one refresh per frame
+
 class instrument		// basic instrument template
 {  public:
 	instrument(int x, int y,Panel *i_parent);
@@ -18,6 +21,8 @@ class instrument		// basic instrument template
 	virtual void RegisterMe(int index){};//register instrument within Orbiter's api
 	virtual void PaintMe(){};		//repaint the instrument
 	virtual void RefreshMe(){};	//basic refresh()
+	virtual bool Changed() {return true;};	//change predicate: skip RefreshMe if inputs didn't change
+	void SetRefreshRate(double rate, int group=0);	//desired refresh rate [Hz] (0=every frame) and exclusion group
 	virtual void LBD(int x,int y) {};
 	virtual void RBD(int x, int y) {};
 	virtual void BU() {};
@@ -28,6 +33,15 @@ class instrument		// basic instrument template
     int idx;			//index on the panel list 
 	Panel *parent;		// pointer to parent panel
 
+	double refresh_dt;	//min. time between two refreshes [s]
+	double refresh_due;	//sys time of the next refresh
+	double refresh_t;	//sys time at which the last refresh was due
+	double refresh_step;	//time since the previous refresh [s], for animations in RefreshMe
+	int refresh_group;	//members of a group >0 are never refreshed in the same frame
+	bool refresh_force;	//refresh regardless of the change predicate (after a repaint)
+	LONGLONG refresh_ticks;	//accumulated cost of RefreshMe (performance counter ticks)
+	int refresh_num;	//number of RefreshMe calls
+	int refresh_skip;	//number of refreshes skipped by the change predicate
 };
 
 class instrument_list	//list used by panels to keep instruments 
@@ -43,6 +57,7 @@ class TB:public instrument
 	void RegisterMe(int index);
     void PaintMe();
 	void RefreshMe();
+	bool Changed();
 	int last_d;
 	float * SRC;
 };
@@ -86,7 +101,9 @@ class EGauge:public instrument
 	void RegisterMe(int index);
 	void PaintMe();
 	void RefreshMe();
+	bool Changed();
 private:
+	float Angle();		//pointer target angle
 	float lastdraw;
 	SURFHANDLE temps; //need a back surf. but only surf,since we can use oapiBlt
 };
@@ -105,7 +122,9 @@ class HGauge:public instrument
 	void RegisterMe(int index);
 	void PaintMe();
 	void RefreshMe();
+	bool Changed();
 private:
+	int Pos(float *S);	//arrow target position
 	SURFHANDLE temps;
 };
 class DigClock:public instrument
@@ -121,6 +140,7 @@ class DigClock:public instrument
  void RegisterMe(int index);
  void PaintMe();
  void RefreshMe();
+ bool Changed();
 //private:
  //SURFHANDLE temps;
 };
@@ -325,6 +345,7 @@ class FuelMeter:public instrument
 	void RegisterMe(int index);
     void PaintMe();
 	void RefreshMe();
+	bool Changed();
 };
 class VROT:public instrument
 {public:
@@ -27,9 +27,8 @@ SURFHANDLE hSliderSRF;
 SURFHANDLE hCwSRF;
 SURFHANDLE hMFDSRF;
 SURFHANDLE hDockBSRF;
-SURFHANDLE hDockSW1SRF;
-SURFHANDLE hDockDlSRF;
-SURFHANDLE hDockSW2SRF;
+SurfaceAtlas *hDockAtlas;	//dock and nav switches and dial, in one source surface
+int DockSW1,DockDl,DockSW2;	//sprites in hDockAtlas
 SURFHANDLE hNavSRF;
 SURFHANDLE hRadarSRF;
 SURFHANDLE hRadBkSRF;
@@ -100,11 +99,15 @@ void MoveTo(HDC PANEL_hdc, int x, int y)
 Panel::Panel()
 {
 	instruments=NULL;
+	inst_index=NULL;
+	inst_num=0;
 	screw_num = 0;
 };
 
 Panel::~Panel()
 { DeleteDC(hDC3);
+  LogRefreshCost();
+  if (inst_index) delete []inst_index;
   instrument_list *runner=instruments;
   instrument_list *gone;
   while (runner){ gone=runner;
@@ -205,18 +208,84 @@ void Panel::RegisterYourInstruments()
 			runner->instance->RegisterMe(index++); //now register all the inst. in the list
     runner=runner->next;
   }
+  //build the index for the refresh scheduler
+  if (inst_index) delete []inst_index;
+  inst_num=index;
+  inst_index=new instrument*[inst_num];
+  double t=oapiGetSysTime();
+  runner=instruments;
+  index=0;
+  while (runner)
+  { if (runner->instance)
+		{ instrument *inst=runner->instance;
+		  inst_index[index]=inst;
+		  //stagger the first refresh so that instruments with the same rate
+		  //are spread over the frames of one refresh period
+		  inst->refresh_due=t+inst->refresh_dt*fmod(index*0.618034,1.0);
+		  inst->refresh_t=t;
+		  inst->refresh_force=true;
+		  index++;
+		}
+    runner=runner->next;
+  }
+  for (int i=0;i<REFRESH_GROUPS;i++) {group_t[i]=-1;group_wait[i]=NULL;}
 };
 void Panel::Paint(int index)
 { instrument_list *runner=instruments;
    for (int i=0;i<index;i++) runner=runner->next;
    runner->instance->PaintMe();
-
+   blt.Flush();
+   runner->instance->refresh_force=true;	//dynamic parts need redrawing on top
 }
-void Panel::Refresh(int index)
-{ instrument_list *runner=instruments;
-   for (int i=0;i<index;i++) runner=runner->next;
-   runner->instance->RefreshMe();
-
+bool Panel::Refresh(int index)
+{ if ((index<0)||(index>=inst_num)) return false;
+  instrument *inst=inst_index[index];
+  double t=oapiGetSysTime();
+  if (t<inst->refresh_due) return false;			//not due yet
+  int g=inst->refresh_group;
+  if (g) {
+	if (group_t[g]==t) {						//group already refreshed in this frame
+		if (!group_wait[g]) group_wait[g]=inst;	//we're next
+		return false;
+	}
+	if ((group_wait[g])&&(group_wait[g]!=inst)) return false; //let the deferred one go first
+	group_wait[g]=NULL;
+  }
+  //animations advance by the time since the last due refresh, not by a fixed
+  //step per refresh, so their speed doesn't depend on the refresh rate
+  double dt=t-inst->refresh_t;
+  inst->refresh_t=t;
+  if (!inst->refresh_force && !inst->Changed()) {inst->refresh_skip++; return false;}
+  inst->refresh_force=false;
+  inst->refresh_step=min(dt,0.1);	//no jumps after a stall
+  if (g) group_t[g]=t;
+
+  LARGE_INTEGER t0,t1;
+  QueryPerformanceCounter(&t0);
+  inst->RefreshMe();
+  blt.Flush();
+  QueryPerformanceCounter(&t1);
+  inst->refresh_ticks+=t1.QuadPart-t0.QuadPart;
+  inst->refresh_num++;
+
+  inst->refresh_due+=inst->refresh_dt;
+  if (inst->refresh_due<t) inst->refresh_due=t;	//don't try to catch up after a stall
+  return true;
+}
+void Panel::LogRefreshCost()
+{ LARGE_INTEGER fq;
+  if (!inst_index || !QueryPerformanceFrequency(&fq)) return;
+  for (int i=0;i<inst_num;i++)
+  { instrument *inst=inst_index[i];
+	if (!inst->refresh_num) continue;
+	oapiWriteLogV("Dragonfly panel %d area %2d (type %d): %6d refreshes, %6d skipped, %8.2f us/refresh",
+		idx,i,inst->type,inst->refresh_num,inst->refresh_skip,
+		1e6*(double)inst->refresh_ticks/(double)fq.QuadPart/(double)inst->refresh_num);
+  }
+  const BltBatch::Stats &bs=blt.GetStats();
+  if (bs.ngroup)
+	oapiWriteLogV("Dragonfly panel %d blits: %d in %d groups, %d source changes, %d forced flushes",
+		idx,bs.nblt,bs.ngroup,bs.nsrc,bs.nflush);
 }
 void Panel::LBD(int index,int x,int y)
 { instrument_list *runner=instruments;
@@ -407,9 +476,10 @@ void PANEL_InitGDIResources(HINSTANCE hModule)
   hCwSRF=oapiCreateSurface (LoadBitmap(hModule,MAKEINTRESOURCE(IDB_BITMAP9)));
   hMFDSRF=oapiCreateSurface (LoadBitmap(hModule,MAKEINTRESOURCE(IDB_BITMAP10)));
   hDockBSRF=oapiCreateSurface (LoadBitmap(hModule,MAKEINTRESOURCE(IDB_BITMAP14)));
-  hDockSW1SRF=oapiCreateSurface (LoadBitmap(hModule,MAKEINTRESOURCE(IDB_BITMAP16)));
-  hDockDlSRF=oapiCreateSurface (LoadBitmap(hModule,MAKEINTRESOURCE(IDB_BITMAP17)));
-  hDockSW2SRF=oapiCreateSurface (LoadBitmap(hModule,MAKEINTRESOURCE(IDB_BITMAP18)));
+  hDockAtlas=new SurfaceAtlas(256,128);
+  DockSW1=hDockAtlas->Add(LoadBitmap(hModule,MAKEINTRESOURCE(IDB_BITMAP16)));
+  DockDl=hDockAtlas->Add(LoadBitmap(hModule,MAKEINTRESOURCE(IDB_BITMAP17)));
+  DockSW2=hDockAtlas->Add(LoadBitmap(hModule,MAKEINTRESOURCE(IDB_BITMAP18)));
   hNavSRF=oapiCreateSurface (LoadBitmap(hModule,MAKEINTRESOURCE(IDB_BITMAP19)));
   hRadarSRF=oapiCreateSurface (LoadBitmap(hModule,MAKEINTRESOURCE(IDB_BITMAP20)));
   hRadBkSRF=oapiCreateSurface (LoadBitmap(hModule,MAKEINTRESOURCE(IDB_BITMAP21)));
@@ -465,9 +535,7 @@ void PANEL_ReleaseGDIResources()
    oapiDestroySurface(hCwSRF);
    oapiDestroySurface(hMFDSRF);
    oapiDestroySurface(hDockBSRF);
-   oapiDestroySurface(hDockSW1SRF);
-   oapiDestroySurface(hDockDlSRF);
-   oapiDestroySurface(hDockSW2SRF);
+   delete hDockAtlas;
    oapiDestroySurface(hNavSRF);
    oapiDestroySurface(hRadarSRF);
    oapiDestroySurface(hRadBkSRF);
@@ -63,16 +63,16 @@ q.z=z/scale;
 return q;
 }
 
-void quaternion::rotate(float theta,vector3 axis)
+void quaternion::rotate(double theta,vector3 axis)
 {
-float sin_t=sin(theta/2);
+double sin_t=sin(theta/2);
 w=cos(theta/2);
 x=axis.x*sin_t;
 y=axis.y*sin_t;
 z=axis.z*sin_t;
 }
 
-quaternion _quaternion(float theta,vector3 axis)
+quaternion _quaternion(double theta,vector3 axis)
 {quaternion q;
 q.rotate(theta,axis);
 return q;
@@ -12,8 +12,8 @@ public:
 	quaternion operator * (quaternion q2);
 	matrix mat();
 	quaternion rotaxis();
-	void rotate(float theta,vector3 axis);
+	void rotate(double theta,vector3 axis);
 };
 
-quaternion _quaternion(float theta,vector3 axis);
+quaternion _quaternion(double theta,vector3 axis);
 #endif
\ No newline at end of file
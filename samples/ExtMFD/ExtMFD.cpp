@@ -13,6 +13,7 @@
 #define ORBITER_MODULE
 #include <windows.h>
 #include "MFDWindow.h"
+#include "MFDPresent.h"
 #include "orbitersdk.h"
 #include "resource.h"
 #include <stdio.h>
@@ -24,6 +25,7 @@
 HINSTANCE g_hInst;    // module instance handle
 HBITMAP g_hPin;       // "pin" button bitmap
 DWORD g_dwCmd;        // custom function identifier
+MFDPresenter *g_Presenter; // presentation thread for MFD displays
 
 // ==============================================================
 // Local prototypes
@@ -56,6 +58,9 @@ DLLCLBK void InitModule (HINSTANCE hDLL)
 	// Load the bitmap for the "pin" title button
 	g_hPin = (HBITMAP)LoadImage (g_hInst, MAKEINTRESOURCE(IDB_PIN), IMAGE_BITMAP, 15, 30, 0);
 
+	// Start the display presentation thread
+	g_Presenter = new MFDPresenter;
+
 	// Register a window classes for the MFD display and buttons
 	WNDCLASS wndClass;
 	wndClass.style = CS_HREDRAW | CS_VREDRAW;
@@ -91,6 +96,9 @@ DLLCLBK void ExitModule (HINSTANCE hDLL)
 
 	// Unregister the custom function in Orbiter
 	oapiUnregisterCustomCmd (g_dwCmd);
+
+	// Stop the presentation thread
+	delete g_Presenter;
 }
 
 
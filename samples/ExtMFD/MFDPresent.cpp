@@ -0,0 +1,188 @@
+// ==============================================================
+//                  ORBITER MODULE: ExtMFD
+//                  Part of the ORBITER SDK
+//            Copyright (C) 2006 Martin Schweiger
+//                   All rights reserved
+//
+// MFDPresent.cpp
+//
+// Class implementations for MFDBuffer and MFDPresenter.
+// ==============================================================
+
+#include "MFDPresent.h"
+
+// ==============================================================
+// class MFDBuffer
+
+MFDBuffer::MFDBuffer ()
+{
+	for (int i = 0; i < 2; i++) {
+		hDC[i] = 0;
+		hBmp[i] = 0;
+		hPrev[i] = 0;
+		bits[i] = 0;
+	}
+	w = h = 0;
+	front = 0;
+	dirty = false;
+	InitializeCriticalSection (&cs);
+}
+
+MFDBuffer::~MFDBuffer ()
+{
+	Free ();
+	DeleteCriticalSection (&cs);
+}
+
+bool MFDBuffer::Alloc (int _w, int _h)
+{
+	BITMAPINFO bmi;
+	memset (&bmi, 0, sizeof(bmi));
+	bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	bmi.bmiHeader.biWidth = _w;
+	bmi.bmiHeader.biHeight = -_h;   // top-down
+	bmi.bmiHeader.biPlanes = 1;
+	bmi.bmiHeader.biBitCount = 32;
+	bmi.bmiHeader.biCompression = BI_RGB;
+
+	HDC hDCscreen = GetDC (NULL);
+	for (int i = 0; i < 2; i++) {
+		hDC[i] = CreateCompatibleDC (hDCscreen);
+		hBmp[i] = CreateDIBSection (hDCscreen, &bmi, DIB_RGB_COLORS, (void**)&bits[i], NULL, 0);
+		if (!hDC[i] || !hBmp[i]) {
+			ReleaseDC (NULL, hDCscreen);
+			Free ();
+			return false;
+		}
+		hPrev[i] = SelectObject (hDC[i], hBmp[i]);
+		PatBlt (hDC[i], 0, 0, _w, _h, BLACKNESS);
+	}
+	ReleaseDC (NULL, hDCscreen);
+	w = _w, h = _h;
+	return true;
+}
+
+void MFDBuffer::Free ()
+{
+	for (int i = 0; i < 2; i++) {
+		if (hDC[i]) {
+			if (hPrev[i]) SelectObject (hDC[i], hPrev[i]);
+			DeleteDC (hDC[i]);
+			hDC[i] = 0;
+		}
+		if (hBmp[i]) {
+			DeleteObject (hBmp[i]);
+			hBmp[i] = 0;
+		}
+		hPrev[i] = 0;
+		bits[i] = 0;
+	}
+	w = h = 0;
+	dirty = false;
+}
+
+bool MFDBuffer::Submit (HDC hDCsrc, int _w, int _h)
+{
+	if (_w != w || _h != h) {
+		// display resized: reallocate both buffers
+		EnterCriticalSection (&cs);
+		Free ();
+		bool ok = Alloc (_w, _h);
+		LeaveCriticalSection (&cs);
+		if (!ok) return false;
+	}
+
+	// the back buffer is never accessed by the presentation thread
+	int back = 1-front;
+	BitBlt (hDC[back], 0, 0, w, h, hDCsrc, 0, 0, SRCCOPY);
+	GdiFlush ();
+
+	// skip unchanged displays. A front buffer that is still waiting
+	// for presentation is kept as it is
+	if (!memcmp (bits[back], bits[front], w*h*sizeof(DWORD)))
+		return false;
+
+	EnterCriticalSection (&cs);
+	front = back;
+	dirty = true;
+	LeaveCriticalSection (&cs);
+	return true;
+}
+
+bool MFDBuffer::Present (HDC hDCtgt)
+{
+	bool ok = false;
+	EnterCriticalSection (&cs);
+	if (hDC[front]) {
+		BitBlt (hDCtgt, 0, 0, w, h, hDC[front], 0, 0, SRCCOPY);
+		ok = true;
+	}
+	LeaveCriticalSection (&cs);
+	return ok;
+}
+
+void MFDBuffer::PresentIfDirty (HWND hWnd)
+{
+	EnterCriticalSection (&cs);
+	if (dirty && hDC[front]) {
+		HDC hDCtgt = GetDC (hWnd);
+		BitBlt (hDCtgt, 0, 0, w, h, hDC[front], 0, 0, SRCCOPY);
+		ReleaseDC (hWnd, hDCtgt);
+		dirty = false;
+	}
+	LeaveCriticalSection (&cs);
+}
+
+// ==============================================================
+// class MFDPresenter
+
+MFDPresenter::MFDPresenter ()
+{
+	InitializeCriticalSection (&cs);
+	hEvent = CreateEvent (NULL, FALSE, FALSE, NULL);
+	active = 1;
+	hThread = CreateThread (NULL, 0, PresentThread, this, 0, NULL);
+}
+
+MFDPresenter::~MFDPresenter ()
+{
+	if (hThread) {
+		InterlockedExchange (&active, 0);
+		SetEvent (hEvent);
+		WaitForSingleObject (hThread, INFINITE);
+		CloseHandle (hThread);
+	}
+	CloseHandle (hEvent);
+	DeleteCriticalSection (&cs);
+}
+
+void MFDPresenter::Add (HWND hWnd, MFDBuffer *buf)
+{
+	Target t = {hWnd, buf};
+	EnterCriticalSection (&cs);
+	target.push_back (t);
+	LeaveCriticalSection (&cs);
+}
+
+void MFDPresenter::Remove (MFDBuffer *buf)
+{
+	EnterCriticalSection (&cs);
+	for (size_t i = 0; i < target.size(); i++)
+		if (target[i].buf == buf) {
+			target.erase (target.begin()+i);
+			break;
+		}
+	LeaveCriticalSection (&cs);
+}
+
+DWORD WINAPI MFDPresenter::PresentThread (LPVOID context)
+{
+	MFDPresenter *p = (MFDPresenter*)context;
+	while (WaitForSingleObject (p->hEvent, INFINITE) == WAIT_OBJECT_0 && p->active) {
+		EnterCriticalSection (&p->cs);
+		for (size_t i = 0; i < p->target.size(); i++)
+			p->target[i].buf->PresentIfDirty (p->target[i].hWnd);
+		LeaveCriticalSection (&p->cs);
+	}
+	return 0;
+}
@@ -0,0 +1,109 @@
+// ==============================================================
+//                  ORBITER MODULE: ExtMFD
+//                  Part of the ORBITER SDK
+//            Copyright (C) 2006 Martin Schweiger
+//                   All rights reserved
+//
+// MFDPresent.h
+//
+// Class interfaces for MFDBuffer and MFDPresenter. MFD displays are
+// copied into double-buffered memory surfaces in the simulation
+// thread, and copied to their windows by a separate presentation
+// thread, so that external MFD windows don't add GDI window blits
+// to the frame time.
+// ==============================================================
+
+#ifndef __MFDPRESENT_H
+#define __MFDPRESENT_H
+
+#define STRICT 1
+#include <windows.h>
+#include <vector>
+
+// ==============================================================
+// Double-buffered display surface
+
+class MFDBuffer {
+public:
+	MFDBuffer ();
+	~MFDBuffer ();
+
+	/**
+	 * \brief Copy a rendered display into the back buffer, and make it
+	 *   the front buffer if its contents have changed.
+	 * \param hDCsrc device context of the rendered display
+	 * \param w display width
+	 * \param h display height
+	 * \return true if the front buffer was replaced
+	 * \note Called from the simulation thread only.
+	 */
+	bool Submit (HDC hDCsrc, int w, int h);
+
+	/**
+	 * \brief Copy the front buffer to a device context.
+	 * \return false if no display has been submitted yet
+	 * \note Thread safe.
+	 */
+	bool Present (HDC hDCtgt);
+
+	/**
+	 * \brief Copy the front buffer to a window if it has changed since
+	 *   the last call.
+	 * \note Called from the presentation thread.
+	 */
+	void PresentIfDirty (HWND hWnd);
+
+private:
+	bool Alloc (int w, int h);
+	void Free ();
+
+	HDC hDC[2];           // memory DCs
+	HBITMAP hBmp[2];      // DIB sections
+	HGDIOBJ hPrev[2];     // bitmaps initially selected into the DCs
+	DWORD *bits[2];       // pixel data
+	int w, h;             // buffer size
+	int front;            // index of the front buffer
+	bool dirty;           // front buffer not yet presented
+	CRITICAL_SECTION cs;  // guards front buffer and dirty flag
+};
+
+// ==============================================================
+// Presentation thread shared by all MFD windows
+
+class MFDPresenter {
+public:
+	MFDPresenter ();
+	~MFDPresenter ();
+
+	/**
+	 * \brief Add a display window to the presentation list.
+	 */
+	void Add (HWND hWnd, MFDBuffer *buf);
+
+	/**
+	 * \brief Remove a display window from the presentation list.
+	 * \note Waits until a presentation in progress has finished, so the
+	 *   window and buffer can be destroyed after the call.
+	 */
+	void Remove (MFDBuffer *buf);
+
+	/**
+	 * \brief Wake the presentation thread after a buffer swap.
+	 */
+	inline void Signal () { SetEvent (hEvent); }
+
+private:
+	static DWORD WINAPI PresentThread (LPVOID context);
+
+	struct Target {
+		HWND hWnd;
+		MFDBuffer *buf;
+	};
+	std::vector<Target> target;
+	CRITICAL_SECTION cs;    // guards the target list
+	HANDLE hEvent;          // buffer swap notification
+	HANDLE hThread;
+	volatile LONG active;   // thread keeps running while nonzero
+};
+
+#endif // !__MFDPRESENT_H
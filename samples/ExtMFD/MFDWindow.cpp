@@ -19,6 +19,8 @@
 
 BOOL CALLBACK DlgProc (HWND hDlg, UINT uMsg, WPARAM wParam, LPARAM lParam);
 
+extern MFDPresenter *g_Presenter;
+
 // ==============================================================
 // class MFDWindow
 
@@ -33,6 +35,7 @@ MFDWindow::MFDWindow (HINSTANCE _hInst, const MFDSPEC &spec): ExternMFD (spec),
 
 MFDWindow::~MFDWindow ()
 {
+	g_Presenter->Remove (&dspbuf);
 	oapiCloseDialog (hDlg);
 	if (hBtnFnt) DeleteObject (hBtnFnt);
 }
@@ -49,6 +52,7 @@ void MFDWindow::Initialise (HWND _hDlg)
 	SetTitle ();
 	gap = 3;
 	Resize (false);
+	g_Presenter->Add (hDsp, &dspbuf);
 }
 
 void MFDWindow::SetVessel (OBJHANDLE hV)
@@ -115,12 +119,7 @@ void MFDWindow::RepaintDisplay (HWND hWnd)
 {
 	PAINTSTRUCT ps;
 	HDC hDCtgt = BeginPaint (hWnd, &ps);
-	SURFHANDLE surf = GetDisplaySurface();
-	if (surf) {
-		HDC hDCsrc = oapiGetDC (surf);
-		BitBlt (hDCtgt, 0, 0, DW, DH, hDCsrc, 0, 0, SRCCOPY);
-		oapiReleaseDC (surf, hDCsrc);
-	} else {
+	if (!dspbuf.Present (hDCtgt)) {
 		SelectObject (hDCtgt, GetStockObject (BLACK_BRUSH));
 		Rectangle (hDCtgt, 0, 0, DW, DH);
 	}
@@ -175,7 +174,15 @@ void MFDWindow::ProcessButton (int bt, int event)
 
 void MFDWindow::clbkRefreshDisplay (SURFHANDLE)
 {
-	InvalidateRect (hDsp, NULL, FALSE);
+	// Copy the display into the back buffer. The window is updated by
+	// the presentation thread if the contents have changed
+	SURFHANDLE surf = GetDisplaySurface();
+	if (surf) {
+		HDC hDCsrc = oapiGetDC (surf);
+		bool swap = dspbuf.Submit (hDCsrc, DW, DH);
+		oapiReleaseDC (surf, hDCsrc);
+		if (swap) g_Presenter->Signal();
+	}
 }
 
 void MFDWindow::clbkRefreshButtons ()
@@ -16,6 +16,7 @@
 #define STRICT 1
 #include <windows.h>
 #include "orbitersdk.h"
+#include "MFDPresent.h"
 
 class MFDWindow: public ExternMFD {
 public:
@@ -42,6 +43,7 @@ private:
 	int gap;          // geometry parameters
 	int fnth;         // button font height
 	bool vstick;      // stick to vessel
+	MFDBuffer dspbuf; // display buffers for the presentation thread
 };
 
 #endif // !__MFDWINDOW_H
\ No newline at end of file
@@ -5,7 +5,8 @@
 //                   All rights reserved
 //
 // Framerate.cpp
-// Dialog box for displaying simulation frame rate.
+// Dialog box for displaying simulation frame rate, and frame
+// profiler dialog for the callback timers of all modules.
 // ==============================================================
 
 #define STRICT
@@ -14,6 +15,8 @@
 #include <stdio.h>
 #include "Orbitersdk.h"
 #include "Dialog\Graph.h"
+#include "Vessel\Profiler.h"
+#include <vector>
 #include "resource.h"
 
 static char *desc = "Simulation frame rate / time step monitor";
@@ -32,11 +35,19 @@ DWORD g_fcount;                     // frame counter
 bool bDisplay = false;              // display open?
 bool bShowGraph[2] = {true, false}; // show graphs?
 
+HWND g_hProfDlg = 0;                // profiler dialog handle
+DWORD g_dwProfCmd;                  // profiler custom function identifier
+double g_profT = 0.0;               // profiler sample system time
+const double PROF_WINDOW = 5.0;     // profiler statistics window [s]
+const double PROF_TRACE = 60.0;     // profiler trace export window [s]
+
 // ==============================================================
 // Local prototypes
 
 void OpenDlgClbk (void *context);
+void OpenProfDlgClbk (void *context);
 BOOL CALLBACK MsgProc (HWND, UINT, WPARAM, LPARAM);
+BOOL CALLBACK ProfMsgProc (HWND, UINT, WPARAM, LPARAM);
 long FAR PASCAL Graph_WndProc (HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
 
 // ==============================================================
@@ -47,6 +58,9 @@ DLLCLBK void InitModule (HINSTANCE hDLL)
 	g_hInst = hDLL;
 	g_hDlg = 0;
 	g_dwCmd = oapiRegisterCustomCmd ("Performance Meter", desc, OpenDlgClbk, NULL);
+	g_dwProfCmd = oapiRegisterCustomCmd ("Frame Profiler",
+		"Per-callback timing statistics (median, 95th and 99th percentile) of profiled modules, with trace export",
+		OpenProfDlgClbk, NULL);
 
 	// register the window class for the data graph
 	WNDCLASS wndClass;
@@ -69,12 +83,16 @@ DLLCLBK void ExitModule (HINSTANCE hDLL)
 {
 	UnregisterClass ("PerfGraphWindow", g_hInst);
 	oapiUnregisterCustomCmd (g_dwCmd);
+	oapiUnregisterCustomCmd (g_dwProfCmd);
 
 	Graph::FreeGDI();
 }
 
+void RefreshProfiler ();
+
 DLLCLBK void opcPreStep (double simt, double simdt, double mjd)
 {
+	if (g_hProfDlg) RefreshProfiler ();
 	if (!bDisplay) return; // flight data dialog not open
 
 	double syst = oapiGetSysTime(); // ignore time acceleration for graph updates
@@ -108,6 +126,12 @@ void OpenDlgClbk (void *context)
 	if (hDlg) g_hDlg = hDlg; // otherwise open already
 }
 
+void OpenProfDlgClbk (void *context)
+{
+	HWND hDlg = oapiOpenDialog (g_hInst, IDD_PROFILER, ProfMsgProc);
+	if (hDlg) g_hProfDlg = hDlg; // otherwise open already
+}
+
 void ArrangeGraphs (HWND hDlg)
 {
 	static int hdrofs = 0;
@@ -187,6 +211,91 @@ BOOL CALLBACK MsgProc (HWND hDlg, UINT uMsg, WPARAM wParam, LPARAM lParam)
 	return oapiDefDialogProc (hDlg, uMsg, wParam, lParam);
 }
 
+// =================================================================================
+// Frame profiler dialog
+// =================================================================================
+
+void RefreshProfiler ()
+{
+	double syst = oapiGetSysTime();
+	if (syst < g_profT+g_DT) return;
+	g_profT = syst;
+
+	std::vector<ProfStats> stats;
+	Profiler::Collect (stats, PROF_WINDOW);
+
+	char cbuf[256];
+	HWND hList = GetDlgItem (g_hProfDlg, IDC_PROF_LIST);
+	int top = (int)SendMessage (hList, LB_GETTOPINDEX, 0, 0);
+	SendMessage (hList, WM_SETREDRAW, FALSE, 0);
+	SendMessage (hList, LB_RESETCONTENT, 0, 0);
+	SendMessage (hList, LB_ADDSTRING, 0, (LPARAM)"Site\tCalls\tTotal\tMean\tp50\tp95\tp99\tMax");
+	for (size_t i = 0; i < stats.size(); i++) {
+		const ProfStats &s = stats[i];
+		sprintf (cbuf, "%s\t%u\t%0.2f\t%0.3f\t%0.3f\t%0.3f\t%0.3f\t%0.3f",
+			Profiler::SiteName (s.site), s.count, s.total, s.mean, s.p50, s.p95, s.p99, s.max);
+		SendMessage (hList, LB_ADDSTRING, 0, (LPARAM)cbuf);
+	}
+	SendMessage (hList, LB_SETTOPINDEX, top, 0);
+	SendMessage (hList, WM_SETREDRAW, TRUE, 0);
+	InvalidateRect (hList, NULL, TRUE);
+}
+
+void ArrangeProfiler (HWND hDlg)
+{
+	static int hdrofs = 0;
+	RECT r;
+	GetClientRect (hDlg, &r);
+	if (!hdrofs) {
+		RECT r2;
+		GetWindowRect (GetDlgItem (hDlg, IDC_PROF_LIST), &r2);
+		hdrofs = r.bottom - (r2.bottom-r2.top);
+	}
+	SetWindowPos (GetDlgItem (hDlg, IDC_PROF_LIST), 0, 0, hdrofs, r.right, r.bottom-hdrofs,
+		SWP_NOZORDER | SWP_NOCOPYBITS);
+}
+
+BOOL CALLBACK ProfMsgProc (HWND hDlg, UINT uMsg, WPARAM wParam, LPARAM lParam)
+{
+	switch (uMsg) {
+	case WM_INITDIALOG: {
+		static int tabs[7] = {120, 150, 180, 210, 240, 270, 300}; // dialog units
+		SendDlgItemMessage (hDlg, IDC_PROF_LIST, LB_SETTABSTOPS, 7, (LPARAM)tabs);
+		SendDlgItemMessage (hDlg, IDC_PROF_ENABLE, BM_SETCHECK, Profiler::Enabled() ? BST_CHECKED : BST_UNCHECKED, 0);
+		SetDlgItemText (hDlg, IDC_PROF_STATUS, "Times in ms");
+		g_profT = 0.0;
+		ArrangeProfiler (hDlg);
+		} return TRUE;
+	case WM_DESTROY:
+		g_hProfDlg = 0;
+		return 0;
+	case WM_SIZE:
+		ArrangeProfiler (hDlg);
+		return 0;
+	case WM_COMMAND:
+		switch (LOWORD (wParam)) {
+		case IDCANCEL:
+			oapiCloseDialog (hDlg);
+			return TRUE;
+		case IDC_PROF_ENABLE:
+			if (HIWORD (wParam) == BN_CLICKED)
+				Profiler::Enable (SendDlgItemMessage (hDlg, IDC_PROF_ENABLE, BM_GETCHECK, 0, 0) == BST_CHECKED);
+			return 0;
+		case IDC_PROF_TRACE:
+			if (HIWORD (wParam) == BN_CLICKED) {
+				char cbuf[256];
+				int n = Profiler::ExportTrace ("ProfilerTrace.json", PROF_TRACE);
+				if (n >= 0) sprintf (cbuf, "%d events written to ProfilerTrace.json", n);
+				else strcpy (cbuf, "Could not write ProfilerTrace.json");
+				SetDlgItemText (hDlg, IDC_PROF_STATUS, cbuf);
+			}
+			return 0;
+		}
+		break;
+	}
+	return oapiDefDialogProc (hDlg, uMsg, wParam, lParam);
+}
+
 // =================================================================================
 // Graph canvas message handler
 // =================================================================================
@@ -3,20 +3,25 @@
 // Used by Framerate.rc
 //
 #define IDD_FRAMERATE                   101
+#define IDD_PROFILER                    105
 #define IDC_FRAMERATE                   1000
 #define IDS_INFO                        1000
 #define IDC_TIMESTEP                    1001
 #define IDS_TYPE                        1001
 #define IDC_SHOW_FRAMERATE              1002
 #define IDC_SHOW_TIMESTEP               1003
+#define IDC_PROF_ENABLE                 1004
+#define IDC_PROF_TRACE                  1005
+#define IDC_PROF_STATUS                 1006
+#define IDC_PROF_LIST                   1007
 
 // Next default values for new objects
 // 
 #ifdef APSTUDIO_INVOKED
 #ifndef APSTUDIO_READONLY_SYMBOLS
-#define _APS_NEXT_RESOURCE_VALUE        105
+#define _APS_NEXT_RESOURCE_VALUE        106
 #define _APS_NEXT_COMMAND_VALUE         40005
-#define _APS_NEXT_CONTROL_VALUE         1004
+#define _APS_NEXT_CONTROL_VALUE         1008
 #define _APS_NEXT_SYMED_VALUE           101
 #endif
 #endif
@@ -0,0 +1,173 @@
+// ==============================================================
+//                 ORBITER MODULE: Quicksnap
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// Quicksnap.cpp
+//
+// Binary rollback points for the current session. Ctrl-Shift-S
+// stores the state of all vessels (see Snapshot.h) in a memory
+// slot, Ctrl-Shift-L restores it. The slot is discarded at the end
+// of the session. The time taken for each save and restore is
+// written to the log.
+// ==============================================================
+
+#define STRICT 1
+#define ORBITER_MODULE
+#include "Orbitersdk.h"
+#include "..\Common\Vessel\Snapshot.h"
+#include <stdio.h>
+#include <vector>
+
+// ==============================================================
+// The module interface class
+
+namespace oapi {
+
+class Quicksnap: public Module {
+public:
+	Quicksnap (HINSTANCE hDLL);
+	void clbkSimulationEnd ();
+	void clbkPreStep (double simt, double simdt, double mjd);
+	bool clbkProcessKeyboardBuffered (DWORD key, char kstate[256], bool simRunning);
+
+private:
+	void Save ();
+	void Load ();
+	void Report (const char *msg);
+	double Elapsed (const LARGE_INTEGER &t0) const;
+
+	std::vector<char> slot;  // snapshot blob, or empty
+	double slot_simt;        // simulation time of the snapshot [s]
+	double msg_t;            // system time at which the status message is cleared
+	LARGE_INTEGER fq;        // performance counter frequency
+};
+
+}; // namespace oapi
+
+using namespace oapi;
+
+static Quicksnap *g_Quicksnap = 0;
+
+// ==============================================================
+// Quicksnap implementation
+
+Quicksnap::Quicksnap (HINSTANCE hDLL): Module (hDLL)
+{
+	slot_simt = 0.0;
+	msg_t = 0.0;
+	QueryPerformanceFrequency (&fq);
+}
+
+// --------------------------------------------------------------
+
+void Quicksnap::clbkSimulationEnd ()
+{
+	std::vector<char>().swap (slot);
+}
+
+// --------------------------------------------------------------
+
+void Quicksnap::clbkPreStep (double simt, double simdt, double mjd)
+{
+	if (msg_t && oapiGetSysTime() > msg_t) {
+		oapiDebugString()[0] = '\0';
+		msg_t = 0.0;
+	}
+}
+
+// --------------------------------------------------------------
+
+bool Quicksnap::clbkProcessKeyboardBuffered (DWORD key, char kstate[256], bool simRunning)
+{
+	if (!KEYMOD_CONTROL (kstate) || !KEYMOD_SHIFT (kstate) || KEYMOD_ALT (kstate))
+		return false;
+
+	switch (key) {
+	case OAPI_KEY_S:
+		Save ();
+		return true;
+	case OAPI_KEY_L:
+		Load ();
+		return true;
+	}
+	return false;
+}
+
+// --------------------------------------------------------------
+
+void Quicksnap::Save ()
+{
+	char cbuf[256];
+	LARGE_INTEGER t0;
+	QueryPerformanceCounter (&t0);
+
+	SnapshotWriter snp;
+	SnapshotSaveAll (snp);
+	const char *data = snp.Data();
+	slot.assign (data, data + snp.Size());
+	slot_simt = oapiGetSimTime();
+
+	sprintf (cbuf, "Quicksnap: saved %d vessels (%d KB) in %0.2f ms",
+		oapiGetVesselCount(), (int)(slot.size() >> 10), Elapsed (t0));
+	Report (cbuf);
+}
+
+// --------------------------------------------------------------
+
+void Quicksnap::Load ()
+{
+	char cbuf[256];
+	if (!slot.size()) {
+		Report ("Quicksnap: no snapshot saved");
+		return;
+	}
+
+	LARGE_INTEGER t0;
+	QueryPerformanceCounter (&t0);
+
+	SnapshotReader snp;
+	int n = -1;
+	if (snp.Set (&slot[0], slot.size()))
+		n = SnapshotLoadAll (snp);
+
+	if (n < 0)
+		sprintf (cbuf, "Quicksnap: snapshot is corrupt, not restored");
+	else
+		sprintf (cbuf, "Quicksnap: restored %d vessels from T=%0.1f s in %0.2f ms",
+			n, slot_simt, Elapsed (t0));
+	Report (cbuf);
+}
+
+// --------------------------------------------------------------
+
+void Quicksnap::Report (const char *msg)
+{
+	oapiWriteLog ((char*)msg);
+	strcpy (oapiDebugString(), msg);
+	msg_t = oapiGetSysTime() + 5.0;
+}
+
+// --------------------------------------------------------------
+
+double Quicksnap::Elapsed (const LARGE_INTEGER &t0) const
+{
+	LARGE_INTEGER t1;
+	QueryPerformanceCounter (&t1);
+	return 1e3 * (double)(t1.QuadPart - t0.QuadPart) / (double)fq.QuadPart;
+}
+
+// ==============================================================
+// API interface
+
+DLLCLBK void InitModule (HINSTANCE hDLL)
+{
+	g_Quicksnap = new Quicksnap (hDLL);
+	oapiRegisterModule (g_Quicksnap);
+}
+
+DLLCLBK void ExitModule (HINSTANCE hDLL)
+{
+	delete g_Quicksnap;
+}
@@ -0,0 +1,103 @@
+// ==============================================================
+//                  ORBITER MODULE: Rcontrol
+//                  Part of the ORBITER SDK
+//           Copyright (C) 2003-2016 Martin Schweiger
+//                   All rights reserved
+//
+// RcFrame.h
+// Command frame protocol of the Rcontrol command server.
+//
+// External programs (e.g. hardware-in-the-loop rigs) control
+// vessels by sending command frames. A frame is a time-stamped batch
+// of commands for any number of vessels, and is applied by the
+// simulation thread in a single pass at the start of the time step
+// in which it becomes due.
+//
+// Transports:
+// - Shared memory: a single-producer/single-consumer byte ring in the
+//   file mapping RC_SHM_NAME, written with RcWriteFrame.
+// - Named pipe: one frame per message, written to RC_PIPE_NAME.
+//
+// This header depends only on windows.h, so that it can be included
+// by client programs.
+// ==============================================================
+
+#ifndef __RCFRAME_H
+#define __RCFRAME_H
+
+#include <windows.h>
+#include <string.h>
+
+#define RC_SHM_NAME   "Local\\OrbiterRcontrol"
+#define RC_PIPE_NAME  "\\\\.\\pipe\\OrbiterRcontrol"
+#define RC_MAGIC      0x4352524F   // 'ORRC'
+#define RC_VERSION    1
+#define RC_RINGSIZE   0x10000      // size of the ring data area [bytes], power of 2
+#define RC_MAXFRAME   0x4000       // max. frame size [bytes]
+
+// ==============================================================
+// Command types
+
+enum RC_CMDTYPE {
+	RC_THGROUP = 1,  ///< set thruster group level. id: THGROUP_TYPE, value: level (0..1)
+	RC_CTRLSURF,     ///< set control surface level. id: AIRCTRL_TYPE, value: level (-1..1)
+	RC_NAVMODE       ///< set navmode state. id: NAVMODE_xxx, value: 0=off, 1=on
+};
+
+/**
+ * \brief A single vessel command (48 bytes).
+ */
+struct RC_CMD {
+	char vessel[32];  ///< name of the target vessel (zero-terminated)
+	WORD type;        ///< command type (RC_CMDTYPE)
+	WORD id;          ///< command target (thruster group, control surface or navmode)
+	DWORD reserved;
+	double value;     ///< command value
+};
+
+/**
+ * \brief Frame header (24 bytes), followed by ncmd RC_CMD entries.
+ */
+struct RC_FRAME {
+	DWORD size;       ///< total frame size [bytes]: sizeof(RC_FRAME) + ncmd*sizeof(RC_CMD)
+	DWORD seq;        ///< client sequence number
+	double simt;      ///< simulation time at which the frame is applied (0: as soon as possible)
+	DWORD ncmd;       ///< number of commands
+	DWORD reserved;
+};
+
+/**
+ * \brief Shared memory ring header, followed by RC_RINGSIZE bytes of data.
+ * \note head and tail are running byte counts. Only the client writes
+ *   head, and only the server writes tail. Frames are stored back to
+ *   back and may wrap around the end of the data area.
+ */
+struct RC_RING {
+	DWORD magic;         ///< RC_MAGIC once the server has initialised the ring
+	DWORD version;       ///< RC_VERSION
+	DWORD size;          ///< data area size (RC_RINGSIZE)
+	DWORD reserved;
+	volatile LONG head;  ///< bytes written
+	volatile LONG tail;  ///< bytes consumed
+};
+
+inline BYTE *RcRingData (RC_RING *ring) { return (BYTE*)(ring+1); }
+
+/**
+ * \brief Append a frame to a shared memory ring (client side).
+ * \return false if the ring is not initialised or has no room for the frame.
+ */
+inline bool RcWriteFrame (RC_RING *ring, const RC_FRAME *frame)
+{
+	if (ring->magic != RC_MAGIC || ring->version != RC_VERSION) return false;
+	DWORD size = frame->size, head = (DWORD)ring->head;
+	if (size > RC_MAXFRAME || size > ring->size - (head - (DWORD)ring->tail)) return false;
+	DWORD ofs = head & (ring->size-1), n = min (size, ring->size - ofs);
+	memcpy (RcRingData(ring) + ofs, frame, n);
+	memcpy (RcRingData(ring), (const BYTE*)frame + n, size - n);
+	MemoryBarrier();
+	ring->head = (LONG)(head + size);
+	return true;
+}
+
+#endif // !__RCFRAME_H
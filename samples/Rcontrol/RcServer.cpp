@@ -0,0 +1,300 @@
+// ==============================================================
+//                  ORBITER MODULE: Rcontrol
+//                  Part of the ORBITER SDK
+//           Copyright (C) 2003-2016 Martin Schweiger
+//                   All rights reserved
+//
+// RcServer.cpp
+// Implementation for class CommandServer
+// ==============================================================
+
+#include "RcServer.h"
+
+#ifndef PIPE_REJECT_REMOTE_CLIENTS
+#define PIPE_REJECT_REMOTE_CLIENTS 0x00000008  // Vista and later; ignored by older systems
+#endif
+
+// ==============================================================
+// Local helpers
+
+// check a frame header received from a client
+static bool ValidFrame (const RC_FRAME *frame, DWORD avail)
+{
+	// bound ncmd first, so that the size calculation can't overflow
+	if (frame->ncmd > (RC_MAXFRAME - sizeof(RC_FRAME))/sizeof(RC_CMD)) return false;
+	return frame->size == sizeof(RC_FRAME) + frame->ncmd*sizeof(RC_CMD) &&
+		frame->size <= avail;
+}
+
+// complete an overlapped pipe operation started with result ok.
+// Returns false if the operation failed, or if hStop was signalled
+// (the operation is then cancelled).
+static bool WaitPipe (HANDLE hPipe, OVERLAPPED *ov, HANDLE hStop, BOOL ok, DWORD &n)
+{
+	n = 0;
+	if (!ok) {
+		DWORD err = GetLastError();
+		if (err == ERROR_PIPE_CONNECTED) return true; // client connected before ConnectNamedPipe
+		if (err != ERROR_IO_PENDING) return false;
+		HANDLE hWait[2] = {hStop, ov->hEvent};
+		if (WaitForMultipleObjects (2, hWait, FALSE, INFINITE) != WAIT_OBJECT_0+1) {
+			CancelIo (hPipe);
+			GetOverlappedResult (hPipe, ov, &n, TRUE); // wait until ov is released
+			return false;
+		}
+	}
+	return GetOverlappedResult (hPipe, ov, &n, FALSE) != FALSE;
+}
+
+// ==============================================================
+
+CommandServer::CommandServer ()
+{
+	hMap = NULL;
+	ring = NULL;
+	hThread = NULL;
+	hStop = NULL;
+	nframe = nreject = 0;
+	InitializeCriticalSection (&cs);
+}
+
+// --------------------------------------------------------------
+
+CommandServer::~CommandServer ()
+{
+	Stop();
+	DeleteCriticalSection (&cs);
+}
+
+// --------------------------------------------------------------
+
+bool CommandServer::Start ()
+{
+	Stop();
+
+	// shared memory ring
+	DWORD mapsize = sizeof(RC_RING) + RC_RINGSIZE;
+	hMap = CreateFileMapping (INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, mapsize, RC_SHM_NAME);
+	if (hMap) {
+		ring = (RC_RING*)MapViewOfFile (hMap, FILE_MAP_ALL_ACCESS, 0, 0, mapsize);
+		if (ring) {
+			// discard anything left over from a previous session
+			ring->size = RC_RINGSIZE;
+			ring->version = RC_VERSION;
+			ring->tail = ring->head;
+			MemoryBarrier();
+			ring->magic = RC_MAGIC;
+		} else {
+			CloseHandle (hMap);
+			hMap = NULL;
+		}
+	}
+
+	// named pipe listener
+	hStop = CreateEvent (NULL, TRUE, FALSE, NULL);
+	if (hStop) {
+		hThread = CreateThread (NULL, 0, PipeThread, this, 0, NULL);
+		if (!hThread) {
+			CloseHandle (hStop);
+			hStop = NULL;
+		}
+	}
+
+	nframe = nreject = 0;
+	return ring != NULL || hThread != NULL;
+}
+
+// --------------------------------------------------------------
+
+void CommandServer::Stop ()
+{
+	if (hThread) {
+		// the listener only ever blocks on hStop and its own pipe
+		// operations, so it exits promptly
+		SetEvent (hStop);
+		WaitForSingleObject (hThread, INFINITE);
+		CloseHandle (hThread);
+		CloseHandle (hStop);
+		hThread = hStop = NULL;
+	}
+	if (ring) {
+		ring->magic = 0;
+		UnmapViewOfFile (ring);
+		ring = NULL;
+	}
+	if (hMap) {
+		CloseHandle (hMap);
+		hMap = NULL;
+	}
+	pipebuf.clear();
+	pending.clear();
+	vref.clear();
+}
+
+// --------------------------------------------------------------
+
+int CommandServer::Apply (double simt)
+{
+	// collect new frames from both transports
+	if (ring) ReadRing();
+	if (hThread) {
+		EnterCriticalSection (&cs);
+		if (pipebuf.size()) {
+			pending.insert (pending.end(), pipebuf.begin(), pipebuf.end());
+			pipebuf.clear();
+		}
+		LeaveCriticalSection (&cs);
+	}
+	if (pending.empty()) return 0;
+
+	// apply due frames, keep the others in order
+	int napply = 0;
+	size_t ofs = 0, n = pending.size();
+	swapbuf.clear();
+	while (ofs < n) {
+		const RC_FRAME *frame = (const RC_FRAME*)&pending[ofs];
+		if (frame->simt <= simt) {
+			const RC_CMD *cmd = (const RC_CMD*)(frame+1);
+			for (DWORD i = 0; i < frame->ncmd; i++)
+				if (ApplyCommand (cmd[i])) napply++;
+				else InterlockedIncrement (&nreject);
+		} else {
+			swapbuf.insert (swapbuf.end(), pending.begin()+ofs, pending.begin()+ofs+frame->size);
+		}
+		ofs += frame->size;
+	}
+	pending.swap (swapbuf);
+	return napply;
+}
+
+// --------------------------------------------------------------
+
+void CommandServer::ReadRing ()
+{
+	DWORD head = (DWORD)ring->head;
+	DWORD tail = (DWORD)ring->tail;
+	MemoryBarrier();
+	const BYTE *data = RcRingData (ring);
+
+	while (tail != head) {
+		DWORD avail = head - tail;
+		DWORD ofs = tail & (RC_RINGSIZE-1);
+		RC_FRAME hdr;
+		if (avail < sizeof(RC_FRAME) || avail > RC_RINGSIZE) {
+			tail = head; InterlockedIncrement (&nreject); // corrupt ring: resynchronise
+			break;
+		}
+
+		// copy the header, then the complete frame, unwrapping as required
+		DWORD n = min ((DWORD)sizeof(RC_FRAME), RC_RINGSIZE-ofs);
+		memcpy (&hdr, data+ofs, n);
+		memcpy ((BYTE*)&hdr+n, data, sizeof(RC_FRAME)-n);
+		if (!ValidFrame (&hdr, avail)) {
+			tail = head; InterlockedIncrement (&nreject);
+			break;
+		}
+		size_t pos = pending.size();
+		pending.resize (pos + hdr.size);
+		n = min (hdr.size, RC_RINGSIZE-ofs);
+		BYTE *dst = &pending[0] + pos;
+		memcpy (dst, data+ofs, n);
+		memcpy (dst+n, data, hdr.size-n);
+		// the writer may have changed the header since it was validated:
+		// Apply relies on size and ncmd, so keep the validated copy
+		memcpy (dst, &hdr, sizeof(RC_FRAME));
+		tail += hdr.size;
+		InterlockedIncrement (&nframe);
+	}
+	MemoryBarrier();
+	ring->tail = (LONG)tail;
+}
+
+// --------------------------------------------------------------
+
+bool CommandServer::ApplyCommand (const RC_CMD &cmd)
+{
+	OBJHANDLE hVessel = FindVessel (cmd.vessel);
+	if (!hVessel) return false;
+	VESSEL *v = oapiGetVesselInterface (hVessel);
+
+	switch (cmd.type) {
+	case RC_THGROUP:
+		if (cmd.id > THGROUP_ATT_BACK) return false;
+		v->SetThrusterGroupLevel ((THGROUP_TYPE)cmd.id, cmd.value);
+		return true;
+	case RC_CTRLSURF:
+		if (cmd.id > AIRCTRL_RUDDERTRIM) return false;
+		v->SetControlSurfaceLevel ((AIRCTRL_TYPE)cmd.id, cmd.value);
+		return true;
+	case RC_NAVMODE:
+		if (cmd.id < NAVMODE_KILLROT || cmd.id > NAVMODE_HOLDALT) return false;
+		if (cmd.value) v->ActivateNavmode (cmd.id);
+		else           v->DeactivateNavmode (cmd.id);
+		return true;
+	}
+	return false;
+}
+
+// --------------------------------------------------------------
+
+OBJHANDLE CommandServer::FindVessel (const char *name)
+{
+	char cbuf[32];
+	strncpy (cbuf, name, 31); cbuf[31] = '\0';
+
+	for (size_t i = 0; i < vref.size(); i++) {
+		if (!strcmp (vref[i].name, cbuf)) {
+			if (oapiIsVessel (vref[i].hVessel)) return vref[i].hVessel;
+			vref.erase (vref.begin()+i); // vessel was deleted
+			break;
+		}
+	}
+	OBJHANDLE hVessel = oapiGetVesselByName (cbuf);
+	if (hVessel) {
+		VesselRef ref;
+		strcpy (ref.name, cbuf);
+		ref.hVessel = hVessel;
+		vref.push_back (ref);
+	}
+	return hVessel;
+}
+
+// --------------------------------------------------------------
+
+DWORD WINAPI CommandServer::PipeThread (LPVOID context)
+{
+	CommandServer *server = (CommandServer*)context;
+	HANDLE hStop = server->hStop;
+	BYTE buf[RC_MAXFRAME];
+	DWORD nread, res = 0;
+	OVERLAPPED ov;
+	memset (&ov, 0, sizeof(ov));
+	ov.hEvent = CreateEvent (NULL, TRUE, FALSE, NULL);
+	if (!ov.hEvent) return 1;
+
+	while (WaitForSingleObject (hStop, 0) == WAIT_TIMEOUT) {
+		HANDLE hPipe = CreateNamedPipe (RC_PIPE_NAME, PIPE_ACCESS_INBOUND | FILE_FLAG_OVERLAPPED,
+			PIPE_TYPE_MESSAGE | PIPE_READMODE_MESSAGE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+			1, 0, RC_MAXFRAME, 0, NULL);
+		if (hPipe == INVALID_HANDLE_VALUE) { res = 1; break; }
+
+		if (WaitPipe (hPipe, &ov, hStop, ConnectNamedPipe (hPipe, &ov), nread)) {
+			// oversized messages fail with ERROR_MORE_DATA and drop the client
+			while (WaitPipe (hPipe, &ov, hStop, ReadFile (hPipe, buf, RC_MAXFRAME, NULL, &ov), nread)) {
+				const RC_FRAME *frame = (const RC_FRAME*)buf;
+				if (nread >= sizeof(RC_FRAME) && ValidFrame (frame, nread)) {
+					EnterCriticalSection (&server->cs);
+					server->pipebuf.insert (server->pipebuf.end(), buf, buf+frame->size);
+					LeaveCriticalSection (&server->cs);
+					InterlockedIncrement (&server->nframe);
+				} else {
+					InterlockedIncrement (&server->nreject);
+				}
+			}
+		}
+		DisconnectNamedPipe (hPipe);
+		CloseHandle (hPipe);
+	}
+	CloseHandle (ov.hEvent);
+	return res;
+}
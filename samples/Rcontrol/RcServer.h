@@ -0,0 +1,77 @@
+// ==============================================================
+//                  ORBITER MODULE: Rcontrol
+//                  Part of the ORBITER SDK
+//           Copyright (C) 2003-2016 Martin Schweiger
+//                   All rights reserved
+//
+// RcServer.h
+// Interface for class CommandServer:
+//   Receives vessel command frames from external programs through
+//   shared memory or a named pipe, and applies them in the
+//   simulation thread.
+// ==============================================================
+
+#ifndef __RCSERVER_H
+#define __RCSERVER_H
+
+#include "Orbitersdk.h"
+#include "RcFrame.h"
+#include <vector>
+
+class CommandServer {
+public:
+	CommandServer ();
+	~CommandServer ();
+
+	/**
+	 * \brief Open the shared memory ring and start the pipe listener.
+	 * \return false if neither transport could be opened.
+	 */
+	bool Start ();
+
+	/**
+	 * \brief Close both transports. Frames not yet applied are discarded.
+	 * \note Pending pipe operations are cancelled, and the call returns once
+	 *   the listener thread has exited.
+	 */
+	void Stop ();
+
+	/**
+	 * \brief Apply all frames due at the current simulation time.
+	 * \param simt simulation time [s]
+	 * \return number of commands applied
+	 * \note Call from the simulation thread once per time step, before
+	 *   the vessel states are propagated (i.e. from clbkPreStep).
+	 *   Frames are applied in arrival order. Frames time-stamped for a
+	 *   later step are kept until they become due.
+	 */
+	int Apply (double simt);
+
+	inline DWORD FrameCount () const { return (DWORD)nframe; }   ///< frames received
+	inline DWORD RejectCount () const { return (DWORD)nreject; } ///< malformed frames and rejected commands
+
+private:
+	void ReadRing ();
+	bool ApplyCommand (const RC_CMD &cmd);
+	OBJHANDLE FindVessel (const char *name);
+	static DWORD WINAPI PipeThread (LPVOID context);
+
+	HANDLE hMap;                 // shared memory file mapping
+	RC_RING *ring;               // mapped ring
+	HANDLE hThread;              // pipe listener thread
+	HANDLE hStop;                // signalled to stop the pipe listener
+	CRITICAL_SECTION cs;         // guards pipebuf
+	std::vector<BYTE> pipebuf;   // frames received through the pipe
+	std::vector<BYTE> pending;   // frames waiting to be applied
+	std::vector<BYTE> swapbuf;   // work buffer
+
+	struct VesselRef {
+		char name[32];
+		OBJHANDLE hVessel;
+	};
+	std::vector<VesselRef> vref; // vessel name cache
+
+	volatile LONG nframe, nreject;
+};
+
+#endif // !__RCSERVER_H
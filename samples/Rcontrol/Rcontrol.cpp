@@ -7,13 +7,15 @@
 // Rcontrol.cpp
 //
 // A small plugin which allows to manipulate spacecraft main and
-// retro controls via a dialog box.
+// retro controls via a dialog box, or from external programs via
+// the command frame protocol defined in RcFrame.h.
 // ==============================================================
 
 #define STRICT 1
 #define ORBITER_MODULE
 #include "Orbitersdk.h"
 #include "DlgCtrl.h"
+#include "RcServer.h"
 #include "resource.h"
 #include <stdio.h>
 
@@ -27,6 +29,7 @@ public:
 	RControl (HINSTANCE hDLL): Module (hDLL) {}
 	~RControl () {}
 	void clbkSimulationStart (RenderMode mode);
+	void clbkSimulationEnd ();
 	void clbkPreStep (double simt, double simdt, double mjd);
 };
 
@@ -39,6 +42,7 @@ using namespace oapi;
 
 static struct {
 	RControl *rcontrol;
+	CommandServer *server;
 	HINSTANCE hDLL;
 	HWND      hDlg;
 	DWORD     dwCmd;
@@ -56,11 +60,20 @@ void CreateVesselList (HWND);
 void RControl::clbkSimulationStart (RenderMode mode)
 {
 	g_Param.hDlg = NULL;
+	g_Param.server->Start();
+}
+
+void RControl::clbkSimulationEnd ()
+{
+	g_Param.server->Stop();
 }
 
 // Frame update
 void RControl::clbkPreStep (double simt, double simdt, double mjd)
 {
+	// commands from external programs
+	g_Param.server->Apply (simt);
+
 	if (!g_Param.hDlg) return;
 
 	int slider;
@@ -118,6 +131,7 @@ DLLCLBK void InitModule (HINSTANCE hDLL)
 	oapiRegisterCustomControls (hDLL);
 
 	// Register the module
+	g_Param.server = new CommandServer;
 	g_Param.rcontrol = new RControl (hDLL);
 	oapiRegisterModule (g_Param.rcontrol);
 }
@@ -132,6 +146,7 @@ DLLCLBK void ExitModule (HINSTANCE hDLL)
 	oapiUnregisterCustomControls (hDLL);
 
 	delete g_Param.rcontrol;
+	delete g_Param.server;
 }
 
 // Open the dialog box
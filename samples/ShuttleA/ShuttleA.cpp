@@ -41,6 +41,10 @@
 
 GDIParams g_Param;
 
+// HUD marker element masks (in order of definition in DefineHUDGeometry)
+static const DWORD HUDELEM_GEAR      = 0x1;
+static const DWORD HUDELEM_DOCKCOVER = 0x2;
+
 static const int ntdvtx = 16;
 static TOUCHDOWNVTX tdvtx[ntdvtx] = {
 	{_V(-3  ,-3.05, 12.5), 3.5e6, 3.5e5, 3},
@@ -111,8 +115,10 @@ ShuttleA::ShuttleA (OBJHANDLE hObj, int fmodel)
 	gear_proc = 0.0;
 	gear_status = DOOR_CLOSED;
 	DefineAnimations ();
+	DefineHUDGeometry ();
 	for (i = 0; i < nsurf; i++)
 		srf[i] = 0;
+	vcatlas = 0;
 	for (i = 0; i < 2; i++) {
 		pod_angle[i] = pod_angle_request[i] = 0.0;
 	};
@@ -137,6 +143,56 @@ ShuttleA::~ShuttleA ()
 		delete pel[i];
 }
 
+// --------------------------------------------------------------
+// Define the retained geometry for vessel-specific HUD markers
+// --------------------------------------------------------------
+void ShuttleA::DefineHUDGeometry ()
+{
+	static float texw = 512.0f, texh = 256.0f;
+	int i;
+
+	// gear status indicator
+	NTVERTEX vgear[24];
+	static WORD igear[36] = {
+		 0, 3, 1,  2, 3, 0,
+		 4, 7, 5,  6, 7, 4,
+		 8,11, 9, 10,11, 8,
+		12,15,13, 14,15,12,
+		16,19,17, 18,19,16,
+		20,23,21, 22,23,20
+	};
+	float x[24] = {-5,-3,-5,-3,-5,-3,-5,-3,-5,-3,-5,-3, 3,5,3,5,3,5,3,5,3,5,3,5};
+	float y[24] = {-6.5,-6.5,-8.5,-8.5,-1.5,-1.5,-3.5,-3.5,3.5,3.5,1.5,1.5,-6.5,-6.5,-8.5,-8.5,-1.5,-1.5,-3.5,-3.5,3.5,3.5,1.5,1.5};
+	for (i = 0; i < 24; i++) {
+		vgear[i].x = x[i];
+		vgear[i].y = y[i];
+		vgear[i].tu = (405.0f + (18.0f * (i%2)))/texw;
+		vgear[i].tv = (104.0f - (18.0f * ((i%4)/2)))/texh;
+	}
+	hudgeom.AddElement (vgear, 24, igear, 36);
+
+	// dock cover indicator
+	NTVERTEX vnose[12];
+	static WORD inose[30] = {
+		0,1,2, 2,3,0,
+		0,6,1, 6,7,1,
+		1,8,2, 8,9,2,
+		2,10,3, 10,11,3,
+		3,4,0, 0,4,5
+	};
+	float xn[12] = {0,1,0,-1,-31,-30,30,31,31,30,-30,-31};
+	float yn[12] = {-1,0,1,0,-30,-31,-31,-30,30,31,31,30};
+	float un[12] = {392.5f, 397.0f, 392.5f, 388.0f, 388.0f, 392.5f, 392.5f, 397.0f, 397.0f, 392.5f, 392.5f, 388.0f};
+	float vn[12] = {92.0f, 96.5f, 101.0f, 96.5f, 96.5f, 92.0f, 92.0f, 96.5f, 96.5f, 101.0f, 101.0f, 96.5f};
+	for (i = 0; i < 12; i++) {
+		vnose[i].x = xn[i];
+		vnose[i].y = yn[i];
+		vnose[i].tu = un[i]/texw;
+		vnose[i].tv = vn[i]/texh;
+	}
+	hudgeom.AddElement (vnose, 12, inose, 30, 0.4f);
+}
+
 // --------------------------------------------------------------
 // Define animation sequences for moving parts
 // --------------------------------------------------------------
@@ -321,11 +377,16 @@ void ShuttleA::DefineAnimations ()
 // --------------------------------------------------------------
 void ShuttleA::ReleaseSurfaces ()
 {
+	bltbatch.Flush();
 	for (int i = 0; i < nsurf; i++)
 		if (srf[i]) {
 			oapiDestroySurface (srf[i]);
 			srf[i] = 0;
 		}
+	if (vcatlas) {
+		delete vcatlas;
+		vcatlas = 0;
+	}
 }
 
 // --------------------------------------------------------------
@@ -337,11 +398,13 @@ void ShuttleA::InitPanel (int panel)
 
 	switch (panel) {
 	case -1: //VC resources
-		srf[2] = oapiCreateSurface (LOADBMP (IDB_BUTTON1));
-		srf[3] = oapiCreateSurface (LOADBMP (IDB_INDICATOR1));
-		srf[4] = oapiCreateSurface (LOADBMP (IDB_INDICATOR2));
-		srf[5] = oapiCreateSurface (LOADBMP (IDB_BUTTON3)); 
-
+		// the VC bitmaps share one atlas surface, so that the blits of a
+		// redraw event are submitted without source changes
+		vcatlas = new SurfaceAtlas (256, 128);
+		vcsprite[SPR_BUTTON3]    = vcatlas->Add (LOADBMP (IDB_BUTTON3));
+		vcsprite[SPR_INDICATOR1] = vcatlas->Add (LOADBMP (IDB_INDICATOR1));
+		vcsprite[SPR_INDICATOR2] = vcatlas->Add (LOADBMP (IDB_INDICATOR2));
+		vcsprite[SPR_BUTTON1]    = vcatlas->Add (LOADBMP (IDB_BUTTON1));
 		break;
 	case 0:
 		srf[0] = oapiCreateSurface (LOADBMP (IDB_SLIDER1));
@@ -714,7 +777,7 @@ void ShuttleA::RedrawPanel_Navmode (SURFHANDLE surf)
 {
 	for (DWORD i = NAVMODE_KILLROT; i < NAVMODE_HOLDALT; i++)
 		if (GetNavmodeState (i))
-			oapiBlt (surf, srf[2], (6-i)*44, 0, (i-1)*42, 0, 42, 31);
+			bltbatch.Blt (surf, vcatlas, vcsprite[SPR_BUTTON1], (6-i)*44, 0, (i-1)*42, 0, 42, 31);
 }
 
 // --------------------------------------------------------------
@@ -733,7 +796,7 @@ bool ShuttleA::RedrawPanel_Throttle (SURFHANDLE surf)
 	}
 	if (redraw)
 		for (i = 0; i < 2; i++)
-			oapiBlt (surf, srf[0], i*30, sliderpos_main[i], 0, 0, 23, 19);
+			bltbatch.Blt (surf, srf[0], i*30, sliderpos_main[i], 0, 0, 23, 19);
 	return redraw;
 }
 
@@ -753,7 +816,7 @@ bool ShuttleA::RedrawPanel_Hover (SURFHANDLE surf)
 	}
 	if (redraw)
 		for (i = 0; i < 2; i++)
-			oapiBlt (surf, srf[0], i*30, sliderpos_hovr[i], 0, 0, 23, 19);
+			bltbatch.Blt (surf, srf[0], i*30, sliderpos_hovr[i], 0, 0, 23, 19);
 	return redraw;
 }
 
@@ -773,7 +836,7 @@ bool ShuttleA::RedrawPanel_Podlevel (SURFHANDLE surf)
 	}
 	if (redraw)
 		for (i = 0; i < 2; i++)
-			oapiBlt (surf, srf[0], i*30, sliderpos_pod[i], 0, 0, 23, 19);
+			bltbatch.Blt (surf, srf[0], i*30, sliderpos_pod[i], 0, 0, 23, 19);
 	return redraw;
 }
 
@@ -1000,13 +1063,13 @@ void ShuttleA::RedrawPanel_CargoOpen(SURFHANDLE surf)
 		{	
 			mx = (i>2?0:45);
 			my = (i % 3)*44;
-			oapiBlt (surf, srf[5], mx, my, 0, 0, 38, 42);
+			bltbatch.Blt (surf, vcatlas, vcsprite[SPR_BUTTON3], mx, my, 0, 0, 38, 42);
 
 		} else if (cargo_arm_status ==1)
 		{
 			mx = (i>2?0:45);
 			my = (i % 3)*44;
-			oapiBlt (surf, srf[5], mx+1, my, 0, 42, 38, 42);
+			bltbatch.Blt (surf, vcatlas, vcsprite[SPR_BUTTON3], mx+1, my, 0, 42, 38, 42);
 		}
 }
 
@@ -1614,6 +1677,7 @@ bool ShuttleA::clbkLoadPanel2D (int id, PANELHANDLE hPanel, DWORD viewW, DWORD v
 	case 0:
 		DefineMainPanel (hPanel);
 		ScalePanel (hPanel, viewW, viewH);
+		adiball->LoadPanel2D (id, hPanel, viewW, viewH);
 		oapiSetPanelNeighbours (-1,-1,1,-1);
 		SetCameraDefaultDirection (_V(0,0,1)); // forward
 		oapiCameraSetCockpitDir (0,0);         // look forward
@@ -1930,79 +1994,20 @@ void ShuttleA::clbkRenderHUD (int mode, const HUDPAINTSPEC *hps, SURFHANDLE hTex
 {
 	VESSEL4::clbkRenderHUD (mode, hps, hTex);
 
-	static float texw = 512.0f, texh = 256.0f;
-	float cx = (float)hps->CX, cy = (float)hps->CY;
-	int i, nvtx = 0, nidx = 0;
-	static NTVERTEX vtx[24+12];
-	static WORD idx[36+30];
-	static float scl = 0;
-	static NTVERTEX vgear[24];
-	static NTVERTEX vnose[12];
-	static WORD igear[36] = {
-		 0, 3, 1,  2, 3, 0,
-		 4, 7, 5,  6, 7, 4,
-		 8,11, 9, 10,11, 8,
-		12,15,13, 14,15,12,
-		16,19,17, 18,19,16,
-		20,23,21, 22,23,20
-	};
-	static WORD inose[30] = {
-		0,1,2, 2,3,0,
-		0,6,1, 6,7,1,
-		1,8,2, 8,9,2,
-		2,10,3, 10,11,3,
-		3,4,0, 0,4,5
-	};
-
-	if (scl != hps->Markersize*0.25f) {
-		scl = hps->Markersize*0.25f;
-		memset (vgear, 0, 24*sizeof(NTVERTEX));
-		float x[24] = {-5,-3,-5,-3,-5,-3,-5,-3,-5,-3,-5,-3, 3,5,3,5,3,5,3,5,3,5,3,5};
-		float y[24] = {-6.5,-6.5,-8.5,-8.5,-1.5,-1.5,-3.5,-3.5,3.5,3.5,1.5,1.5,-6.5,-6.5,-8.5,-8.5,-1.5,-1.5,-3.5,-3.5,3.5,3.5,1.5,1.5};
-		for (i = 0; i < 24; i++) {
-			vgear[i].x = cx + x[i]*scl;
-			vgear[i].y = cy + y[i]*scl;
-			vgear[i].tu = (405.0f + (18.0f * (i%2)))/texw;
-			vgear[i].tv = (104.0f - (18.0f * ((i%4)/2)))/texh;
-		}
-		memset (vnose, 0, 12*sizeof(NTVERTEX));
-		float xn[12] = {0,1,0,-1,-31,-30,30,31,31,30,-30,-31};
-		float yn[12] = {-1,0,1,0,-30,-31,-31,-30,30,31,31,30};
-		float un[12] = {392.5f, 397.0f, 392.5f, 388.0f, 388.0f, 392.5f, 392.5f, 397.0f, 397.0f, 392.5f, 392.5f, 388.0f};
-		float vn[12] = {92.0f, 96.5f, 101.0f, 96.5f, 96.5f, 92.0f, 92.0f, 96.5f, 96.5f, 101.0f, 101.0f, 96.5f};
-		for (i = 0; i < 12; i++) {
-			vnose[i].x = cx + xn[i]*scl*0.4f;
-			vnose[i].y = cy + yn[i]*scl*0.4f;
-			vnose[i].tu = un[i]/texw;
-			vnose[i].tv = vn[i]/texh;
-		}
-	}
+	DWORD mask = 0;
 
 	// show gear deployment status
-	if (gear_status == DOOR_CLOSED || (gear_status >= DOOR_CLOSING && fmod (oapiGetSimTime(), 1.0) < 0.5)) {
-		memcpy (vtx+nvtx, vgear, 24*sizeof(NTVERTEX));
-		for (i = 0; i < 36; i++) idx[nidx+i] = igear[i]+nvtx;
-		nvtx += 24;
-		nidx += 36;
-	}
+	if (gear_status == DOOR_CLOSED || (gear_status >= DOOR_CLOSING && fmod (oapiGetSimTime(), 1.0) < 0.5))
+		mask |= HUDELEM_GEAR;
 
 	// show dock cover status
 	if (oapiGetHUDMode() == HUD_DOCKING && dock_status != DOOR_OPEN) {
 		double tmp;
-		if (dock_status == DOOR_CLOSED || modf (oapiGetSimTime(), &tmp) < 0.5) {
-			memcpy (vtx+nvtx, vnose, 12*sizeof(NTVERTEX));
-			for (i = 0; i < 30; i++) idx[nidx+i] = inose[i]+nvtx;
-			nvtx += 12;
-			nidx += 30;
-		}
+		if (dock_status == DOOR_CLOSED || modf (oapiGetSimTime(), &tmp) < 0.5)
+			mask |= HUDELEM_DOCKCOVER;
 	}
 
-	if (nvtx) {
-		MESHGROUP grp = {vtx, idx, nvtx, nidx, 0, 0, 0, 0, 0};
-		MESHHANDLE hmesh = oapiCreateMesh (1, &grp);
-		oapiRenderHUD (hmesh, &hTex);
-		oapiDeleteMesh (hmesh);
-	}
+	hudgeom.Render ((float)hps->CX, (float)hps->CY, hps->Markersize*0.25f, mask, &hTex);
 }
 
 // --------------------------------------------------------------
@@ -2316,7 +2321,18 @@ return false;
 // --------------------------------------------------------------
 bool ShuttleA::clbkVCRedrawEvent (int id, int event, SURFHANDLE surf)
 {
+	// blits are queued by the redraw functions and submitted here,
+	// before the surface is handed back to the client
+	bool redraw = RedrawVC (id, event, surf);
+	bltbatch.Flush();
+	return redraw;
+}
 
+// --------------------------------------------------------------
+// Redraw a VC area. Blits are queued in bltbatch.
+// --------------------------------------------------------------
+bool ShuttleA::RedrawVC (int id, int event, SURFHANDLE surf)
+{
 	switch (id) {
 	case AID_MFD1_LBUTTONS:
 			RedrawPanel_MFDButton (surf, MFD_LEFT, 0);
@@ -2365,23 +2381,23 @@ bool ShuttleA::clbkVCRedrawEvent (int id, int event, SURFHANDLE surf)
 			return true;
 	case AID_AIRLOCK1INDICATOR:
 		switch (lock_status[0]) {
-		case DOOR_CLOSED: oapiBlt (surf, srf[3], 0, 0, 0,  0, 34, 8); break;
-		case DOOR_OPEN:   oapiBlt (surf, srf[3], 0, 0, 0, 16, 34, 8); break;
-		default:          oapiBlt (surf, srf[3], 0, 0, 0,  8, 34, 8); break;
+		case DOOR_CLOSED: bltbatch.Blt (surf, vcatlas, vcsprite[SPR_INDICATOR1], 0, 0, 0,  0, 34, 8); break;
+		case DOOR_OPEN:   bltbatch.Blt (surf, vcatlas, vcsprite[SPR_INDICATOR1], 0, 0, 0, 16, 34, 8); break;
+		default:          bltbatch.Blt (surf, vcatlas, vcsprite[SPR_INDICATOR1], 0, 0, 0,  8, 34, 8); break;
 		}
 		return true;
 	case AID_DOCKINDICATOR:
 		switch (dock_status) {
-		case DOOR_CLOSED: oapiBlt (surf, srf[4], 0, 0, 0,  0, 34, 8); break;
-		case DOOR_OPEN:   oapiBlt (surf, srf[4], 0, 0, 0, 16, 34, 8); break;
-		default:          oapiBlt (surf, srf[4], 0, 0, 0,  8, 34, 8); break;
+		case DOOR_CLOSED: bltbatch.Blt (surf, vcatlas, vcsprite[SPR_INDICATOR2], 0, 0, 0,  0, 34, 8); break;
+		case DOOR_OPEN:   bltbatch.Blt (surf, vcatlas, vcsprite[SPR_INDICATOR2], 0, 0, 0, 16, 34, 8); break;
+		default:          bltbatch.Blt (surf, vcatlas, vcsprite[SPR_INDICATOR2], 0, 0, 0,  8, 34, 8); break;
 		}
 		return true;
 	case AID_GEARINDICATOR:
 		switch (gear_status) {
-		case DOOR_CLOSED: oapiBlt (surf, srf[4], 0, 0, 0,  0, 34, 8); break;
-		case DOOR_OPEN:   oapiBlt (surf, srf[4], 0, 0, 0, 16, 34, 8); break;
-		default:          oapiBlt (surf, srf[4], 0, 0, 0,  8, 34, 8); break;
+		case DOOR_CLOSED: bltbatch.Blt (surf, vcatlas, vcsprite[SPR_INDICATOR2], 0, 0, 0,  0, 34, 8); break;
+		case DOOR_OPEN:   bltbatch.Blt (surf, vcatlas, vcsprite[SPR_INDICATOR2], 0, 0, 0, 16, 34, 8); break;
+		default:          bltbatch.Blt (surf, vcatlas, vcsprite[SPR_INDICATOR2], 0, 0, 0,  8, 34, 8); break;
 		}
 		return true;
 	case AID_DOCKSWITCH:
@@ -2403,7 +2419,7 @@ bool ShuttleA::clbkVCRedrawEvent (int id, int event, SURFHANDLE surf)
 		SetAnimation (anim_cargo_switch,cargo_arm_status == 1 ? 0.0:1.0);
 		return false;
 	case AID_CARGOARMINDICATOR:
-		oapiBlt (surf, srf[4], 0, 0, 0,  cargo_arm_status == 1? 16:0, 34, 8); 
+		bltbatch.Blt (surf, vcatlas, vcsprite[SPR_INDICATOR2], 0, 0, 0,  cargo_arm_status == 1? 16:0, 34, 8); 
 		 return true;
 		
 
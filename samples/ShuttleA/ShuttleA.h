@@ -12,6 +12,8 @@
 #define __SHUTTLEA_H
 
 #include "orbitersdk.h"
+#include "..\Common\Vessel\HudGeometry.h"
+#include "..\Common\Vessel\BltBatch.h"
 
 // ==========================================================
 // Some vessel class caps
@@ -70,6 +72,13 @@ const double POD_ROT_SPEED = 0.2;
 
 const int nsurf = 6; // number of bitmap handles
 
+// sprites in the VC bitmap atlas
+const int SPR_BUTTON1    = 0;
+const int SPR_BUTTON3    = 1;
+const int SPR_INDICATOR1 = 2;
+const int SPR_INDICATOR2 = 3;
+const int nsprite        = 4;
+
 const double MAX_GRAPPLING_DIST = 0.5f;
 const double MAX_GRAPPLING_ANG  = 0.9f; //(cos(angle)>0.9f)
 //distance for payload grappling.. being a bit generous here
@@ -131,6 +140,10 @@ public:
 	void RedrawPanel_CargoPresent(SURFHANDLE surf);
 
 	SURFHANDLE srf[nsurf];
+	SurfaceAtlas *vcatlas;  // small VC bitmaps, packed into one source surface
+	int vcsprite[nsprite];
+	BltBatch bltbatch;      // panel and VC blits, flushed after each redraw event
+	HUDGeometry hudgeom;    // retained HUD marker mesh
 	PROPELLANT_HANDLE ph_main, ph_rcs;
 	THRUSTER_HANDLE th_main[2], th_hover[2], th_pod[2];
 	MESHHANDLE vcmesh_tpl,exmesh_tpl;
@@ -191,10 +204,12 @@ public:
 	bool clbkVCMouseEvent (int id, int event, VECTOR3 &p);
 
 private:
+	bool RedrawVC (int id, int event, SURFHANDLE surf);
 	void DefineMainPanel (PANELHANDLE hPanel);
 	void DefineOverheadPanel (PANELHANDLE hPanel);
 	void ScalePanel (PANELHANDLE hPanel, DWORD viewW, DWORD viewH);
 	void DefineAnimations ();
+	void DefineHUDGeometry ();
 	double payload_mass;
 	void ComputePayloadMass();
 	
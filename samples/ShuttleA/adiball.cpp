@@ -11,6 +11,7 @@
 #define STRICT 1
 #include "adiball.h"
 #include "attref.h"
+#include <xmmintrin.h>
 
 // Generic ADI texture parameters
 static const float texw = 512.0f;  // ADI texture width
@@ -57,6 +58,20 @@ static const float bb_tf_y0   = bb_cnty-59.5f;
 
 static const double rad = 68.0;
 
+// Ball resolution levels
+static const int    ball_res    = 12;      // resolution of the full-resolution ball (level 0)
+static const double lod_rad[2]  = {120.0, 48.0}; // min. on-screen ball radius [pixel] for levels 0 and 1
+static const double ball_eps    = 0.1;     // min. ball displacement [pixel] to trigger a ball update
+
+// Difference between two angles, mapped to -pi..pi
+static inline double AngleDiff (double a, double b)
+{
+	double d = a-b;
+	if (d > PI)       d -= PI2;
+	else if (d < -PI) d += PI2;
+	return d;
+}
+
 // ==============================================================
 
 ADIBall::ADIBall (VESSEL3 *v, AttitudeReference *attref): PanelElement (v)
@@ -65,7 +80,11 @@ ADIBall::ADIBall (VESSEL3 *v, AttitudeReference *attref): PanelElement (v)
 	layout = 0;
 	rho_curr = tht_curr = phi_curr = 0.0;
 	tgtx_curr = tgty_curr = 0.0;
-	ballvtx0 = 0;
+	rho_disp = tht_disp = phi_disp = 0.0;
+	memset (balllod, 0, NBALLLOD*sizeof(BallLod));
+	lod = 1;
+	lodscale = 1.0;
+	ballvalid = false;
 	peuler = _V(0,0,0);
 	vrot = _V(0,0,0);
 	euler_t = 0;
@@ -76,7 +95,7 @@ ADIBall::ADIBall (VESSEL3 *v, AttitudeReference *attref): PanelElement (v)
 
 ADIBall::~ADIBall ()
 {
-	if (ballvtx0) delete []ballvtx0;
+	ClearBallLod ();
 }
 
 // ==============================================================
@@ -84,24 +103,21 @@ ADIBall::~ADIBall ()
 void ADIBall::AddMeshData2D (MESHHANDLE hMesh, DWORD grpidx_ball, DWORD grpidx_ind)
 {
 	// We need two separate mesh groups for the ball and indicators, because the ball is typically
-	// rendered below the panel mesh, and the indicators above it
+	// rendered below the panel mesh, and the indicators above it. The ball group must not contain
+	// other geometry, because its vertex and index counts change with the resolution level
 
 	static const DWORD nvtx_rect = 4;
 	static const DWORD nidx_rect = 6;
 	static const WORD idx_rect[nidx_rect] = { 0,1,2,  3,2,1 };
 
-	DWORD i, nidx;
+	DWORD i;
 	NTVERTEX *vtx;
 	WORD *idx;
 
 	// ball mesh
-	MakeBall (6, rad, vtx, nballvtx, idx, nidx);
-	if (ballvtx0) delete []ballvtx0;
-	ballvtx0 = new VECTOR3[nballvtx];
+	MakeBall (ball_res, rad, vtx, nballvtx, idx, nballidx);
+	MakeBallLod (ball_res, vtx, idx);
 	for (i = 0; i < nballvtx; i++) {
-		ballvtx0[i].x = vtx[i].x;
-		ballvtx0[i].y = vtx[i].y;
-		ballvtx0[i].z = vtx[i].z;
 		vtx[i].x += bb_cntx;
 		vtx[i].y += bb_cnty;
 		vtx[i].z = 0;
@@ -110,9 +126,14 @@ void ADIBall::AddMeshData2D (MESHHANDLE hMesh, DWORD grpidx_ball, DWORD grpidx_i
 		for (i = 0; i < nballvtx; i++)
 			vtx[i].tu += tx_dx/texw;
 
-	AddGeometry (hMesh, grpidx_ball, vtx, nballvtx, idx, nidx);
+	ballidxofs = oapiMeshGroup (hMesh, grpidx_ball)->nIdx;
+	AddGeometry (hMesh, grpidx_ball, vtx, nballvtx, idx, nballidx);
 	ballgrp = grp;
 	ballofs = vtxofs;
+	lod = 0; // the mesh group now contains the full-resolution index list
+	SetBallLod (lodscale);
+	delete []vtx;
+	delete []idx;
 
 	// Roll indicator mesh
 	static const NTVERTEX bvtx[nvtx_rect] = {
@@ -184,9 +205,6 @@ void ADIBall::AddMeshData2D (MESHHANDLE hMesh, DWORD grpidx_ball, DWORD grpidx_i
 	};
 	AddGeometry (hMesh, grpidx_ind, yrvtx, nvtx_rect, idx_rect, nidx_rect);
 	yrateofs = vtxofs;
-
-	delete []vtx;
-	delete []idx;
 }
 
 // ==============================================================
@@ -197,13 +215,24 @@ void ADIBall::SetLayout (int _layout)
 
 	layout = _layout;
 
-	if (ballvtx0) {
+	if (balllod[0].idx) {
 		float dtu = (layout ? tx_dx : -tx_dx)/texw;
 		for (DWORD i = 0; i < nballvtx; i++)
 			ballgrp->Vtx[ballofs+i].tu += dtu;
 	}
 
 	aref->SetProjMode (layout);
+	ballvalid = false;
+}
+
+// ==============================================================
+
+void ADIBall::LoadPanel2D (int panelid, PANELHANDLE hPanel, DWORD viewW, DWORD viewH)
+{
+	// select the ball resolution for the largest panel magnification
+	// (see ShuttleA::ScalePanel)
+	double scale = max ((double)viewW/(double)PANEL2D_MAINW, 1.0);
+	SetBallLod (scale);
 }
 
 // ==============================================================
@@ -219,15 +248,9 @@ bool ADIBall::Redraw2D (SURFHANDLE surf)
 	const double ballspeed = 3.0;
 	double dangle_max = ballspeed*dt;
 
-	double drho = rho-rho_curr;
-	if (drho > PI)       drho -= PI2;
-	else if (drho < -PI) drho += PI2;
-	double dtht = tht-tht_curr;
-	if (dtht > PI)       dtht -= PI2;
-	else if (dtht < -PI) dtht += PI2;
-	double dphi = phi-phi_curr;
-	if (dphi > PI)       dphi -= PI2;
-	else if (dphi < -PI) dphi += PI2;
+	double drho = AngleDiff (rho, rho_curr);
+	double dtht = AngleDiff (tht, tht_curr);
+	double dphi = AngleDiff (phi, phi_curr);
 	double dangle = max (fabs(drho), max (fabs(dtht), fabs(dphi)));
 	if (dangle > dangle_max) {
 		double scale = dangle_max/dangle;
@@ -239,6 +262,21 @@ bool ADIBall::Redraw2D (SURFHANDLE surf)
 	tht_curr = tht;
 	phi_curr = phi;
 
+	// Only update the ball if it moves by a noticeable fraction of a pixel.
+	// Otherwise keep the previously drawn attitude for the ball and the
+	// needles, so that small changes accumulate until they become visible.
+	double ddisp = max (fabs(AngleDiff (rho, rho_disp)), max (fabs(AngleDiff (tht, tht_disp)), fabs(AngleDiff (phi, phi_disp))));
+	bool redraw_ball = (!ballvalid || ddisp*rad*lodscale >= ball_eps);
+	if (redraw_ball) {
+		rho_disp = rho;
+		tht_disp = tht;
+		phi_disp = phi;
+	} else {
+		rho = rho_disp;
+		tht = tht_disp;
+		phi = phi_disp;
+	}
+
 	DWORD i;
 
 	double sinp = sin(phi), cosp = cos(phi);
@@ -284,9 +322,10 @@ bool ADIBall::Redraw2D (SURFHANDLE surf)
 		c3 =  cosp*cost;
 	}
 
-	for (i = 0; i < nballvtx; i++) {
-		ballgrp->Vtx[ballofs+i].x = bb_cntx + (float)(a1*ballvtx0[i].x + b1*ballvtx0[i].y + c1*ballvtx0[i].z);
-		ballgrp->Vtx[ballofs+i].y = bb_cnty - (float)(a2*ballvtx0[i].x + b2*ballvtx0[i].y + c2*ballvtx0[i].z);
+	if (redraw_ball) {
+		float M[9] = {(float)a1, (float)b1, (float)c1, (float)a2, (float)b2, (float)c2, (float)a3, (float)b3, (float)c3};
+		TransformBall (M);
+		ballvalid = true;
 	}
 
 	// Roll indicator transformation
@@ -416,3 +455,168 @@ void ADIBall::MakeBall (int res, double rad, NTVERTEX *&vtx, DWORD &nvtx, WORD *
 		}
 	}
 }
+
+// ==============================================================
+
+void ADIBall::MakeBallLod (int res, NTVERTEX *vtx, WORD *idx)
+{
+	ClearBallLod ();
+
+	int i, j, k, n, lv;
+	int nrow = res*4+1;
+	int nvtx = (res*2+1) * nrow;
+	int nidx = res*2 * res*4 * 6;
+	double scl = PI05/(double)res;
+
+	// block position of each grid vertex: the vertices of the coarsest
+	// level first, followed by those added by each finer level
+	WORD *pos = new WORD[nvtx];
+	memset (pos, 0xFF, nvtx*sizeof(WORD));
+	for (lv = NBALLLOD-1, k = 0; lv >= 0; lv--) {
+		int step = 1 << lv;
+		for (j = 0; j <= res*2; j += step)
+			for (i = 0; i <= res*4; i += step)
+				if (pos[j*nrow+i] == 0xFFFF) pos[j*nrow+i] = (WORD)k++;
+	}
+	NTVERTEX *tmp = new NTVERTEX[nvtx];
+	for (k = 0; k < nvtx; k++) tmp[pos[k]] = vtx[k];
+	memcpy (vtx, tmp, nvtx*sizeof(NTVERTEX));
+	delete []tmp;
+	for (k = 0; k < nidx; k++) idx[k] = pos[idx[k]];
+
+	for (lv = 0; lv < NBALLLOD; lv++) {
+		BallLod &L = balllod[lv];
+		int step = 1 << lv;
+		int lres = res/step;
+
+		// vertex subset, stored as aligned coordinate streams for TransformBall
+		L.nvtx = (lres*2+1) * (lres*4+1);
+		L.nvtx4 = (L.nvtx+3) & ~3;
+		L.x = (float*)_mm_malloc (L.nvtx4*sizeof(float), 16);
+		L.y = (float*)_mm_malloc (L.nvtx4*sizeof(float), 16);
+		L.z = (float*)_mm_malloc (L.nvtx4*sizeof(float), 16);
+		for (j = 0; j <= lres*2; j++) {
+			double tht = (double)(j*step)*scl;
+			double sint = sin(tht), cost = cos(tht);
+			for (i = 0; i <= lres*4; i++) {
+				double phi = (double)(i*step)*scl;
+				k = pos[j*step*nrow + i*step];
+				L.x[k] = (float)(sin(phi)*sint*rad);
+				L.y[k] = (float)(cost*rad);
+				L.z[k] = (float)(cos(phi)*sint*rad);
+			}
+		}
+		for (k = L.nvtx; k < (int)L.nvtx4; k++) { // pad with copies of the last vertex
+			L.x[k] = L.x[k-1]; L.y[k] = L.y[k-1]; L.z[k] = L.z[k-1];
+		}
+
+		// Vertices further behind the ball's visible hemisphere than the
+		// diagonal of a grid cell cannot contribute to a visible triangle.
+		L.cullz = (float)(-rad*sin(min (1.5*step*scl, PI05)));
+
+		// index list
+		L.nidx = lres*2 * lres*4 * 6;
+		L.idx = new WORD[L.nidx];
+		for (j = n = 0; j < lres*2; j++) {
+			for (i = 0; i < lres*4; i++) {
+				WORD v00 = pos[ j   *step*nrow +  i   *step];
+				WORD v01 = pos[ j   *step*nrow + (i+1)*step];
+				WORD v10 = pos[(j+1)*step*nrow +  i   *step];
+				WORD v11 = pos[(j+1)*step*nrow + (i+1)*step];
+				L.idx[n++] = v00;
+				L.idx[n++] = v01;
+				L.idx[n++] = v10;
+				L.idx[n++] = v10;
+				L.idx[n++] = v01;
+				L.idx[n++] = v11;
+			}
+		}
+	}
+	delete []pos;
+}
+
+// ==============================================================
+
+void ADIBall::ClearBallLod ()
+{
+	for (int lv = 0; lv < NBALLLOD; lv++) {
+		BallLod &L = balllod[lv];
+		if (L.idx) {
+			_mm_free (L.x);
+			_mm_free (L.y);
+			_mm_free (L.z);
+			delete []L.idx;
+		}
+		memset (&L, 0, sizeof(BallLod));
+	}
+}
+
+// ==============================================================
+
+void ADIBall::SetBallLod (double scale)
+{
+	lodscale = scale;
+	double r = rad*scale; // on-screen ball radius
+	int newlod = (r >= lod_rad[0] ? 0 : r >= lod_rad[1] ? 1 : 2);
+	if (newlod == lod || !balllod[newlod].idx) return;
+
+	// the vertices of the level are at the start of the ball vertex block,
+	// so only the level's vertices and triangles are passed to the renderer
+	lod = newlod;
+	const BallLod &L = balllod[lod];
+	WORD *idx = ballgrp->Idx + ballidxofs;
+	for (DWORD i = 0; i < L.nidx; i++)
+		idx[i] = (WORD)(ballofs + L.idx[i]);
+	ballgrp->nIdx = ballidxofs + L.nidx;
+	ballgrp->nVtx = ballofs + L.nvtx;
+	ballvalid = false;
+}
+
+// ==============================================================
+
+void ADIBall::TransformBall (const float *M)
+{
+	// Rotate the vertices of the current resolution level four at a time.
+	// Vertices culled by depth are collapsed onto the ball centre, which
+	// is the projection of the far pole, so that triangles sharing culled
+	// vertices remain back-facing.
+
+	const BallLod &L = balllod[lod];
+	NTVERTEX *vtx = ballgrp->Vtx + ballofs;
+	const __m128 a1 = _mm_set1_ps (M[0]), b1 = _mm_set1_ps (M[1]), c1 = _mm_set1_ps (M[2]);
+	const __m128 a2 = _mm_set1_ps (M[3]), b2 = _mm_set1_ps (M[4]), c2 = _mm_set1_ps (M[5]);
+	const __m128 a3 = _mm_set1_ps (M[6]), b3 = _mm_set1_ps (M[7]), c3 = _mm_set1_ps (M[8]);
+	const __m128 cntx = _mm_set1_ps (bb_cntx), cnty = _mm_set1_ps (bb_cnty);
+	const __m128 cullz = _mm_set1_ps (L.cullz);
+	float px[4], py[4];
+	DWORD i, k, n;
+
+	for (i = 0; i < L.nvtx4; i += 4) {
+		n = min (L.nvtx-i, (DWORD)4);
+		__m128 x = _mm_load_ps (L.x+i);
+		__m128 y = _mm_load_ps (L.y+i);
+		__m128 z = _mm_load_ps (L.z+i);
+		__m128 pz = _mm_add_ps (_mm_add_ps (_mm_mul_ps (a3, x), _mm_mul_ps (b3, y)), _mm_mul_ps (c3, z));
+		int cull = _mm_movemask_ps (_mm_cmplt_ps (pz, cullz));
+		if (cull == 0xF) {
+			for (k = 0; k < n; k++) {
+				NTVERTEX &v = vtx[i+k];
+				v.x = bb_cntx;
+				v.y = bb_cnty;
+			}
+			continue;
+		}
+		_mm_storeu_ps (px, _mm_add_ps (cntx, _mm_add_ps (_mm_add_ps (_mm_mul_ps (a1, x), _mm_mul_ps (b1, y)), _mm_mul_ps (c1, z))));
+		_mm_storeu_ps (py, _mm_sub_ps (cnty, _mm_add_ps (_mm_add_ps (_mm_mul_ps (a2, x), _mm_mul_ps (b2, y)), _mm_mul_ps (c2, z))));
+		for (k = 0; k < n; k++) {
+			NTVERTEX &v = vtx[i+k];
+			if (cull & (1 << k)) {
+				v.x = bb_cntx;
+				v.y = bb_cnty;
+			} else {
+				v.x = px[k];
+				v.y = py[k];
+			}
+		}
+	}
+}
@@ -23,21 +23,72 @@ public:
 	void AddMeshData2D (MESHHANDLE hMesh, DWORD grpidx_ball, DWORD grpidx_ind);
 	void SetLayout (int _layout);
 	inline void SetRateMode (bool local) { rate_local = local; }
+	void LoadPanel2D (int panelid, PANELHANDLE hPanel, DWORD viewW, DWORD viewH);
+
+	/**
+	 * \brief Update the ball and indicator vertices.
+	 * \return false. The instrument is drawn entirely from mesh vertices, so
+	 *   the panel surface is never modified, whether or not the ball update
+	 *   is skipped.
+	 */
 	bool Redraw2D (SURFHANDLE surf);
 	
 protected:
 	void MakeBall (int res, double rad, NTVERTEX *&vtx, DWORD &nvtx, WORD *&idx, DWORD &nidx);
 
+	/**
+	 * \brief Build the vertex and index lists for all ball resolution levels.
+	 * \param res ball resolution of the full-resolution mesh (level 0)
+	 * \param vtx full-resolution vertex list, as returned by MakeBall
+	 * \param idx full-resolution index list, as returned by MakeBall
+	 * \note Level i uses every (2^i)-th latitude and longitude line of the
+	 *   full-resolution mesh, so all levels share the same vertex block.
+	 * \note vtx is reordered so that the vertices of each level come first
+	 *   (coarsest level first), and idx is remapped accordingly. A level then
+	 *   uses the first nvtx vertices of the block.
+	 */
+	void MakeBallLod (int res, NTVERTEX *vtx, WORD *idx);
+	void ClearBallLod ();
+
+	/**
+	 * \brief Select the ball resolution level from the on-screen ball radius.
+	 * \param scale panel scaling factor (screen pixels per panel pixel)
+	 * \note Sets the vertex and index counts of the ball mesh group to those
+	 *   of the level, so the ball must be the only geometry in its group.
+	 */
+	void SetBallLod (double scale);
+
+	/**
+	 * \brief Rotate and project the vertices of the active resolution level.
+	 * \param M ball rotation matrix rows (a1,b1,c1, a2,b2,c2, a3,b3,c3)
+	 */
+	void TransformBall (const float *M);
+
 private:
 	int layout;           // 0: pitch range=-90..90, 1: pitch range=0..360
 	AttitudeReference *aref;
 	double rho_curr, tht_curr, phi_curr;  // current Euler angles
 	double tgtx_curr, tgty_curr;          // current error needle positions
-	VECTOR3 *ballvtx0;    // untransformed ball vertex coordinates
+	double rho_disp, tht_disp, phi_disp;  // Euler angles of the ball as last drawn
 	MESHGROUP *ballgrp;
 	MESHGROUP *indgrp;
 	DWORD nballvtx;
+	DWORD nballidx;       // index count of the full-resolution ball
 	DWORD ballofs;
+	DWORD ballidxofs;     // offset of the ball index block in the mesh group
+
+	enum { NBALLLOD = 3 };
+	struct BallLod {      // ball resolution level
+		DWORD nvtx;       // number of vertices used by the level (the first nvtx of the block)
+		DWORD nvtx4;      // nvtx padded to a multiple of 4
+		float *x, *y, *z; // untransformed coordinates of the used vertices (16-byte aligned)
+		DWORD nidx;       // number of triangle indices
+		WORD *idx;        // triangle index list
+		float cullz;      // depth limit below which vertices can be culled
+	} balllod[NBALLLOD];
+	int lod;              // current ball resolution level
+	double lodscale;      // panel scale used for level selection
+	bool ballvalid;       // ball vertices are consistent with rho_disp, tht_disp, phi_disp
 	DWORD rollindofs;
 	DWORD prateofs, brateofs, yrateofs;
 	DWORD yeofs, peofs, tfofs;
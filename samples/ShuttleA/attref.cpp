@@ -17,52 +17,65 @@ AttitudeReference::AttitudeReference (const VESSEL *vessel)
 	mode = 0;
 	tgtmode = 0;
 	navid = 0;
-	valid_axes = false;
-	valid_euler = false;
-	valid_tgteuler = false;
+	euler = _V(0,0,0);
+	tgteuler = _V(0,0,0);
+	have_tgteuler = false;
 	euler_offs = _V(0,0,0);
 	tgt_offs = _V(0,0,0);
 	tgt_rvel = _V(0,0,0);
 	tgt_ppos = _V(0,0,0);
 	tgt_ptime = 0;
+	step = 0;
+	axes_step = euler_step = tgteuler_step = INVALID;
+
+	// nothing is published before the first step
+	snap.mode = snap.projmode = snap.tgtmode = snap.navid = 0;
+	snap.R = _M(1,0,0, 0,1,0, 0,0,1);
+	snap.euler = snap.tgteuler = _V(0,0,0);
+	snap.have_tgteuler = false;
+	snap.simt = 0.0;
+	snapseq = 0;
+	snapreq = 0;
 }
 
 // ==============================================================
 
 void AttitudeReference::SetProjMode (int newmode)
 {
-	projmode = newmode;
-	valid_axes = false;
-	valid_euler = false;
-	valid_tgteuler = false;
+	if (newmode != projmode) {
+		projmode = newmode;
+		euler_step = tgteuler_step = INVALID; // the frame itself doesn't depend on the projection
+	}
 }
 
 // ==============================================================
 
 void AttitudeReference::SetMode (int newmode)
 {
-	mode = newmode;
-	valid_axes = false;
-	valid_euler = false;
-	valid_tgteuler = false;
+	if (newmode != mode) {
+		mode = newmode;
+		axes_step = euler_step = tgteuler_step = INVALID;
+	}
 }
 
 // ==============================================================
 
 void AttitudeReference::SetTgtmode (int newmode)
 {
-	tgtmode = newmode;
+	if (newmode != tgtmode) {
+		tgtmode = newmode;
+		tgteuler_step = INVALID;
+	}
 }
 
 // ==============================================================
 
 void AttitudeReference::SetNavid (int newnavid)
 {
-	navid = newnavid;
-	if (mode == 4) {
-		valid_axes = false;
-		valid_euler = false;
-		valid_tgteuler = false;
+	if (newnavid != navid) {
+		navid = newnavid;
+		if (mode == 4)
+			axes_step = euler_step = tgteuler_step = INVALID;
 	}
 }
 
@@ -72,7 +85,7 @@ void AttitudeReference::SetEulerOffset (const VECTOR3 &ofs)
 {
 	for (int i = 0; i < 3; i++)
 		euler_offs.data[i] = posangle (ofs.data[i]);
-	valid_euler = false;
+	euler_step = INVALID;
 }
 
 // ==============================================================
@@ -81,6 +94,7 @@ void AttitudeReference::SetTgtOffset (const VECTOR3 &ofs)
 {
 	for (int i = 0; i < 3; i++)
 		tgt_offs.data[i] = posangle (ofs.data[i]);
+	tgteuler_step = INVALID;
 }
 
 // ==============================================================
@@ -89,7 +103,7 @@ const MATRIX3 &AttitudeReference::GetFrameRotMatrix () const
 {
 	// Returns rotation matrix for rotation from reference frame to global frame
 
-	if (!valid_axes) {
+	if (axes_step != step) {
 		VECTOR3 axis1, axis2, axis3;
 		switch (mode) {
 		case 0:    // inertial (ecliptic)
@@ -157,8 +171,8 @@ const MATRIX3 &AttitudeReference::GetFrameRotMatrix () const
 		axis1 = crossp(axis2,axis3);
 		R = _M(axis1.x, axis2.x, axis3.x,  axis1.y, axis2.y, axis3.y,  axis1.z, axis2.z, axis3.z);
 
-		valid_axes = true;
-		valid_euler = false;
+		axes_step = step;
+		euler_step = tgteuler_step = INVALID; // depend on the frame
 	}
 	return R;
 }
@@ -167,9 +181,10 @@ const MATRIX3 &AttitudeReference::GetFrameRotMatrix () const
 
 const VECTOR3 &AttitudeReference::GetEulerAngles () const
 {
-	if (!valid_euler) {
-		// Update the axes of the reference frame
-		const MATRIX3 &Rref = GetFrameRotMatrix();
+	// Update the axes of the reference frame
+	const MATRIX3 &Rref = GetFrameRotMatrix();
+
+	if (euler_step != step) {
 
 		// Rotation matrix ship->global
 		MATRIX3 srot;
@@ -196,7 +211,7 @@ const VECTOR3 &AttitudeReference::GetEulerAngles () const
 		for (int i = 0; i < 3; i++)
 			euler.data[i] = posangle (euler.data[i]);
 
-		valid_euler = true;
+		euler_step = step;
 	}
 
 	return euler;
@@ -206,7 +221,11 @@ const VECTOR3 &AttitudeReference::GetEulerAngles () const
 
 bool AttitudeReference::GetTgtEulerAngles (VECTOR3 &tgt_euler) const
 {
-	if (!valid_tgteuler) {
+	if (mode >= 4 && (tgtmode == 2 || tgtmode == 3))
+		GetFrameRotMatrix(); // the target direction is mapped into the reference frame
+
+	if (tgteuler_step != step) {
+		tgteuler.x = 0.0;
 		switch (tgtmode) {
 			case 1:  // fixed
 				tgteuler.y = tgteuler.z = 0.0;
@@ -246,8 +265,8 @@ bool AttitudeReference::GetTgtEulerAngles (VECTOR3 &tgt_euler) const
 				have_tgteuler = false;
 				break;
 		}
+		tgteuler_step = step;
 	}
-	valid_tgteuler = true;
 	tgt_euler = tgteuler;
 	return have_tgteuler;;
 }
@@ -256,10 +275,52 @@ bool AttitudeReference::GetTgtEulerAngles (VECTOR3 &tgt_euler) const
 
 void AttitudeReference::PostStep (double simt, double simdt, double mjd)
 {
-	valid_axes = false;
-	valid_euler = false;
-	valid_tgteuler = false;
+	step++; // invalidates all cached values
+	UpdateTgtRvel ();
+	if (snapreq) Publish ();
+}
+
+// ==============================================================
+
+void AttitudeReference::GetState (AttrefState &state) const
+{
+	if (!snapreq) InterlockedExchange (&snapreq, 1);
 
+	// seqlock read: retry if the snapshot was updated while copying
+	LONG seq;
+	do {
+		while ((seq = snapseq) & 1)
+			YieldProcessor ();
+		MemoryBarrier ();
+		state = snap;
+		MemoryBarrier ();
+	} while (snapseq != seq);
+}
+
+// ==============================================================
+
+void AttitudeReference::Publish ()
+{
+	// evaluate on the simulation thread, then copy into the snapshot
+	AttrefState s;
+	s.mode = mode;
+	s.projmode = projmode;
+	s.tgtmode = tgtmode;
+	s.navid = navid;
+	s.R = GetFrameRotMatrix();
+	s.euler = GetEulerAngles();
+	s.have_tgteuler = GetTgtEulerAngles (s.tgteuler);
+	s.simt = oapiGetSimTime();
+
+	InterlockedIncrement (&snapseq); // odd: update in progress
+	snap = s;
+	InterlockedIncrement (&snapseq); // even: consistent
+}
+
+// ==============================================================
+
+void AttitudeReference::UpdateTgtRvel ()
+{
 	if (mode >= 4 && tgtmode == 3) {
 		NAVHANDLE hNav = v->GetNavSource (navid);
 		if (hNav) {
@@ -13,6 +13,16 @@
 
 #include "Orbitersdk.h"
 
+// Snapshot of the attitude reference state, as published once per step
+struct AttrefState {
+	int mode, projmode, tgtmode, navid;
+	MATRIX3 R;           // rotation reference frame -> global frame
+	VECTOR3 euler;       // vessel Euler angles in the reference frame (incl. offset)
+	VECTOR3 tgteuler;    // target Euler angles (valid if have_tgteuler)
+	bool have_tgteuler;
+	double simt;         // simulation time of the snapshot
+};
+
 class AttitudeReference {
 public:
 	AttitudeReference (const VESSEL *vessel);
@@ -41,7 +51,21 @@ public:
 	inline const VECTOR3 &GetTgtOffset () const { return tgt_offs; }
 	void PostStep (double simt, double simdt, double mjd);
 
+	/**
+	 * \brief Copy of the state published at the end of the last step.
+	 * \note Lock-free and safe to call from any thread. The frame, Euler and
+	 *   target Euler getters above return the same values, but are only valid
+	 *   on the simulation thread.
+	 * \note Publishing costs a frame and Euler angle evaluation per step, so
+	 *   it only starts with the first call of this method. That call returns
+	 *   the initial state (simt = 0).
+	 */
+	void GetState (AttrefState &state) const;
+
 private:
+	void UpdateTgtRvel ();
+	void Publish ();
+
 	const VESSEL *v;
 	int projmode;
 	int mode;
@@ -55,10 +79,20 @@ private:
 	mutable VECTOR3 tgt_rvel;
 	mutable VECTOR3 tgt_ppos;
 	mutable double  tgt_ptime;
-	mutable bool valid_axes;
-	mutable bool valid_euler;
-	mutable bool valid_tgteuler;
 	mutable bool have_tgteuler;
+
+	// Cached values are stamped with the step they were computed in, and
+	// are recomputed on first access after PostStep or a change of a
+	// parameter they depend on (stamp reset to INVALID)
+	enum { INVALID = -1 };
+	int step;                  // step counter, incremented by PostStep
+	mutable int axes_step;     // step of R
+	mutable int euler_step;    // step of euler
+	mutable int tgteuler_step; // step of tgteuler
+
+	AttrefState snap;          // published state
+	volatile LONG snapseq;     // snapshot sequence counter (odd while writing)
+	mutable volatile LONG snapreq; // set by GetState: publish from the next step on
 };
 
 #endif // !__ATTREF_H
\ No newline at end of file
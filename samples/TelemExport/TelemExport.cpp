@@ -0,0 +1,205 @@
+// ==============================================================
+//                ORBITER MODULE: TelemExport
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// TelemExport.cpp
+//
+// Publishes the state of all vessels at the end of each time step
+// into a shared memory region, for use by external processes. See
+// Common\Vessel\TelemFrame.h for the layout and TelemReader.h for a
+// reader.
+// ==============================================================
+
+#define STRICT 1
+#define ORBITER_MODULE
+#include "Orbitersdk.h"
+#include "..\Common\Vessel\TelemFrame.h"
+#include "..\Common\Vessel\VesselMsg.h"
+
+// ==============================================================
+// The module interface class
+
+namespace oapi {
+
+class TelemExport: public Module {
+public:
+	TelemExport (HINSTANCE hDLL);
+	~TelemExport ();
+	void clbkSimulationStart (RenderMode mode);
+	void clbkSimulationEnd ();
+	void clbkPostStep (double simt, double simdt, double mjd);
+
+private:
+	void Export (VESSEL *v, TELEM_VESSEL &rec, double simt, double mjd, OBJHANDLE hFocus);
+	HANDLE hMap;
+	TELEM_HEADER *hdr;
+};
+
+}; // namespace oapi
+
+using namespace oapi;
+
+static TelemExport *g_Export = 0;
+
+// ==============================================================
+// TelemExport implementation
+
+TelemExport::TelemExport (HINSTANCE hDLL): Module (hDLL)
+{
+	hMap = NULL;
+	hdr = NULL;
+}
+
+// --------------------------------------------------------------
+
+TelemExport::~TelemExport ()
+{
+	clbkSimulationEnd();
+}
+
+// --------------------------------------------------------------
+
+void TelemExport::clbkSimulationStart (RenderMode mode)
+{
+	DWORD size = sizeof(TELEM_HEADER) + TELEM_MAXVESSEL*sizeof(TELEM_SLOT);
+	hMap = CreateFileMapping (INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, size, TELEM_SHM_NAME);
+	if (!hMap) return;
+	hdr = (TELEM_HEADER*)MapViewOfFile (hMap, FILE_MAP_ALL_ACCESS, 0, 0, size);
+	if (!hdr) {
+		CloseHandle (hMap);
+		hMap = NULL;
+		return;
+	}
+	// slot sequence counters are left as they are, so that readers
+	// attached to a region from a previous session stay consistent
+	hdr->version = TELEM_VERSION;
+	hdr->maxvessel = TELEM_MAXVESSEL;
+	hdr->slotsize = sizeof(TELEM_SLOT);
+	hdr->nvessel = 0;
+	MemoryBarrier();
+	hdr->magic = TELEM_MAGIC;
+}
+
+// --------------------------------------------------------------
+
+void TelemExport::clbkSimulationEnd ()
+{
+	if (hdr) {
+		hdr->magic = 0;
+		UnmapViewOfFile (hdr);
+		hdr = NULL;
+	}
+	if (hMap) {
+		CloseHandle (hMap);
+		hMap = NULL;
+	}
+}
+
+// --------------------------------------------------------------
+
+void TelemExport::clbkPostStep (double simt, double simdt, double mjd)
+{
+	if (!hdr) return;
+
+	OBJHANDLE hFocus = oapiGetFocusObject();
+	DWORD i, n = oapiGetVesselCount();
+	if (n > TELEM_MAXVESSEL) n = TELEM_MAXVESSEL;
+
+	for (i = 0; i < n; i++) {
+		TELEM_SLOT *s = TelemSlot (hdr, i);
+		VESSEL *v = oapiGetVesselInterface (oapiGetVesselByIndex (i));
+		TelemBeginUpdate (s);
+		Export (v, s->rec, simt, mjd, hFocus);
+		TelemEndUpdate (s);
+	}
+	hdr->nvessel = (LONG)n;
+	InterlockedIncrement (&hdr->frame);
+}
+
+// --------------------------------------------------------------
+
+void TelemExport::Export (VESSEL *v, TELEM_VESSEL &rec, double simt, double mjd, OBJHANDLE hFocus)
+{
+	DWORD i, n;
+	VECTOR3 p, q;
+	MATRIX3 R;
+	OBJHANDLE hVessel = v->GetHandle();
+	OBJHANDLE hRef = v->GetGravityRef();
+
+	strncpy (rec.name, v->GetName(), 31); rec.name[31] = '\0';
+	if (hRef) oapiGetObjectName (hRef, rec.ref, 32);
+	else rec.ref[0] = '\0';
+	rec.simt = simt;
+	rec.mjd = mjd;
+
+	v->GetGlobalPos (p);
+	v->GetGlobalVel (q);
+	rec.gpos[0] = p.x, rec.gpos[1] = p.y, rec.gpos[2] = p.z;
+	rec.gvel[0] = q.x, rec.gvel[1] = q.y, rec.gvel[2] = q.z;
+	if (hRef) {
+		v->GetRelativePos (hRef, p);
+		v->GetRelativeVel (hRef, q);
+	} else p = q = _V(0,0,0);
+	rec.rpos[0] = p.x, rec.rpos[1] = p.y, rec.rpos[2] = p.z;
+	rec.rvel[0] = q.x, rec.rvel[1] = q.y, rec.rvel[2] = q.z;
+
+	v->GetRotationMatrix (R);
+	for (i = 0; i < 9; i++) rec.rotm[i] = R.data[i];
+	v->GetGlobalOrientation (p);
+	rec.arot[0] = p.x, rec.arot[1] = p.y, rec.arot[2] = p.z;
+	v->GetAngularVel (p);
+	rec.vrot[0] = p.x, rec.vrot[1] = p.y, rec.vrot[2] = p.z;
+
+	rec.alt      = v->GetAltitude();
+	rec.pitch    = v->GetPitch();
+	rec.bank     = v->GetBank();
+	rec.yaw      = v->GetYaw();
+	rec.airspeed = v->GetAirspeed();
+	rec.dynpres  = v->GetDynPressure();
+	rec.mach     = v->GetMachNumber();
+
+	rec.mass      = v->GetMass();
+	rec.emptymass = v->GetEmptyMass();
+	rec.propmass  = v->GetTotalPropellantMass();
+	n = v->GetPropellantCount();
+	rec.ntank = (n < TELEM_MAXTANK ? n : TELEM_MAXTANK);
+	for (i = 0; i < rec.ntank; i++)
+		rec.tank[i] = v->GetPropellantMass (v->GetPropellantHandleByIndex (i));
+
+	for (i = 0; i < TELEM_NTHGROUP; i++)
+		rec.thgroup[i] = v->GetThrusterGroupLevel ((THGROUP_TYPE)i);
+	for (i = 0; i < TELEM_NCTRLSURF; i++)
+		rec.ctrlsurf[i] = v->GetControlSurfaceLevel ((AIRCTRL_TYPE)i);
+
+	rec.navmode = 0;
+	for (i = NAVMODE_KILLROT; i <= NAVMODE_HOLDALT; i++)
+		if (v->GetNavmodeState (i)) rec.navmode |= (1 << i);
+
+	rec.flags = 0;
+	if (v->GetFlightStatus() & 1) rec.flags |= TELEM_LANDED;
+	if (v->GroundContact())       rec.flags |= TELEM_CONTACT;
+	if (hVessel == hFocus)        rec.flags |= TELEM_FOCUS;
+
+	// vessel-defined subsystem values
+	rec.nuser = 0;
+	if (VesselAcceptsMsg (v, TELEM_VMSG)) {
+		int nu = ((VESSEL3*)v)->clbkGeneric (TELEM_VMSG, TELEM_MAXUSER, rec.user);
+		if (nu > 0) rec.nuser = (nu < TELEM_MAXUSER ? nu : TELEM_MAXUSER);
+	}
+}
+
+// ==============================================================
+// DLL entry and exit points
+
+DLLCLBK void InitModule (HINSTANCE hDLL)
+{
+	g_Export = new TelemExport (hDLL);
+	oapiRegisterModule (g_Export);
+}
+
+DLLCLBK void ExitModule (HINSTANCE hDLL)
+{
+	delete g_Export;
+}
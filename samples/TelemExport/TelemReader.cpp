@@ -0,0 +1,117 @@
+// ==============================================================
+//                ORBITER MODULE: TelemExport
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// TelemReader.cpp
+// Implementation for class TelemetryReader
+// ==============================================================
+
+#include "TelemReader.h"
+#include <string.h>
+
+// ==============================================================
+
+TelemetryReader::TelemetryReader ()
+{
+	hMap = NULL;
+	hdr = NULL;
+}
+
+// --------------------------------------------------------------
+
+TelemetryReader::~TelemetryReader ()
+{
+	Close();
+}
+
+// --------------------------------------------------------------
+
+bool TelemetryReader::Open ()
+{
+	Close();
+	hMap = OpenFileMapping (FILE_MAP_READ, FALSE, TELEM_SHM_NAME);
+	if (!hMap) return false;
+	hdr = (TELEM_HEADER*)MapViewOfFile (hMap, FILE_MAP_READ, 0, 0, 0);
+	if (hdr && (hdr->version != TELEM_VERSION || hdr->slotsize != sizeof(TELEM_SLOT))) {
+		UnmapViewOfFile (hdr);
+		hdr = NULL;
+	}
+	if (!hdr) {
+		CloseHandle (hMap);
+		hMap = NULL;
+		return false;
+	}
+	return true;
+}
+
+// --------------------------------------------------------------
+
+void TelemetryReader::Close ()
+{
+	if (hdr) {
+		UnmapViewOfFile (hdr);
+		hdr = NULL;
+	}
+	if (hMap) {
+		CloseHandle (hMap);
+		hMap = NULL;
+	}
+}
+
+// --------------------------------------------------------------
+
+bool TelemetryReader::Active () const
+{
+	return hdr && hdr->magic == TELEM_MAGIC;
+}
+
+// --------------------------------------------------------------
+
+DWORD TelemetryReader::Frame () const
+{
+	return (hdr ? (DWORD)hdr->frame : 0);
+}
+
+// --------------------------------------------------------------
+
+int TelemetryReader::VesselCount () const
+{
+	if (!hdr) return 0;
+	int n = hdr->nvessel;
+	return (n < (int)hdr->maxvessel ? n : (int)hdr->maxvessel);
+}
+
+// --------------------------------------------------------------
+
+bool TelemetryReader::Read (int slot, TELEM_VESSEL &rec, int maxtry) const
+{
+	if (!hdr || slot < 0 || slot >= (int)hdr->maxvessel) return false;
+	const TELEM_SLOT *s = TelemSlot (hdr, slot);
+
+	for (int i = 0; i < maxtry; i++) {
+		LONG seq0 = s->seq;
+		if (seq0 & 1) {        // update in progress
+			YieldProcessor();
+			continue;
+		}
+		MemoryBarrier();
+		memcpy (&rec, (const void*)&s->rec, sizeof(TELEM_VESSEL));
+		MemoryBarrier();
+		if (s->seq == seq0) return true;
+	}
+	return false;
+}
+
+// --------------------------------------------------------------
+
+int TelemetryReader::FindVessel (const char *name) const
+{
+	int i, n = VesselCount();
+	for (i = 0; i < n; i++) {
+		const TELEM_SLOT *s = TelemSlot (hdr, i);
+		if (!strncmp ((const char*)s->rec.name, name, 32)) return i;
+	}
+	return -1;
+}
@@ -0,0 +1,75 @@
+// ==============================================================
+//                ORBITER MODULE: TelemExport
+//                  Part of the ORBITER SDK
+//          Copyright (C) 2001-2016 Martin Schweiger
+//                   All rights reserved
+//
+// TelemReader.h
+// Interface for class TelemetryReader:
+//   Reference reader for the telemetry export region, for use in
+//   client processes (cockpit displays, data recorders etc.).
+//   Compile TelemReader.cpp into the client. No Orbiter headers or
+//   libraries are required.
+// ==============================================================
+
+#ifndef __TELEMREADER_H
+#define __TELEMREADER_H
+
+#include "..\Common\Vessel\TelemFrame.h"
+
+class TelemetryReader {
+public:
+	TelemetryReader ();
+	~TelemetryReader ();
+
+	/**
+	 * \brief Map the telemetry region.
+	 * \return false if the exporter is not running.
+	 */
+	bool Open ();
+	void Close ();
+	inline bool IsOpen () const { return hdr != NULL; }
+
+	/**
+	 * \brief Returns true while the exporter is publishing.
+	 */
+	bool Active () const;
+
+	/**
+	 * \brief Number of published steps. Can be polled to detect new data.
+	 */
+	DWORD Frame () const;
+
+	/**
+	 * \brief Number of vessel slots in use.
+	 */
+	int VesselCount () const;
+
+	/**
+	 * \brief Copy a consistent vessel record.
+	 * \param slot slot index (0 <= slot < VesselCount())
+	 * \param rec record on return
+	 * \param maxtry max. number of attempts
+	 * \return false if no consistent copy was obtained within maxtry
+	 *   attempts (the record is being updated at a very high rate) or
+	 *   if the slot is invalid.
+	 * \note Never blocks the writer. A retry is only needed if the copy
+	 *   overlapped with an update of the same slot.
+	 */
+	bool Read (int slot, TELEM_VESSEL &rec, int maxtry = 100) const;
+
+	/**
+	 * \brief Find the slot of a named vessel.
+	 * \return slot index, or -1 if not found
+	 * \note Slots are assigned in vessel list order and change when
+	 *   vessels are created or deleted. Check the name of the returned
+	 *   record.
+	 */
+	int FindVessel (const char *name) const;
+
+private:
+	HANDLE hMap;
+	TELEM_HEADER *hdr;
+};
+
+#endif // !__TELEMREADER_H
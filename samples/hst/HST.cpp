@@ -25,13 +25,19 @@
 HST::HST (OBJHANDLE hObj, int fmodel)
 : VESSEL3 (hObj, fmodel)
 {
-	ant_proc = 0.0;
-	ant_status = DOOR_CLOSED;
-	hatch_proc = 0.0;
-	hatch_status = DOOR_CLOSED;
-	array_proc = 1.0;
-	array_status = DOOR_OPEN;
 	DefineAnimations ();
+	actuators = new ActuatorScheduler (this);
+	act_ant   = actuators->AddActuator (anim_ant,   ANTENNA_OPERATING_SPEED, 0.0);
+	act_hatch = actuators->AddActuator (anim_hatch, HATCH_OPERATING_SPEED,   0.0);
+	act_array = actuators->AddActuator (anim_array, ARRAY_OPERATING_SPEED,   1.0);
+}
+
+// --------------------------------------------------------------
+// Destructor
+// --------------------------------------------------------------
+HST::~HST ()
+{
+	delete actuators;
 }
 
 // --------------------------------------------------------------
@@ -74,37 +80,75 @@ void HST::DefineAnimations (void)
 
 void HST::ActivateAntenna (DoorStatus action)
 {
-	ant_status = action;
+	Activate (act_ant, action);
 }
 
 void HST::RevertAntenna (void)
 {
-	ActivateAntenna ((ant_status == DOOR_CLOSED || ant_status == DOOR_CLOSING) ?
-		DOOR_OPENING : DOOR_CLOSING);
+	Revert (act_ant);
 }
 
 void HST::ActivateHatch (DoorStatus action)
 {
-	hatch_status = action;
+	Activate (act_hatch, action);
 }
 
 void HST::RevertHatch (void)
 {
-	ActivateHatch ((hatch_status == DOOR_CLOSED || hatch_status == DOOR_CLOSING) ?
-		DOOR_OPENING : DOOR_CLOSING);
+	Revert (act_hatch);
 }
 
 void HST::ActivateArray (DoorStatus action)
 {
-	array_status = action;
+	Activate (act_array, action);
 }
 
 void HST::RevertArray (void)
 {
-	ActivateArray ((array_status == DOOR_CLOSED || array_status == DOOR_CLOSING) ?
+	Revert (act_array);
+}
+
+HST::DoorStatus HST::GetStatus (int actuator) const
+{
+	double speed = actuators->Speed (actuator);
+	if      (speed > 0.0) return DOOR_OPENING;
+	else if (speed < 0.0) return DOOR_CLOSING;
+	else return (actuators->State (actuator) >= 1.0 ? DOOR_OPEN : DOOR_CLOSED);
+}
+
+void HST::Activate (int actuator, DoorStatus action)
+{
+	switch (action) {
+	case DOOR_OPENING: actuators->Open (actuator);  break;
+	case DOOR_CLOSING: actuators->Close (actuator); break;
+	default:           actuators->Stop (actuator);  break;
+	}
+}
+
+void HST::Revert (int actuator)
+{
+	DoorStatus status = GetStatus (actuator);
+	Activate (actuator, (status == DOOR_CLOSED || status == DOOR_CLOSING) ?
 		DOOR_OPENING : DOOR_CLOSING);
 }
 
+void HST::ParseDoorStatus (const char *line, int actuator)
+{
+	int status = DOOR_CLOSED;
+	double proc = actuators->State (actuator);
+	sscanf (line, "%d%lf", &status, &proc);
+	actuators->SetState (actuator, proc);
+	if (status == DOOR_OPENING || status == DOOR_CLOSING)
+		Activate (actuator, (DoorStatus)status);
+}
+
+void HST::SaveDoorStatus (FILEHANDLE scn, const char *label, int actuator)
+{
+	char cbuf[256];
+	sprintf (cbuf, "%d %0.4f", GetStatus (actuator), actuators->State (actuator));
+	oapiWriteScenario_string (scn, (char*)label, cbuf);
+}
+
 // ==============================================================
 // Overloaded callback functions
 // ==============================================================
@@ -127,19 +171,20 @@ void HST::clbkLoadStateEx (FILEHANDLE scn, void *vs)
 
 	while (oapiReadScenario_nextline (scn, line)) {
 		if (!_strnicmp (line, "ANT", 3)) {
-			sscanf (line+3, "%d%lf", &ant_status, &ant_proc);
+			ParseDoorStatus (line+3, act_ant);
 		} else if (!_strnicmp (line, "HATCH", 5)) {
-			sscanf (line+5, "%d%lf", &hatch_status, &hatch_proc);
+			ParseDoorStatus (line+5, act_hatch);
 		} else if (!_strnicmp (line, "FOLD", 4)) {
-			sscanf (line+5, "%d%lf", &array_status, &array_proc);
+			ParseDoorStatus (line+4, act_array);
 		} else {
 			ParseScenarioLineEx (line, vs);
 		}
 	}
 
-	SetAnimation (anim_ant, ant_proc);
-	SetAnimation (anim_hatch, hatch_proc);
-	SetAnimation (anim_array, array_proc);
+	// apply the states of parts not listed in the scenario
+	actuators->SetState (act_ant,   actuators->State (act_ant),   actuators->Speed (act_ant));
+	actuators->SetState (act_hatch, actuators->State (act_hatch), actuators->Speed (act_hatch));
+	actuators->SetState (act_array, actuators->State (act_array), actuators->Speed (act_array));
 }
 
 // --------------------------------------------------------------
@@ -147,14 +192,10 @@ void HST::clbkLoadStateEx (FILEHANDLE scn, void *vs)
 // --------------------------------------------------------------
 void HST::clbkSaveState (FILEHANDLE scn)
 {
-	char cbuf[256];
 	SaveDefaultState (scn);
-	sprintf (cbuf, "%d %0.4f", ant_status, ant_proc);
-	oapiWriteScenario_string (scn, "ANT", cbuf);
-	sprintf (cbuf, "%d %0.4f", hatch_status, hatch_proc);
-	oapiWriteScenario_string (scn, "HATCH", cbuf);
-	sprintf (cbuf, "%d %0.4f", array_status, array_proc);
-	oapiWriteScenario_string (scn, "FOLD", cbuf);
+	SaveDoorStatus (scn, "ANT", act_ant);
+	SaveDoorStatus (scn, "HATCH", act_hatch);
+	SaveDoorStatus (scn, "FOLD", act_array);
 }
 
 // --------------------------------------------------------------
@@ -162,44 +203,8 @@ void HST::clbkSaveState (FILEHANDLE scn)
 // --------------------------------------------------------------
 void HST::clbkPostStep (double simt, double simdt, double mjd)
 {
-	// Animate hi-gain antenna
-	if (ant_status >= DOOR_CLOSING) {
-		double da = simdt * ANTENNA_OPERATING_SPEED;
-		if (ant_status == DOOR_CLOSING) {
-			if (ant_proc > 0.0) ant_proc = max (0.0, ant_proc-da);
-			else                ant_status = DOOR_CLOSED;
-		} else {
-			if (ant_proc < 1.0) ant_proc = min (1.0, ant_proc+da);
-			else                ant_status = DOOR_OPEN;
-		}
-		SetAnimation (anim_ant, ant_proc);
-	}
-
-	// Animate main telescope hatch
-	if (hatch_status >= DOOR_CLOSING) {
-		double da = simdt * HATCH_OPERATING_SPEED;
-		if (hatch_status == DOOR_CLOSING) {
-			if (hatch_proc > 0.0) hatch_proc = max (0.0, hatch_proc-da);
-			else                  hatch_status = DOOR_CLOSED;
-		} else {
-			if (hatch_proc < 1.0) hatch_proc = min (1.0, hatch_proc+da);
-			else                  hatch_status = DOOR_OPEN;
-		}
-		SetAnimation (anim_hatch, hatch_proc);
-	}
-
-	// Animate solar arrays
-	if (array_status >= DOOR_CLOSING) {
-		double da = simdt * ARRAY_OPERATING_SPEED;
-		if (array_status == DOOR_CLOSING) {
-			if (array_proc > 0.0) array_proc = max (0.0, array_proc-da);
-			else                  array_status = DOOR_CLOSED;
-		} else {
-			if (array_proc < 1.0) array_proc = min (1.0, array_proc+da);
-			else                  array_status = DOOR_OPEN;
-		}
-		SetAnimation (anim_array, array_proc);
-	}
+	// Animate antenna, hatch and solar arrays
+	actuators->Step (simdt);
 }
 
 // --------------------------------------------------------------
@@ -15,6 +15,7 @@
 
 #define STRICT
 #include "orbitersdk.h"
+#include "..\Common\Vessel\ActuatorSched.h"
 
 // ==============================================================
 // Some parameters and capabilities
@@ -32,8 +33,9 @@ const double ARRAY_OPERATING_SPEED = 0.02;
 
 class HST: public VESSEL3 {
 public:
-	enum DoorStatus { DOOR_CLOSED, DOOR_OPEN, DOOR_CLOSING, DOOR_OPENING } ant_status, hatch_status, array_status;
+	enum DoorStatus { DOOR_CLOSED, DOOR_OPEN, DOOR_CLOSING, DOOR_OPENING };
 	HST (OBJHANDLE hObj, int fmodel);
+	~HST ();
 	void DefineAnimations (void);
 	void ActivateAntenna (DoorStatus action);
 	void RevertAntenna (void);
@@ -41,6 +43,7 @@ public:
 	void RevertHatch (void);
 	void ActivateArray (DoorStatus action);
 	void RevertArray (void);
+	DoorStatus GetStatus (int actuator) const;
 
 	// Overloaded callback functions
 	void clbkSetClassCaps (FILEHANDLE cfg);
@@ -51,8 +54,14 @@ public:
 	int  clbkGeneric (int msgid, int prm, void *context);
 
 private:
+	void Activate (int actuator, DoorStatus action);
+	void Revert (int actuator);
+	void ParseDoorStatus (const char *line, int actuator);
+	void SaveDoorStatus (FILEHANDLE scn, const char *label, int actuator);
+
 	UINT anim_ant, anim_hatch, anim_array;
-	double ant_proc, hatch_proc, array_proc;
+	ActuatorScheduler *actuators;            // steps the moving parts
+	int act_ant, act_hatch, act_array;       // actuator identifiers
 
 	// script interface-related methods, implemented in HST_Lua.cpp
 	int Lua_InitInterpreter (void *context);